@@ -96,7 +96,10 @@ char** g_internal_macros = NULL;
 
 const char* intrinsics[] = {
     "clz32", "ctz32", "clz64", "ctz64",
-    "u128_low", "u128_high", "u128_multiply"
+    "popcount32", "popcount64", "bswap32", "bswap64", "rotl32", "rotl64",
+    "memory_copy", "memory_move", "memory_set",
+    "u128_low", "u128_high", "u128_multiply",
+    "skip_whitespace", "skip_identifier", "find_any4",
 };
 
 Kai_Allocator g_allocator = {0};
@@ -558,6 +561,10 @@ enum {
 };
 Identifier_Type generate_expression(String_Builder* builder, Kai_Expr* expr, int prec, int flags);
 
+// Set while generating the elements of a global array, where literals
+// must be plain initializers (a compound literal is not a constant in C)
+static bool g_constant_initializer = false;
+
 void generate_struct_literal(String_Builder* builder, Kai_Expr* expr)
 {
     ASSERT(expr->id == KAI_EXPR_LITERAL);
@@ -600,6 +607,179 @@ bool try_generate_builtin_array_procedure(String_Builder* builder, Kai_Expr_Proc
     return false;
 }
 
+typedef struct {
+    const char* name;
+    const char* command;
+    const char* field;
+    const char* accepts; // argument types that fit in the field without changing the value
+} Format_Spec;
+
+Format_Spec format_specs[] = {
+    {"u32",    "KAI_WRITE_U32",    "u32",    " u8 u16 u32 "},
+    {"s32",    "KAI_WRITE_S32",    "s32",    " s8 s16 s32 u8 u16 "},
+    {"u64",    "KAI_WRITE_U64",    "u64",    " u8 u16 u32 u64 "},
+    {"s64",    "KAI_WRITE_S64",    "s64",    " s8 s16 s32 s64 u8 u16 u32 "},
+    {"f64",    "KAI_WRITE_F64",    "f64",    " f32 f64 "},
+    {"string", "KAI_WRITE_STRING", "string", " string "},
+};
+
+// Literal text is collected until an argument (or the end) is written,
+// so pieces split by "{{" and "}}" are still one write.
+static void generate_format_piece(String_Builder* builder, String_Builder* literal, int* write_count)
+{
+    if (literal->count == 0) return;
+    if ((*write_count)++ != 0) sb_append(builder, ", ");
+    sb_appendf(builder, "writer->write(writer->user, KAI_WRITE_STRING, (Kai_Value){.string = KAI_STRING(\"%.*s\")}, (Kai_Write_Format){0})",
+        (int)literal->count, literal->items);
+    literal->count = 0;
+}
+
+static void format_error(Kai_Expr* expr, const char* message)
+{
+    nob_log(ERROR, "line %u: %s in format string", expr->line_number, message);
+    exit(1);
+}
+
+// Type expression of a format argument when it is declared or cast, otherwise NULL
+static Kai_Expr* format_argument_type(Kai_Expr* arg)
+{
+    switch (arg->id)
+    {
+    default: break;
+
+    case KAI_EXPR_IDENTIFIER: {
+        return lookup(temp_cstr_from_string(arg->source_code)).expr;
+    }
+
+    case KAI_EXPR_BINARY: {
+        Kai_Expr_Binary* bin = (void*)arg;
+        if (bin->op == KAI_MULTI('-','>',,))
+            return bin->right;
+        if (bin->op != '.' || bin->right->id != KAI_EXPR_IDENTIFIER)
+            break;
+        Kai_Expr* left = format_argument_type(bin->left);
+        if (left == NULL) break;
+        Kai_Expr_Struct* str = (void*)resolve_type(left);
+        if (str == NULL || str->id != KAI_EXPR_STRUCT) break;
+        Kai_Stmt_Declaration* decl = find_struct_member(str, bin->right->source_code);
+        if (decl != NULL) return decl->type;
+    } break;
+    }
+    return NULL;
+}
+
+// Arguments of a type that does not fit the specifier fail the build, arguments
+// of an unknown type (e.g. an enum or a call) are left to the C compiler.
+static void check_format_argument(Kai_Expr* format, Format_Spec* spec, Kai_Expr* arg)
+{
+    const char* name = NULL;
+    if (arg->id == KAI_EXPR_STRING)
+        name = "string";
+    else if (arg->id == KAI_EXPR_NUMBER) {
+        if (strcmp(spec->name, "string") == 0)
+            format_error(format, "number given for {string}");
+        return;
+    }
+    else {
+        Kai_Expr* type = format_argument_type(arg);
+        if (type == NULL) return;
+        if (type->id == KAI_EXPR_UNARY)
+            format_error(format, temp_sprintf("pointer given for {%s}", spec->name));
+        if (type->id != KAI_EXPR_IDENTIFIER) return;
+        name = temp_cstr_from_string(type->source_code);
+    }
+
+    bool known = strcmp(name, "string") == 0;
+    for (int k = 0; k < len(prim_types); ++k)
+        if (strcmp(name, prim_types[k]) == 0) known = true;
+    if (known && strstr(spec->accepts, temp_sprintf(" %s ", name)) == NULL)
+        format_error(format, temp_sprintf("%s given for {%s}", name, spec->name));
+}
+
+// `_writef("x = {u32}, name = {string}\n", x, name)` is parsed here, when generating C,
+// and lowered to one write call per argument and per run of literal text.
+// No format string is parsed at runtime. "{{" and "}}" write a single brace.
+void generate_format_write(String_Builder* builder, Kai_Expr_Procedure_Call* call)
+{
+    Kai_Expr* format = call->arg_head;
+    if (format == NULL || format->id != KAI_EXPR_STRING)
+        format_error((Kai_Expr*)call, "expected a string literal");
+
+    Kai_string source = format->source_code;
+    Kai_u8* data = source.data + 1; // skip quotes
+    Kai_u32 count = source.count - 2;
+    Kai_Expr* arg = format->next;
+    int write_count = 0;
+    String_Builder literal = {0};
+
+    sb_append(builder, "(");
+    for (Kai_u32 i = 0; i < count; ++i)
+    {
+        if (data[i] == '}') {
+            if (i + 1 >= count || data[i + 1] != '}')
+                format_error(format, "unmatched '}'");
+            da_append(&literal, '}');
+            i += 1;
+            continue;
+        }
+        if (data[i] != '{') {
+            da_append(&literal, data[i]);
+            continue;
+        }
+        if (i + 1 < count && data[i + 1] == '{') {
+            da_append(&literal, '{');
+            i += 1;
+            continue;
+        }
+
+        Kai_u32 end = i + 1;
+        while (end < count && data[end] != '}') end += 1;
+        if (end == count)
+            format_error(format, "unmatched '{'");
+
+        Format_Spec* spec = NULL;
+        for (int k = 0; k < len(format_specs); ++k)
+        {
+            if (strlen(format_specs[k].name) == end - i - 1
+            &&  memcmp(format_specs[k].name, data + i + 1, end - i - 1) == 0)
+                spec = &format_specs[k];
+        }
+        if (spec == NULL)
+            format_error(format, "unknown specifier");
+        if (arg == NULL)
+            format_error(format, "not enough arguments");
+        check_format_argument(format, spec, arg);
+
+        generate_format_piece(builder, &literal, &write_count);
+        if (write_count++ != 0) sb_append(builder, ", ");
+        sb_appendf(builder, "writer->write(writer->user, %s, (Kai_Value){.%s = ", spec->command, spec->field);
+        generate_expression(builder, arg, TOP_PRECEDENCE, NOT_TYPE);
+        sb_append(builder, "}, (Kai_Write_Format){0})");
+
+        arg = arg->next;
+        i = end;
+    }
+    generate_format_piece(builder, &literal, &write_count);
+    sb_free(literal);
+    if (arg != NULL)
+        format_error(format, "too many arguments");
+    if (write_count == 0)
+        sb_append(builder, "(void)0");
+    sb_append(builder, ")");
+}
+
+// Constants are written in capitals, so `[COUNT] T` is a fixed size array and not a hash table
+bool is_constant_name(Kai_string name)
+{
+    for (Kai_u32 i = 0; i < name.count; ++i)
+    {
+        Kai_u8 c = name.data[i];
+        if (!(c >= 'A' && c <= 'Z') && !(c >= '0' && c <= '9') && c != '_')
+            return false;
+    }
+    return true;
+}
+
 Identifier_Type generate_expression(String_Builder* builder, Kai_Expr* expr, int prec, int flags)
 {
     ASSERT(expr != NULL);
@@ -691,6 +871,12 @@ Identifier_Type generate_expression(String_Builder* builder, Kai_Expr* expr, int
     case KAI_EXPR_UNARY: {
         Kai_Expr_Unary* una = (void*)expr;
 
+        // Untyped literal, only valid as a nested initializer: `.{ ... }`
+        if (una->op == '.' && una->expr != NULL && una->expr->id == KAI_EXPR_LITERAL) {
+            generate_struct_literal(builder, una->expr);
+            break;
+        }
+
         int new_prec = binary_operator_precedence(una->op);
         bool parenthesis = flags & KEEP_ALL_PARENTHESIS || una->op == '~' || una->op == KAI_MULTI('-','>',,);
 
@@ -731,6 +917,11 @@ Identifier_Type generate_expression(String_Builder* builder, Kai_Expr* expr, int
                 op_str = "->";
             }
         }
+        if (op == '$' && g_constant_initializer)
+        {
+            generate_struct_literal(builder, bin->right);
+            break;
+        }
         int new_prec = binary_operator_precedence(op);
         if (new_prec == 4 && prec == 10) flags |= KEEP_ALL_PARENTHESIS; // silence warning
         if (new_prec >= prec || (flags & KEEP_ALL_PARENTHESIS)) da_append(builder, '(');
@@ -804,6 +995,11 @@ Identifier_Type generate_expression(String_Builder* builder, Kai_Expr* expr, int
             {
                 copy_source = true;
             }
+            else if (kai_string_equals(call->proc->source_code, KAI_STRING("_writef")))
+            {
+                generate_format_write(builder, call);
+                break;
+            }
             else if (kai_string_equals(call->proc->source_code, KAI_STRING("sizeof"))
                  ||  kai_string_equals(call->proc->source_code, KAI_STRING("LINKED_LIST")))
             {
@@ -824,7 +1020,12 @@ Identifier_Type generate_expression(String_Builder* builder, Kai_Expr* expr, int
         //	if (try_generate_builtin_array_procedure(builder, call))
         //		break;
         //}
-        if (!copy_source)
+        if (g_constant_initializer && call->proc->id == KAI_EXPR_IDENTIFIER
+        &&  kai_string_equals(call->proc->source_code, KAI_STRING("STRING")))
+        {
+            sb_append(builder, "KAI_CONST_STRING(");
+        }
+        else if (!copy_source)
         {	
             generate_expression(builder, call->proc, TOP_PRECEDENCE, NONE);
             sb_append(builder, "(");
@@ -1070,7 +1271,7 @@ void generate_all_data_structure_types(String_Builder* builder, Kai_Stmt* stmt)
                 }
             }
         }
-        else if (arr->rows->id == KAI_EXPR_IDENTIFIER)
+        else if (arr->rows->id == KAI_EXPR_IDENTIFIER && !is_constant_name(arr->rows->source_code))
         {
             String_Builder temp = {0};
             generate_expression(&temp, arr->rows, TOP_PRECEDENCE, NO_RENAME);
@@ -1216,6 +1417,7 @@ Kai_bool enum_excludes_name(Kai_string name)
     if (kai_string_equals(name, KAI_STRING("Result"))) return true;
     if (kai_string_equals(name, KAI_STRING("Write_Command"))) return true;
     if (kai_string_equals(name, KAI_STRING("_Builtin_Type_ID"))) return true;
+    if (kai_string_equals(name, KAI_STRING("_Intrinsic_ID"))) return true;
     return false;
 }
 
@@ -1327,6 +1529,119 @@ void generate_all_function_definitions(String_Builder* builder, Kai_Stmt_Compoun
 }
 
 bool g_go_through_case = false;
+int  g_string_case_index = -1; // >= 0 while generating the dispatch switch of a string if-case
+
+// Perfect hash over the case strings of a string if-case:
+//   h = (count*a + c(p)*b + c(q)) % n, where c(i) = i < count ? data[i] : 0
+typedef struct {
+    Kai_u32 a, b, p, q, n;
+} String_Case_Hash;
+
+static Kai_u32 string_case_char(Kai_string s, Kai_u32 i)
+{
+    return i < s.count ? s.data[i] : 0;
+}
+
+static Kai_u32 string_case_hash(String_Case_Hash h, Kai_string s)
+{
+    return (s.count * h.a + string_case_char(s, h.p) * h.b + string_case_char(s, h.q)) % h.n;
+}
+
+// Smallest table size wins; the search space is tiny, this runs once per if-case at build time.
+static bool find_string_case_hash(Kai_string* strings, Kai_u32 count, String_Case_Hash* out)
+{
+    Kai_u8 used[256];
+    for (Kai_u32 n = count; n <= 4 * count + 8 && n <= sizeof(used); ++n)
+    for (Kai_u32 a = 0; a < 8; ++a)
+    for (Kai_u32 b = 1; b < 32; ++b)
+    for (Kai_u32 p = 0; p < 8; ++p)
+    for (Kai_u32 q = 0; q < 8; ++q)
+    {
+        String_Case_Hash h = {a, b, p, q, n};
+        memset(used, 0, n);
+        Kai_u32 i = 0;
+        for (; i < count; ++i) {
+            Kai_u32 k = string_case_hash(h, strings[i]);
+            if (used[k]) break;
+            used[k] = 1;
+        }
+        if (i == count) {
+            *out = h;
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool is_string_case(Kai_Stmt_If* _if)
+{
+    if (_if->then_body == NULL || _if->then_body->id != KAI_STMT_COMPOUND)
+        return false;
+    Kai_Stmt_Compound* comp = (void*)_if->then_body;
+    for (Kai_Stmt* current = comp->head; current != NULL; current = current->next)
+    {
+        if (current->id != KAI_STMT_CONTROL) continue;
+        Kai_Stmt_Control* con = (void*)current;
+        if (con->kind == KAI_CONTROL_CASE && con->expr != NULL)
+            return con->expr->id == KAI_EXPR_STRING;
+    }
+    return false;
+}
+
+void generate_statement(String_Builder* builder, Kai_Stmt* stmt, int depth, int increase_depth_on_non_compound);
+
+// Lowers `if s == { case "a"; ... }` to a perfect-hash lookup that yields the case index,
+// followed by an ordinary switch over that index. Each case costs one string compare at most.
+void generate_string_case(String_Builder* builder, Kai_Stmt_If* _if, int depth)
+{
+    Kai_Stmt_Compound* comp = (void*)_if->then_body;
+    Kai_string* strings = NULL;
+    for (Kai_Stmt* current = comp->head; current != NULL; current = current->next)
+    {
+        if (current->id != KAI_STMT_CONTROL) continue;
+        Kai_Stmt_Control* con = (void*)current;
+        if (con->kind != KAI_CONTROL_CASE || con->expr == NULL) continue;
+        ASSERT(con->expr->id == KAI_EXPR_STRING);
+        Kai_Expr_String* str = (void*)con->expr;
+        for (Kai_u32 i = 0; i < str->value.count; ++i)
+            ASSERT(str->value.data[i] != '\\'); // hash is computed over the raw literal
+        arrpush(strings, str->value);
+    }
+    Kai_u32 count = (Kai_u32)arrlen(strings);
+    String_Case_Hash h;
+    if (!find_string_case_hash(strings, count, &h))
+    {
+        nob_log(ERROR, "no perfect hash found for string if-case on line %u", _if->line_number);
+        exit(1);
+    }
+
+    tab(depth); sb_append(builder, "{\n");
+    tab(depth+1); sb_append(builder, "Kai_string kai__case_string = ");
+    generate_expression(builder, _if->condition, TOP_PRECEDENCE, NONE);
+    sb_append(builder, ";\n");
+    tab(depth+1); sb_appendf(builder, "Kai_u32 kai__case_index = %u;\n", count);
+    tab(depth+1); sb_appendf(builder,
+        "#define kai__case_char(I) ((I) < kai__case_string.count ? kai__case_string.data[I] : 0)\n");
+    tab(depth+1); sb_appendf(builder,
+        "switch ((kai__case_string.count * %uu + kai__case_char(%u) * %uu + kai__case_char(%u)) %% %uu)\n",
+        h.a, h.p, h.b, h.q, h.n);
+    tab(depth+1); sb_append(builder, "{\n");
+    for (Kai_u32 i = 0; i < count; ++i)
+    {
+        tab(depth+1); sb_appendf(builder, "case %u: if (kai_string_equals(kai__case_string, KAI_STRING(\"%.*s\"))) kai__case_index = %u; break;\n",
+            string_case_hash(h, strings[i]), strings[i].count, strings[i].data, i);
+    }
+    tab(depth+1); sb_append(builder, "}\n");
+    tab(depth+1); sb_append(builder, "#undef kai__case_char\n");
+    tab(depth+1); sb_append(builder, "switch (kai__case_index)\n");
+    int saved_index = g_string_case_index;
+    g_string_case_index = 0;
+    g_go_through_case = false;
+    generate_statement(builder, _if->then_body, depth+1, true);
+    g_string_case_index = saved_index;
+    tab(depth); sb_append(builder, "}\n");
+    arrfree(strings);
+}
 
 void generate_statement(String_Builder* builder, Kai_Stmt* stmt, int depth, int increase_depth_on_non_compound)
 {
@@ -1354,6 +1669,8 @@ void generate_statement(String_Builder* builder, Kai_Stmt* stmt, int depth, int
                 if (!g_go_through_case) sb_append(builder, "break; ");
                 if (con->expr == NULL)
                     sb_append(builder, "default:\n");
+                else if (g_string_case_index >= 0)
+                    sb_appendf(builder, "case %i:\n", g_string_case_index++);
                 else {
                     sb_append(builder, "case ");
                     generate_expression(builder, con->expr, TOP_PRECEDENCE, NONE);
@@ -1451,6 +1768,13 @@ void generate_statement(String_Builder* builder, Kai_Stmt* stmt, int depth, int
     
     case KAI_STMT_IF: {
         Kai_Stmt_If* _if = (void*)stmt;
+        if ((_if->flags & KAI_FLAG_IF_CASE) && is_string_case(_if)) {
+            generate_string_case(builder, _if, depth);
+            break;
+        }
+        int saved_index = g_string_case_index;
+        if (_if->flags & KAI_FLAG_IF_CASE)
+            g_string_case_index = -1;
         tab(depth);
         if (_if->flags & KAI_FLAG_IF_CASE) {
             g_go_through_case = false;
@@ -1467,6 +1791,7 @@ void generate_statement(String_Builder* builder, Kai_Stmt* stmt, int depth, int
                 depth -= 1;
             generate_statement(builder, _if->else_body, depth, true);
         }
+        g_string_case_index = saved_index;
     } break;
     
     case KAI_STMT_WHILE: {
@@ -1530,15 +1855,26 @@ void generate_constant(String_Builder* builder, Kai_Stmt_Declaration* decl)
         sb_append(builder, "static ");
         generate_expression(builder, arr->expr, TOP_PRECEDENCE, NONE);
         const char* id = temp_cstr_from_string(decl->name);
-        ASSERT(arr->rows != NULL && arr->rows->id == KAI_EXPR_NUMBER);
-        Kai_Expr_Number* num = (void*)arr->rows;
-        sb_appendf(builder, " kai_%s[%llu] = {\n", id, kai_number_to_u64(num->value));
         shput(g_identifier_map, id, Identifier_Type_Function);
+        ASSERT(arr->rows != NULL);
+        if (arr->rows->id == KAI_EXPR_NUMBER)
+        {
+            Kai_Expr_Number* num = (void*)arr->rows;
+            sb_appendf(builder, " kai_%s[%llu] = {\n", id, kai_number_to_u64(num->value));
+        }
+        else
+        {
+            ASSERT(arr->rows->id == KAI_EXPR_IDENTIFIER);
+            sb_appendf(builder, " kai_%s[", id);
+            generate_expression(builder, arr->rows, TOP_PRECEDENCE, NONE);
+            sb_append(builder, "] = {\n");
+        }
         tab(1);
         Kai_u32 last = builder->count;
+        g_constant_initializer = true;
         for (Kai_Expr* expr = lit->head; expr != NULL; expr = expr->next)
         {
-            generate_expression(builder, expr, TOP_PRECEDENCE, NONE);
+            generate_expression(builder, expr, TOP_PRECEDENCE, NOT_TYPE);
             if (expr->next == NULL)
             {
                 sb_append(builder, "\n");
@@ -1552,6 +1888,7 @@ void generate_constant(String_Builder* builder, Kai_Stmt_Declaration* decl)
                 last = builder->count;
             }
         }
+        g_constant_initializer = false;
         sb_append(builder, "};\n");
     }
     else {
@@ -1855,6 +2192,89 @@ Module modules[] = {
 "}\n"
 "#else\n"
 "#	error \"[KAI] No memory allocator implemented for the current platform :(\"\n"
+"#endif\n"
+    },
+    {KAI_CONST_STRING("source"), NULL, {0},
+"#if defined(KAI_PLATFORM_LINUX) || defined(KAI_PLATFORM_APPLE)\n"
+"#include <fcntl.h>    // -> open\n"
+"#include <sys/stat.h> // -> fstat\n"
+"#include <sys/mman.h> // -> mmap\n"
+"#include <unistd.h>   // -> close\n"
+"KAI_INTERNAL void* kai__platform_map_file(char const* path, Kai_u32* out_size)\n"
+"{\n"
+"    int fd = open(path, O_RDONLY);\n"
+"    if (fd < 0)\n"
+"        return NULL;\n"
+"    struct stat info;\n"
+"    if (fstat(fd, &info) != 0 || info.st_size > 0xFFFFFFFF) {\n"
+"        close(fd);\n"
+"        return NULL;\n"
+"    }\n"
+"    *out_size = (Kai_u32)info.st_size;\n"
+"    if (info.st_size == 0) {\n"
+"        close(fd);\n"
+"        return (void*)\"\"; // nothing to map\n"
+"    }\n"
+"    void* data = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);\n"
+"    close(fd); // the mapping keeps the file\n"
+"    if (data == MAP_FAILED)\n"
+"        return NULL;\n"
+"    // Read once from beginning to end, so ask for all of it now\n"
+"    madvise(data, (size_t)info.st_size, MADV_SEQUENTIAL);\n"
+"    madvise(data, (size_t)info.st_size, MADV_WILLNEED);\n"
+"    return data;\n"
+"}\n"
+"KAI_INTERNAL void kai__platform_unmap_file(void* data, Kai_u32 size)\n"
+"{\n"
+"    if (size != 0)\n"
+"        kai_assert(munmap(data, size) == 0);\n"
+"}\n"
+"#elif defined(KAI_PLATFORM_WINDOWS)\n"
+"__declspec(dllimport) void* __stdcall CreateFileA(char const* lpFileName, unsigned long dwDesiredAccess, unsigned long dwShareMode, void* lpSecurityAttributes, unsigned long dwCreationDisposition, unsigned long dwFlagsAndAttributes, void* hTemplateFile);\n"
+"__declspec(dllimport) int __stdcall GetFileSizeEx(void* hFile, long long* lpFileSize);\n"
+"__declspec(dllimport) void* __stdcall CreateFileMappingA(void* hFile, void* lpFileMappingAttributes, unsigned long flProtect, unsigned long dwMaximumSizeHigh, unsigned long dwMaximumSizeLow, char const* lpName);\n"
+"__declspec(dllimport) void* __stdcall MapViewOfFile(void* hFileMappingObject, unsigned long dwDesiredAccess, unsigned long dwFileOffsetHigh, unsigned long dwFileOffsetLow, uintptr_t dwNumberOfBytesToMap);\n"
+"__declspec(dllimport) int __stdcall UnmapViewOfFile(void const* lpBaseAddress);\n"
+"__declspec(dllimport) int __stdcall CloseHandle(void* hObject);\n"
+"__declspec(dllimport) void* __stdcall GetCurrentProcess(void);\n"
+"typedef struct { void* VirtualAddress; uintptr_t NumberOfBytes; } Kai__Memory_Range_Entry; // WIN32_MEMORY_RANGE_ENTRY\n"
+"__declspec(dllimport) int __stdcall PrefetchVirtualMemory(void* hProcess, uintptr_t NumberOfEntries, Kai__Memory_Range_Entry* VirtualAddresses, unsigned long Flags);\n"
+"KAI_INTERNAL void* kai__platform_map_file(char const* path, Kai_u32* out_size)\n"
+"{\n"
+"    // GENERIC_READ, FILE_SHARE_READ, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL\n"
+"    void* file = CreateFileA(path, 0x80000000, 0x1, NULL, 3, 0x80, NULL);\n"
+"    if (file == (void*)(intptr_t)-1)\n"
+"        return NULL;\n"
+"    long long size = 0;\n"
+"    if (!GetFileSizeEx(file, &size) || size > 0xFFFFFFFF) {\n"
+"        CloseHandle(file);\n"
+"        return NULL;\n"
+"    }\n"
+"    *out_size = (Kai_u32)size;\n"
+"    if (size == 0) {\n"
+"        CloseHandle(file);\n"
+"        return (void*)\"\"; // nothing to map\n"
+"    }\n"
+"    void* mapping = CreateFileMappingA(file, NULL, 0x02, 0, 0, NULL); // PAGE_READONLY\n"
+"    CloseHandle(file);\n"
+"    if (mapping == NULL)\n"
+"        return NULL;\n"
+"    void* data = MapViewOfFile(mapping, 0x04, 0, 0, 0); // FILE_MAP_READ\n"
+"    CloseHandle(mapping); // the view keeps the mapping\n"
+"    if (data == NULL)\n"
+"        return NULL;\n"
+"    // Read once from beginning to end, so ask for all of it now (a hint, failure is fine)\n"
+"    Kai__Memory_Range_Entry range = { data, (uintptr_t)size };\n"
+"    PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);\n"
+"    return data;\n"
+"}\n"
+"KAI_INTERNAL void kai__platform_unmap_file(void* data, Kai_u32 size)\n"
+"{\n"
+"    if (size != 0)\n"
+"        kai_assert(UnmapViewOfFile(data) != 0);\n"
+"}\n"
+"#else\n"
+"#	error \"[KAI] No file mapping implemented for the current platform :( (define KAI_DONT_USE_SOURCE_API)\"\n"
 "#endif\n"
     },
 };
@@ -1891,6 +2311,8 @@ int main(int argc, char** argv)
     shput(g_identifier_map, "_stdc_file_open",              Identifier_Type_Function);
     shput(g_identifier_map, "_allocator_platform_allocate", Identifier_Type_Function);
     shput(g_identifier_map, "_page_size",                   Identifier_Type_Function);
+    shput(g_identifier_map, "_platform_map_file",           Identifier_Type_Function);
+    shput(g_identifier_map, "_platform_unmap_file",         Identifier_Type_Function);
 
     String_Builder builder = {0};
     exit_on_fail(read_entire_file("src/comments/header.h", &builder));
@@ -21,8 +21,10 @@ extern "C" {
 #ifndef KAI_DONT_USE_ALLOCATOR_API
 #include <stdlib.h>
 #endif
+#ifndef KAI_DONT_USE_SOURCE_API
+#endif
 
-#define KAI_BUILD_DATE 20251111084220 // YMD HMS (UTC)
+#define KAI_BUILD_DATE 20261019070537 // YMD HMS (UTC)
 #define KAI_VERSION_MAJOR 0
 #define KAI_VERSION_MINOR 1
 #define KAI_VERSION_PATCH 0
@@ -126,6 +128,7 @@ do {
     while (kai_raw_table_next_match((Kai_Raw_Hash_Table*)(T), __hash__, &__index__))                       \
         if (kai_ ## K ## _equals(KEY, (T)->keys[__index__]))                                               \
             break;                                                                                         \
+        else __index__ += 1; /* hash collision, keep probing */                                            \
     (T)->keys[__index__] = KEY;                                                                            \
     (T)->values[__index__] = __VA_ARGS__;                                                                  \
 } while(0)
@@ -253,6 +256,7 @@ typedef Kai_u32 Kai_Write_Command;
 typedef struct Kai_Writer Kai_Writer;
 typedef struct Kai_Fixed_Allocator Kai_Fixed_Allocator;
 typedef struct Kai_Arena_Bucket Kai_Arena_Bucket;
+typedef struct Kai_Arena_Large Kai_Arena_Large;
 typedef struct Kai_Arena_Allocator Kai_Arena_Allocator;
 typedef struct Kai_Arena_Checkpoint Kai_Arena_Checkpoint;
 typedef struct Kai_Growing_Arena Kai_Growing_Arena;
@@ -286,13 +290,25 @@ typedef struct Kai_Stmt_While Kai_Stmt_While;
 typedef struct Kai_Stmt_For Kai_Stmt_For;
 typedef struct Kai_Stmt_Control Kai_Stmt_Control;
 typedef struct Kai_Syntax_Tree Kai_Syntax_Tree;
+typedef struct Kai_Statement_Span Kai_Statement_Span;
+typedef struct Kai_Source_Edit Kai_Source_Edit;
 typedef struct Kai_Syntax_Tree_Create_Info Kai_Syntax_Tree_Create_Info;
 typedef Kai_u32 Kai_Token_Id;
+typedef struct Kai_Atom_Table Kai_Atom_Table;
 typedef struct Kai_Token Kai_Token;
 typedef struct Kai_Tokenizer Kai_Tokenizer;
+typedef struct Kai_Token_Buffer Kai_Token_Buffer;
+typedef Kai_u8 Kai_Token_Class;
+typedef struct Kai_Token_Run Kai_Token_Run;
+typedef struct Kai_Classify_State Kai_Classify_State;
 typedef struct Kai_Parser Kai_Parser;
 typedef struct Kai__Operator Kai__Operator;
 typedef Kai_u32 Kai__Operator_Type;
+typedef struct Kai_Source_Stream_Create_Info Kai_Source_Stream_Create_Info;
+typedef struct Kai_Source_Stream Kai_Source_Stream;
+typedef struct Kai_Compact_Node Kai_Compact_Node;
+typedef struct Kai_Compact_Tree Kai_Compact_Tree;
+typedef struct Kai__Compactor Kai__Compactor;
 
 typedef Kai_u32 Kai_Backend;
 typedef Kai_u8 Kai_Condition;
@@ -300,9 +316,12 @@ typedef struct Kai_Assembler Kai_Assembler;
 
 typedef Kai_u32 Kai_Compile_Flags;
 typedef struct Kai_Compile_Options Kai_Compile_Options;
+typedef struct Kai_Job_System Kai_Job_System;
 typedef struct Kai_Import Kai_Import;
 typedef struct Kai_Export Kai_Export;
 typedef struct Kai_Module Kai_Module;
+typedef struct Kai_Compile_Statistics Kai_Compile_Statistics;
+typedef struct Kai_Type_Table Kai_Type_Table;
 typedef struct Kai_Program_Create_Info Kai_Program_Create_Info;
 typedef struct Kai_Variable Kai_Variable;
 typedef struct Kai_Program Kai_Program;
@@ -311,43 +330,87 @@ typedef struct Kai_Node_Reference Kai_Node_Reference;
 typedef struct Kai_Node Kai_Node;
 typedef struct Kai_Local_Node Kai_Local_Node;
 typedef struct Kai_Scope Kai_Scope;
+typedef struct Kai__Binding Kai__Binding;
+typedef struct Kai__Shadowed Kai__Shadowed;
 typedef struct Kai_Pending_Node Kai_Pending_Node;
+typedef struct Kai_Node_Waiter Kai_Node_Waiter;
+typedef struct Kai_Attempt_Checkpoint Kai_Attempt_Checkpoint;
 typedef Kai_u8 Kai__Builtin_Type_ID;
+typedef Kai_u8 Kai__Intrinsic_ID;
+typedef struct Kai__Case Kai__Case;
+typedef struct Kai__Case_Jump Kai__Case_Jump;
+typedef struct Kai__Case_Lowering Kai__Case_Lowering;
+typedef struct Kai__String_Case_Hash Kai__String_Case_Hash;
+typedef struct Kai__Instance Kai__Instance;
+typedef struct Kai__Polymorph Kai__Polymorph;
+typedef struct Kai__Procedure_Job Kai__Procedure_Job;
+typedef struct Kai__Label_Fixup Kai__Label_Fixup;
 typedef struct Kai_Compiler_Context Kai_Compiler_Context;
+typedef struct Kai__Parse_Result Kai__Parse_Result;
+typedef struct Kai__Parse_Batch Kai__Parse_Batch;
+typedef struct Kai__Worker Kai__Worker;
+typedef struct Kai__Job_Batch Kai__Job_Batch;
 
 typedef Kai_Type_Info* Kai_Type;
 typedef void* Kai_P_Memory_Heap_Allocate(void* user, void* ptr, Kai_u32 new_size, Kai_u32 old_size);
 typedef void* Kai_P_Memory_Platform_Allocate(void* user, void* ptr, Kai_u32 size, Kai_Memory_Command op);
 typedef KAI_HASH_TABLE(Kai_string, void) Kai__string_HashTable;
 typedef KAI_HASH_TABLE(Kai_Type, void) Kai__Type_HashTable;
+typedef KAI_HASH_TABLE(Kai_u32, void) Kai__u32_HashTable;
 typedef void Kai_P_Write_Callback(void* user, Kai_Write_Command command, Kai_Value value, Kai_Write_Format format);
 
 typedef Kai_Expr Kai_Stmt;
 typedef KAI_LINKED_LIST(Kai_Expr) Kai_Expr_List;
 typedef KAI_LINKED_LIST(Kai_Stmt) Kai_Stmt_List;
+typedef Kai_u32* Kai__Atom_Ref;
 #define KAI_TOP_PRECEDENCE 1
 #define KAI_PRECEDENCE_MASK 65535
+typedef Kai_Expr* Kai__Expr_Ref;
+typedef Kai_u32 Kai_P_Source_Read(void* user, Kai_u8* buffer, Kai_u32 capacity);
+#define KAI_COMPACT_EMPTY 254
+#define KAI_COMPACT_TAG 255
+
+typedef void Kai_P_Job_Run(void* data, Kai_u32 index);
+typedef void Kai_P_Job_Dispatch(void* user, Kai_P_Job_Run* run, void* data, Kai_u32 count);
 
+typedef KAI_SLICE(Kai_u32) Kai_u32_Slice;
 typedef KAI_SLICE(Kai_Type) Kai_Type_Slice;
 typedef KAI_SLICE(Kai_Struct_Field) Kai_Struct_Field_Slice;
 typedef KAI_SLICE(Kai_Enum_Value) Kai_Enum_Value_Slice;
 typedef KAI_DYNAMIC_ARRAY(Kai_u8) Kai_u8_DynArray;
 typedef KAI_DYNAMIC_ARRAY(Kai_u32) Kai_u32_DynArray;
+typedef KAI_DYNAMIC_ARRAY(Kai_Statement_Span) Kai_Statement_Span_DynArray;
+typedef KAI_DYNAMIC_ARRAY(Kai_string) Kai_string_DynArray;
+typedef KAI_HASH_TABLE(Kai_string,Kai_u32) Kai_string_u32_HashTable;
+typedef KAI_DYNAMIC_ARRAY(Kai_Token_Id) Kai_Token_Id_DynArray;
+typedef KAI_DYNAMIC_ARRAY(Kai_Number) Kai_Number_DynArray;
+typedef KAI_DYNAMIC_ARRAY(Kai__Atom_Ref) Kai__Atom_Ref_DynArray;
+typedef KAI_DYNAMIC_ARRAY(Kai__Expr_Ref) Kai__Expr_Ref_DynArray;
+typedef KAI_DYNAMIC_ARRAY(Kai_Compact_Node) Kai_Compact_Node_DynArray;
+typedef KAI_DYNAMIC_ARRAY(Kai_Range) Kai_Range_DynArray;
 typedef KAI_SLICE(Kai_Export) Kai_Export_Slice;
+typedef KAI_HASH_TABLE(Kai_Type,Kai_u32) Kai_Type_u32_HashTable;
 typedef KAI_SLICE(Kai_Source) Kai_Source_Slice;
 typedef KAI_SLICE(Kai_Import) Kai_Import_Slice;
+typedef KAI_SLICE(Kai_string) Kai_string_Slice;
 typedef KAI_SLICE(Kai_u8) Kai_u8_Slice;
 typedef KAI_SLICE(Kai_Syntax_Tree) Kai_Syntax_Tree_Slice;
-typedef KAI_HASH_TABLE(Kai_string,Kai_u32) Kai_string_u32_HashTable;
 typedef KAI_HASH_TABLE(Kai_string,Kai_Variable) Kai_string_Variable_HashTable;
 typedef KAI_HASH_TABLE(Kai_string,Kai_Type) Kai_string_Type_HashTable;
-typedef KAI_HASH_TABLE(Kai_string,Kai_Node_Reference) Kai_string_Node_Reference_HashTable;
-typedef KAI_DYNAMIC_ARRAY(Kai_Pending_Node) Kai_Pending_Node_DynArray;
 typedef KAI_DYNAMIC_ARRAY(Kai_Node_Reference) Kai_Node_Reference_DynArray;
+typedef KAI_DYNAMIC_ARRAY(Kai_Pending_Node) Kai_Pending_Node_DynArray;
+typedef KAI_DYNAMIC_ARRAY(Kai_Node_Waiter) Kai_Node_Waiter_DynArray;
+typedef KAI_HASH_TABLE(Kai_u32,Kai_bool) Kai_u32_bool_HashTable;
 typedef KAI_DYNAMIC_ARRAY(Kai_Node) Kai_Node_DynArray;
 typedef KAI_DYNAMIC_ARRAY(Kai_Local_Node) Kai_Local_Node_DynArray;
-typedef KAI_HASH_TABLE(Kai_Type,Kai_u32) Kai_Type_u32_HashTable;
+typedef KAI_SLICE(Kai_Compact_Tree) Kai_Compact_Tree_Slice;
 typedef KAI_DYNAMIC_ARRAY(Kai_Scope) Kai_Scope_DynArray;
+typedef KAI_HASH_TABLE(Kai_u32,Kai__Binding) Kai_u32__Binding_HashTable;
+typedef KAI_DYNAMIC_ARRAY(Kai__Shadowed) Kai__Shadowed_DynArray;
+typedef KAI_DYNAMIC_ARRAY(Kai__Polymorph) Kai__Polymorph_DynArray;
+typedef KAI_DYNAMIC_ARRAY(Kai__Instance) Kai__Instance_DynArray;
+typedef KAI_DYNAMIC_ARRAY(Kai__Procedure_Job) Kai__Procedure_Job_DynArray;
+typedef KAI_DYNAMIC_ARRAY(Kai__Label_Fixup) Kai__Label_Fixup_DynArray;
 
 struct Kai_Range {
     Kai_u32 start;
@@ -375,6 +438,7 @@ enum {
 struct Kai_Source {
     Kai_string name;
     Kai_string contents;
+    Kai_u32_Slice line_starts;
 };
 
 struct Kai_Location {
@@ -457,32 +521,38 @@ enum {
 
 struct Kai_Type_Info {
     Kai_Type_Id id;
+    Kai_u64 hash;
 };
 
 struct Kai_Type_Info_Integer {
     Kai_Type_Id id;
+    Kai_u64 hash;
     Kai_bool is_signed;
     Kai_u8 bits;
 };
 
 struct Kai_Type_Info_Float {
     Kai_Type_Id id;
+    Kai_u64 hash;
     Kai_u8 bits;
 };
 
 struct Kai_Type_Info_Pointer {
     Kai_Type_Id id;
+    Kai_u64 hash;
     Kai_Type sub_type;
 };
 
 struct Kai_Type_Info_Procedure {
     Kai_Type_Id id;
+    Kai_u64 hash;
     Kai_Type_Slice inputs;
     Kai_Type_Slice outputs;
 };
 
 struct Kai_Type_Info_Array {
     Kai_Type_Id id;
+    Kai_u64 hash;
     Kai_u32 rows;
     Kai_u32 cols;
     Kai_Type sub_type;
@@ -496,6 +566,7 @@ struct Kai_Struct_Field {
 
 struct Kai_Type_Info_Struct {
     Kai_Type_Id id;
+    Kai_u64 hash;
     Kai_u32 size;
     Kai_Struct_Field_Slice fields;
 };
@@ -507,12 +578,14 @@ struct Kai_Enum_Value {
 
 struct Kai_Type_Info_Enum {
     Kai_Type_Id id;
+    Kai_u64 hash;
     Kai_Type sub_type;
     Kai_Enum_Value_Slice values;
 };
 
 struct Kai_Type_Info_Module {
     Kai_Type_Id id;
+    Kai_u64 hash;
     Kai_u32 module_index;
 };
 
@@ -595,16 +668,23 @@ struct Kai_Arena_Bucket {
     Kai_Arena_Bucket* next;
 };
 
+struct Kai_Arena_Large {
+    Kai_Arena_Large* prev;
+    Kai_u32 size;
+};
+
 struct Kai_Arena_Allocator {
     Kai_Arena_Bucket* current_bucket;
     Kai_u32 current_allocated;
     Kai_u32 bucket_size;
     Kai_Allocator base;
+    Kai_Arena_Large* large;
 };
 
 struct Kai_Arena_Checkpoint {
     Kai_Arena_Bucket* bucket;
     Kai_u32 allocated;
+    Kai_Arena_Large* large;
 };
 
 struct Kai_Growing_Arena {
@@ -700,10 +780,12 @@ struct Kai_Expr {
     Kai_Expr_Flags flags;
     Kai_string source_code;
     Kai_string name;
+    Kai_u32 atom;
+    Kai_u32 name_atom;
     Kai_Expr* next;
     Kai_Tag* tag;
     Kai_Type_Info* this_type;
-    Kai_u32 line_number;
+    Kai_u32 offset;
 };
 
 struct Kai_Expr_String {
@@ -711,10 +793,12 @@ struct Kai_Expr_String {
     Kai_Expr_Flags flags;
     Kai_string source_code;
     Kai_string name;
+    Kai_u32 atom;
+    Kai_u32 name_atom;
     Kai_Expr* next;
     Kai_Tag* tag;
     Kai_Type_Info* this_type;
-    Kai_u32 line_number;
+    Kai_u32 offset;
     Kai_string value;
 };
 
@@ -723,10 +807,12 @@ struct Kai_Expr_Number {
     Kai_Expr_Flags flags;
     Kai_string source_code;
     Kai_string name;
+    Kai_u32 atom;
+    Kai_u32 name_atom;
     Kai_Expr* next;
     Kai_Tag* tag;
     Kai_Type_Info* this_type;
-    Kai_u32 line_number;
+    Kai_u32 offset;
     Kai_Number value;
 };
 
@@ -735,10 +821,12 @@ struct Kai_Expr_Literal {
     Kai_Expr_Flags flags;
     Kai_string source_code;
     Kai_string name;
+    Kai_u32 atom;
+    Kai_u32 name_atom;
     Kai_Expr* next;
     Kai_Tag* tag;
     Kai_Type_Info* this_type;
-    Kai_u32 line_number;
+    Kai_u32 offset;
     Kai_Expr* head;
     Kai_u32 count;
 };
@@ -748,10 +836,12 @@ struct Kai_Expr_Unary {
     Kai_Expr_Flags flags;
     Kai_string source_code;
     Kai_string name;
+    Kai_u32 atom;
+    Kai_u32 name_atom;
     Kai_Expr* next;
     Kai_Tag* tag;
     Kai_Type_Info* this_type;
-    Kai_u32 line_number;
+    Kai_u32 offset;
     Kai_Expr* expr;
     Kai_u32 op;
 };
@@ -761,10 +851,12 @@ struct Kai_Expr_Binary {
     Kai_Expr_Flags flags;
     Kai_string source_code;
     Kai_string name;
+    Kai_u32 atom;
+    Kai_u32 name_atom;
     Kai_Expr* next;
     Kai_Tag* tag;
     Kai_Type_Info* this_type;
-    Kai_u32 line_number;
+    Kai_u32 offset;
     Kai_Expr* left;
     Kai_Expr* right;
     Kai_u32 op;
@@ -775,10 +867,12 @@ struct Kai_Expr_Procedure_Call {
     Kai_Expr_Flags flags;
     Kai_string source_code;
     Kai_string name;
+    Kai_u32 atom;
+    Kai_u32 name_atom;
     Kai_Expr* next;
     Kai_Tag* tag;
     Kai_Type_Info* this_type;
-    Kai_u32 line_number;
+    Kai_u32 offset;
     Kai_Expr* proc;
     Kai_Expr* arg_head;
     Kai_u8 arg_count;
@@ -789,10 +883,12 @@ struct Kai_Expr_Procedure_Type {
     Kai_Expr_Flags flags;
     Kai_string source_code;
     Kai_string name;
+    Kai_u32 atom;
+    Kai_u32 name_atom;
     Kai_Expr* next;
     Kai_Tag* tag;
     Kai_Type_Info* this_type;
-    Kai_u32 line_number;
+    Kai_u32 offset;
     Kai_Expr* in_out_expr;
     Kai_u8 in_count;
     Kai_u8 out_count;
@@ -803,10 +899,12 @@ struct Kai_Expr_Procedure {
     Kai_Expr_Flags flags;
     Kai_string source_code;
     Kai_string name;
+    Kai_u32 atom;
+    Kai_u32 name_atom;
     Kai_Expr* next;
     Kai_Tag* tag;
     Kai_Type_Info* this_type;
-    Kai_u32 line_number;
+    Kai_u32 offset;
     Kai_Expr* in_out_expr;
     Kai_Stmt* body;
     Kai_u8 in_count;
@@ -818,10 +916,12 @@ struct Kai_Expr_Struct {
     Kai_Expr_Flags flags;
     Kai_string source_code;
     Kai_string name;
+    Kai_u32 atom;
+    Kai_u32 name_atom;
     Kai_Expr* next;
     Kai_Tag* tag;
     Kai_Type_Info* this_type;
-    Kai_u32 line_number;
+    Kai_u32 offset;
     Kai_u32 field_count;
     Kai_Stmt* head;
 };
@@ -831,10 +931,12 @@ struct Kai_Expr_Enum {
     Kai_Expr_Flags flags;
     Kai_string source_code;
     Kai_string name;
+    Kai_u32 atom;
+    Kai_u32 name_atom;
     Kai_Expr* next;
     Kai_Tag* tag;
     Kai_Type_Info* this_type;
-    Kai_u32 line_number;
+    Kai_u32 offset;
     Kai_Expr* type;
     Kai_u32 field_count;
     Kai_Stmt* head;
@@ -845,10 +947,12 @@ struct Kai_Expr_Array {
     Kai_Expr_Flags flags;
     Kai_string source_code;
     Kai_string name;
+    Kai_u32 atom;
+    Kai_u32 name_atom;
     Kai_Expr* next;
     Kai_Tag* tag;
     Kai_Type_Info* this_type;
-    Kai_u32 line_number;
+    Kai_u32 offset;
     Kai_Expr* rows;
     Kai_Expr* cols;
     Kai_Expr* expr;
@@ -859,10 +963,12 @@ struct Kai_Expr_Special {
     Kai_Expr_Flags flags;
     Kai_string source_code;
     Kai_string name;
+    Kai_u32 atom;
+    Kai_u32 name_atom;
     Kai_Expr* next;
     Kai_Tag* tag;
     Kai_Type_Info* this_type;
-    Kai_u32 line_number;
+    Kai_u32 offset;
     Kai_u8 kind;
 };
 
@@ -871,10 +977,12 @@ struct Kai_Stmt_Return {
     Kai_Expr_Flags flags;
     Kai_string source_code;
     Kai_string name;
+    Kai_u32 atom;
+    Kai_u32 name_atom;
     Kai_Expr* next;
     Kai_Tag* tag;
     Kai_Type_Info* this_type;
-    Kai_u32 line_number;
+    Kai_u32 offset;
     Kai_Expr* expr;
 };
 
@@ -883,10 +991,12 @@ struct Kai_Stmt_Declaration {
     Kai_Expr_Flags flags;
     Kai_string source_code;
     Kai_string name;
+    Kai_u32 atom;
+    Kai_u32 name_atom;
     Kai_Expr* next;
     Kai_Tag* tag;
     Kai_Type_Info* this_type;
-    Kai_u32 line_number;
+    Kai_u32 offset;
     Kai_Expr* value;
     Kai_Expr* type;
 };
@@ -896,10 +1006,12 @@ struct Kai_Stmt_Assignment {
     Kai_Expr_Flags flags;
     Kai_string source_code;
     Kai_string name;
+    Kai_u32 atom;
+    Kai_u32 name_atom;
     Kai_Expr* next;
     Kai_Tag* tag;
     Kai_Type_Info* this_type;
-    Kai_u32 line_number;
+    Kai_u32 offset;
     Kai_u32 op;
     Kai_Expr* dest;
     Kai_Expr* value;
@@ -910,10 +1022,12 @@ struct Kai_Stmt_Compound {
     Kai_Expr_Flags flags;
     Kai_string source_code;
     Kai_string name;
+    Kai_u32 atom;
+    Kai_u32 name_atom;
     Kai_Expr* next;
     Kai_Tag* tag;
     Kai_Type_Info* this_type;
-    Kai_u32 line_number;
+    Kai_u32 offset;
     Kai_Stmt* head;
 };
 
@@ -922,10 +1036,12 @@ struct Kai_Stmt_If {
     Kai_Expr_Flags flags;
     Kai_string source_code;
     Kai_string name;
+    Kai_u32 atom;
+    Kai_u32 name_atom;
     Kai_Expr* next;
     Kai_Tag* tag;
     Kai_Type_Info* this_type;
-    Kai_u32 line_number;
+    Kai_u32 offset;
     Kai_Expr* condition;
     Kai_Stmt* then_body;
     Kai_Stmt* else_body;
@@ -936,10 +1052,12 @@ struct Kai_Stmt_While {
     Kai_Expr_Flags flags;
     Kai_string source_code;
     Kai_string name;
+    Kai_u32 atom;
+    Kai_u32 name_atom;
     Kai_Expr* next;
     Kai_Tag* tag;
     Kai_Type_Info* this_type;
-    Kai_u32 line_number;
+    Kai_u32 offset;
     Kai_Expr* condition;
     Kai_Stmt* body;
 };
@@ -949,14 +1067,17 @@ struct Kai_Stmt_For {
     Kai_Expr_Flags flags;
     Kai_string source_code;
     Kai_string name;
+    Kai_u32 atom;
+    Kai_u32 name_atom;
     Kai_Expr* next;
     Kai_Tag* tag;
     Kai_Type_Info* this_type;
-    Kai_u32 line_number;
+    Kai_u32 offset;
     Kai_Stmt* body;
     Kai_Expr* from;
     Kai_Expr* to;
     Kai_string iterator_name;
+    Kai_u32 iterator_atom;
 };
 
 struct Kai_Stmt_Control {
@@ -964,10 +1085,12 @@ struct Kai_Stmt_Control {
     Kai_Expr_Flags flags;
     Kai_string source_code;
     Kai_string name;
+    Kai_u32 atom;
+    Kai_u32 name_atom;
     Kai_Expr* next;
     Kai_Tag* tag;
     Kai_Type_Info* this_type;
-    Kai_u32 line_number;
+    Kai_u32 offset;
     Kai_u8 kind;
     Kai_Expr* expr;
 };
@@ -976,12 +1099,34 @@ struct Kai_Syntax_Tree {
     Kai_Stmt_Compound root;
     Kai_Source source;
     Kai_Arena_Allocator allocator;
+    Kai_Arena_Allocator* arena;
+    Kai_Arena_Checkpoint arena_start;
+    Kai_u32_DynArray lines;
+    Kai_Statement_Span_DynArray spans;
+    Kai_bool incomplete;
+    Kai_u32 update_bytes;
+};
+
+struct Kai_Statement_Span {
+    Kai_Stmt* stmt;
+    Kai_u32 start;
+    Kai_u32 moved;
+    Kai_string base;
+};
+
+struct Kai_Source_Edit {
+    Kai_u32 offset;
+    Kai_u32 removed;
+    Kai_u32 inserted;
 };
 
 struct Kai_Syntax_Tree_Create_Info {
     Kai_Source source;
     Kai_Allocator allocator;
     Kai_Error* error;
+    Kai_Atom_Table* atoms;
+    Kai_Token_Buffer* tokens;
+    Kai_Arena_Allocator* arena;
 };
 
 // Type: Kai_Token_Id
@@ -1012,9 +1157,17 @@ enum {
     KAI_TOKEN_true = 145,
 };
 
+struct Kai_Atom_Table {
+    Kai_string_DynArray names;
+    Kai_string_u32_HashTable atoms;
+    Kai_Arena_Allocator name_data;
+    Kai_Allocator allocator;
+};
+
 struct Kai_Token {
     Kai_Token_Id id;
-    Kai_u32 line_number;
+    Kai_u32 offset;
+    Kai_u32 atom;
     Kai_string string;
     struct { Kai_string string; Kai_Number number; } value;
 };
@@ -1024,15 +1177,57 @@ struct Kai_Tokenizer {
     Kai_Token peeked_token;
     Kai_string source;
     Kai_u32 cursor;
-    Kai_u32 line_number;
     Kai_bool peeking;
-    Kai_Fixed_Allocator string_arena;
+    Kai_Arena_Allocator* string_arena;
+    Kai_Atom_Table* atoms;
+    Kai_Token_Buffer* tokens;
+    Kai_u32 token_index;
+};
+
+struct Kai_Token_Buffer {
+    Kai_Token_Id_DynArray ids;
+    Kai_u32_DynArray offsets;
+    Kai_u32_DynArray lengths;
+    Kai_u32_DynArray values;
+    Kai_Number_DynArray numbers;
+    Kai_string_DynArray strings;
+    Kai_string source;
+    Kai_Arena_Allocator string_arena;
+    Kai_Arena_Checkpoint string_start;
+    Kai_Allocator allocator;
+};
+
+// Type: Kai_Token_Class
+enum {
+    KAI_TOKEN_CLASS_IDENTIFIER = 0,
+    KAI_TOKEN_CLASS_KEYWORD = 1,
+    KAI_TOKEN_CLASS_NUMBER = 2,
+    KAI_TOKEN_CLASS_STRING = 3,
+    KAI_TOKEN_CLASS_COMMENT = 4,
+    KAI_TOKEN_CLASS_DIRECTIVE = 5,
+    KAI_TOKEN_CLASS_TAG = 6,
+    KAI_TOKEN_CLASS_SYMBOL = 7,
+};
+
+struct Kai_Token_Run {
+    Kai_u32 offset;
+    Kai_u32 length;
+    Kai_Token_Class kind;
+};
+
+struct Kai_Classify_State {
+    Kai_u32 offset;
+    Kai_u32 comment_depth;
+    Kai_bool in_string;
 };
 
 struct Kai_Parser {
     Kai_Tokenizer tokenizer;
+    Kai_Source source;
     Kai_Arena_Allocator arena;
     Kai_Error* error;
+    Kai__Atom_Ref_DynArray* atom_refs;
+    Kai_bool reused;
 };
 
 struct Kai__Operator {
@@ -1047,6 +1242,63 @@ enum {
     KAI__OPERATOR_TYPE_PROCEDURE_CALL = 2,
 };
 
+struct Kai_Source_Stream_Create_Info {
+    Kai_string name;
+    Kai_P_Source_Read* read;
+    void* user;
+    Kai_u32 window_size;
+    Kai_Allocator allocator;
+    Kai_Error* error;
+    Kai_Atom_Table* atoms;
+};
+
+struct Kai_Source_Stream {
+    Kai_Source source;
+    Kai_u64 offset;
+    Kai_u32 line;
+    Kai_P_Source_Read* read;
+    void* user;
+    Kai_u32 window_size;
+    Kai_u32 start;
+    Kai_bool ended;
+    Kai_bool failed;
+    Kai_Arena_Allocator arena;
+    Kai_Arena_Checkpoint arena_start;
+    Kai_Allocator allocator;
+    Kai_Error* error;
+    Kai_Atom_Table* atoms;
+};
+
+struct Kai_Compact_Node {
+    Kai_u8 id;
+    Kai_u8 flags;
+    Kai_u16 tag_count;
+    Kai_u32 value;
+    Kai_u32 atom;
+    Kai_u32 name_atom;
+    Kai_u32 offset;
+    Kai_u32 length;
+    Kai_u32 first_child;
+    Kai_u32 child_count;
+};
+
+struct Kai_Compact_Tree {
+    Kai_Compact_Node_DynArray nodes;
+    Kai_Number_DynArray numbers;
+    Kai_Range_DynArray strings;
+    Kai_u8_DynArray string_data;
+    Kai_u32_DynArray lines;
+    Kai_Source source;
+    Kai_Atom_Table* atoms;
+    Kai_Allocator allocator;
+};
+
+struct Kai__Compactor {
+    Kai_Compact_Tree* tree;
+    Kai__Expr_Ref_DynArray children;
+    Kai_Compact_Node_DynArray statements;
+};
+
 // Type: Kai_Backend
 enum {
     KAI_BACKEND_AST = 0,
@@ -1087,12 +1339,20 @@ struct Kai_Assembler {
 enum {
     KAI_COMPILE_NO_CODE_GEN = 1,
     KAI_COMPILE_ALLOW_UNDEFINED = 2,
+    KAI_COMPILE_REACHABLE_ONLY = 4,
+    KAI_COMPILE_COMPACT_TREES = 8,
 };
 
 struct Kai_Compile_Options {
     Kai_u32 interpreter_max_step_count;
     Kai_u32 interpreter_max_call_depth;
     Kai_Compile_Flags flags;
+    Kai_u32 worker_count;
+};
+
+struct Kai_Job_System {
+    Kai_P_Job_Dispatch* dispatch;
+    void* user;
 };
 
 struct Kai_Import {
@@ -1111,13 +1371,31 @@ struct Kai_Module {
     Kai_Export_Slice exports;
 };
 
+struct Kai_Compile_Statistics {
+    Kai_u32 declaration_count;
+    Kai_u32 skipped_count;
+    Kai_u32 expanded_count;
+    Kai_u32 instance_count;
+    Kai_u32 jump_table_count;
+    Kai_u32 compare_tree_count;
+};
+
+struct Kai_Type_Table {
+    Kai_Arena_Allocator arena;
+    Kai_Type_u32_HashTable types;
+};
+
 struct Kai_Program_Create_Info {
     Kai_Allocator allocator;
     Kai_Error* error;
     Kai_Source_Slice sources;
     Kai_Import_Slice imports;
+    Kai_string_Slice exports;
     Kai_Compile_Options options;
     Kai_Writer* debug_writer;
+    Kai_Job_System* jobs;
+    Kai_Type_Table* types;
+    Kai_Compile_Statistics* statistics;
 };
 
 struct Kai_Variable {
@@ -1130,6 +1408,7 @@ struct Kai_Program {
     Kai_Backend backend;
     Kai_u8_Slice code;
     Kai_Syntax_Tree_Slice trees;
+    Kai_Arena_Allocator tree_arena;
     Kai_string_u32_HashTable procedure_table;
     Kai_string_Variable_HashTable variable_table;
     Kai_string_Type_HashTable type_table;
@@ -1147,6 +1426,7 @@ enum {
     KAI_NODE_IMPORT = 32,
     KAI_NODE_VISITED = 64,
     KAI_NODE_NOT_FOUND = 128,
+    KAI_NODE_QUEUED = 256,
 };
 
 struct Kai_Node_Reference {
@@ -1162,6 +1442,13 @@ struct Kai_Node {
     Kai_Expr* type_expr;
     Kai_Expr* decl;
     Kai_Node_Flags flags;
+    Kai_u32 type_waiters;
+    Kai_u32 value_waiters;
+    Kai_Type_Info* partial;
+    Kai_u32 resume;
+    Kai_u32 compact;
+    Kai_Compact_Tree* compact_tree;
+    Kai_u32 polymorph;
 };
 
 struct Kai_Local_Node {
@@ -1171,14 +1458,47 @@ struct Kai_Local_Node {
 };
 
 struct Kai_Scope {
-    Kai_string_Node_Reference_HashTable identifiers;
+    Kai_u32 trail_start;
+    Kai_Node_Reference_DynArray ready_nodes;
+    Kai_u32 ready_head;
     Kai_Pending_Node_DynArray pending_nodes;
+    Kai_Node_Waiter_DynArray waiters;
+    Kai_u32 waiting_count;
     Kai_bool is_proc_scope;
 };
 
+struct Kai__Binding {
+    Kai_Node_Reference ref;
+    Kai_u32 scope;
+};
+
+struct Kai__Shadowed {
+    Kai_u32 atom;
+    Kai__Binding previous;
+};
+
 struct Kai_Pending_Node {
     Kai_Node_Reference ref;
     Kai_Node_Reference_DynArray dependencies;
+    Kai_u32 unresolved;
+};
+
+struct Kai_Node_Waiter {
+    Kai_u32 pending;
+    Kai_u32 next;
+};
+
+struct Kai_Attempt_Checkpoint {
+    Kai_Arena_Checkpoint types;
+    Kai_u32 type_count;
+    Kai_u32 instance_count;
+    Kai_u32 code_count;
+    Kai_u32 scope_count;
+    Kai_u32 trail_count;
+    Kai_u32 local_node_count;
+    Kai_u32 jump_table_count;
+    Kai_u32 compare_tree_count;
+    Kai_u32 procedure_job_count;
 };
 
 // Type: Kai__Builtin_Type_ID
@@ -1203,6 +1523,79 @@ enum {
     KAI_BUILTIN_COUNT = 17,
 };
 
+// Type: Kai__Intrinsic_ID
+enum {
+    KAI_INTRINSIC_NONE = 0,
+    KAI_INTRINSIC_CLZ = 1,
+    KAI_INTRINSIC_CTZ = 2,
+    KAI_INTRINSIC_POPCOUNT = 3,
+    KAI_INTRINSIC_BSWAP = 4,
+    KAI_INTRINSIC_ROTL = 5,
+    KAI_INTRINSIC_MULTIPLY_HIGH = 6,
+    KAI_INTRINSIC_MEMORY_COPY = 7,
+    KAI_INTRINSIC_MEMORY_SET = 8,
+};
+
+struct Kai__Case {
+    Kai_u64 value;
+    Kai_string text;
+    Kai_u32 label;
+    Kai_Stmt* body;
+};
+
+struct Kai__Case_Jump {
+    Kai_u32 label;
+    Kai_u32 target;
+};
+
+struct Kai__Case_Lowering {
+    Kai__Case* cases;
+    Kai_u32* sorted;
+    Kai__Case_Jump* jumps;
+    Kai_u32 jump_count;
+    Kai_u32 end_label;
+    Kai_bool is_signed;
+};
+
+struct Kai__String_Case_Hash {
+    Kai_u32 a;
+    Kai_u32 b;
+    Kai_u32 p;
+    Kai_u32 q;
+    Kai_u32 n;
+};
+
+struct Kai__Instance {
+    Kai_Expr_Procedure* proc;
+    Kai_Source source;
+    Kai_string* names;
+    Kai_u32* atoms;
+    Kai_Type_Info_Procedure* bindings;
+    Kai_Type_Info_Procedure* type;
+    Kai_Value value;
+};
+
+struct Kai__Polymorph {
+    Kai_Expr_Procedure* proc;
+    Kai_Type_u32_HashTable instances;
+};
+
+struct Kai__Procedure_Job {
+    Kai_Expr_Procedure* proc;
+    Kai_Type_Info_Procedure* type;
+    Kai__Instance instance;
+    Kai_Source source;
+    Kai_u32_DynArray code;
+    Kai_u32 label;
+    Kai_bool compiled;
+    Kai_Error error;
+};
+
+struct Kai__Label_Fixup {
+    Kai_u32 location;
+    Kai_u32 job;
+};
+
 struct Kai_Compiler_Context {
     Kai_Allocator allocator;
     Kai_Growing_Arena error_arena;
@@ -1212,18 +1605,37 @@ struct Kai_Compiler_Context {
     Kai_Program* program;
     Kai_Compile_Options options;
     Kai_Import_Slice imports;
+    Kai_u32_bool_HashTable export_atoms;
     Kai_Type_Slice builtin_types;
     Kai_Node_DynArray nodes;
     Kai_Local_Node_DynArray local_nodes;
     Kai_Syntax_Tree_Slice trees;
+    Kai_Compact_Tree_Slice compact_trees;
+    Kai_Atom_Table atoms;
     Kai_Type_u32_HashTable type_cache;
     Kai_Scope_DynArray scopes;
+    Kai_u32__Binding_HashTable symbols;
+    Kai__Shadowed_DynArray symbol_trail;
+    Kai__Polymorph_DynArray polymorphs;
+    Kai__Instance_DynArray instances;
+    Kai_u32 instances_compiled;
+    Kai_Job_System* jobs;
+    Kai__Procedure_Job_DynArray procedure_jobs;
+    Kai__Label_Fixup_DynArray label_fixups;
+    Kai_Type_u32_HashTable shared_type_cache;
+    Kai_u32__Binding_HashTable shared_symbols;
+    Kai_bool is_worker;
     Kai_Node_Reference current_node;
     Kai_Source current_source;
     Kai_Node_Reference_DynArray current_dependencies;
+    Kai__Instance* current_instance;
+    Kai_u32 current_compact;
+    Kai_Compact_Tree* current_compact_tree;
     Kai_Assembler assembler;
     Kai_u32 stack_index;
     Kai_u32 last_variable_index;
+    Kai_u32 jump_table_count;
+    Kai_u32 compare_tree_count;
     Kai_Type_Info* number_type;
     Kai_Type_Info* string_type;
     Kai_Type_Info* type_type;
@@ -1231,8 +1643,40 @@ struct Kai_Compiler_Context {
     Kai_Writer* debug_writer;
 };
 
+struct Kai__Parse_Result {
+    Kai_Error error;
+    Kai_Atom_Table atoms;
+    Kai__Atom_Ref_DynArray atom_refs;
+};
+
+struct Kai__Parse_Batch {
+    Kai_Source_Slice sources;
+    Kai_Syntax_Tree* trees;
+    Kai_Compact_Tree* compact_trees;
+    Kai__Parse_Result* results;
+    Kai_Allocator allocator;
+    Kai_u32 worker_count;
+};
+
+struct Kai__Worker {
+    Kai_Compiler_Context context;
+    Kai_Error error;
+};
+
+struct Kai__Job_Batch {
+    Kai_Compiler_Context* main;
+    Kai__Worker* workers;
+    Kai_u32 worker_count;
+    Kai_u32 first;
+    Kai_u32 end;
+};
+
 KAI_API(Kai_string) kai_version_string(void);
 KAI_API(Kai_vector3_u32) kai_version(void);
+KAI_API(Kai_u32) kai_find_line_starts(Kai_string contents, Kai_u32* out);
+KAI_API(void) kai_find_line_starts_into(Kai_string contents, Kai_u32_DynArray* lines, Kai_Allocator* allocator);
+KAI_API(Kai_u32) kai_source_line(Kai_Source* source, Kai_u32 offset);
+KAI_API(Kai_u32) kai_source_column(Kai_Source* source, Kai_u32 offset);
 KAI_API(Kai_bool) kai_string_equals(Kai_string left, Kai_string right);
 KAI_API(Kai_string) kai_string_from_c(Kai_cstring s);
 KAI_API(Kai_string) kai_string_from_data(Kai_u8* data, Kai_u32 count);
@@ -1247,8 +1691,11 @@ KAI_API(void) kai_raw_array_remove(Kai_Raw_Dynamic_Array* array, Kai_u32 index,
 KAI_API(Kai_Hash_Table_Size) kai_raw_table_size(Kai_u32 capacity, Kai_u32 key_size, Kai_u32 elem_size);
 KAI_API(void) kai_raw_table_grow(Kai_Raw_Hash_Table* table, Kai_Allocator* allocator, Kai_u32 key_size, Kai_u32 elem_size);
 KAI_API(Kai_bool) kai_raw_table_next_match(Kai_Raw_Hash_Table* table, Kai_u64 hash, Kai_u32* out_index);
+KAI_API(Kai_u64) kai_hash_u32(Kai_u32 key);
+KAI_API(Kai_bool) kai_u32_equals(Kai_u32 left, Kai_u32 right);
 KAI_API(Kai_int) kai_raw_table_find_string(Kai__string_HashTable* table, Kai_string key);
 KAI_API(Kai_int) kai_raw_table_find_Type(Kai__Type_HashTable* table, Kai_Type key);
+KAI_API(Kai_int) kai_raw_table_find_u32(Kai__u32_HashTable* table, Kai_u32 key);
 KAI_API(Kai_u64) kai_hash_type(Kai_Type_Info* type);
 KAI_API(Kai_bool) kai_type_equals(Kai_Type_Info* a, Kai_Type_Info* b);
 KAI_API(Kai_u64) kai_number_to_u64(Kai_Number number);
@@ -1280,15 +1727,25 @@ KAI_API(void) kai_write_error(Kai_Writer* writer, Kai_Error* error);
 KAI_API(void) kai_write_type(Kai_Writer* writer, Kai_Type_Info* type);
 KAI_API(void) kai_write_value(Kai_Writer* writer, void* data, Kai_Type_Info* type);
 KAI_API(void) kai_write_expression(Kai_Writer* writer, Kai_Expr* expr, Kai_u32 depth);
+KAI_API(void) kai_write_compact_tree(Kai_Writer* writer, Kai_Compact_Tree* tree);
 KAI_API(void) kai_write_syntax_tree(Kai_Writer* writer, Kai_Syntax_Tree* tree);
 KAI_API(void) kai_write_number(Kai_Writer* writer, Kai_Number number);
 KAI_API(void) kai_destroy_error(Kai_Error* error, Kai_Allocator* allocator);
 
+KAI_API(void) kai_create_atom_table(Kai_Atom_Table* table, Kai_Allocator* allocator);
+KAI_API(void) kai_destroy_atom_table(Kai_Atom_Table* table);
+KAI_API(Kai_u32) kai_intern_atom(Kai_Atom_Table* table, Kai_string name);
 KAI_API(void) kai_write_token(Kai_Writer* writer, Kai_Token token);
 KAI_API(Kai_string) kai_token_string(Kai_Token_Id id, Kai_string dst);
 KAI_API(Kai_Token) kai_tokenizer_generate(Kai_Tokenizer* context);
 KAI_API(Kai_Token*) kai_tokenizer_next(Kai_Tokenizer* context);
 KAI_API(Kai_Token*) kai_tokenizer_peek(Kai_Tokenizer* context);
+KAI_API(Kai_Token) kai_tokenizer_look_ahead(Kai_Tokenizer* context, Kai_u32 n);
+KAI_API(void) kai_create_token_buffer(Kai_Token_Buffer* buffer, Kai_Allocator* allocator);
+KAI_API(void) kai_destroy_token_buffer(Kai_Token_Buffer* buffer);
+KAI_API(void) kai_tokenize_source(Kai_Token_Buffer* buffer, Kai_string source, Kai_Atom_Table* atoms);
+KAI_API(Kai_Token) kai_token_buffer_get(Kai_Token_Buffer* buffer, Kai_u32 index);
+KAI_API(Kai_u32) kai_tokenize_classify(Kai_string source, Kai_u32 end, Kai_Classify_State* state, Kai_Token_Run* runs, Kai_u32 capacity);
 KAI_API(Kai_Expr*) kai_parse_procedure_call_arguments(Kai_Parser* parser, Kai_u32* arg_count);
 KAI_API(Kai_Expr*) kai_parse_tag_to_expr(Kai_Parser* parser, Kai_Expr* expr);
 KAI_API(Kai_Expr*) kai_parse_expression(Kai_Parser* parser, Kai_u32 flags);
@@ -1297,23 +1754,56 @@ KAI_API(Kai_Expr*) kai_parse_procedure(Kai_Parser* parser);
 KAI_API(Kai_Stmt*) kai_parse_declaration(Kai_Parser* parser);
 KAI_API(Kai_Stmt*) kai_parse_statement(Kai_Parser* parser);
 KAI_API(Kai_Result) kai_create_syntax_tree(Kai_Syntax_Tree_Create_Info* info, Kai_Syntax_Tree* out_tree);
+KAI_API(void) kai_reset_syntax_tree(Kai_Syntax_Tree* tree);
 KAI_API(void) kai_destroy_syntax_tree(Kai_Syntax_Tree* tree);
+KAI_API(void) kai_settle_syntax_tree(Kai_Syntax_Tree* tree);
+KAI_API(Kai_Result) kai_update_syntax_tree(Kai_Syntax_Tree_Create_Info* info, Kai_Syntax_Tree* tree, Kai_Source_Edit edit);
+KAI_API(Kai_Result) kai_create_source_stream(Kai_Source_Stream_Create_Info* info, Kai_Source_Stream* out_stream);
+KAI_API(void) kai_destroy_source_stream(Kai_Source_Stream* stream);
+KAI_API(Kai_Stmt*) kai_source_stream_next(Kai_Source_Stream* stream);
+KAI_API(void) kai_create_compact_tree(Kai_Syntax_Tree* tree, Kai_Atom_Table* atoms, Kai_Allocator* allocator, Kai_Compact_Tree* out_tree);
+KAI_API(Kai_Result) kai_parse_compact_tree(Kai_Syntax_Tree_Create_Info* info, Kai_Compact_Tree* out_tree);
+KAI_API(void) kai_destroy_compact_tree(Kai_Compact_Tree* tree);
+KAI_API(Kai_Compact_Node*) kai_compact_node(Kai_Compact_Tree* tree, Kai_u32 index);
+KAI_API(Kai_u32) kai_compact_child(Kai_Compact_Tree* tree, Kai_u32 index, Kai_u32 i);
+KAI_API(Kai_string) kai_compact_source(Kai_Compact_Tree* tree, Kai_u32 index);
+KAI_API(Kai_string) kai_compact_name(Kai_Compact_Tree* tree, Kai_u32 index);
+KAI_API(Kai_string) kai_compact_string(Kai_Compact_Tree* tree, Kai_u32 index);
+KAI_API(Kai_Number) kai_compact_number(Kai_Compact_Tree* tree, Kai_u32 index);
+KAI_API(Kai_Expr*) kai_compact_expand_node(Kai_Compact_Tree* tree, Kai_u32 index, Kai_Arena_Allocator* arena);
+KAI_API(Kai_Expr*) kai_compact_expand(Kai_Compact_Tree* tree, Kai_u32 index, Kai_Arena_Allocator* arena);
 
 KAI_API(Kai_u32) kai_asm_create_label(Kai_Assembler* assembler);
 KAI_API(Kai_s32) kai_asm_relative_location(Kai_u32 label_from, Kai_u32 label_to);
 KAI_API(Kai_u32) kai_asm_insert_jump(Kai_Assembler* assembler, Kai_u32 condition, Kai_s32 relative);
 KAI_API(void) kai_asm_modify_jump(Kai_Assembler* assembler, Kai_u32 label, Kai_s32 relative);
 KAI_API(void) kai_asm_insert_ret(Kai_Assembler* assembler);
-KAI_API(void) kai_asm_insert_load_constant(Kai_Assembler* assembler, Kai_u64 value);
+KAI_API(void) kai_asm_insert_load_constant(Kai_Assembler* assembler, Kai_u32 reg, Kai_u64 value);
 KAI_API(void) kai_asm_insert_stack_load(Kai_Assembler* assembler, Kai_u32 index, Kai_u32 reg);
 KAI_API(void) kai_asm_insert_stack_store(Kai_Assembler* assembler, Kai_u32 index, Kai_u32 reg);
 KAI_API(void) kai_asm_insert_add(Kai_Assembler* assembler, Kai_u32 dst, Kai_u32 a, Kai_u32 b);
 KAI_API(void) kai_asm_insert_sub(Kai_Assembler* assembler, Kai_u32 dst, Kai_u32 a, Kai_u32 b);
 KAI_API(void) kai_asm_insert_cmp(Kai_Assembler* assembler, Kai_u32 a, Kai_u32 b);
+KAI_API(void) kai_asm_insert_move(Kai_Assembler* assembler, Kai_u32 dst, Kai_u32 src);
 KAI_API(void) kai_asm_insert_test(Kai_Assembler* assembler, Kai_u32 reg);
+KAI_API(void) kai_asm_insert_extend(Kai_Assembler* assembler, Kai_u32 reg, Kai_u8 bits, Kai_bool is_signed);
+KAI_API(Kai_u32) kai_asm_insert_jump_table(Kai_Assembler* assembler, Kai_u32 reg, Kai_u32 count);
+KAI_API(void) kai_asm_set_jump_table_entry(Kai_Assembler* assembler, Kai_u32 table, Kai_u32 index, Kai_u32 target);
+KAI_API(void) kai_asm_insert_string_hash(Kai_Assembler* assembler, Kai_u32 count, Kai_u32 data, Kai_u32 a, Kai_u32 b, Kai_u32 p, Kai_u32 q, Kai_u32 n);
+KAI_API(Kai_u32) kai_asm_insert_string_compare(Kai_Assembler* assembler, Kai_u32 count, Kai_u32 data, Kai_string text);
+KAI_API(void) kai_asm_insert_count_leading_zeros(Kai_Assembler* assembler, Kai_u32 reg, Kai_u8 bits);
+KAI_API(void) kai_asm_insert_count_trailing_zeros(Kai_Assembler* assembler, Kai_u32 reg, Kai_u8 bits);
+KAI_API(void) kai_asm_insert_popcount(Kai_Assembler* assembler, Kai_u32 reg, Kai_u8 bits);
+KAI_API(void) kai_asm_insert_byte_swap(Kai_Assembler* assembler, Kai_u32 reg, Kai_u8 bits);
+KAI_API(void) kai_asm_insert_rotate_left(Kai_Assembler* assembler, Kai_u32 dst, Kai_u32 value, Kai_u32 shift, Kai_u8 bits);
+KAI_API(void) kai_asm_insert_multiply_high(Kai_Assembler* assembler, Kai_u32 dst, Kai_u32 a, Kai_u32 b);
+KAI_API(void) kai_asm_insert_memory_copy(Kai_Assembler* assembler, Kai_u32 dst, Kai_u32 src, Kai_u32 size);
+KAI_API(void) kai_asm_insert_memory_set(Kai_Assembler* assembler, Kai_u32 dst, Kai_u32 byte, Kai_u32 size);
 
 KAI_API(Kai_Result) kai_create_program(Kai_Program_Create_Info* info, Kai_Program* out_program);
 KAI_API(void) kai_destroy_program(Kai_Program* program);
+KAI_API(void) kai_create_type_table(Kai_Type_Table* table, Kai_Allocator* allocator);
+KAI_API(void) kai_destroy_type_table(Kai_Type_Table* table);
 KAI_API(void*) kai_find_variable(Kai_Program* program, Kai_string name, Kai_Type* out_type);
 KAI_API(void*) kai_find_procedure(Kai_Program* program, Kai_string name, Kai_string type);
 
@@ -1342,6 +1832,11 @@ KAI_API(Kai_Result) kai_allocator_destroy(Kai_Allocator* allocator);
 KAI_API(Kai_u64) kai_allocator_usage(Kai_Allocator* allocator);
 #endif
 
+#ifndef KAI_DONT_USE_SOURCE_API
+KAI_API(Kai_Result) kai_source_map_file(Kai_cstring path, Kai_Source* out_source);
+KAI_API(void) kai_source_unmap(Kai_Source* source);
+#endif
+
 #ifdef KAI_IMPLEMENTATION
 
 #define kai__explore(Expr,IS_LAST) (kai__tree_traversal_push(context, IS_LAST),kai__write_tree(context, Expr),kai__tree_traversal_pop(context))
@@ -1362,6 +1857,8 @@ KAI_API(Kai_u64) kai_allocator_usage(Kai_Allocator* allocator);
 #define KAI__Z ((8<<1)|1)
 #define KAI__PREC_CAST 2304
 #define KAI__PREC_UNARY 4096
+#define KAI__BUILTIN_NAME_COUNT 13
+#define KAI__BUILTIN_NODE_COUNT (KAI__BUILTIN_NAME_COUNT+2)
 
 static inline Kai_u32 kai_intrinsics_clz32(Kai_u32 value)
 {
@@ -1411,6 +1908,76 @@ static inline Kai_u32 kai_intrinsics_ctz64(Kai_u64 value)
 #endif
 }
 
+static inline Kai_u32 kai_intrinsics_popcount32(Kai_u32 value)
+{
+#if defined(KAI_COMPILER_CLANG) || defined(KAI_COMPILER_GNU)
+    return (Kai_u32)__builtin_popcount(value);
+#elif defined(KAI_COMPILER_MSVC)
+    return (Kai_u32)__popcnt(value);
+#endif
+}
+
+static inline Kai_u32 kai_intrinsics_popcount64(Kai_u64 value)
+{
+#if defined(KAI_COMPILER_CLANG) || defined(KAI_COMPILER_GNU)
+    return (Kai_u32)__builtin_popcountll(value);
+#elif defined(KAI_COMPILER_MSVC)
+    return (Kai_u32)__popcnt64(value);
+#endif
+}
+
+static inline Kai_u32 kai_intrinsics_bswap32(Kai_u32 value)
+{
+#if defined(KAI_COMPILER_CLANG) || defined(KAI_COMPILER_GNU)
+    return __builtin_bswap32(value);
+#elif defined(KAI_COMPILER_MSVC)
+    return _byteswap_ulong(value);
+#endif
+}
+
+static inline Kai_u64 kai_intrinsics_bswap64(Kai_u64 value)
+{
+#if defined(KAI_COMPILER_CLANG) || defined(KAI_COMPILER_GNU)
+    return __builtin_bswap64(value);
+#elif defined(KAI_COMPILER_MSVC)
+    return _byteswap_uint64(value);
+#endif
+}
+
+// NOTE: compilers recognize this pattern and emit a single rotate instruction
+static inline Kai_u32 kai_intrinsics_rotl32(Kai_u32 value, Kai_u32 shift)
+{
+#if defined(KAI_COMPILER_MSVC)
+    return _rotl(value, (int)shift);
+#else
+    shift &= 31;
+    return (value << shift) | (value >> ((32 - shift) & 31));
+#endif
+}
+
+static inline Kai_u64 kai_intrinsics_rotl64(Kai_u64 value, Kai_u32 shift)
+{
+#if defined(KAI_COMPILER_MSVC)
+    return _rotl64(value, (int)shift);
+#else
+    shift &= 63;
+    return (value << shift) | (value >> ((64 - shift) & 63));
+#endif
+}
+
+// Memory (WASM builds must provide memcpy, memmove and memset)
+
+#if defined(KAI_COMPILER_CLANG) || defined(KAI_COMPILER_GNU)
+#   define kai_intrinsics_memory_copy(DST,SRC,SIZE) __builtin_memcpy(DST,SRC,SIZE)
+#   define kai_intrinsics_memory_move(DST,SRC,SIZE) __builtin_memmove(DST,SRC,SIZE)
+#   define kai_intrinsics_memory_set(DST,BYTE,SIZE) __builtin_memset(DST,BYTE,SIZE)
+#else
+#   include <string.h>
+#   define kai_intrinsics_memory_copy(DST,SRC,SIZE) memcpy(DST,SRC,SIZE)
+#   define kai_intrinsics_memory_move(DST,SRC,SIZE) memmove(DST,SRC,SIZE)
+#   define kai_intrinsics_memory_set(DST,BYTE,SIZE) memset(DST,BYTE,SIZE)
+#endif
+
 // 128 bit integers (unsigned)
 
 // Always use fallback when compiling for WASM
@@ -1460,6 +2027,135 @@ static inline Kai_u32 kai_intrinsics_ctz64(Kai_u64 value)
     }
 #endif
 
+// Byte scanning (used by the tokenizer)
+// Each scan returns the index of the first byte in [start, end) that stops it, or end.
+// 32 bytes at a time with AVX2, 16 with SSE2 or NEON, one at a time for WASM or KAI_NO_SIMD.
+
+#if defined(KAI_NO_SIMD) || defined(__wasm__)
+#elif defined(__AVX2__)
+#   include <immintrin.h>
+#   define KAI__VECTOR_SIZE 32
+#   define KAI__VECTOR_MASK_SHIFT 0 // one mask bit per byte
+#   define KAI__VECTOR_ALL 0xFFFFFFFFull
+    typedef __m256i Kai__Vector;
+    static inline Kai__Vector kai__vector_load(Kai_u8 const* p) { return _mm256_loadu_si256((__m256i const*)p); }
+    static inline Kai__Vector kai__vector_splat(Kai_u8 b) { return _mm256_set1_epi8((char)b); }
+    static inline Kai__Vector kai__vector_equals(Kai__Vector a, Kai__Vector b) { return _mm256_cmpeq_epi8(a, b); }
+    static inline Kai__Vector kai__vector_or(Kai__Vector a, Kai__Vector b) { return _mm256_or_si256(a, b); }
+    static inline Kai__Vector kai__vector_and_not(Kai__Vector a, Kai__Vector b) { return _mm256_andnot_si256(b, a); }
+    static inline Kai__Vector kai__vector_sub(Kai__Vector a, Kai_u8 b) { return _mm256_sub_epi8(a, _mm256_set1_epi8((char)b)); }
+    static inline Kai__Vector kai__vector_at_most(Kai__Vector a, Kai_u8 b) {
+        return _mm256_cmpeq_epi8(_mm256_subs_epu8(a, _mm256_set1_epi8((char)b)), _mm256_setzero_si256());
+    }
+    static inline Kai_u64 kai__vector_mask(Kai__Vector a) { return (Kai_u32)_mm256_movemask_epi8(a); }
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#   include <emmintrin.h>
+#   define KAI__VECTOR_SIZE 16
+#   define KAI__VECTOR_MASK_SHIFT 0
+#   define KAI__VECTOR_ALL 0xFFFFull
+    typedef __m128i Kai__Vector;
+    static inline Kai__Vector kai__vector_load(Kai_u8 const* p) { return _mm_loadu_si128((__m128i const*)p); }
+    static inline Kai__Vector kai__vector_splat(Kai_u8 b) { return _mm_set1_epi8((char)b); }
+    static inline Kai__Vector kai__vector_equals(Kai__Vector a, Kai__Vector b) { return _mm_cmpeq_epi8(a, b); }
+    static inline Kai__Vector kai__vector_or(Kai__Vector a, Kai__Vector b) { return _mm_or_si128(a, b); }
+    static inline Kai__Vector kai__vector_and_not(Kai__Vector a, Kai__Vector b) { return _mm_andnot_si128(b, a); }
+    static inline Kai__Vector kai__vector_sub(Kai__Vector a, Kai_u8 b) { return _mm_sub_epi8(a, _mm_set1_epi8((char)b)); }
+    static inline Kai__Vector kai__vector_at_most(Kai__Vector a, Kai_u8 b) {
+        return _mm_cmpeq_epi8(_mm_subs_epu8(a, _mm_set1_epi8((char)b)), _mm_setzero_si128());
+    }
+    static inline Kai_u64 kai__vector_mask(Kai__Vector a) { return (Kai_u32)_mm_movemask_epi8(a); }
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#   include <arm_neon.h>
+#   define KAI__VECTOR_SIZE 16
+#   define KAI__VECTOR_MASK_SHIFT 2 // four mask bits per byte
+#   define KAI__VECTOR_ALL 0xFFFFFFFFFFFFFFFFull
+    typedef uint8x16_t Kai__Vector;
+    static inline Kai__Vector kai__vector_load(Kai_u8 const* p) { return vld1q_u8(p); }
+    static inline Kai__Vector kai__vector_splat(Kai_u8 b) { return vdupq_n_u8(b); }
+    static inline Kai__Vector kai__vector_equals(Kai__Vector a, Kai__Vector b) { return vceqq_u8(a, b); }
+    static inline Kai__Vector kai__vector_or(Kai__Vector a, Kai__Vector b) { return vorrq_u8(a, b); }
+    static inline Kai__Vector kai__vector_and_not(Kai__Vector a, Kai__Vector b) { return vbicq_u8(a, b); }
+    static inline Kai__Vector kai__vector_sub(Kai__Vector a, Kai_u8 b) { return vsubq_u8(a, vdupq_n_u8(b)); }
+    static inline Kai__Vector kai__vector_at_most(Kai__Vector a, Kai_u8 b) { return vcleq_u8(a, vdupq_n_u8(b)); }
+    static inline Kai_u64 kai__vector_mask(Kai__Vector a) {
+        return vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(a), 4)), 0);
+    }
+#endif
+
+#if defined(KAI__VECTOR_SIZE)
+    static inline Kai__Vector kai__vector_in_range(Kai__Vector a, Kai_u8 low, Kai_u8 high) {
+        return kai__vector_at_most(kai__vector_sub(a, low), (Kai_u8)(high - low));
+    }
+#endif
+
+// Spaces, tabs and other control characters, but not line breaks
+static inline Kai_u32 kai_intrinsics_skip_whitespace(Kai_u8 const* data, Kai_u32 start, Kai_u32 end)
+{
+#if defined(KAI__VECTOR_SIZE)
+    Kai__Vector lf = kai__vector_splat('\n');
+    Kai__Vector cr = kai__vector_splat('\r');
+    while (start + KAI__VECTOR_SIZE <= end) {
+        Kai__Vector v = kai__vector_load(data + start);
+        Kai__Vector breaks = kai__vector_or(kai__vector_equals(v, lf), kai__vector_equals(v, cr));
+        Kai_u64 stop = kai__vector_mask(kai__vector_and_not(kai__vector_at_most(v, ' '), breaks)) ^ KAI__VECTOR_ALL;
+        if (stop) return start + (kai_intrinsics_ctz64(stop) >> KAI__VECTOR_MASK_SHIFT);
+        start += KAI__VECTOR_SIZE;
+    }
+#endif
+    while (start < end && data[start] <= ' ' && data[start] != '\n' && data[start] != '\r')
+        start += 1;
+    return start;
+}
+
+// [0-9A-Za-z_] and any byte of a multi-byte unicode symbol
+static inline Kai_u32 kai_intrinsics_skip_identifier(Kai_u8 const* data, Kai_u32 start, Kai_u32 end)
+{
+#if defined(KAI__VECTOR_SIZE)
+    Kai__Vector underscore = kai__vector_splat('_');
+    Kai__Vector lower = kai__vector_splat(0x20);
+    while (start + KAI__VECTOR_SIZE <= end) {
+        Kai__Vector v = kai__vector_load(data + start);
+        Kai__Vector ident = kai__vector_or(
+            kai__vector_or(kai__vector_in_range(v, '0', '9'), kai__vector_in_range(kai__vector_or(v, lower), 'a', 'z')),
+            kai__vector_or(kai__vector_equals(v, underscore), kai__vector_in_range(v, 0x80, 0xFF)));
+        Kai_u64 stop = kai__vector_mask(ident) ^ KAI__VECTOR_ALL;
+        if (stop) return start + (kai_intrinsics_ctz64(stop) >> KAI__VECTOR_MASK_SHIFT);
+        start += KAI__VECTOR_SIZE;
+    }
+#endif
+    while (start < end) {
+        Kai_u8 c = data[start];
+        if (!((c >= '0' && c <= '9') || ((c | 0x20) >= 'a' && (c | 0x20) <= 'z') || c == '_' || c >= 0x80))
+            break;
+        start += 1;
+    }
+    return start;
+}
+
+// Stops at any of the bytes a, b, c or d (repeat a byte to look for fewer)
+static inline Kai_u32 kai_intrinsics_find_any4(Kai_u8 const* data, Kai_u32 start, Kai_u32 end, Kai_u8 a, Kai_u8 b, Kai_u8 c, Kai_u8 d)
+{
+#if defined(KAI__VECTOR_SIZE)
+    Kai__Vector va = kai__vector_splat(a), vb = kai__vector_splat(b);
+    Kai__Vector vc = kai__vector_splat(c), vd = kai__vector_splat(d);
+    while (start + KAI__VECTOR_SIZE <= end) {
+        Kai__Vector v = kai__vector_load(data + start);
+        Kai_u64 stop = kai__vector_mask(kai__vector_or(
+            kai__vector_or(kai__vector_equals(v, va), kai__vector_equals(v, vb)),
+            kai__vector_or(kai__vector_equals(v, vc), kai__vector_equals(v, vd))));
+        if (stop) return start + (kai_intrinsics_ctz64(stop) >> KAI__VECTOR_MASK_SHIFT);
+        start += KAI__VECTOR_SIZE;
+    }
+#endif
+    while (start < end) {
+        Kai_u8 x = data[start];
+        if (x == a || x == b || x == c || x == d)
+            break;
+        start += 1;
+    }
+    return start;
+}
+
 // TODO: only dev builds
 #if defined(KAI_PLATFORM_APPLE) || defined(KAI_PLATFORM_LINUX)
 #include "execinfo.h"
@@ -1498,8 +2194,11 @@ KAI_INTERNAL Kai_f64 kai__ldexp(Kai_f64 x, Kai_int n);
 KAI_INTERNAL Kai_u64 kai__mul_with_shift(Kai_u64 a, Kai_u64 b, Kai_s32* exp, Kai_bool sub);
 KAI_INTERNAL Kai_u64 kai__add_with_shift(Kai_u64 a, Kai_u64 b, Kai_s32* exp, Kai_bool sub);
 KAI_INTERNAL void kai__memory_copy(void* dst, void* src, Kai_u32 size);
+KAI_INTERNAL void kai__memory_move(void* dst, void* src, Kai_u32 size);
 KAI_INTERNAL void kai__memory_zero(void* dst, Kai_u32 size);
 KAI_INTERNAL void kai__memory_fill(void* dst, Kai_u8 byte, Kai_u32 size);
+KAI_INTERNAL Kai_u64 kai__compute_type_hash(Kai_Type_Info* type);
+KAI_INTERNAL void kai__arena_free_large(Kai_Arena_Allocator* arena, Kai_Arena_Large* until);
 KAI_INTERNAL void kai__push_integer(Kai_Growing_Arena* arena, Kai_u64 value);
 KAI_INTERNAL void kai__arena_writer_write(void* user, Kai_Write_Command command, Kai_Value value, Kai_Write_Format format);
 KAI_INTERNAL void kai__buffer_append_string(Kai_Buffer* buffer, Kai_string s);
@@ -1507,8 +2206,7 @@ KAI_INTERNAL Kai_Range kai__buffer_end(Kai_Buffer* buffer);
 KAI_INTERNAL Kai_Range kai__buffer_push(Kai_Buffer* buffer, Kai_u32 size);
 KAI_INTERNAL Kai_Memory kai__buffer_done(Kai_Buffer* buffer);
 KAI_INTERNAL Kai_u32 kai__base10_digit_count(Kai_u32 x);
-KAI_INTERNAL Kai_u8* kai__advance_to_line(Kai_u8* source, Kai_u32 line);
-KAI_INTERNAL void kai__write_source_code(Kai_Writer* writer, Kai_u8* src);
+KAI_INTERNAL void kai__write_source_code(Kai_Writer* writer, Kai_u8* src, Kai_u8* end);
 KAI_INTERNAL Kai_u32 kai__utf8_decode(Kai_string s, Kai_u32* out);
 KAI_INTERNAL Kai_u32 kai__unicode_char_width(Kai_Writer* writer, Kai_u32 cp, Kai_u8 first, Kai_u8 ch);
 KAI_INTERNAL void kai__write_source_code_fill(Kai_Writer* writer, Kai_u8* src, Kai_u8* end, Kai_u8 first, Kai_u8 ch);
@@ -1520,10 +2218,22 @@ KAI_INTERNAL void kai__write_binary_operator_name(Kai_Writer* writer, Kai_u32 op
 KAI_INTERNAL void kai__write_assignment_operator_name(Kai_Writer* writer, Kai_u32 op);
 KAI_INTERNAL void kai__write_tree_branches(Kai__Tree_Traversal_Context* context);
 KAI_INTERNAL void kai__write_tree(Kai__Tree_Traversal_Context* context, Kai_Expr* expr);
+KAI_INTERNAL void kai__explore_compact(Kai__Tree_Traversal_Context* context, Kai_Compact_Tree* tree, Kai_u32 index, Kai_bool is_last);
+KAI_INTERNAL void kai__write_compact_id_with_name(Kai_Writer* writer, Kai_string id, Kai_string name);
+KAI_INTERNAL void kai__write_compact_tree(Kai__Tree_Traversal_Context* context, Kai_Compact_Tree* tree, Kai_u32 index);
 KAI_INTERNAL Kai_u32 kai__string_to_keyword_index(Kai_string kw);
 KAI_INTERNAL Kai_Number kai__parse_fractional_part(Kai_string source, Kai_u32* offset, Kai_Number start);
 KAI_INTERNAL Kai_bool kai__make_multi_token(Kai_Tokenizer* context, Kai_Token* t, Kai_u8 current);
 KAI_INTERNAL void kai__tokenizer_advance_to_identifier_end(Kai_Tokenizer* context);
+KAI_INTERNAL Kai_string kai__tokenizer_unescape(Kai_Tokenizer* context);
+KAI_INTERNAL void kai__tokenizer_read(Kai_Tokenizer* context, Kai_Token* token);
+KAI_INTERNAL void kai__token_buffer_read(Kai_Token_Buffer* buffer, Kai_u32 index, Kai_Token* token);
+KAI_INTERNAL Kai_u32 kai__classify_digits(Kai_string source, Kai_u32 i, Kai_u32 base);
+KAI_INTERNAL Kai_u32 kai__classify_fraction(Kai_string source, Kai_u32 i);
+KAI_INTERNAL Kai_u32 kai__classify_comment(Kai_string source, Kai_u32 i, Kai_u32 end, Kai_u32* depth);
+KAI_INTERNAL Kai_u32 kai__classify_string(Kai_string source, Kai_u32 i, Kai_u32 end, Kai_bool* in_string);
+KAI_INTERNAL void* kai__parser_allocate(Kai_Parser* parser, Kai_u32 size);
+KAI_INTERNAL void kai__set_atom(Kai_Parser* parser, Kai_u32* dst, Kai_u32 atom);
 KAI_INTERNAL Kai_Expr* kai__error_unexpected(Kai_Parser* parser, Kai_Token* token, Kai_string where, Kai_string wanted);
 KAI_INTERNAL Kai__Operator kai__operator_info(Kai_u32 op);
 KAI_INTERNAL Kai_Expr* kai__parser_create_identifier(Kai_Parser* parser, Kai_Token token);
@@ -1541,15 +2251,34 @@ KAI_INTERNAL Kai_Expr* kai__parser_create_import(Kai_Parser* parser, Kai_Token t
 KAI_INTERNAL Kai_Expr* kai__parser_create_struct(Kai_Parser* parser, Kai_Token token, Kai_u32 field_count, Kai_Stmt* body);
 KAI_INTERNAL Kai_Expr* kai__parser_create_enum(Kai_Parser* parser, Kai_Token token, Kai_Expr* type, Kai_u32 field_count, Kai_Stmt* body);
 KAI_INTERNAL Kai_Expr* kai__parser_create_return(Kai_Parser* parser, Kai_Token ret_token, Kai_Expr* expr);
-KAI_INTERNAL Kai_Expr* kai__parser_create_declaration(Kai_Parser* parser, Kai_string name, Kai_Expr* type, Kai_Expr* value, Kai_u8 flags, Kai_u32 line_number);
+KAI_INTERNAL Kai_Expr* kai__parser_create_declaration(Kai_Parser* parser, Kai_string name, Kai_u32 atom, Kai_Expr* type, Kai_Expr* value, Kai_u8 flags, Kai_u32 offset);
 KAI_INTERNAL Kai_Expr* kai__parser_create_assignment(Kai_Parser* parser, Kai_u32 op, Kai_Expr* dest, Kai_Expr* value);
 KAI_INTERNAL Kai_Expr* kai__parser_create_if(Kai_Parser* parser, Kai_Token if_token, Kai_u8 flags, Kai_Expr* expr, Kai_Stmt* then_body, Kai_Stmt* else_body);
 KAI_INTERNAL Kai_Expr* kai__parser_create_while(Kai_Parser* parser, Kai_Token while_token, Kai_Expr* expr, Kai_Stmt* body);
-KAI_INTERNAL Kai_Expr* kai__parser_create_for(Kai_Parser* parser, Kai_Token for_token, Kai_string name, Kai_Expr* from, Kai_Expr* to, Kai_Stmt* body, Kai_u8 flags);
+KAI_INTERNAL Kai_Expr* kai__parser_create_for(Kai_Parser* parser, Kai_Token for_token, Kai_Token name, Kai_Expr* from, Kai_Expr* to, Kai_Stmt* body, Kai_u8 flags);
 KAI_INTERNAL Kai_Expr* kai__parser_create_control(Kai_Parser* parser, Kai_Token token, Kai_u8 kind, Kai_Expr* expr);
 KAI_INTERNAL Kai_Expr* kai__parser_create_compound(Kai_Parser* parser, Kai_Token token, Kai_Stmt* body);
 KAI_INTERNAL Kai_Tag* kai__parser_create_tag(Kai_Parser* parser, Kai_Token token, Kai_Expr* expr);
 KAI_INTERNAL Kai_bool kai__is_procedure_next(Kai_Parser* parser);
+KAI_INTERNAL void kai__find_tree_lines(Kai_Syntax_Tree* tree, Kai_Source* source, Kai_Allocator* allocator);
+KAI_INTERNAL void kai__update_tree_lines(Kai_Syntax_Tree* tree, Kai_Source* source, Kai_Allocator* allocator, Kai_Source_Edit edit);
+KAI_INTERNAL Kai_Result kai__create_syntax_tree(Kai_Syntax_Tree_Create_Info* info, Kai_Syntax_Tree* out_tree, Kai__Atom_Ref_DynArray* atom_refs);
+KAI_INTERNAL void kai__push_expr_list(Kai__Expr_Ref_DynArray* list, Kai_Allocator* allocator, Kai_Expr* head, Kai_u32 limit);
+KAI_INTERNAL void kai__push_expr_children(Kai__Expr_Ref_DynArray* list, Kai_Allocator* allocator, Kai_Expr* expr);
+KAI_INTERNAL void kai__rebase_string(Kai_string* s, Kai_string from, Kai_string to, Kai_u32 delta);
+KAI_INTERNAL void kai__relocate_statement(Kai_Stmt* stmt, Kai__Expr_Ref_DynArray* stack, Kai_Allocator* allocator, Kai_string from, Kai_string to, Kai_u32 delta);
+KAI_INTERNAL Kai_Result kai__reparse_syntax_tree(Kai_Syntax_Tree_Create_Info* info, Kai_Syntax_Tree* tree);
+KAI_INTERNAL Kai_bool kai__source_stream_fill(Kai_Source_Stream* stream);
+KAI_INTERNAL Kai_u32 kai__compact_reserve(Kai_Compact_Tree* tree, Kai_u32 count);
+KAI_INTERNAL Kai_u32 kai__compact_string(Kai_Compact_Tree* tree, Kai_string s);
+KAI_INTERNAL Kai_Compact_Node kai__compact_expr(Kai__Compactor* compactor, Kai_Expr* expr);
+KAI_INTERNAL void kai__compact_fill(Kai__Compactor* compactor, Kai_u32 index, Kai_Expr* expr);
+KAI_INTERNAL void kai__compact_begin(Kai__Compactor* compactor, Kai_Compact_Tree* out_tree, Kai_Source source, Kai_Atom_Table* atoms, Kai_Allocator* allocator);
+KAI_INTERNAL void kai__compact_end(Kai__Compactor* compactor);
+KAI_INTERNAL Kai_u32 kai__compact_expr_size(Kai_u8 id);
+KAI_INTERNAL Kai_string kai__compact_copy_string(Kai_string s, Kai_Arena_Allocator* arena);
+KAI_INTERNAL Kai_Expr* kai__compact_expand_list(Kai_Compact_Tree* tree, Kai_u32 index, Kai_u32 first, Kai_u32 count, Kai_Arena_Allocator* arena);
+KAI_INTERNAL void kai__asm_insert_zero_extend(Kai_Assembler* assembler, Kai_u32 reg, Kai_u8 bits);
 KAI_INTERNAL Kai_u32 kai__arm64_add(Kai_u32 Rd, Kai_u32 Rn, Kai_u32 Rm, Kai_u8 sf);
 KAI_INTERNAL Kai_u32 kai__arm64_sub(Kai_u32 Rd, Kai_u32 Rn, Kai_u32 Rm, Kai_u8 sf);
 KAI_INTERNAL Kai_u32 kai__arm64_subs(Kai_u32 imm12, Kai_u32 Rn, Kai_u8 sf);
@@ -1565,35 +2294,111 @@ KAI_INTERNAL Kai_u32 kai__arm64_ldr_12(Kai_u32 Rn, Kai_u32 Rt, Kai_u16 offset12)
 KAI_INTERNAL Kai_u32 kai__arm64_str(Kai_u32 Rn, Kai_u32 Rt, Kai_s16 offset9);
 KAI_INTERNAL Kai_u32 kai__arm64_ldr(Kai_u32 Rn, Kai_u32 Rt, Kai_s16 offset9);
 KAI_INTERNAL Kai_u32 kai__arm64_ret(void);
+KAI_INTERNAL Kai_u32 kai__arm64_sub_imm(Kai_u32 Rd, Kai_u32 Rn, Kai_u32 imm12, Kai_u8 sf);
+KAI_INTERNAL Kai_u32 kai__arm64_subs_imm(Kai_u32 Rd, Kai_u32 Rn, Kai_u32 imm12, Kai_u8 sf);
+KAI_INTERNAL Kai_u32 kai__arm64_orr_bit(Kai_u32 Rd, Kai_u32 Rn, Kai_u32 bit);
+KAI_INTERNAL Kai_u32 kai__arm64_ubfm(Kai_u32 Rd, Kai_u32 Rn, Kai_u32 immr, Kai_u32 imms, Kai_u8 sf);
+KAI_INTERNAL Kai_u32 kai__arm64_sbfm(Kai_u32 Rd, Kai_u32 Rn, Kai_u32 immr, Kai_u32 imms, Kai_u8 sf);
+KAI_INTERNAL Kai_u32 kai__arm64_clz(Kai_u32 Rd, Kai_u32 Rn, Kai_u8 sf);
+KAI_INTERNAL Kai_u32 kai__arm64_rbit(Kai_u32 Rd, Kai_u32 Rn, Kai_u8 sf);
+KAI_INTERNAL Kai_u32 kai__arm64_rev16(Kai_u32 Rd, Kai_u32 Rn);
+KAI_INTERNAL Kai_u32 kai__arm64_rev(Kai_u32 Rd, Kai_u32 Rn, Kai_u8 sf);
+KAI_INTERNAL Kai_u32 kai__arm64_rorv(Kai_u32 Rd, Kai_u32 Rn, Kai_u32 Rm, Kai_u8 sf);
+KAI_INTERNAL Kai_u32 kai__arm64_umulh(Kai_u32 Rd, Kai_u32 Rn, Kai_u32 Rm);
+KAI_INTERNAL Kai_u32 kai__arm64_cbz(Kai_s32 imm19, Kai_u32 Rt, Kai_u8 sf);
+KAI_INTERNAL Kai_u32 kai__arm64_ldrb_post(Kai_u32 Rn, Kai_u32 Rt, Kai_s16 offset9);
+KAI_INTERNAL Kai_u32 kai__arm64_strb_post(Kai_u32 Rn, Kai_u32 Rt, Kai_s16 offset9);
+KAI_INTERNAL Kai_u32 kai__arm64_adr(Kai_u32 Rd, Kai_s32 imm21);
+KAI_INTERNAL Kai_u32 kai__arm64_ldrb_12(Kai_u32 Rn, Kai_u32 Rt, Kai_u32 offset12);
+KAI_INTERNAL Kai_u32 kai__arm64_madd(Kai_u32 Rd, Kai_u32 Rn, Kai_u32 Rm, Kai_u32 Ra);
+KAI_INTERNAL Kai_u32 kai__arm64_msub(Kai_u32 Rd, Kai_u32 Rn, Kai_u32 Rm, Kai_u32 Ra);
+KAI_INTERNAL Kai_u32 kai__arm64_udiv(Kai_u32 Rd, Kai_u32 Rn, Kai_u32 Rm);
+KAI_INTERNAL Kai_u32 kai__arm64_ldrsw_lsl2(Kai_u32 Rt, Kai_u32 Rn, Kai_u32 Rm);
+KAI_INTERNAL Kai_u32 kai__arm64_br(Kai_u32 Rn);
+KAI_INTERNAL Kai_u32 kai__arm64_fmov_to_d(Kai_u32 Vd, Kai_u32 Rn);
+KAI_INTERNAL Kai_u32 kai__arm64_fmov_to_s(Kai_u32 Vd, Kai_u32 Rn);
+KAI_INTERNAL Kai_u32 kai__arm64_fmov_from_s(Kai_u32 Rd, Kai_u32 Vn);
+KAI_INTERNAL Kai_u32 kai__arm64_cnt_8b(Kai_u32 Vd, Kai_u32 Vn);
+KAI_INTERNAL Kai_u32 kai__arm64_addv_8b(Kai_u32 Vd, Kai_u32 Vn);
+KAI_INTERNAL void kai__parse_sources(void* data, Kai_u32 index);
 KAI_INTERNAL Kai_bool kai__create_syntax_trees(Kai_Compiler_Context* context, Kai_Source_Slice sources);
 KAI_INTERNAL void kai__write_expression_name(Kai_Writer* writer, Kai_Expr* expr);
 KAI_INTERNAL Kai_bool kai__inside_procedure_scope(Kai_Compiler_Context* context);
 KAI_INTERNAL Kai_bool kai__error_fatal(Kai_Compiler_Context* context, Kai_string message);
+KAI_INTERNAL Kai_Location kai__location_with_line(Kai_Location location);
+KAI_INTERNAL Kai_bool kai__error_unsupported(Kai_Compiler_Context* context, Kai_Expr* expr, Kai_string message);
 KAI_INTERNAL Kai_bool kai__error_redefinition(Kai_Compiler_Context* context, Kai_Location location, Kai_u32 original);
 KAI_INTERNAL Kai_bool kai__error_not_declared(Kai_Compiler_Context* context, Kai_Location location);
-KAI_INTERNAL Kai_bool kai__error_circular_dependency(Kai_Compiler_Context* context);
+KAI_INTERNAL void kai__write_circular_dependency(Kai_Compiler_Context* context, Kai_u32* ends);
 KAI_INTERNAL Kai_bool kai__error_type_check(Kai_Compiler_Context* context, Kai_Expr* expr, Kai_Type expected, Kai_Type got);
 KAI_INTERNAL Kai_bool kai__error_no_member(Kai_Compiler_Context* context, Kai_Type type, Kai_Expr* identifier);
 KAI_INTERNAL Kai_bool kai__error_host_import_not_found(Kai_Compiler_Context* context, Kai_Location location);
 KAI_INTERNAL void kai__write_node(Kai_Writer* writer, Kai_Node* node, Kai_Node_Flags flags);
 KAI_INTERNAL Kai_bool kai__create_nodes(Kai_Compiler_Context* context, Kai_Expr* expr);
 KAI_INTERNAL Kai_bool kai__generate_nodes(Kai_Compiler_Context* context);
-KAI_INTERNAL Kai_Node_Reference kai__lookup_node(Kai_Compiler_Context* context, Kai_string name);
+KAI_INTERNAL Kai_bool kai__create_compact_nodes(Kai_Compiler_Context* context, Kai_Compact_Tree* tree);
+KAI_INTERNAL void kai__expand_node(Kai_Compiler_Context* context, Kai_Node* node);
+KAI_INTERNAL void kai__push_scope(Kai_Compiler_Context* context, Kai_bool is_proc_scope);
+KAI_INTERNAL void kai__pop_scope(Kai_Compiler_Context* context);
+KAI_INTERNAL void kai__unbind_to(Kai_Compiler_Context* context, Kai_u32 count);
+KAI_INTERNAL void kai__bind(Kai_Compiler_Context* context, Kai_u32 atom, Kai_Node_Reference ref);
+KAI_INTERNAL Kai__Binding kai__lookup_binding(Kai_Compiler_Context* context, Kai_u32 atom);
+KAI_INTERNAL Kai_Node_Reference kai__lookup_node(Kai_Compiler_Context* context, Kai_u32 atom);
 KAI_INTERNAL void kai__debug_show_type(Kai_Compiler_Context* context, Kai_Type type);
+KAI_INTERNAL void kai__intern_builtin_names(Kai_Compiler_Context* context);
 KAI_INTERNAL Kai_bool kai__generate_builtin_types(Kai_Compiler_Context* context);
 KAI_INTERNAL Kai_bool kai__value_to_number(Kai_Value value, Kai_Type_Info* type, Kai_Number* out_number);
 KAI_INTERNAL Kai_Value kai__evaluate_binary_operation(Kai_u32 op, Kai_Type_Info* type, Kai_Value a, Kai_Value b);
 KAI_INTERNAL void kai__add_dependency(Kai_Compiler_Context* context, Kai_Node_Reference ref);
+KAI_INTERNAL Kai_u8 kai__intrinsic_from_name(Kai_string name);
+KAI_INTERNAL Kai_u8 kai__intrinsic_of_call(Kai_Compiler_Context* context, Kai_Expr* expr);
+KAI_INTERNAL Kai_u64 kai__evaluate_intrinsic(Kai_u8 intrinsic, Kai_u8 bits, Kai_u64 a, Kai_u64 b);
+KAI_INTERNAL Kai_bool kai__value_of_intrinsic(Kai_Compiler_Context* context, Kai_Expr* expr, Kai_u8 intrinsic, Kai_Value* out_value, Kai_Type* expected_type);
+KAI_INTERNAL Kai_u64 kai__normalize_case_value(Kai_u64 value, Kai_Type_Info_Integer* info);
+KAI_INTERNAL Kai_bool kai__case_value_less(Kai_u64 a, Kai_u64 b, Kai_bool is_signed);
+KAI_INTERNAL Kai_u64 kai__sorted_case_value(Kai__Case_Lowering* lowering, Kai_u32 k);
+KAI_INTERNAL void kai__add_case_jump(Kai__Case_Lowering* lowering, Kai_u32 label, Kai_u32 target);
+KAI_INTERNAL void kai__lower_case_tree(Kai_Compiler_Context* context, Kai__Case_Lowering* lowering, Kai_u32 low, Kai_u32 high, Kai_u32 default_target);
+KAI_INTERNAL Kai_u32 kai__case_target_label(Kai__Case_Lowering* lowering, Kai_u32 target, Kai_u32 case_count);
+KAI_INTERNAL Kai_bool kai__lower_case_bodies(Kai_Compiler_Context* context, Kai__Case_Lowering* lowering, Kai_u32 case_count, Kai_Type* expected_type);
+KAI_INTERNAL Kai_u32 kai__string_case_char(Kai_string s, Kai_u32 i);
+KAI_INTERNAL Kai_u32 kai__string_case_hash(Kai__String_Case_Hash h, Kai_string s);
+KAI_INTERNAL Kai_bool kai__find_string_case_hash(Kai_Compiler_Context* context, Kai__Case_Lowering* lowering, Kai_u32 value_count, Kai__String_Case_Hash* out);
+KAI_INTERNAL Kai_bool kai__value_of_string_if_case(Kai_Compiler_Context* context, Kai_Stmt_If* i, Kai_Type* expected_type);
+KAI_INTERNAL Kai_bool kai__value_of_if_case(Kai_Compiler_Context* context, Kai_Stmt_If* i, Kai_Type* expected_type);
+KAI_INTERNAL Kai_Node* kai__polymorphic_node_of_call(Kai_Compiler_Context* context, Kai_Expr_Procedure_Call* c);
+KAI_INTERNAL Kai_bool kai__bind_polymorphic_type(Kai_Compiler_Context* context, Kai_Expr* pattern, Kai_Expr* arg, Kai_Type_Info* type, Kai__Instance* instance);
+KAI_INTERNAL void kai__push_instance_scope(Kai_Compiler_Context* context, Kai__Instance* instance);
+KAI_INTERNAL void kai__pop_instance_scope(Kai_Compiler_Context* context, Kai__Instance* instance, Kai__Instance* previous);
+KAI_INTERNAL Kai_bool kai__instantiate_procedure(Kai_Compiler_Context* context, Kai_Expr_Procedure_Call* c, Kai_Node* node, Kai_Type_Info_Procedure** out_type);
+KAI_INTERNAL Kai_bool kai__compile_instances(Kai_Compiler_Context* context);
+KAI_INTERNAL Kai_Type kai__intern_type(Kai_Compiler_Context* context, Kai_Type_Info* type, Kai_Arena_Checkpoint checkpoint);
+KAI_INTERNAL Kai_bool kai__compile_procedure_job(Kai_Compiler_Context* context, Kai__Procedure_Job* job);
+KAI_INTERNAL void kai__create_worker(Kai_Compiler_Context* main, Kai__Worker* worker);
+KAI_INTERNAL void kai__destroy_worker(Kai__Worker* worker);
+KAI_INTERNAL void kai__run_procedure_jobs(void* data, Kai_u32 index);
+KAI_INTERNAL Kai_bool kai__compile_procedure_jobs(Kai_Compiler_Context* context);
+KAI_INTERNAL void kai__link_procedures(Kai_Compiler_Context* context);
+KAI_INTERNAL Kai_bool kai__compile_procedure_body(Kai_Compiler_Context* context, Kai_Expr_Procedure* p, Kai_Type_Info_Procedure* pt);
 KAI_INTERNAL Kai_bool kai__value_of_expr(Kai_Compiler_Context* context, Kai_Expr* expr, Kai_Value* out_value, Kai_Type* expected_type);
 KAI_INTERNAL void kai__write_node_ref(Kai_Compiler_Context* context, Kai_Node_Reference ref);
 KAI_INTERNAL Kai_bool kai__type_of_expression(Kai_Compiler_Context* context, Kai_Expr* expr, Kai_Type* out_type);
+KAI_INTERNAL Kai_bool kai__is_host_export(Kai_Compiler_Context* context, Kai_u32 atom);
 KAI_INTERNAL Kai_Import* kai__find_host_import(Kai_Compiler_Context* context, Kai_string name);
 KAI_INTERNAL Kai_Expr* kai__type_expression_from_string(Kai_Compiler_Context* context, Kai_string s);
 KAI_INTERNAL Kai_u32 kai__type_size(Kai_Type_Info* type);
 KAI_INTERNAL void kai__copy_value(Kai_u8* out, Kai_Type_Info* type, Kai_Value value);
 KAI_INTERNAL Kai_u32 kai__push_value(Kai_Compiler_Context* context, Kai_Type_Info* type, Kai_Value value);
 KAI_INTERNAL Kai_bool kai__node_reference_equals(Kai_Node_Reference a, Kai_Node_Reference b);
-KAI_INTERNAL Kai_bool kai__explore_nodes(Kai_Compiler_Context* context, Kai_Pending_Node* pending);
+KAI_INTERNAL void kai__wait_for_dependencies(Kai_Compiler_Context* context, Kai_Node_Reference ref);
+KAI_INTERNAL Kai_bool kai__queue_node(Kai_Compiler_Context* context, Kai_Scope* scope, Kai_u32 index);
+KAI_INTERNAL Kai_bool kai__compile_dependencies(Kai_Compiler_Context* context);
+KAI_INTERNAL void kai__resolve_waiters(Kai_Compiler_Context* context, Kai_u32 head);
+KAI_INTERNAL Kai_u32 kai__pending_slot(Kai_Node_Reference ref);
+KAI_INTERNAL Kai_u32 kai__pending_of_dependency(Kai_Compiler_Context* context, Kai_u32* pending_index, Kai_Node_Reference dep);
+KAI_INTERNAL Kai_bool kai__error_unresolved_dependencies(Kai_Compiler_Context* context);
+KAI_INTERNAL Kai_Attempt_Checkpoint kai__save_attempt(Kai_Compiler_Context* context);
+KAI_INTERNAL void kai__restore_attempt(Kai_Compiler_Context* context, Kai_Attempt_Checkpoint checkpoint, Kai_Node* node);
 KAI_INTERNAL Kai_bool kai__compile_all_nodes_in_scope(Kai_Compiler_Context* context);
 KAI_INTERNAL void kai__file_writer_write(void* user, Kai_Write_Command command, Kai_Value value, Kai_Write_Format format);
 KAI_INTERNAL void kai__stdout_writer_write(void* user, Kai_Write_Command command, Kai_Value value, Kai_Write_Format format);
@@ -1613,6 +2418,78 @@ KAI_API(Kai_vector3_u32) kai_version(void)
     return v;
 }
 
+KAI_API(Kai_u32) kai_find_line_starts(Kai_string contents, Kai_u32* out)
+{
+    if (out!=NULL)
+        out[0] = 0;
+    Kai_u32 count = 1;
+    Kai_u32 i = 0;
+    while (i<contents.count)
+    {
+        i = kai_intrinsics_find_any4(contents.data, i, contents.count, 10, 13, 10, 13);
+        if (i==contents.count)
+            break;
+        if (((contents.data)[i]==13&&i+1<contents.count)&&(contents.data)[i+1]==10)
+            i += 1;
+        i += 1;
+        if (out!=NULL)
+            out[count] = i;
+        count += 1;
+    }
+    return count;
+}
+
+KAI_API(void) kai_find_line_starts_into(Kai_string contents, Kai_u32_DynArray* lines, Kai_Allocator* allocator)
+{
+    lines->count = 0;
+    kai_array_push(lines, 0);
+    Kai_u32 i = 0;
+    while (i<contents.count)
+    {
+        i = kai_intrinsics_find_any4(contents.data, i, contents.count, 10, 13, 10, 13);
+        if (i==contents.count)
+            break;
+        if (((contents.data)[i]==13&&i+1<contents.count)&&(contents.data)[i+1]==10)
+            i += 1;
+        i += 1;
+        kai_array_push(lines, i);
+    }
+}
+
+KAI_API(Kai_u32) kai_source_line(Kai_Source* source, Kai_u32 offset)
+{
+    if (offset>(source->contents).count)
+        offset = (source->contents).count;
+    if ((source->line_starts).count==0)
+        return kai_find_line_starts(((Kai_string){.count = offset, .data = (source->contents).data}), NULL);
+    Kai_u32 low = 0;
+    Kai_u32 high = (source->line_starts).count;
+    while (low<high)
+    {
+        Kai_u32 middle = (low+high)/2;
+        if (((source->line_starts).data)[middle]<=offset)
+            low = middle+1;
+        else
+            high = middle;
+    }
+    return low;
+}
+
+KAI_API(Kai_u32) kai_source_column(Kai_Source* source, Kai_u32 offset)
+{
+    if (offset>(source->contents).count)
+        offset = (source->contents).count;
+    Kai_u32 start = offset;
+    if ((source->line_starts).count!=0)
+        start = ((source->line_starts).data)[kai_source_line(source, offset)-1];
+    else
+    {
+        while ((start>0&&((source->contents).data)[start-1]!=10)&&((source->contents).data)[start-1]!=13)
+            start -= 1;
+    }
+    return (offset-start)+1;
+}
+
 KAI_INTERNAL Kai_string kai__range_to_string(Kai_Range range, Kai_Memory memory)
 {
     return ((Kai_string){.count = range.count, .data = (Kai_u8*)(memory.data)+range.start});
@@ -1728,26 +2605,26 @@ KAI_INTERNAL Kai_u64 kai__add_with_shift(Kai_u64 a, Kai_u64 b, Kai_s32* exp, Kai
 
 KAI_INTERNAL void kai__memory_copy(void* dst, void* src, Kai_u32 size)
 {
-    for (Kai_u32 i = 0; i < size; ++i)
-    {
-        ((Kai_u8*)(dst))[i] = ((Kai_u8*)(src))[i];
-    }
+    if (size!=0)
+        kai_intrinsics_memory_copy(dst, src, size);
+}
+
+KAI_INTERNAL void kai__memory_move(void* dst, void* src, Kai_u32 size)
+{
+    if (size!=0)
+        kai_intrinsics_memory_move(dst, src, size);
 }
 
 KAI_INTERNAL void kai__memory_zero(void* dst, Kai_u32 size)
 {
-    for (Kai_u32 i = 0; i < size; ++i)
-    {
-        ((Kai_u8*)(dst))[i] = 0;
-    }
+    if (size!=0)
+        kai_intrinsics_memory_set(dst, 0, size);
 }
 
 KAI_INTERNAL void kai__memory_fill(void* dst, Kai_u8 byte, Kai_u32 size)
 {
-    for (Kai_u32 i = 0; i < size; ++i)
-    {
-        ((Kai_u8*)(dst))[i] = byte;
-    }
+    if (size!=0)
+        kai_intrinsics_memory_set(dst, byte, size);
 }
 
 KAI_API(Kai_bool) kai_string_equals(Kai_string left, Kai_string right)
@@ -1933,6 +2810,16 @@ KAI_API(Kai_bool) kai_raw_table_next_match(Kai_Raw_Hash_Table* table, Kai_u64 ha
     return KAI_FALSE;
 }
 
+KAI_API(Kai_u64) kai_hash_u32(Kai_u32 key)
+{
+    return (Kai_u64)(key)*2654435761;
+}
+
+KAI_API(Kai_bool) kai_u32_equals(Kai_u32 left, Kai_u32 right)
+{
+    return left==right;
+}
+
 KAI_API(Kai_int) kai_raw_table_find_string(Kai__string_HashTable* table, Kai_string key)
 {
     Kai_u64 hash = kai_hash_string(key);
@@ -1979,11 +2866,39 @@ KAI_API(Kai_int) kai_raw_table_find_Type(Kai__Type_HashTable* table, Kai_Type ke
     return -1;
 }
 
-KAI_API(Kai_u64) kai_hash_type(Kai_Type_Info* type)
+KAI_API(Kai_int) kai_raw_table_find_u32(Kai__u32_HashTable* table, Kai_u32 key)
 {
-    if (type==NULL)
-        return -1;
-    switch (type->id)
+    Kai_u64 hash = kai_hash_u32(key);
+    Kai_u32 mask = table->capacity-1;
+    Kai_u32 index = (Kai_u32)(hash)&mask;
+    for (Kai_u32 i = 0; i < table->capacity; ++i)
+    {
+        Kai_u64 block = (table->occupied)[index/64];
+        Kai_u64 bit = ((Kai_u64)(1))<<(index%64);
+        if ((block&bit)==0)
+        {
+            return -1;
+        }
+        else
+        if ((table->hashes)[index]==hash&&(table->keys)[index]==key)
+        {
+            return (Kai_int)(index);
+        }
+        index = (index+1)&mask;
+    }
+    return -1;
+}
+
+KAI_API(Kai_u64) kai_hash_type(Kai_Type_Info* type)
+{
+    if (type==NULL)
+        return -1;
+    return type->hash;
+}
+
+KAI_INTERNAL Kai_u64 kai__compute_type_hash(Kai_Type_Info* type)
+{
+    switch (type->id)
     {
         break; case KAI_TYPE_ID_VOID:
         return 0;
@@ -2031,25 +2946,20 @@ KAI_API(Kai_u64) kai_hash_type(Kai_Type_Info* type)
         break; case KAI_TYPE_ID_ARRAY:
         {
             Kai_Type_Info_Array* info = ((Kai_Type_Info_Array*)type);
-            return kai_hash_type(info->sub_type);
+            Kai_u64 hash = kai_hash_type(info->sub_type);
+            hash = (hash<<4^hash>>60)^info->rows;
+            hash = (hash<<4^hash>>60)^info->cols;
+            return hash^156;
         }
         break; case KAI_TYPE_ID_STRING:
         return 35;
         break; case KAI_TYPE_ID_STRUCT:
+        /* fall through */
+        case KAI_TYPE_ID_ENUM:
         {
-            Kai_Type_Info_Struct* info = ((Kai_Type_Info_Struct*)type);
-            Kai_u64 hash = 3;
-            for (Kai_u32 i = 0; i < (info->fields).count; ++i)
-            {
-                Kai_Struct_Field field = ((info->fields).data)[i];
-                Kai_u64 sub = kai_hash_type(field.type);
-                hash = (hash<<4^hash>>60)^sub;
-            }
-            return hash;
-        }
-        break; case KAI_TYPE_ID_ENUM:
-        {
-            return (Kai_u64)(type);
+            Kai_u64 hash = (Kai_u64)(type);
+            hash = (hash^hash>>33)*9202493588570546565;
+            return hash^hash>>33;
         }
     }
     return (~0);
@@ -2057,8 +2967,10 @@ KAI_API(Kai_u64) kai_hash_type(Kai_Type_Info* type)
 
 KAI_API(Kai_bool) kai_type_equals(Kai_Type_Info* a, Kai_Type_Info* b)
 {
+    if (a==b)
+        return KAI_TRUE;
     if (a==NULL||b==NULL)
-        return a==b;
+        return KAI_FALSE;
     if (a->id!=b->id)
         return KAI_FALSE;
     switch (a->id)
@@ -2075,13 +2987,11 @@ KAI_API(Kai_bool) kai_type_equals(Kai_Type_Info* a, Kai_Type_Info* b)
             Kai_Type_Info_Integer* bt = ((Kai_Type_Info_Integer*)b);
             return at->is_signed==bt->is_signed&&at->bits==bt->bits;
         }
-        break; case KAI_TYPE_ID_ENUM:
-        /* fall through */
-        case KAI_TYPE_ID_POINTER:
+        break; case KAI_TYPE_ID_POINTER:
         {
             Kai_Type_Info_Pointer* at = ((Kai_Type_Info_Pointer*)a);
             Kai_Type_Info_Pointer* bt = ((Kai_Type_Info_Pointer*)b);
-            return kai_type_equals(at->sub_type, bt->sub_type);
+            return at->sub_type==bt->sub_type;
         }
         break; case KAI_TYPE_ID_PROCEDURE:
         {
@@ -2091,12 +3001,12 @@ KAI_API(Kai_bool) kai_type_equals(Kai_Type_Info* a, Kai_Type_Info* b)
                 return KAI_FALSE;
             for (Kai_u32 i = 0; i < (at->inputs).count; ++i)
             {
-                if (!kai_type_equals(((at->inputs).data)[i], ((bt->inputs).data)[i]))
+                if (((at->inputs).data)[i]!=((bt->inputs).data)[i])
                     return KAI_FALSE;
             }
             for (Kai_u32 i = 0; i < (at->outputs).count; ++i)
             {
-                if (!kai_type_equals(((at->outputs).data)[i], ((bt->outputs).data)[i]))
+                if (((at->outputs).data)[i]!=((bt->outputs).data)[i])
                     return KAI_FALSE;
             }
         }
@@ -2104,23 +3014,13 @@ KAI_API(Kai_bool) kai_type_equals(Kai_Type_Info* a, Kai_Type_Info* b)
         {
             Kai_Type_Info_Array* at = ((Kai_Type_Info_Array*)a);
             Kai_Type_Info_Array* bt = ((Kai_Type_Info_Array*)b);
-            if (at->rows!=bt->rows||at->cols!=bt->cols)
-                return KAI_FALSE;
-            return kai_type_equals(at->sub_type, bt->sub_type);
+            return (at->rows==bt->rows&&at->cols==bt->cols)&&at->sub_type==bt->sub_type;
         }
         break; case KAI_TYPE_ID_STRUCT:
+        /* fall through */
+        case KAI_TYPE_ID_ENUM:
         {
-            Kai_Type_Info_Struct* at = ((Kai_Type_Info_Struct*)a);
-            Kai_Type_Info_Struct* bt = ((Kai_Type_Info_Struct*)b);
-            if ((at->fields).count!=(bt->fields).count)
-                return KAI_FALSE;
-            for (Kai_u32 i = 0; i < (at->fields).count; ++i)
-            {
-                Kai_Struct_Field af = ((at->fields).data)[i];
-                Kai_Struct_Field bf = ((bt->fields).data)[i];
-                if (!kai_type_equals(af.type, bf.type))
-                    return KAI_FALSE;
-            }
+            return KAI_FALSE;
         }
     }
     return KAI_TRUE;
@@ -2402,13 +3302,24 @@ KAI_API(void*) kai_fixed_allocate(Kai_Fixed_Allocator* arena, Kai_u32 size)
 
 KAI_API(Kai_Arena_Checkpoint) kai_arena_save(Kai_Arena_Allocator* arena)
 {
-    return ((Kai_Arena_Checkpoint){.bucket = arena->current_bucket, .allocated = arena->current_allocated});
+    return ((Kai_Arena_Checkpoint){.bucket = arena->current_bucket, .allocated = arena->current_allocated, .large = arena->large});
 }
 
 KAI_API(void) kai_arena_restore(Kai_Arena_Allocator* arena, Kai_Arena_Checkpoint checkpoint)
 {
     arena->current_bucket = checkpoint.bucket;
     arena->current_allocated = checkpoint.allocated;
+    kai__arena_free_large(arena, checkpoint.large);
+}
+
+KAI_INTERNAL void kai__arena_free_large(Kai_Arena_Allocator* arena, Kai_Arena_Large* until)
+{
+    while (arena->large!=NULL&&arena->large!=until)
+    {
+        Kai_Arena_Large* large = arena->large;
+        arena->large = large->prev;
+        (arena->base).heap_allocate((arena->base).user, large, 0, sizeof(Kai_Arena_Large)+large->size);
+    }
 }
 
 KAI_API(void) kai_arena_create(Kai_Arena_Allocator* arena, Kai_Allocator* base)
@@ -2419,6 +3330,9 @@ KAI_API(void) kai_arena_create(Kai_Arena_Allocator* arena, Kai_Allocator* base)
     arena->bucket_size = (Kai_u32)(kai__ceil_div(65536, base->page_size))*base->page_size;
     arena->current_allocated = sizeof(Kai_Arena_Bucket);
     arena->current_bucket = (Kai_Arena_Bucket*)(base->heap_allocate(base->user, NULL, arena->bucket_size, 0));
+    (arena->current_bucket)->prev = NULL;
+    (arena->current_bucket)->next = NULL;
+    arena->large = NULL;
 }
 
 KAI_API(void) kai_arena_destroy(Kai_Arena_Allocator* arena)
@@ -2432,12 +3346,17 @@ KAI_API(void) kai_arena_free_all(Kai_Arena_Allocator* arena)
 {
     kai_assert(arena!=NULL);
     Kai_Arena_Bucket* bucket = arena->current_bucket;
+    while (bucket&&bucket->next)
+    {
+        bucket = bucket->next;
+    }
     while (bucket)
     {
         Kai_Arena_Bucket* prev = bucket->prev;
         (arena->base).heap_allocate((arena->base).user, bucket, 0, arena->bucket_size);
         bucket = prev;
     }
+    kai__arena_free_large(arena, NULL);
     arena->current_bucket = NULL;
     arena->current_allocated = 0;
 }
@@ -2446,7 +3365,15 @@ KAI_API(void*) kai_arena_allocate(Kai_Arena_Allocator* arena, Kai_u32 size)
 {
     kai_assert(arena!=NULL);
     if (size>arena->bucket_size-sizeof(Kai_Arena_Bucket))
-        kai_fatal_error("Arena Allocator", "Object size greater than bucket size (incorrect usage)");
+    {
+        Kai_Arena_Large* large = ((Kai_Arena_Large*)(arena->base).heap_allocate((arena->base).user, NULL, sizeof(Kai_Arena_Large)+size, 0));
+        if (large==NULL)
+            return NULL;
+        large->prev = arena->large;
+        large->size = size;
+        arena->large = large;
+        return (Kai_u8*)(large)+sizeof(Kai_Arena_Large);
+    }
     if (arena->current_allocated+size>arena->bucket_size)
     {
         if ((arena->current_bucket)->next!=NULL)
@@ -2460,6 +3387,8 @@ KAI_API(void*) kai_arena_allocate(Kai_Arena_Allocator* arena, Kai_u32 size)
             if (new_bucket==NULL)
                 return NULL;
             new_bucket->prev = arena->current_bucket;
+            new_bucket->next = NULL;
+            (arena->current_bucket)->next = new_bucket;
             arena->current_bucket = new_bucket;
             arena->current_allocated = sizeof(Kai_Arena_Bucket);
         }
@@ -2613,21 +3542,9 @@ KAI_INTERNAL Kai_u32 kai__base10_digit_count(Kai_u32 x)
     return 0;
 }
 
-KAI_INTERNAL Kai_u8* kai__advance_to_line(Kai_u8* source, Kai_u32 line)
-{
-    line -= 1;
-    while (line>0)
-    {
-        if (*source==10)
-            line -= 1;
-        source += 1;
-    }
-    return source;
-}
-
-KAI_INTERNAL void kai__write_source_code(Kai_Writer* writer, Kai_u8* src)
+KAI_INTERNAL void kai__write_source_code(Kai_Writer* writer, Kai_u8* src, Kai_u8* end)
 {
-    while (*src!=0&&*src!=10)
+    while ((src<end&&*src!=10)&&*src!=13)
     {
         if (*src==9)
             kai__write(" ");
@@ -2696,7 +3613,7 @@ KAI_INTERNAL Kai_u32 kai__unicode_char_width(Kai_Writer* writer, Kai_u32 cp, Kai
 
 KAI_INTERNAL void kai__write_source_code_fill(Kai_Writer* writer, Kai_u8* src, Kai_u8* end, Kai_u8 first, Kai_u8 ch)
 {
-    while ((src<end&&*src!=0)&&*src!=10)
+    while (src<end&&*src!=10)
     {
         Kai_string slice = {0};
         slice.data = src;
@@ -2762,19 +3679,30 @@ KAI_API(void) kai_write_error(Kai_Writer* writer, Kai_Error* error)
         Kai_u32 digits = kai__base10_digit_count((error->location).line);
         kai__write_fill(32, digits);
         kai__write("  |\n");
-        kai__write(" ");
-        kai__write_u32((error->location).line);
-        kai__write(" | ");
-        Kai_u8* begin = kai__advance_to_line((((error->location).source).contents).data, (error->location).line);
+        (writer->write(writer->user, KAI_WRITE_STRING, (Kai_Value){.string = KAI_STRING(" ")}, (Kai_Write_Format){0}), writer->write(writer->user, KAI_WRITE_U32, (Kai_Value){.u32 = (error->location).line}, (Kai_Write_Format){0}), writer->write(writer->user, KAI_WRITE_STRING, (Kai_Value){.string = KAI_STRING(" | ")}, (Kai_Write_Format){0}));
+        Kai_Source* source = &((error->location).source);
+        Kai_u8* begin = (source->contents).data;
+        Kai_u8* end = (source->contents).data+(source->contents).count;
+        Kai_u8* mark = ((error->location).string).data+((error->location).string).count;
+        if (((error->location).string).data<end&&mark>end)
+            mark = end;
+        if ((error->location).line!=0&&(error->location).line<=(source->line_starts).count)
+            begin += ((source->line_starts).data)[(error->location).line-1];
+        else
+        if (((error->location).string).data!=NULL)
+        {
+            Kai_u32 offset = (Kai_u32)(((error->location).string).data-begin);
+            begin += (offset+1)-kai_source_column(source, offset);
+        }
         kai__set_color(KAI_WRITE_COLOR_DEFAULT);
-        kai__write_source_code(writer, begin);
+        kai__write_source_code(writer, begin, end);
         kai__write("\n");
         kai__set_color(KAI_WRITE_COLOR_DECORATION);
         kai__write_fill(32, digits);
         kai__write("  | ");
         kai__write_source_code_fill(writer, begin, ((error->location).string).data, 32, 32);
         kai__set_color(KAI_WRITE_COLOR_IMPORTANT);
-        kai__write_source_code_fill(writer, ((error->location).string).data, ((error->location).string).data+((error->location).string).count, 94, 126);
+        kai__write_source_code_fill(writer, ((error->location).string).data, mark, 94, 126);
         kai__write(" ");
         kai__write_string(error->context);
         kai__write("\n");
@@ -2794,8 +3722,7 @@ KAI_API(void) kai_write_type(Kai_Writer* writer, Kai_Type_Info* type)
     {
         break; default:
         {
-            kai__write("id = ");
-            kai__write_u32(type->id);
+            (writer->write(writer->user, KAI_WRITE_STRING, (Kai_Value){.string = KAI_STRING("id = ")}, (Kai_Write_Format){0}), writer->write(writer->user, KAI_WRITE_U32, (Kai_Value){.u32 = type->id}, (Kai_Write_Format){0}));
         }
         break; case KAI_TYPE_ID_VOID:
         kai__write("void");
@@ -2848,9 +3775,7 @@ KAI_API(void) kai_write_type(Kai_Writer* writer, Kai_Type_Info* type)
         break; case KAI_TYPE_ID_ARRAY:
         {
             Kai_Type_Info_Array* info = ((Kai_Type_Info_Array*)type);
-            kai__write("[");
-            kai__write_u32(info->rows);
-            kai__write("] ");
+            (writer->write(writer->user, KAI_WRITE_STRING, (Kai_Value){.string = KAI_STRING("[")}, (Kai_Write_Format){0}), writer->write(writer->user, KAI_WRITE_U32, (Kai_Value){.u32 = info->rows}, (Kai_Write_Format){0}), writer->write(writer->user, KAI_WRITE_STRING, (Kai_Value){.string = KAI_STRING("] ")}, (Kai_Write_Format){0}));
             kai_write_type(writer, info->sub_type);
         }
         break; case KAI_TYPE_ID_STRING:
@@ -2858,10 +3783,7 @@ KAI_API(void) kai_write_type(Kai_Writer* writer, Kai_Type_Info* type)
         break; case KAI_TYPE_ID_STRUCT:
         {
             Kai_Type_Info_Struct* info = ((Kai_Type_Info_Struct*)type);
-            kai__write("struct");
-            kai__write("(size=");
-            kai__write_u32(info->size);
-            kai__write(")");
+            (writer->write(writer->user, KAI_WRITE_STRING, (Kai_Value){.string = KAI_STRING("struct(size=")}, (Kai_Write_Format){0}), writer->write(writer->user, KAI_WRITE_U32, (Kai_Value){.u32 = info->size}, (Kai_Write_Format){0}), writer->write(writer->user, KAI_WRITE_STRING, (Kai_Value){.string = KAI_STRING(")")}, (Kai_Write_Format){0}));
         }
         break; case KAI_TYPE_ID_ENUM:
         {
@@ -3513,2637 +4435,6260 @@ KAI_API(void) kai_write_expression(Kai_Writer* writer, Kai_Expr* expr, Kai_u32 d
     kai__write_tree(&context, expr);
 }
 
-KAI_API(void) kai_write_syntax_tree(Kai_Writer* writer, Kai_Syntax_Tree* tree)
-{
-    (void)(writer);
-    (void)(tree);
-}
-
-KAI_API(void) kai_write_number(Kai_Writer* writer, Kai_Number number)
+KAI_INTERNAL void kai__explore_compact(Kai__Tree_Traversal_Context* context, Kai_Compact_Tree* tree, Kai_u32 index, Kai_bool is_last)
 {
-    if (!kai_number_is_integer(number))
-    {
-        kai__write_f64(kai_number_to_f64(number));
-        return;
-    }
-    if (number.is_neg)
-    {
-        kai__write("-");
-    }
-    if ((Kai_u32)(number.e)<=kai_intrinsics_clz64(number.n))
-    {
-        kai__write_u64(kai_number_to_u64(number));
-        return;
-    }
-    kai__write_u64(number.n);
-    kai__write(" * 2^");
-    kai__write_s32(number.e);
+    kai__tree_traversal_push(context, is_last);
+    kai__write_compact_tree(context, tree, index);
+    kai__tree_traversal_pop(context);
 }
 
-KAI_API(void) kai_destroy_error(Kai_Error* error, Kai_Allocator* allocator)
+KAI_INTERNAL void kai__write_compact_id_with_name(Kai_Writer* writer, Kai_string id, Kai_string name)
 {
-    while (error)
+    kai__set_color(KAI_WRITE_COLOR_PRIMARY);
+    kai__write_string(id);
+    kai__set_color(KAI_WRITE_COLOR_DEFAULT);
+    if (name.count!=0)
     {
-        Kai_Error* next = error->next;
-        if ((error->memory).size>0)
-            kai__free((error->memory).data, (error->memory).size);
-        error = next;
+        kai__write(" (name = \"");
+        kai__set_color(KAI_WRITE_COLOR_IMPORTANT);
+        kai__write_string(name);
+        kai__set_color(KAI_WRITE_COLOR_DEFAULT);
+        kai__write("\")");
     }
 }
 
-static Kai_string kai__keywords[18] = {
-    KAI_CONST_STRING("if"), KAI_CONST_STRING("struct"), KAI_CONST_STRING("using"), KAI_CONST_STRING("defer"), 
-    KAI_CONST_STRING("null"), KAI_CONST_STRING("false"), KAI_CONST_STRING("then"), KAI_CONST_STRING("enum"), 
-    KAI_CONST_STRING("continue"), KAI_CONST_STRING("else"), KAI_CONST_STRING("while"), 
-    KAI_CONST_STRING("union"), KAI_CONST_STRING("for"), KAI_CONST_STRING("break"), KAI_CONST_STRING("cast"), 
-    KAI_CONST_STRING("case"), KAI_CONST_STRING("ret"), KAI_CONST_STRING("true")
-};
-
-KAI_INTERNAL Kai_u32 kai__string_to_keyword_index(Kai_string kw)
-{
-    Kai_u32 hash = 0;
-    if (0<kw.count)
-        hash |= (((kw.data)[0])>>2&1)<<2;
-    if (1<kw.count)
-        hash |= (((kw.data)[1])>>3&1)<<3;
-    if (2<kw.count)
-        hash |= (((kw.data)[2])>>3&1)<<1;
-    if (2<kw.count)
-        hash |= (((kw.data)[2])>>2&1)<<4;
-    if (2<kw.count)
-        hash |= ((kw.data)[2]&1)<<5;
-    if (3<kw.count)
-        hash |= (kw.data)[3]&1;
-    return hash%18;
-}
-
-KAI_API(void) kai_write_token(Kai_Writer* writer, Kai_Token token)
+KAI_INTERNAL void kai__write_compact_tree(Kai__Tree_Traversal_Context* context, Kai_Compact_Tree* tree, Kai_u32 index)
 {
-    Kai_bool symbol = KAI_FALSE;
-    switch (token.id)
+    Kai_Writer* writer = context->writer;
+    kai__write_tree_branches(context);
+    if (index==0)
     {
-        break; case KAI_TOKEN_IDENTIFIER:
-        kai__write("Ident");
-        break; case KAI_TOKEN_STRING:
-        kai__write("String");
-        break; case KAI_TOKEN_NUMBER:
-        kai__write("Number");
-        break; case KAI_TOKEN_DIRECTIVE:
-        kai__write("Dir");
-        break; case KAI_TOKEN_TAG:
-        kai__write("Tag");
-        break; default:
-        symbol = KAI_TRUE;
+        kai__set_color(KAI_WRITE_COLOR_SPECIAL);
+        kai__write("null\n");
+        kai__set_color(KAI_WRITE_COLOR_DEFAULT);
+        return;
     }
-    if (!symbol)
-        kai__write("(");
-    if (token.id>256)
+    Kai_Compact_Node* node = kai_compact_node(tree, index);
+    Kai_string name = kai_compact_name(tree, index);
+    Kai_bool has_tag = node->tag_count!=0;
+    Kai_u32 count = node->child_count-node->tag_count;
+    switch (node->id)
     {
-        Kai_u32 id = token.id;
-        Kai_u8 ch = {0};
-        Kai_string str = ((Kai_string){.count = 1, .data = &ch});
-        while (id!=0)
+        break; case KAI_EXPR_IDENTIFIER:
         {
-            ch = id&255;
-            kai__write_string(str);
-            id = id>>8;
+            kai__write_compact_id_with_name(writer, KAI_STRING("identifier"), name);
+            kai__write(" \"");
+            kai__set_color(KAI_WRITE_COLOR_IMPORTANT);
+            kai__write_string(kai_compact_source(tree, index));
+            kai__set_color(KAI_WRITE_COLOR_DEFAULT);
+            kai__write("\"\n");
         }
-    }
-    else
-        kai__write_string(token.string);
-    if (!symbol)
-        kai__write(")");
-}
-
-KAI_API(Kai_string) kai_token_string(Kai_Token_Id id, Kai_string dst)
-{
-    kai_assert(dst.count>=12);
-    switch (id)
-    {
-        break; case KAI_TOKEN_END:
-        return kai_string_copy_from_c(dst, "end of file");
-        break; case KAI_TOKEN_IDENTIFIER:
-        return kai_string_copy_from_c(dst, "identifier");
-        break; case KAI_TOKEN_NUMBER:
-        return kai_string_copy_from_c(dst, "number");
-        break; case KAI_TOKEN_DIRECTIVE:
-        return kai_string_copy_from_c(dst, "directive");
-        break; case KAI_TOKEN_TAG:
-        return kai_string_copy_from_c(dst, "tag");
-        break; case KAI_TOKEN_STRING:
-        return kai_string_copy_from_c(dst, "string");
-        break; case KAI_TOKEN_break:
-        return kai_string_copy_from_c(dst, "'break'");
-        break; case KAI_TOKEN_case:
-        return kai_string_copy_from_c(dst, "'case'");
-        break; case KAI_TOKEN_cast:
-        return kai_string_copy_from_c(dst, "'cast'");
-        break; case KAI_TOKEN_continue:
-        return kai_string_copy_from_c(dst, "'continue'");
-        break; case KAI_TOKEN_defer:
-        return kai_string_copy_from_c(dst, "'defer'");
-        break; case KAI_TOKEN_else:
-        return kai_string_copy_from_c(dst, "'else'");
-        break; case KAI_TOKEN_enum:
-        return kai_string_copy_from_c(dst, "'enum'");
-        break; case KAI_TOKEN_for:
-        return kai_string_copy_from_c(dst, "'for'");
-        break; case KAI_TOKEN_if:
-        return kai_string_copy_from_c(dst, "'if'");
-        break; case KAI_TOKEN_ret:
-        return kai_string_copy_from_c(dst, "'ret'");
-        break; case KAI_TOKEN_struct:
-        return kai_string_copy_from_c(dst, "'struct'");
-        break; case KAI_TOKEN_union:
-        return kai_string_copy_from_c(dst, "'union'");
-        break; case KAI_TOKEN_using:
-        return kai_string_copy_from_c(dst, "'using'");
-        break; case KAI_TOKEN_while:
-        return kai_string_copy_from_c(dst, "'while'");
-        break; case KAI_TOKEN_null:
-        return kai_string_copy_from_c(dst, "'null'");
-        break; case KAI_TOKEN_false:
-        return kai_string_copy_from_c(dst, "'false'");
-        break; case KAI_TOKEN_then:
-        return kai_string_copy_from_c(dst, "'then'");
-        break; case KAI_TOKEN_true:
-        return kai_string_copy_from_c(dst, "'true'");
-        break; default:
-        (dst.data)[0] = 39;
-        Kai_u32 i = 0;
-        while (i<=3)
+        break; case KAI_EXPR_STRING:
         {
-            Kai_u8 ch = (Kai_u8)(id>>(i*8));
-            if (ch==0)
-                break;
-            (dst.data)[i+1] = ch;
-            i += 1;
+            kai__write_compact_id_with_name(writer, KAI_STRING("string"), name);
+            kai__write(" ");
+            kai__set_color(KAI_WRITE_COLOR_IMPORTANT);
+            kai__write_string(kai_compact_source(tree, index));
+            kai__set_color(KAI_WRITE_COLOR_DEFAULT);
+            kai__write("\n");
         }
-        (dst.data)[i+1] = 39;
-        return ((Kai_string){.count = i+2, .data = dst.data});
-    }
-}
-
-KAI_INTERNAL Kai_Number kai__parse_fractional_part(Kai_string source, Kai_u32* offset, Kai_Number start)
-{
-    if ((*offset<source.count&&(source.data)[*offset]==46)&&!((((*offset)+1)<(source.count))&&(((source.data)[*offset+1])==46)))
-    {
-        *offset += 1;
-        Kai_Number decimal = kai_number_parse_decimal(source, offset);
-        start = kai_number_add(start, decimal);
-    }
-    if (*offset<source.count&&((source.data)[*offset]==101||(source.data)[*offset]==69))
-    {
-        Kai_bool is_neg = KAI_FALSE;
-        *offset += 1;
-        if (*offset<source.count)
+        break; case KAI_EXPR_NUMBER:
         {
-            if ((source.data)[*offset]==45)
-            {
-                *offset += 1;
-                is_neg = KAI_TRUE;
-            }
-            if ((source.data)[*offset]==43)
-            {
-                *offset += 1;
-            }
+            kai__write_compact_id_with_name(writer, KAI_STRING("number"), name);
+            kai__write(" ");
+            kai__set_color(KAI_WRITE_COLOR_IMPORTANT);
+            kai_write_number(writer, kai_compact_number(tree, index));
+            kai__set_color(KAI_WRITE_COLOR_DEFAULT);
+            kai__write("\n");
         }
-        Kai_Number exponent = kai_number_parse_exponent(source, offset);
-        if (is_neg)
-            exponent = kai_number_inv(exponent);
-        start = kai_number_mul(start, exponent);
-    }
-    return start;
-}
-
-KAI_INTERNAL Kai_bool kai__make_multi_token(Kai_Tokenizer* context, Kai_Token* t, Kai_u8 current)
-{
-    if (context->cursor>=(context->source).count)
-        return KAI_FALSE;
-    switch (current)
-    {
-        break; case 38:
+        break; case KAI_EXPR_LITERAL:
         {
-            if (((context->source).data)[context->cursor]==38)
-            {
-                t->id = 9766;
-                return KAI_TRUE;
-            }
-            if (((context->source).data)[context->cursor]==61)
-            {
-                t->id = 15654;
-                return KAI_TRUE;
-            }
+            kai__write_compact_id_with_name(writer, KAI_STRING("literal"), name);
+            kai__write("\n");
+            for (Kai_u32 i = 0; i < count; ++i)
+                kai__explore_compact(context, tree, kai_compact_child(tree, index, i), (i+1)==count);
         }
-        break; case 124:
+        break; case KAI_EXPR_UNARY:
         {
-            if (((context->source).data)[context->cursor]==124)
-            {
-                t->id = 31868;
-                return KAI_TRUE;
-            }
-            if (((context->source).data)[context->cursor]==61)
-            {
-                t->id = 15740;
-                return KAI_TRUE;
-            }
+            kai__write_compact_id_with_name(writer, KAI_STRING("unary"), name);
+            kai__write(" (op = ");
+            kai__set_color(KAI_WRITE_COLOR_IMPORTANT);
+            kai__write_unary_operator_name(writer, node->value);
+            kai__set_color(KAI_WRITE_COLOR_DEFAULT);
+            kai__write(")\n");
+            kai__explore_compact(context, tree, kai_compact_child(tree, index, 0), KAI_TRUE);
         }
-        break; case 61:
+        break; case KAI_EXPR_BINARY:
         {
-            if (((context->source).data)[context->cursor]==61)
-            {
-                t->id = 15677;
-                return KAI_TRUE;
-            }
-            if (((context->source).data)[context->cursor]==62)
-            {
-                t->id = 15933;
-                return KAI_TRUE;
-            }
+            kai__write_compact_id_with_name(writer, KAI_STRING("binary"), name);
+            kai__write(" (op = ");
+            kai__set_color(KAI_WRITE_COLOR_IMPORTANT);
+            kai__write_binary_operator_name(writer, node->value);
+            kai__set_color(KAI_WRITE_COLOR_DEFAULT);
+            kai__write(")\n");
+            Kai_u32 right = kai_compact_child(tree, index, 1);
+            kai__explore_compact(context, tree, kai_compact_child(tree, index, 0), right==0);
+            if (right!=0)
+                kai__explore_compact(context, tree, right, KAI_TRUE);
         }
-        break; case 62:
+        break; case KAI_EXPR_ARRAY:
         {
-            if (((context->source).data)[context->cursor]==61)
-            {
-                t->id = 15678;
-                return KAI_TRUE;
-            }
-            if (((context->source).data)[context->cursor]==62)
+            kai__write_compact_id_with_name(writer, KAI_STRING("array"), name);
+            if (node->flags&KAI_FLAG_ARRAY_DYNAMIC)
+                kai__write(" DYNAMIC");
+            kai__write("\n");
+            Kai_u32 rows = kai_compact_child(tree, index, 0);
+            Kai_u32 cols = kai_compact_child(tree, index, 1);
+            if (rows!=0)
             {
-                t->id = 15934;
-                return KAI_TRUE;
+                context->prefix = KAI_STRING("rows");
+                kai__explore_compact(context, tree, rows, KAI_FALSE);
+                if (cols!=0)
+                {
+                    context->prefix = KAI_STRING("cols");
+                    kai__explore_compact(context, tree, cols, KAI_FALSE);
+                }
             }
+            kai__explore_compact(context, tree, kai_compact_child(tree, index, 2), KAI_TRUE);
         }
-        break; case 60:
+        break; case KAI_EXPR_SPECIAL:
         {
-            if (((context->source).data)[context->cursor]==61)
+            kai__write_compact_id_with_name(writer, KAI_STRING("special"), name);
+            kai__write(" \"");
+            kai__set_color(KAI_WRITE_COLOR_IMPORTANT);
+            switch (node->value)
             {
-                t->id = 15676;
-                return KAI_TRUE;
+                break; case KAI_SPECIAL_EVAL_TYPE:
+                kai__write("type");
+                break; case KAI_SPECIAL_EVAL_SIZE:
+                kai__write("size");
+                break; case KAI_SPECIAL_TYPE:
+                kai__write("Type");
+                break; case KAI_SPECIAL_NUMBER:
+                kai__write("Number");
+                break; case KAI_SPECIAL_CODE:
+                kai__write("Code");
+                break; case KAI_SPECIAL_TRUE:
+                kai__write("true");
+                break; case KAI_SPECIAL_FALSE:
+                kai__write("false");
+                break; case KAI_SPECIAL_NULL:
+                kai__write("null");
             }
-            if (((context->source).data)[context->cursor]==60)
+            kai__set_color(KAI_WRITE_COLOR_DEFAULT);
+            kai__write("\"\n");
+        }
+        break; case KAI_EXPR_PROCEDURE_TYPE:
+        {
+            kai__write_compact_id_with_name(writer, KAI_STRING("procedure type"), name);
+            kai__write("\n");
+            for (Kai_u32 i = 0; i < count; ++i)
             {
-                t->id = 15420;
-                return KAI_TRUE;
+                if (i<node->value)
+                    context->prefix = KAI_STRING("in ");
+                else
+                    context->prefix = KAI_STRING("out");
+                kai__explore_compact(context, tree, kai_compact_child(tree, index, i), (i+1)==count);
             }
         }
-        break; case 33:
+        break; case KAI_EXPR_PROCEDURE_CALL:
         {
-            if (((context->source).data)[context->cursor]==61)
+            kai__write_compact_id_with_name(writer, KAI_STRING("procedure call"), name);
+            kai__write("\n");
+            context->prefix = KAI_STRING("proc");
+            kai__explore_compact(context, tree, kai_compact_child(tree, index, 0), count==1);
+            for (Kai_u32 i = 1; i < count; ++i)
+                kai__explore_compact(context, tree, kai_compact_child(tree, index, i), !has_tag&&(i+1)==count);
+        }
+        break; case KAI_EXPR_PROCEDURE:
+        {
+            kai__write_compact_id_with_name(writer, KAI_STRING("procedure"), name);
+            kai__write("\n");
+            for (Kai_u32 i = 0; i < count-1; ++i)
             {
-                t->id = 15649;
-                return KAI_TRUE;
+                if (i<node->value)
+                    context->prefix = KAI_STRING("in ");
+                else
+                    context->prefix = KAI_STRING("out");
+                kai__explore_compact(context, tree, kai_compact_child(tree, index, i), KAI_FALSE);
             }
+            kai__explore_compact(context, tree, kai_compact_child(tree, index, count-1), KAI_TRUE);
         }
-        break; case 43:
+        break; case KAI_EXPR_IMPORT:
         {
-            if (((context->source).data)[context->cursor]==61)
+            kai__write_compact_id_with_name(writer, KAI_STRING("import"), name);
+            kai__write("\n");
+        }
+        break; case KAI_EXPR_STRUCT:
+        {
+            kai__write_compact_id_with_name(writer, KAI_STRING("struct"), name);
+            kai__write("\n");
+            for (Kai_u32 i = 0; i < count; ++i)
+                kai__explore_compact(context, tree, kai_compact_child(tree, index, i), (i+1)==count);
+        }
+        break; case KAI_EXPR_ENUM:
+        {
+            kai__write_compact_id_with_name(writer, KAI_STRING("enum"), name);
+            kai__write("\n");
+            for (Kai_u32 i = 1; i < count; ++i)
             {
-                t->id = 15659;
-                return KAI_TRUE;
+                Kai_u32 field = kai_compact_child(tree, index, i);
+                Kai_Compact_Node* field_node = kai_compact_node(tree, field);
+                if (field_node->flags&KAI_FLAG_ENUM_NO_VALUE)
+                    context->prefix = KAI_STRING("*");
+                kai__explore_compact(context, tree, field, (i+1)==count);
             }
         }
-        break; case 45:
+        break; case KAI_STMT_RETURN:
         {
-            if (((context->source).data)[context->cursor]==61)
+            kai__write_compact_id_with_name(writer, KAI_STRING("return"), name);
+            kai__write("\n");
+            Kai_u32 expr = kai_compact_child(tree, index, 0);
+            if (expr!=0)
+                kai__explore_compact(context, tree, expr, KAI_TRUE);
+        }
+        break; case KAI_STMT_DECLARATION:
+        {
+            kai__write_compact_id_with_name(writer, KAI_STRING("declaration"), name);
+            if (node->flags&KAI_FLAG_DECL_CONST)
+                kai__write(" const");
+            if (node->flags&KAI_FLAG_DECL_EXPORT)
             {
-                t->id = 15661;
-                return KAI_TRUE;
+                kai__set_color(KAI_WRITE_COLOR_PRIMARY);
+                kai__write(" export");
+                kai__set_color(KAI_WRITE_COLOR_DEFAULT);
             }
-            if (((context->source).data)[context->cursor]==62)
+            if (node->flags&KAI_FLAG_DECL_HOST_IMPORT)
             {
-                t->id = 15917;
-                return KAI_TRUE;
+                kai__set_color(KAI_WRITE_COLOR_PRIMARY);
+                kai__write(" host_import");
+                kai__set_color(KAI_WRITE_COLOR_DEFAULT);
             }
-            if ((context->cursor+1<(context->source).count&&((context->source).data)[context->cursor]==45)&&((context->source).data)[context->cursor+1]==45)
+            kai__write("\n");
+            Kai_u32 type = kai_compact_child(tree, index, 0);
+            Kai_u32 value = kai_compact_child(tree, index, 1);
+            if (type!=0)
             {
-                t->id = 2960685;
-                context->cursor += 1;
-                (t->string).count += 1;
-                return KAI_TRUE;
+                context->prefix = KAI_STRING("type");
+                kai__explore_compact(context, tree, type, value==0);
             }
+            if (value!=0)
+                kai__explore_compact(context, tree, value, !has_tag);
         }
-        break; case 42:
+        break; case KAI_STMT_ASSIGNMENT:
         {
-            if (((context->source).data)[context->cursor]==61)
+            kai__write_compact_id_with_name(writer, KAI_STRING("assignment"), name);
+            if (node->value!=61)
             {
-                t->id = 15658;
-                return KAI_TRUE;
+                kai__write(" (op = ");
+                kai__set_color(KAI_WRITE_COLOR_IMPORTANT);
+                kai__write_assignment_operator_name(writer, node->value);
+                kai__set_color(KAI_WRITE_COLOR_DEFAULT);
+                kai__write(")");
             }
+            kai__write("\n");
+            context->prefix = KAI_STRING("left ");
+            kai__explore_compact(context, tree, kai_compact_child(tree, index, 0), KAI_FALSE);
+            context->prefix = KAI_STRING("right");
+            kai__explore_compact(context, tree, kai_compact_child(tree, index, 1), KAI_TRUE);
         }
-        break; case 47:
+        break; case KAI_STMT_COMPOUND:
         {
-            if (((context->source).data)[context->cursor]==61)
+            kai__write_compact_id_with_name(writer, KAI_STRING("compound statement"), name);
+            kai__write("\n");
+            for (Kai_u32 i = 0; i < count; ++i)
+                kai__explore_compact(context, tree, kai_compact_child(tree, index, i), (i+1)==count);
+        }
+        break; case KAI_STMT_IF:
+        {
+            Kai_string id = KAI_STRING("if");
+            if (node->flags&KAI_FLAG_IF_CASE)
+                id = KAI_STRING("if-case");
+            kai__write_compact_id_with_name(writer, id, name);
+            kai__write("\n");
+            Kai_u32 else_body = kai_compact_child(tree, index, 2);
+            context->prefix = KAI_STRING("cond");
+            kai__explore_compact(context, tree, kai_compact_child(tree, index, 0), KAI_FALSE);
+            context->prefix = KAI_STRING("then");
+            kai__explore_compact(context, tree, kai_compact_child(tree, index, 1), else_body==0);
+            if (else_body!=0)
             {
-                t->id = 15663;
-                return KAI_TRUE;
+                context->prefix = KAI_STRING("else");
+                kai__explore_compact(context, tree, else_body, KAI_TRUE);
             }
         }
+        break; case KAI_STMT_FOR:
+        {
+            kai__write_compact_id_with_name(writer, KAI_STRING("for"), name);
+            kai__write(" (iterator name = ");
+            kai__set_color(KAI_WRITE_COLOR_IMPORTANT);
+            kai__write_string((((tree->atoms)->names).data)[node->atom]);
+            kai__set_color(KAI_WRITE_COLOR_DEFAULT);
+            kai__write(")\n");
+            context->prefix = KAI_STRING("from");
+            kai__explore_compact(context, tree, kai_compact_child(tree, index, 0), KAI_FALSE);
+            context->prefix = KAI_STRING("to");
+            kai__explore_compact(context, tree, kai_compact_child(tree, index, 1), KAI_FALSE);
+            kai__explore_compact(context, tree, kai_compact_child(tree, index, 2), KAI_TRUE);
+        }
+        break; case KAI_STMT_WHILE:
+        {
+            kai__write_compact_id_with_name(writer, KAI_STRING("while"), name);
+            kai__write("\n");
+            kai__explore_compact(context, tree, kai_compact_child(tree, index, 0), KAI_FALSE);
+            kai__explore_compact(context, tree, kai_compact_child(tree, index, 1), KAI_TRUE);
+        }
+        break; case KAI_STMT_CONTROL:
+        {
+            kai__write_compact_id_with_name(writer, KAI_STRING("control"), name);
+            kai__write(" TODO\n");
+        }
+        break; default:
+        {
+            kai__set_color(KAI_WRITE_COLOR_PRIMARY);
+            kai__write("unknown");
+            kai__set_color(KAI_WRITE_COLOR_DEFAULT);
+            kai__write(" (id = ");
+            kai__write_u32(node->id);
+            kai__write(")\n");
+        }
     }
-    return KAI_FALSE;
-}
-
-static Kai_u8 kai__token_lookup_table[128] = {
-    KAI__W, KAI__W, KAI__W, KAI__W, KAI__W, KAI__W, KAI__W, KAI__W, KAI__W, KAI__W, KAI__W, 
-    KAI__W, KAI__W, KAI__W, KAI__W, KAI__W, KAI__W, KAI__W, KAI__W, KAI__W, KAI__W, KAI__W, 
-    KAI__W, KAI__W, KAI__W, KAI__W, KAI__W, KAI__W, KAI__W, KAI__W, KAI__W, KAI__W, KAI__W, 
-    KAI__T, KAI__S, KAI__D, KAI__T, KAI__T, KAI__T, KAI__T, KAI__T, KAI__T, KAI__T, KAI__T, 
-    KAI__T, KAI__T, KAI__Z, KAI__C, KAI__N, KAI__N, KAI__N, KAI__N, KAI__N, KAI__N, KAI__N, 
-    KAI__N, KAI__N, KAI__N, KAI__T, KAI__T, KAI__T, KAI__T, KAI__T, KAI__T, KAI__G, 0, 
-    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, KAI__T, 
-    KAI__T, KAI__T, KAI__T, 0, KAI__T, 0, KAI__K, KAI__K, KAI__K, KAI__K, KAI__K, 0, 
-    0, KAI__K, 0, 0, KAI__K, 0, 0, 0, 0, 0, KAI__K, KAI__K, KAI__K, KAI__K, 0, KAI__K, 
-    0, 0, 0, KAI__T, KAI__T, KAI__T, KAI__T, KAI__W
-};
-
-KAI_INTERNAL void kai__tokenizer_advance_to_identifier_end(Kai_Tokenizer* context)
-{
-    while (context->cursor<(context->source).count)
+    for (Kai_u32 t = 0; t < node->tag_count; ++t)
     {
-        Kai_u8 c = ((context->source).data)[context->cursor];
-        if (c<128&&kai__token_lookup_table[c]&1)
-            break;
-        context->cursor += 1;
+        Kai_u32 tag = (node->first_child+count)+t;
+        Kai_Compact_Node* tag_node = kai_compact_node(tree, tag);
+        Kai_u32 tag_count = tag_node->child_count;
+        kai__tree_traversal_push(context, (t+1)==node->tag_count);
+        context->prefix = KAI_STRING("tag");
+        kai__write_tree_branches(context);
+        kai__set_color(KAI_WRITE_COLOR_DEFAULT);
+        kai__write("(name = \"");
+        kai__set_color(KAI_WRITE_COLOR_IMPORTANT);
+        kai__write_string(kai_compact_name(tree, tag));
+        kai__set_color(KAI_WRITE_COLOR_DEFAULT);
+        kai__write("\")\n");
+        for (Kai_u32 i = 0; i < tag_count; ++i)
+            kai__explore_compact(context, tree, kai_compact_child(tree, tag, i), (i+1)==tag_count);
+        kai__tree_traversal_pop(context);
     }
 }
 
-KAI_API(Kai_Token) kai_tokenizer_generate(Kai_Tokenizer* context)
+KAI_API(void) kai_write_compact_tree(Kai_Writer* writer, Kai_Compact_Tree* tree)
 {
-    Kai_Token token = ((Kai_Token){.id = KAI_TOKEN_END, .line_number = context->line_number});
-    while (context->cursor<(context->source).count)
-    {
-        (token.string).data = (context->source).data+context->cursor;
-        Kai_u8 ch = ((token.string).data)[0];
-        Kai_u32 where = {0};
-        if (!(ch&128))
-            where = kai__token_lookup_table[ch];
-        switch (where)
-        {
-            break; case KAI__W:
-            {
-                if (ch==13)
-                {
-                    if (kai__next_character_equals(10))
-                        context->cursor += 1;
-                    context->line_number += 1;
-                }
-                else
-                if (ch==10)
-                {
-                    context->line_number += 1;
-                }
-                token.line_number = context->line_number;
-                context->cursor += 1;
-            }
-            break; case KAI__N:
-            {
-                token.id = KAI_TOKEN_NUMBER;
-                Kai_u32 start = context->cursor;
-                if (ch==48)
-                {
-                    context->cursor += 1;
-                    if (context->cursor<(context->source).count)
-                    {
-                        if (((context->source).data)[context->cursor]==98)
-                        {
-                            context->cursor += 1;
-                            (token.value).number = kai_number_parse_whole(context->source, &(context->cursor), 2);
-                            (token.string).count = context->cursor-start;
-                            return token;
-                        }
-                        if (((context->source).data)[context->cursor]==120)
-                        {
-                            context->cursor += 1;
-                            (token.value).number = kai_number_parse_whole(context->source, &(context->cursor), 16);
-                            (token.string).count = context->cursor-start;
-                            return token;
-                        }
-                    }
-                }
-                (token.value).number = kai_number_parse_whole(context->source, &(context->cursor), 10);
-                (token.value).number = kai__parse_fractional_part(context->source, &(context->cursor), (token.value).number);
-                (token.string).count = context->cursor-start;
-                return token;
-            }
-            break; case 0:
-            {
-                token.id = KAI_TOKEN_IDENTIFIER;
-                Kai_u32 start = context->cursor;
-                context->cursor += 1;
-                kai__tokenizer_advance_to_identifier_end(context);
-                (token.string).count = context->cursor-start;
-                return token;
-            }
-            break; case KAI__D:
-            {
-                token.id = KAI_TOKEN_DIRECTIVE;
-                Kai_u32 start = context->cursor;
-                context->cursor += 1;
-                kai__tokenizer_advance_to_identifier_end(context);
-                (token.string).count = context->cursor-start;
-                (token.value).string = token.string;
-                ((token.value).string).count -= 1;
-                ((token.value).string).data += 1;
-                return token;
-            }
-            break; case KAI__G:
-            {
-                token.id = KAI_TOKEN_TAG;
-                Kai_u32 start = context->cursor;
-                context->cursor += 1;
-                kai__tokenizer_advance_to_identifier_end(context);
-                (token.string).count = context->cursor-start;
-                (token.value).string = token.string;
-                ((token.value).string).count -= 1;
-                ((token.value).string).data += 1;
-                return token;
-            }
-            break; case KAI__K:
-            {
-                token.id = KAI_TOKEN_IDENTIFIER;
-                Kai_u32 start = context->cursor;
-                context->cursor += 1;
-                kai__tokenizer_advance_to_identifier_end(context);
-                (token.string).count = context->cursor-start;
-                Kai_u32 index = kai__string_to_keyword_index(token.string);
-                if (kai_string_equals(kai__keywords[index], token.string))
-                {
-                    token.id = 128|index;
-                    return token;
-                }
-                return token;
-            }
-            break; case KAI__S:
-            {
-                token.id = KAI_TOKEN_STRING;
-                (token.string).count = 1;
-                context->cursor += 1;
-                Kai_u32 count = 0;
-                (token.value).string = ((Kai_string){0});
-                while (context->cursor<(context->source).count)
-                {
-                    if (((context->source).data)[context->cursor]==34)
-                    {
-                        break;
-                    }
-                    Kai_u8 m = ((context->source).data)[context->cursor];
-                    if (m==92)
-                    {
-                        context->cursor += 1;
-                        (token.string).count += 1;
-                        if (context->cursor>=(context->source).count)
-                            break;
-                        m = ((context->source).data)[context->cursor];
-                        switch (m)
-                        {
-                            break; case 92:
-                            m = 92;
-                            break; case 34:
-                            m = 34;
-                            break; case 116:
-                            m = 9;
-                            break; case 114:
-                            m = 13;
-                            break; case 110:
-                            m = 10;
-                            break; case 101:
-                            m = 27;
-                        }
-                    }
-                    Kai_u8* data = ((Kai_u8*)kai_fixed_allocate(&(context->string_arena), 1));
-                    kai_assert(data!=NULL);
-                    *data = m;
-                    if (((token.value).string).data==NULL)
-                        ((token.value).string).data = data;
-                    count += 1;
-                    context->cursor += 1;
-                }
-                context->cursor += 1;
-                (token.string).count += count+1;
-                ((token.value).string).count = count;
-                return token;
-            }
-            break; case KAI__C:
-            {
-                (token.string).data = (context->source).data+context->cursor;
-                context->cursor += 1;
-                if (context->cursor<(context->source).count&&((context->source).data)[context->cursor]==47)
-                {
-                    while (context->cursor<(context->source).count)
-                    {
-                        if (((context->source).data)[context->cursor]==13||((context->source).data)[context->cursor]==10)
-                            break;
-                        context->cursor += 1;
-                    }
-                    break;
-                }
-                if (((context->source).data)[context->cursor]==42)
-                {
-                    context->cursor += 1;
-                    Kai_u32 depth = 1;
-                    while (depth>0&&context->cursor<(context->source).count)
-                    {
-                        if ((((context->source).data)[context->cursor]==47&&context->cursor+1<(context->source).count)&&((context->source).data)[context->cursor+1]==42)
-                        {
-                            context->cursor += 2;
-                            depth += 1;
-                            continue;
-                        }
-                        if ((((context->source).data)[context->cursor]==42&&context->cursor+1<(context->source).count)&&((context->source).data)[context->cursor+1]==47)
-                        {
-                            context->cursor += 2;
-                            depth -= 1;
-                            continue;
-                        }
-                        if (((context->source).data)[context->cursor]==13)
-                        {
-                            if (kai__next_character_equals(10))
-                                context->cursor += 1;
-                            context->line_number += 1;
-                        }
-                        else
-                        if (((context->source).data)[context->cursor]==10)
-                        {
-                            context->line_number += 1;
-                        }
-                        context->cursor += 1;
-                    }
-                    break;
-                }
-                token.id = (Kai_u32)(ch);
-                (token.string).count = 1;
-                if (kai__make_multi_token(context, &token, ch))
-                {
-                    context->cursor += 1;
-                    (token.string).count += 1;
-                }
-                return token;
-            }
-            break; case KAI__T:
-            {
-                token.id = (Kai_u32)(ch);
-                (token.string).count = 1;
-                context->cursor += 1;
-                if (kai__make_multi_token(context, &token, ch))
-                {
-                    context->cursor += 1;
-                    (token.string).count += 1;
-                }
-                return token;
-            }
-            break; case KAI__Z:
-            {
-                if (kai__next_character_equals(46))
-                {
-                    context->cursor += 2;
-                    (token.string).count = 2;
-                    token.id = 11822;
-                    return token;
-                }
-                if ((context->cursor+1<(context->source).count&&((context->source).data)[context->cursor+1]>=48)&&((context->source).data)[context->cursor+1]<=57)
-                {
-                    token.id = KAI_TOKEN_NUMBER;
-                    Kai_u32 start = context->cursor;
-                    (token.value).number = kai__parse_fractional_part(context->source, &(context->cursor), (token.value).number);
-                    (token.string).count = context->cursor-start;
-                    return token;
-                }
-                context->cursor += 1;
-                (token.string).count = 1;
-                token.id = (Kai_u32)(ch);
-                return token;
-            }
-        }
+    Kai__Tree_Traversal_Context context = {0};
+    context.writer = writer;
+    (context.stack)[0] = 1;
+    kai__write_compact_tree(&context, tree, 1);
+}
+
+KAI_API(void) kai_write_syntax_tree(Kai_Writer* writer, Kai_Syntax_Tree* tree)
+{
+    kai_settle_syntax_tree(tree);
+    Kai_Allocator* allocator = &((tree->allocator).base);
+    Kai_Atom_Table atoms = {0};
+    kai_create_atom_table(&atoms, allocator);
+    Kai_Compact_Tree compact = {0};
+    Kai__Compactor compactor = {0};
+    kai__compact_begin(&compactor, &compact, tree->source, &atoms, allocator);
+    Kai__Tree_Traversal_Context context = {0};
+    context.writer = writer;
+    (context.stack)[0] = 1;
+    kai__write_tree_branches(&context);
+    kai__write_compact_id_with_name(writer, KAI_STRING("compound statement"), ((Kai_string){0}));
+    kai__write("\n");
+    Kai_Stmt* stmt = (tree->root).head;
+    while (stmt!=NULL)
+    {
+        (compact.nodes).count = 2;
+        (compact.numbers).count = 0;
+        (compact.strings).count = 0;
+        (compact.string_data).count = 0;
+        kai__compact_fill(&compactor, 1, stmt);
+        kai__explore_compact(&context, &compact, 1, stmt->next==NULL);
+        stmt = stmt->next;
     }
-    return token;
+    kai__compact_end(&compactor);
+    kai_destroy_compact_tree(&compact);
+    kai_destroy_atom_table(&atoms);
 }
 
-KAI_API(Kai_Token*) kai_tokenizer_next(Kai_Tokenizer* context)
+KAI_API(void) kai_write_number(Kai_Writer* writer, Kai_Number number)
 {
-    if (!(context->peeking))
+    if (!kai_number_is_integer(number))
     {
-        context->current_token = kai_tokenizer_generate(context);
-        return &(context->current_token);
+        kai__write_f64(kai_number_to_f64(number));
+        return;
     }
-    context->peeking = KAI_FALSE;
-    context->current_token = context->peeked_token;
-    return &(context->current_token);
+    if (number.is_neg)
+    {
+        kai__write("-");
+    }
+    if ((Kai_u32)(number.e)<=kai_intrinsics_clz64(number.n))
+    {
+        kai__write_u64(kai_number_to_u64(number));
+        return;
+    }
+    kai__write_u64(number.n);
+    kai__write(" * 2^");
+    kai__write_s32(number.e);
 }
 
-KAI_API(Kai_Token*) kai_tokenizer_peek(Kai_Tokenizer* context)
+KAI_API(void) kai_destroy_error(Kai_Error* error, Kai_Allocator* allocator)
 {
-    if (context->peeking)
-        return &(context->peeked_token);
-    context->peeking = KAI_TRUE;
-    context->peeked_token = kai_tokenizer_generate(context);
-    return &(context->peeked_token);
+    while (error)
+    {
+        Kai_Error* next = error->next;
+        if ((error->memory).size>0)
+            kai__free((error->memory).data, (error->memory).size);
+        error = next;
+    }
 }
 
-KAI_INTERNAL Kai_Expr* kai__error_unexpected(Kai_Parser* parser, Kai_Token* token, Kai_string where, Kai_string wanted)
+static Kai_string kai__keywords[18] = {
+    KAI_CONST_STRING("if"), KAI_CONST_STRING("struct"), KAI_CONST_STRING("using"), KAI_CONST_STRING("defer"), 
+    KAI_CONST_STRING("null"), KAI_CONST_STRING("false"), KAI_CONST_STRING("then"), KAI_CONST_STRING("enum"), 
+    KAI_CONST_STRING("continue"), KAI_CONST_STRING("else"), KAI_CONST_STRING("while"), 
+    KAI_CONST_STRING("union"), KAI_CONST_STRING("for"), KAI_CONST_STRING("break"), KAI_CONST_STRING("cast"), 
+    KAI_CONST_STRING("case"), KAI_CONST_STRING("ret"), KAI_CONST_STRING("true")
+};
+
+KAI_INTERNAL Kai_u32 kai__string_to_keyword_index(Kai_string kw)
 {
-    if ((parser->error)->result!=KAI_SUCCESS)
-        return NULL;
-    Kai_Buffer buffer = ((Kai_Buffer){.allocator = (parser->arena).base});
-    Kai_u8 temp[32] = {0};
-    Kai_string temp_string = ((Kai_string){.count = sizeof(temp), .data = temp});
-    kai__buffer_append_string(&buffer, KAI_STRING("unexpected "));
-    kai__buffer_append_string(&buffer, kai_token_string(token->id, temp_string));
-    kai__buffer_append_string(&buffer, KAI_STRING(" "));
-    kai__buffer_append_string(&buffer, where);
-    Kai_Range message = kai__buffer_end(&buffer);
-    Kai_Memory memory = kai__buffer_done(&buffer);
-    *(parser->error) = ((Kai_Error){.result = KAI_ERROR_SYNTAX, .location = ((Kai_Location){.string = token->string, .line = token->line_number}), .message = kai__range_to_string(message, memory), .context = wanted, .memory = memory});
-    return NULL;
-}
-
-KAI_INTERNAL Kai__Operator kai__operator_info(Kai_u32 op)
-{
-    switch (op)
-    {
-        break; case 31868:
-        return ((Kai__Operator){16, KAI__OPERATOR_TYPE_BINARY});
-        break; case 9766:
-        return ((Kai__Operator){17, KAI__OPERATOR_TYPE_BINARY});
-        break; case 15676:
-        return ((Kai__Operator){64, KAI__OPERATOR_TYPE_BINARY});
-        break; case 15678:
-        return ((Kai__Operator){64, KAI__OPERATOR_TYPE_BINARY});
-        break; case 60:
-        return ((Kai__Operator){64, KAI__OPERATOR_TYPE_BINARY});
-        break; case 62:
-        return ((Kai__Operator){64, KAI__OPERATOR_TYPE_BINARY});
-        break; case 15677:
-        return ((Kai__Operator){80, KAI__OPERATOR_TYPE_BINARY});
-        break; case 15649:
-        return ((Kai__Operator){80, KAI__OPERATOR_TYPE_BINARY});
-        break; case 124:
-        return ((Kai__Operator){112, KAI__OPERATOR_TYPE_BINARY});
-        break; case 94:
-        return ((Kai__Operator){112, KAI__OPERATOR_TYPE_BINARY});
-        break; case 38:
-        return ((Kai__Operator){112, KAI__OPERATOR_TYPE_BINARY});
-        break; case 15420:
-        return ((Kai__Operator){128, KAI__OPERATOR_TYPE_BINARY});
-        break; case 15934:
-        return ((Kai__Operator){128, KAI__OPERATOR_TYPE_BINARY});
-        break; case 43:
-        return ((Kai__Operator){256, KAI__OPERATOR_TYPE_BINARY});
-        break; case 45:
-        return ((Kai__Operator){256, KAI__OPERATOR_TYPE_BINARY});
-        break; case 42:
-        return ((Kai__Operator){512, KAI__OPERATOR_TYPE_BINARY});
-        break; case 47:
-        return ((Kai__Operator){512, KAI__OPERATOR_TYPE_BINARY});
-        break; case 37:
-        return ((Kai__Operator){512, KAI__OPERATOR_TYPE_BINARY});
-        break; case 46:
-        return ((Kai__Operator){65535, KAI__OPERATOR_TYPE_BINARY});
-        break; case 15917:
-        return ((Kai__Operator){KAI__PREC_CAST, KAI__OPERATOR_TYPE_BINARY});
-        break; case 91:
-        return ((Kai__Operator){48879, KAI__OPERATOR_TYPE_INDEX});
-        break; case 40:
-        return ((Kai__Operator){48879, KAI__OPERATOR_TYPE_PROCEDURE_CALL});
-        break; default:
-        return ((Kai__Operator){0});
-    }
+    Kai_u32 hash = 0;
+    if (0<kw.count)
+        hash |= (((kw.data)[0])>>2&1)<<2;
+    if (1<kw.count)
+        hash |= (((kw.data)[1])>>3&1)<<3;
+    if (2<kw.count)
+        hash |= (((kw.data)[2])>>3&1)<<1;
+    if (2<kw.count)
+        hash |= (((kw.data)[2])>>2&1)<<4;
+    if (2<kw.count)
+        hash |= ((kw.data)[2]&1)<<5;
+    if (3<kw.count)
+        hash |= (kw.data)[3]&1;
+    return hash%18;
 }
 
-KAI_INTERNAL Kai_Expr* kai__parser_create_identifier(Kai_Parser* parser, Kai_Token token)
+KAI_API(void) kai_create_atom_table(Kai_Atom_Table* table, Kai_Allocator* allocator)
 {
-    Kai_Expr* node = ((Kai_Expr*)kai_arena_allocate(&(parser->arena), sizeof(Kai_Expr)));
-    node->id = KAI_EXPR_IDENTIFIER;
-    node->source_code = token.string;
-    node->line_number = token.line_number;
-    return kai_parse_tag_to_expr(parser, (Kai_Expr*)(node));
+    kai__memory_zero(table, sizeof(Kai_Atom_Table));
+    table->allocator = *allocator;
+    kai_arena_create(&(table->name_data), allocator);
+    kai_array_push(&(table->names), ((Kai_string){0}));
 }
 
-KAI_INTERNAL Kai_Expr* kai__parser_create_string(Kai_Parser* parser, Kai_Token token)
+KAI_API(void) kai_destroy_atom_table(Kai_Atom_Table* table)
 {
-    Kai_Expr_String* node = ((Kai_Expr_String*)kai_arena_allocate(&(parser->arena), sizeof(Kai_Expr_String)));
-    node->id = KAI_EXPR_STRING;
-    node->source_code = token.string;
-    node->line_number = token.line_number;
-    node->value = (token.value).string;
-    return (Kai_Expr*)(node);
+    Kai_Allocator* allocator = &(table->allocator);
+    kai_array_destroy(&(table->names));
+    if ((table->atoms).capacity!=0)
+    {
+        kai__free((table->atoms).occupied, kai_raw_table_size((table->atoms).capacity, sizeof(Kai_string), sizeof(Kai_u32)).total);
+    }
+    kai_arena_destroy(&(table->name_data));
 }
 
-KAI_INTERNAL Kai_Expr* kai__parser_create_number(Kai_Parser* parser, Kai_Token token)
+KAI_API(Kai_u32) kai_intern_atom(Kai_Atom_Table* table, Kai_string name)
 {
-    Kai_Expr_Number* node = ((Kai_Expr_Number*)kai_arena_allocate(&(parser->arena), sizeof(Kai_Expr_Number)));
-    node->id = KAI_EXPR_NUMBER;
-    node->source_code = token.string;
-    node->line_number = token.line_number;
-    node->value = (token.value).number;
-    return kai_parse_tag_to_expr(parser, (Kai_Expr*)(node));
+    if (name.count==0)
+        return 0;
+    Kai_int index = kai_table_find(string, &(table->atoms), name);
+    if (index!=-1)
+        return ((table->atoms).values)[index];
+    Kai_Allocator* allocator = &(table->allocator);
+    Kai_string copy = ((Kai_string){.count = name.count});
+    copy.data = (Kai_u8*)(kai_arena_allocate(&(table->name_data), name.count));
+    kai__memory_copy(copy.data, name.data, name.count);
+    Kai_u32 atom = (table->names).count;
+    kai_array_push(&(table->names), copy);
+    kai_table_set(string, &(table->atoms), copy, atom);
+    return atom;
 }
 
-KAI_INTERNAL Kai_Expr* kai__parser_create_literal(Kai_Parser* parser, Kai_Token token, Kai_Expr* head, Kai_u32 count)
+KAI_API(void) kai_write_token(Kai_Writer* writer, Kai_Token token)
 {
-    Kai_Expr_Literal* node = ((Kai_Expr_Literal*)kai_arena_allocate(&(parser->arena), sizeof(Kai_Expr_Literal)));
-    node->id = KAI_EXPR_LITERAL;
-    node->source_code = token.string;
-    node->line_number = token.line_number;
-    node->head = head;
-    node->count = count;
-    return (Kai_Expr*)(node);
+    Kai_bool symbol = KAI_FALSE;
+    switch (token.id)
+    {
+        break; case KAI_TOKEN_IDENTIFIER:
+        kai__write("Ident");
+        break; case KAI_TOKEN_STRING:
+        kai__write("String");
+        break; case KAI_TOKEN_NUMBER:
+        kai__write("Number");
+        break; case KAI_TOKEN_DIRECTIVE:
+        kai__write("Dir");
+        break; case KAI_TOKEN_TAG:
+        kai__write("Tag");
+        break; default:
+        symbol = KAI_TRUE;
+    }
+    if (!symbol)
+        kai__write("(");
+    if (token.id>256)
+    {
+        Kai_u32 id = token.id;
+        Kai_u8 ch = {0};
+        Kai_string str = ((Kai_string){.count = 1, .data = &ch});
+        while (id!=0)
+        {
+            ch = id&255;
+            kai__write_string(str);
+            id = id>>8;
+        }
+    }
+    else
+        kai__write_string(token.string);
+    if (!symbol)
+        kai__write(")");
 }
 
-KAI_INTERNAL Kai_Expr* kai__parser_create_unary(Kai_Parser* parser, Kai_Token op_token, Kai_Expr* expr)
+KAI_API(Kai_string) kai_token_string(Kai_Token_Id id, Kai_string dst)
 {
-    Kai_Expr_Unary* node = ((Kai_Expr_Unary*)kai_arena_allocate(&(parser->arena), sizeof(Kai_Expr_Unary)));
-    node->id = KAI_EXPR_UNARY;
-    node->source_code = kai_merge_strings(op_token.string, expr->source_code);
-    node->line_number = kai__min_u32(op_token.line_number, expr->line_number);
-    node->op = op_token.id;
-    node->expr = expr;
-    return (Kai_Expr*)(node);
+    kai_assert(dst.count>=12);
+    switch (id)
+    {
+        break; case KAI_TOKEN_END:
+        return kai_string_copy_from_c(dst, "end of file");
+        break; case KAI_TOKEN_IDENTIFIER:
+        return kai_string_copy_from_c(dst, "identifier");
+        break; case KAI_TOKEN_NUMBER:
+        return kai_string_copy_from_c(dst, "number");
+        break; case KAI_TOKEN_DIRECTIVE:
+        return kai_string_copy_from_c(dst, "directive");
+        break; case KAI_TOKEN_TAG:
+        return kai_string_copy_from_c(dst, "tag");
+        break; case KAI_TOKEN_STRING:
+        return kai_string_copy_from_c(dst, "string");
+        break; case KAI_TOKEN_break:
+        return kai_string_copy_from_c(dst, "'break'");
+        break; case KAI_TOKEN_case:
+        return kai_string_copy_from_c(dst, "'case'");
+        break; case KAI_TOKEN_cast:
+        return kai_string_copy_from_c(dst, "'cast'");
+        break; case KAI_TOKEN_continue:
+        return kai_string_copy_from_c(dst, "'continue'");
+        break; case KAI_TOKEN_defer:
+        return kai_string_copy_from_c(dst, "'defer'");
+        break; case KAI_TOKEN_else:
+        return kai_string_copy_from_c(dst, "'else'");
+        break; case KAI_TOKEN_enum:
+        return kai_string_copy_from_c(dst, "'enum'");
+        break; case KAI_TOKEN_for:
+        return kai_string_copy_from_c(dst, "'for'");
+        break; case KAI_TOKEN_if:
+        return kai_string_copy_from_c(dst, "'if'");
+        break; case KAI_TOKEN_ret:
+        return kai_string_copy_from_c(dst, "'ret'");
+        break; case KAI_TOKEN_struct:
+        return kai_string_copy_from_c(dst, "'struct'");
+        break; case KAI_TOKEN_union:
+        return kai_string_copy_from_c(dst, "'union'");
+        break; case KAI_TOKEN_using:
+        return kai_string_copy_from_c(dst, "'using'");
+        break; case KAI_TOKEN_while:
+        return kai_string_copy_from_c(dst, "'while'");
+        break; case KAI_TOKEN_null:
+        return kai_string_copy_from_c(dst, "'null'");
+        break; case KAI_TOKEN_false:
+        return kai_string_copy_from_c(dst, "'false'");
+        break; case KAI_TOKEN_then:
+        return kai_string_copy_from_c(dst, "'then'");
+        break; case KAI_TOKEN_true:
+        return kai_string_copy_from_c(dst, "'true'");
+        break; default:
+        (dst.data)[0] = 39;
+        Kai_u32 i = 0;
+        while (i<=3)
+        {
+            Kai_u8 ch = (Kai_u8)(id>>(i*8));
+            if (ch==0)
+                break;
+            (dst.data)[i+1] = ch;
+            i += 1;
+        }
+        (dst.data)[i+1] = 39;
+        return ((Kai_string){.count = i+2, .data = dst.data});
+    }
 }
 
-KAI_INTERNAL Kai_Expr* kai__parser_create_binary(Kai_Parser* parser, Kai_Expr* left, Kai_Expr* right, Kai_u32 op)
+KAI_INTERNAL Kai_Number kai__parse_fractional_part(Kai_string source, Kai_u32* offset, Kai_Number start)
 {
-    Kai_Expr_Binary* node = ((Kai_Expr_Binary*)kai_arena_allocate(&(parser->arena), sizeof(Kai_Expr_Binary)));
-    node->id = KAI_EXPR_BINARY;
-    node->source_code = kai_merge_strings(left->source_code, right->source_code);
-    node->line_number = kai__min_u32(left->line_number, right->line_number);
-    node->op = op;
-    node->left = left;
-    node->right = right;
-    return (Kai_Expr*)(node);
+    if ((*offset<source.count&&(source.data)[*offset]==46)&&!((((*offset)+1)<(source.count))&&(((source.data)[*offset+1])==46)))
+    {
+        *offset += 1;
+        Kai_Number decimal = kai_number_parse_decimal(source, offset);
+        start = kai_number_add(start, decimal);
+    }
+    if (*offset<source.count&&((source.data)[*offset]==101||(source.data)[*offset]==69))
+    {
+        Kai_bool is_neg = KAI_FALSE;
+        *offset += 1;
+        if (*offset<source.count)
+        {
+            if ((source.data)[*offset]==45)
+            {
+                *offset += 1;
+                is_neg = KAI_TRUE;
+            }
+            if ((source.data)[*offset]==43)
+            {
+                *offset += 1;
+            }
+        }
+        Kai_Number exponent = kai_number_parse_exponent(source, offset);
+        if (is_neg)
+            exponent = kai_number_inv(exponent);
+        start = kai_number_mul(start, exponent);
+    }
+    return start;
 }
 
-KAI_INTERNAL Kai_Expr* kai__parser_create_array(Kai_Parser* parser, Kai_Token op_token, Kai_Expr* expr, Kai_Expr* rows, Kai_Expr* cols, Kai_u8 flags)
+KAI_INTERNAL Kai_bool kai__make_multi_token(Kai_Tokenizer* context, Kai_Token* t, Kai_u8 current)
 {
-    Kai_Expr_Array* node = ((Kai_Expr_Array*)kai_arena_allocate(&(parser->arena), sizeof(Kai_Expr_Array)));
-    node->id = KAI_EXPR_ARRAY;
-    node->source_code = kai_merge_strings(op_token.string, expr->source_code);
-    node->line_number = kai__min_u32(op_token.line_number, expr->line_number);
-    node->flags = flags;
-    node->rows = rows;
-    node->cols = cols;
-    node->expr = expr;
-    return (Kai_Expr*)(node);
-}
-
-KAI_INTERNAL Kai_Expr* kai__parser_create_special(Kai_Parser* parser, Kai_Token token, Kai_u8 kind)
-{
-    Kai_Expr_Special* node = ((Kai_Expr_Special*)kai_arena_allocate(&(parser->arena), sizeof(Kai_Expr_Special)));
-    node->id = KAI_EXPR_SPECIAL;
-    node->source_code = token.string;
-    node->line_number = token.line_number;
-    node->kind = kind;
-    return (Kai_Expr*)(node);
-}
-
-KAI_INTERNAL Kai_Expr* kai__parser_create_procedure_type(Kai_Parser* parser, Kai_Expr* in_out, Kai_u8 in_count, Kai_u8 out_count)
-{
-    Kai_Expr_Procedure_Type* node = ((Kai_Expr_Procedure_Type*)kai_arena_allocate(&(parser->arena), sizeof(Kai_Expr_Procedure_Type)));
-    node->id = KAI_EXPR_PROCEDURE_TYPE;
-    if (in_out!=NULL)
+    if (context->cursor>=(context->source).count)
+        return KAI_FALSE;
+    switch (current)
     {
-        node->source_code = in_out->source_code;
-        node->line_number = in_out->line_number;
+        break; case 38:
+        {
+            if (((context->source).data)[context->cursor]==38)
+            {
+                t->id = 9766;
+                return KAI_TRUE;
+            }
+            if (((context->source).data)[context->cursor]==61)
+            {
+                t->id = 15654;
+                return KAI_TRUE;
+            }
+        }
+        break; case 124:
+        {
+            if (((context->source).data)[context->cursor]==124)
+            {
+                t->id = 31868;
+                return KAI_TRUE;
+            }
+            if (((context->source).data)[context->cursor]==61)
+            {
+                t->id = 15740;
+                return KAI_TRUE;
+            }
+        }
+        break; case 61:
+        {
+            if (((context->source).data)[context->cursor]==61)
+            {
+                t->id = 15677;
+                return KAI_TRUE;
+            }
+            if (((context->source).data)[context->cursor]==62)
+            {
+                t->id = 15933;
+                return KAI_TRUE;
+            }
+        }
+        break; case 62:
+        {
+            if (((context->source).data)[context->cursor]==61)
+            {
+                t->id = 15678;
+                return KAI_TRUE;
+            }
+            if (((context->source).data)[context->cursor]==62)
+            {
+                t->id = 15934;
+                return KAI_TRUE;
+            }
+        }
+        break; case 60:
+        {
+            if (((context->source).data)[context->cursor]==61)
+            {
+                t->id = 15676;
+                return KAI_TRUE;
+            }
+            if (((context->source).data)[context->cursor]==60)
+            {
+                t->id = 15420;
+                return KAI_TRUE;
+            }
+        }
+        break; case 33:
+        {
+            if (((context->source).data)[context->cursor]==61)
+            {
+                t->id = 15649;
+                return KAI_TRUE;
+            }
+        }
+        break; case 43:
+        {
+            if (((context->source).data)[context->cursor]==61)
+            {
+                t->id = 15659;
+                return KAI_TRUE;
+            }
+        }
+        break; case 45:
+        {
+            if (((context->source).data)[context->cursor]==61)
+            {
+                t->id = 15661;
+                return KAI_TRUE;
+            }
+            if (((context->source).data)[context->cursor]==62)
+            {
+                t->id = 15917;
+                return KAI_TRUE;
+            }
+            if ((context->cursor+1<(context->source).count&&((context->source).data)[context->cursor]==45)&&((context->source).data)[context->cursor+1]==45)
+            {
+                t->id = 2960685;
+                context->cursor += 1;
+                (t->string).count += 1;
+                return KAI_TRUE;
+            }
+        }
+        break; case 42:
+        {
+            if (((context->source).data)[context->cursor]==61)
+            {
+                t->id = 15658;
+                return KAI_TRUE;
+            }
+        }
+        break; case 47:
+        {
+            if (((context->source).data)[context->cursor]==61)
+            {
+                t->id = 15663;
+                return KAI_TRUE;
+            }
+        }
     }
-    node->in_out_expr = in_out;
-    node->in_count = in_count;
-    node->out_count = out_count;
-    return (Kai_Expr*)(node);
-}
-
-KAI_INTERNAL Kai_Expr* kai__parser_create_procedure_call(Kai_Parser* parser, Kai_Expr* proc, Kai_Expr* args, Kai_u8 arg_count)
-{
-    Kai_Expr_Procedure_Call* node = ((Kai_Expr_Procedure_Call*)kai_arena_allocate(&(parser->arena), sizeof(Kai_Expr_Procedure_Call)));
-    node->id = KAI_EXPR_PROCEDURE_CALL;
-    node->source_code = proc->source_code;
-    node->line_number = proc->line_number;
-    node->proc = proc;
-    node->arg_head = args;
-    node->arg_count = arg_count;
-    return (Kai_Expr*)(node);
-}
-
-KAI_INTERNAL Kai_Expr* kai__parser_create_procedure(Kai_Parser* parser, Kai_Token token, Kai_Expr* in_out, Kai_Stmt* body, Kai_u8 in_count, Kai_u8 out_count)
-{
-    Kai_Expr_Procedure* node = ((Kai_Expr_Procedure*)kai_arena_allocate(&(parser->arena), sizeof(Kai_Expr_Procedure)));
-    node->id = KAI_EXPR_PROCEDURE;
-    node->source_code = token.string;
-    node->line_number = token.line_number;
-    node->in_out_expr = in_out;
-    node->in_count = in_count;
-    node->out_count = out_count;
-    node->body = body;
-    return (Kai_Expr*)(node);
-}
-
-KAI_INTERNAL Kai_Expr* kai__parser_create_import(Kai_Parser* parser, Kai_Token token, Kai_Token import)
-{
-    Kai_Expr* node = ((Kai_Expr*)kai_arena_allocate(&(parser->arena), sizeof(Kai_Expr)));
-    node->id = KAI_EXPR_IMPORT;
-    node->source_code = kai_merge_strings(token.string, import.string);
-    node->line_number = token.line_number;
-    node->name = (import.value).string;
-    return (Kai_Expr*)(node);
-}
-
-KAI_INTERNAL Kai_Expr* kai__parser_create_struct(Kai_Parser* parser, Kai_Token token, Kai_u32 field_count, Kai_Stmt* body)
-{
-    Kai_Expr_Struct* node = ((Kai_Expr_Struct*)kai_arena_allocate(&(parser->arena), sizeof(Kai_Expr_Struct)));
-    node->id = KAI_EXPR_STRUCT;
-    node->source_code = token.string;
-    node->line_number = token.line_number;
-    node->field_count = field_count;
-    node->head = body;
-    return (Kai_Expr*)(node);
-}
-
-KAI_INTERNAL Kai_Expr* kai__parser_create_enum(Kai_Parser* parser, Kai_Token token, Kai_Expr* type, Kai_u32 field_count, Kai_Stmt* body)
-{
-    Kai_Expr_Enum* node = ((Kai_Expr_Enum*)kai_arena_allocate(&(parser->arena), sizeof(Kai_Expr_Enum)));
-    node->id = KAI_EXPR_ENUM;
-    node->source_code = token.string;
-    node->line_number = token.line_number;
-    node->type = type;
-    node->field_count = field_count;
-    node->head = body;
-    return (Kai_Expr*)(node);
-}
-
-KAI_INTERNAL Kai_Expr* kai__parser_create_return(Kai_Parser* parser, Kai_Token ret_token, Kai_Expr* expr)
-{
-    Kai_Stmt_Return* node = ((Kai_Stmt_Return*)kai_arena_allocate(&(parser->arena), sizeof(Kai_Stmt_Return)));
-    node->id = KAI_STMT_RETURN;
-    node->source_code = ret_token.string;
-    node->line_number = ret_token.line_number;
-    node->expr = expr;
-    return (Kai_Expr*)(node);
-}
-
-KAI_INTERNAL Kai_Expr* kai__parser_create_declaration(Kai_Parser* parser, Kai_string name, Kai_Expr* type, Kai_Expr* value, Kai_u8 flags, Kai_u32 line_number)
-{
-    Kai_Stmt_Declaration* node = ((Kai_Stmt_Declaration*)kai_arena_allocate(&(parser->arena), sizeof(Kai_Stmt_Declaration)));
-    node->id = KAI_STMT_DECLARATION;
-    node->source_code = name;
-    node->line_number = line_number;
-    node->name = name;
-    node->type = type;
-    node->value = value;
-    node->flags = flags;
-    return kai_parse_tag_to_expr(parser, (Kai_Expr*)(node));
+    return KAI_FALSE;
 }
 
-KAI_INTERNAL Kai_Expr* kai__parser_create_assignment(Kai_Parser* parser, Kai_u32 op, Kai_Expr* dest, Kai_Expr* value)
-{
-    Kai_Stmt_Assignment* node = ((Kai_Stmt_Assignment*)kai_arena_allocate(&(parser->arena), sizeof(Kai_Stmt_Assignment)));
-    node->id = KAI_STMT_ASSIGNMENT;
-    node->source_code = dest->source_code;
-    node->line_number = dest->line_number;
-    node->op = op;
-    node->dest = dest;
-    node->value = value;
-    return (Kai_Expr*)(node);
-}
+static Kai_u8 kai__token_lookup_table[128] = {
+    KAI__W, KAI__W, KAI__W, KAI__W, KAI__W, KAI__W, KAI__W, KAI__W, KAI__W, KAI__W, KAI__W, 
+    KAI__W, KAI__W, KAI__W, KAI__W, KAI__W, KAI__W, KAI__W, KAI__W, KAI__W, KAI__W, KAI__W, 
+    KAI__W, KAI__W, KAI__W, KAI__W, KAI__W, KAI__W, KAI__W, KAI__W, KAI__W, KAI__W, KAI__W, 
+    KAI__T, KAI__S, KAI__D, KAI__T, KAI__T, KAI__T, KAI__T, KAI__T, KAI__T, KAI__T, KAI__T, 
+    KAI__T, KAI__T, KAI__Z, KAI__C, KAI__N, KAI__N, KAI__N, KAI__N, KAI__N, KAI__N, KAI__N, 
+    KAI__N, KAI__N, KAI__N, KAI__T, KAI__T, KAI__T, KAI__T, KAI__T, KAI__T, KAI__G, 0, 
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, KAI__T, 
+    KAI__T, KAI__T, KAI__T, 0, KAI__T, 0, KAI__K, KAI__K, KAI__K, KAI__K, KAI__K, 0, 
+    0, KAI__K, 0, 0, KAI__K, 0, 0, 0, 0, 0, KAI__K, KAI__K, KAI__K, KAI__K, 0, KAI__K, 
+    0, 0, 0, KAI__T, KAI__T, KAI__T, KAI__T, KAI__W
+};
 
-KAI_INTERNAL Kai_Expr* kai__parser_create_if(Kai_Parser* parser, Kai_Token if_token, Kai_u8 flags, Kai_Expr* expr, Kai_Stmt* then_body, Kai_Stmt* else_body)
+KAI_INTERNAL void kai__tokenizer_advance_to_identifier_end(Kai_Tokenizer* context)
 {
-    Kai_Stmt_If* node = ((Kai_Stmt_If*)kai_arena_allocate(&(parser->arena), sizeof(Kai_Stmt_If)));
-    node->id = KAI_STMT_IF;
-    node->source_code = if_token.string;
-    node->line_number = if_token.line_number;
-    node->flags = flags;
-    node->condition = expr;
-    node->then_body = then_body;
-    node->else_body = else_body;
-    return (Kai_Expr*)(node);
+    context->cursor = kai_intrinsics_skip_identifier((context->source).data, context->cursor, (context->source).count);
 }
 
-KAI_INTERNAL Kai_Expr* kai__parser_create_while(Kai_Parser* parser, Kai_Token while_token, Kai_Expr* expr, Kai_Stmt* body)
+KAI_INTERNAL Kai_string kai__tokenizer_unescape(Kai_Tokenizer* context)
 {
-    Kai_Stmt_While* node = ((Kai_Stmt_While*)kai_arena_allocate(&(parser->arena), sizeof(Kai_Stmt_While)));
-    node->id = KAI_STMT_WHILE;
-    node->source_code = while_token.string;
-    node->line_number = while_token.line_number;
-    node->body = body;
-    node->condition = expr;
-    return (Kai_Expr*)(node);
+    Kai_u32 end = context->cursor;
+    while (end<(context->source).count)
+    {
+        end = kai_intrinsics_find_any4((context->source).data, end, (context->source).count, 34, 92, 34, 92);
+        if (end>=(context->source).count||((context->source).data)[end]==34)
+            break;
+        end += 2;
+    }
+    if (end>(context->source).count)
+        end = (context->source).count;
+    kai_assert(context->string_arena!=NULL);
+    Kai_u8* data = ((Kai_u8*)kai_arena_allocate(context->string_arena, (Kai_u32)(kai__ceil_div(end-context->cursor, 8))*8));
+    kai_assert(data!=NULL);
+    Kai_u32 count = 0;
+    while (context->cursor<end)
+    {
+        Kai_u32 run = kai_intrinsics_find_any4((context->source).data, context->cursor, end, 92, 92, 92, 92);
+        kai__memory_copy(data+count, (context->source).data+context->cursor, run-context->cursor);
+        count += run-context->cursor;
+        context->cursor = run+1;
+        if (context->cursor>=end)
+            break;
+        Kai_u8 m = ((context->source).data)[context->cursor];
+        switch (m)
+        {
+            break; case 92:
+            m = 92;
+            break; case 34:
+            m = 34;
+            break; case 116:
+            m = 9;
+            break; case 114:
+            m = 13;
+            break; case 110:
+            m = 10;
+            break; case 101:
+            m = 27;
+        }
+        data[count] = m;
+        count += 1;
+        context->cursor += 1;
+    }
+    context->cursor = end;
+    return ((Kai_string){.count = count, .data = data});
 }
 
-KAI_INTERNAL Kai_Expr* kai__parser_create_for(Kai_Parser* parser, Kai_Token for_token, Kai_string name, Kai_Expr* from, Kai_Expr* to, Kai_Stmt* body, Kai_u8 flags)
+KAI_API(Kai_Token) kai_tokenizer_generate(Kai_Tokenizer* context)
 {
-    Kai_Stmt_For* node = ((Kai_Stmt_For*)kai_arena_allocate(&(parser->arena), sizeof(Kai_Stmt_For)));
-    node->id = KAI_STMT_FOR;
-    node->source_code = for_token.string;
-    node->line_number = for_token.line_number;
-    node->body = body;
-    node->from = from;
-    node->to = to;
-    node->iterator_name = name;
-    node->flags = flags;
-    return (Kai_Expr*)(node);
+    Kai_Token token = ((Kai_Token){.id = KAI_TOKEN_END});
+    while (context->cursor<(context->source).count)
+    {
+        (token.string).data = (context->source).data+context->cursor;
+        token.offset = context->cursor;
+        Kai_u8 ch = ((token.string).data)[0];
+        Kai_u32 where = {0};
+        if (!(ch&128))
+            where = kai__token_lookup_table[ch];
+        switch (where)
+        {
+            break; case KAI__W:
+            {
+                context->cursor = kai_intrinsics_skip_whitespace((context->source).data, context->cursor+1, (context->source).count);
+            }
+            break; case KAI__N:
+            {
+                token.id = KAI_TOKEN_NUMBER;
+                Kai_u32 start = context->cursor;
+                if (ch==48)
+                {
+                    context->cursor += 1;
+                    if (context->cursor<(context->source).count)
+                    {
+                        if (((context->source).data)[context->cursor]==98)
+                        {
+                            context->cursor += 1;
+                            (token.value).number = kai_number_parse_whole(context->source, &(context->cursor), 2);
+                            (token.string).count = context->cursor-start;
+                            return token;
+                        }
+                        if (((context->source).data)[context->cursor]==120)
+                        {
+                            context->cursor += 1;
+                            (token.value).number = kai_number_parse_whole(context->source, &(context->cursor), 16);
+                            (token.string).count = context->cursor-start;
+                            return token;
+                        }
+                    }
+                }
+                (token.value).number = kai_number_parse_whole(context->source, &(context->cursor), 10);
+                (token.value).number = kai__parse_fractional_part(context->source, &(context->cursor), (token.value).number);
+                (token.string).count = context->cursor-start;
+                return token;
+            }
+            break; case 0:
+            {
+                token.id = KAI_TOKEN_IDENTIFIER;
+                Kai_u32 start = context->cursor;
+                context->cursor += 1;
+                kai__tokenizer_advance_to_identifier_end(context);
+                (token.string).count = context->cursor-start;
+                if (context->atoms!=NULL)
+                    token.atom = kai_intern_atom(context->atoms, token.string);
+                return token;
+            }
+            break; case KAI__D:
+            {
+                token.id = KAI_TOKEN_DIRECTIVE;
+                Kai_u32 start = context->cursor;
+                context->cursor += 1;
+                kai__tokenizer_advance_to_identifier_end(context);
+                (token.string).count = context->cursor-start;
+                (token.value).string = token.string;
+                ((token.value).string).count -= 1;
+                ((token.value).string).data += 1;
+                return token;
+            }
+            break; case KAI__G:
+            {
+                token.id = KAI_TOKEN_TAG;
+                Kai_u32 start = context->cursor;
+                context->cursor += 1;
+                kai__tokenizer_advance_to_identifier_end(context);
+                (token.string).count = context->cursor-start;
+                (token.value).string = token.string;
+                ((token.value).string).count -= 1;
+                ((token.value).string).data += 1;
+                return token;
+            }
+            break; case KAI__K:
+            {
+                token.id = KAI_TOKEN_IDENTIFIER;
+                Kai_u32 start = context->cursor;
+                context->cursor += 1;
+                kai__tokenizer_advance_to_identifier_end(context);
+                (token.string).count = context->cursor-start;
+                Kai_u32 index = kai__string_to_keyword_index(token.string);
+                if (kai_string_equals(kai__keywords[index], token.string))
+                {
+                    token.id = 128|index;
+                    return token;
+                }
+                if (context->atoms!=NULL)
+                    token.atom = kai_intern_atom(context->atoms, token.string);
+                return token;
+            }
+            break; case KAI__S:
+            {
+                token.id = KAI_TOKEN_STRING;
+                Kai_u32 start = context->cursor;
+                context->cursor += 1;
+                Kai_u32 end = kai_intrinsics_find_any4((context->source).data, context->cursor, (context->source).count, 34, 92, 34, 92);
+                if (end<(context->source).count&&((context->source).data)[end]==92)
+                {
+                    (token.value).string = kai__tokenizer_unescape(context);
+                }
+                else
+                {
+                    (token.value).string = ((Kai_string){.count = end-context->cursor, .data = (context->source).data+context->cursor});
+                    context->cursor = end;
+                }
+                context->cursor += 1;
+                (token.string).count = context->cursor-start;
+                return token;
+            }
+            break; case KAI__C:
+            {
+                (token.string).data = (context->source).data+context->cursor;
+                context->cursor += 1;
+                if (context->cursor<(context->source).count&&((context->source).data)[context->cursor]==47)
+                {
+                    context->cursor = kai_intrinsics_find_any4((context->source).data, context->cursor, (context->source).count, 13, 10, 13, 10);
+                    break;
+                }
+                if (((context->source).data)[context->cursor]==42)
+                {
+                    context->cursor += 1;
+                    Kai_u32 depth = 1;
+                    while (depth>0&&context->cursor<(context->source).count)
+                    {
+                        context->cursor = kai_intrinsics_find_any4((context->source).data, context->cursor, (context->source).count, 47, 42, 47, 42);
+                        if (context->cursor>=(context->source).count)
+                            break;
+                        if ((((context->source).data)[context->cursor]==47&&context->cursor+1<(context->source).count)&&((context->source).data)[context->cursor+1]==42)
+                        {
+                            context->cursor += 2;
+                            depth += 1;
+                            continue;
+                        }
+                        if ((((context->source).data)[context->cursor]==42&&context->cursor+1<(context->source).count)&&((context->source).data)[context->cursor+1]==47)
+                        {
+                            context->cursor += 2;
+                            depth -= 1;
+                            continue;
+                        }
+                        context->cursor += 1;
+                    }
+                    break;
+                }
+                token.id = (Kai_u32)(ch);
+                (token.string).count = 1;
+                if (kai__make_multi_token(context, &token, ch))
+                {
+                    context->cursor += 1;
+                    (token.string).count += 1;
+                }
+                return token;
+            }
+            break; case KAI__T:
+            {
+                token.id = (Kai_u32)(ch);
+                (token.string).count = 1;
+                context->cursor += 1;
+                if (kai__make_multi_token(context, &token, ch))
+                {
+                    context->cursor += 1;
+                    (token.string).count += 1;
+                }
+                return token;
+            }
+            break; case KAI__Z:
+            {
+                if (kai__next_character_equals(46))
+                {
+                    context->cursor += 2;
+                    (token.string).count = 2;
+                    token.id = 11822;
+                    return token;
+                }
+                if ((context->cursor+1<(context->source).count&&((context->source).data)[context->cursor+1]>=48)&&((context->source).data)[context->cursor+1]<=57)
+                {
+                    token.id = KAI_TOKEN_NUMBER;
+                    Kai_u32 start = context->cursor;
+                    (token.value).number = kai__parse_fractional_part(context->source, &(context->cursor), (token.value).number);
+                    (token.string).count = context->cursor-start;
+                    return token;
+                }
+                context->cursor += 1;
+                (token.string).count = 1;
+                token.id = (Kai_u32)(ch);
+                return token;
+            }
+        }
+    }
+    token.string = ((Kai_string){.count = 0, .data = (context->source).data+context->cursor});
+    token.offset = context->cursor;
+    return token;
 }
 
-KAI_INTERNAL Kai_Expr* kai__parser_create_control(Kai_Parser* parser, Kai_Token token, Kai_u8 kind, Kai_Expr* expr)
+KAI_INTERNAL void kai__tokenizer_read(Kai_Tokenizer* context, Kai_Token* token)
 {
-    Kai_Stmt_Control* node = ((Kai_Stmt_Control*)kai_arena_allocate(&(parser->arena), sizeof(Kai_Stmt_Control)));
-    node->id = KAI_STMT_CONTROL;
-    node->source_code = token.string;
-    node->line_number = token.line_number;
-    node->kind = kind;
-    node->expr = expr;
-    return (Kai_Expr*)(node);
+    if (context->tokens==NULL)
+    {
+        *token = kai_tokenizer_generate(context);
+        return;
+    }
+    kai__token_buffer_read(context->tokens, context->token_index, token);
+    context->token_index += 1;
 }
 
-KAI_INTERNAL Kai_Expr* kai__parser_create_compound(Kai_Parser* parser, Kai_Token token, Kai_Stmt* body)
+KAI_API(Kai_Token*) kai_tokenizer_next(Kai_Tokenizer* context)
 {
-    Kai_Stmt_Compound* node = ((Kai_Stmt_Compound*)kai_arena_allocate(&(parser->arena), sizeof(Kai_Stmt_Compound)));
-    node->id = KAI_STMT_COMPOUND;
-    node->source_code = token.string;
-    node->line_number = token.line_number;
-    node->head = body;
-    return (Kai_Expr*)(node);
+    if (!(context->peeking))
+    {
+        kai__tokenizer_read(context, &(context->current_token));
+        return &(context->current_token);
+    }
+    context->peeking = KAI_FALSE;
+    context->current_token = context->peeked_token;
+    return &(context->current_token);
 }
 
-KAI_INTERNAL Kai_Tag* kai__parser_create_tag(Kai_Parser* parser, Kai_Token token, Kai_Expr* expr)
+KAI_API(Kai_Token*) kai_tokenizer_peek(Kai_Tokenizer* context)
 {
-    Kai_Tag* tag = ((Kai_Tag*)kai_arena_allocate(&(parser->arena), sizeof(Kai_Tag)));
-    tag->name = (token.value).string;
-    tag->expr = expr;
-    return tag;
+    if (context->peeking)
+        return &(context->peeked_token);
+    context->peeking = KAI_TRUE;
+    kai__tokenizer_read(context, &(context->peeked_token));
+    return &(context->peeked_token);
 }
 
-KAI_API(Kai_Expr*) kai_parse_procedure_call_arguments(Kai_Parser* parser, Kai_u32* arg_count)
+KAI_API(Kai_Token) kai_tokenizer_look_ahead(Kai_Tokenizer* context, Kai_u32 n)
 {
-    Kai_Token* current = &((parser->tokenizer).current_token);
-    Kai_Expr_List args = {0};
-    while (current->id!=41)
-    {
-        Kai_Expr* expr = kai_parse_expression(parser, KAI_TOP_PRECEDENCE);
-        kai__expect(expr, "in argument list", "expected an expression here");
-        kai__linked_list_append(args, expr);
-        kai__expect(*arg_count<255, "in argument list", "too many arguments");
-        *arg_count += 1;
-        kai__next_token();
-        if (current->id==44)
-            kai__next_token();
-        else
-        if (current->id!=41)
-            return kai__unexpected("in argument list", "',' or ')' expected here");
-    }
-    return args.head;
+    kai_assert(context->tokens!=NULL);
+    Kai_u32 next = context->token_index;
+    if (context->peeking)
+        next -= 1;
+    return kai_token_buffer_get(context->tokens, (next+n)-1);
 }
 
-KAI_API(Kai_Expr*) kai_parse_tag_to_expr(Kai_Parser* parser, Kai_Expr* expr)
+KAI_API(void) kai_create_token_buffer(Kai_Token_Buffer* buffer, Kai_Allocator* allocator)
 {
-    Kai_Token* peeked = kai__peek_token();
-    Kai_Tag* tag = 0;
-    while (peeked->id==KAI_TOKEN_TAG)
+    kai__memory_zero(buffer, sizeof(Kai_Token_Buffer));
+    buffer->allocator = *allocator;
+}
+
+KAI_API(void) kai_destroy_token_buffer(Kai_Token_Buffer* buffer)
+{
+    Kai_Allocator* allocator = &(buffer->allocator);
+    kai_array_destroy(&(buffer->ids));
+    kai_array_destroy(&(buffer->offsets));
+    kai_array_destroy(&(buffer->lengths));
+    kai_array_destroy(&(buffer->values));
+    kai_array_destroy(&(buffer->numbers));
+    kai_array_destroy(&(buffer->strings));
+    if ((buffer->string_arena).current_bucket!=NULL)
+        kai_arena_destroy(&(buffer->string_arena));
+}
+
+KAI_API(void) kai_tokenize_source(Kai_Token_Buffer* buffer, Kai_string source, Kai_Atom_Table* atoms)
+{
+    Kai_Allocator* allocator = &(buffer->allocator);
+    (buffer->ids).count = 0;
+    (buffer->offsets).count = 0;
+    (buffer->lengths).count = 0;
+    (buffer->values).count = 0;
+    (buffer->numbers).count = 0;
+    (buffer->strings).count = 0;
+    buffer->source = source;
+    if ((buffer->string_arena).current_bucket==NULL)
+    {
+        kai_arena_create(&(buffer->string_arena), allocator);
+        buffer->string_start = kai_arena_save(&(buffer->string_arena));
+    }
+    else
+        kai_arena_restore(&(buffer->string_arena), buffer->string_start);
+    Kai_Tokenizer tokenizer = {0};
+    tokenizer.source = source;
+    tokenizer.atoms = atoms;
+    tokenizer.string_arena = &(buffer->string_arena);
+    Kai_bool done = KAI_FALSE;
+    while (!done)
     {
-        Kai_Token token = *peeked;
-        kai__next_token();
-        Kai_Expr* tag_expr = 0;
-        kai__peek_token();
-        if (peeked->id==40)
+        Kai_Token token = kai_tokenizer_generate(&tokenizer);
+        Kai_u32 value = 0;
+        switch (token.id)
         {
-            kai__next_token();
-            kai__next_token();
-            Kai_u32 arg_count = {0};
-            tag_expr = kai_parse_procedure_call_arguments(parser, &arg_count);
-            kai__peek_token();
+            break; case KAI_TOKEN_IDENTIFIER:
+            value = token.atom;
+            break; case KAI_TOKEN_NUMBER:
+            {
+                value = (buffer->numbers).count;
+                kai_array_push(&(buffer->numbers), (token.value).number);
+            }
+            break; case KAI_TOKEN_STRING:
+            /* fall through */
+            case KAI_TOKEN_DIRECTIVE:
+            /* fall through */
+            case KAI_TOKEN_TAG:
+            {
+                value = (buffer->strings).count;
+                kai_array_push(&(buffer->strings), (token.value).string);
+            }
         }
-        if (tag==NULL)
+        kai_array_push(&(buffer->ids), token.id);
+        kai_array_push(&(buffer->offsets), token.offset);
+        kai_array_push(&(buffer->lengths), (token.string).count);
+        kai_array_push(&(buffer->values), value);
+        done = token.id==KAI_TOKEN_END;
+    }
+}
+
+KAI_API(Kai_Token) kai_token_buffer_get(Kai_Token_Buffer* buffer, Kai_u32 index)
+{
+    Kai_Token token = {0};
+    kai__token_buffer_read(buffer, index, &token);
+    return token;
+}
+
+KAI_INTERNAL void kai__token_buffer_read(Kai_Token_Buffer* buffer, Kai_u32 index, Kai_Token* token)
+{
+    if (index>=(buffer->ids).count)
+        index = (buffer->ids).count-1;
+    Kai_u32 offset = ((buffer->offsets).data)[index];
+    Kai_u32 value = ((buffer->values).data)[index];
+    token->id = ((buffer->ids).data)[index];
+    token->offset = offset;
+    token->atom = 0;
+    token->string = ((Kai_string){.count = ((buffer->lengths).data)[index], .data = (buffer->source).data+offset});
+    switch (token->id)
+    {
+        break; case KAI_TOKEN_IDENTIFIER:
+        token->atom = value;
+        break; case KAI_TOKEN_NUMBER:
+        (token->value).number = ((buffer->numbers).data)[value];
+        break; case KAI_TOKEN_STRING:
+        /* fall through */
+        case KAI_TOKEN_DIRECTIVE:
+        /* fall through */
+        case KAI_TOKEN_TAG:
+        (token->value).string = ((buffer->strings).data)[value];
+    }
+}
+
+KAI_INTERNAL Kai_u32 kai__classify_digits(Kai_string source, Kai_u32 i, Kai_u32 base)
+{
+    while (i<source.count)
+    {
+        Kai_u8 ch = (source.data)[i];
+        Kai_u32 dg = 255;
+        if (ch>=48&&ch<=57)
+            dg = (Kai_u32)(ch-48);
+        else
+        if (ch>=65&&ch<=70)
+            dg = (Kai_u32)(ch-65)+10;
+        else
+        if (ch>=97&&ch<=102)
+            dg = (Kai_u32)(ch-97)+10;
+        else
+        if (ch==95)
+            dg = 0;
+        if (dg>=base)
+            break;
+        i += 1;
+    }
+    return i;
+}
+
+KAI_INTERNAL Kai_u32 kai__classify_fraction(Kai_string source, Kai_u32 i)
+{
+    if ((i<source.count&&(source.data)[i]==46)&&!(((i+1)<(source.count))&&(((source.data)[i+1])==46)))
+    {
+        i += 1;
+        while ((i<source.count&&(source.data)[i]>=48)&&(source.data)[i]<=57)
+            i += 1;
+    }
+    if (i<source.count&&((source.data)[i]==101||(source.data)[i]==69))
+    {
+        i += 1;
+        if (i<source.count&&(source.data)[i]==45)
+            i += 1;
+        if (i<source.count&&(source.data)[i]==43)
+            i += 1;
+        while ((i<source.count&&(source.data)[i]>=48)&&(source.data)[i]<=57)
+            i += 1;
+    }
+    return i;
+}
+
+KAI_INTERNAL Kai_u32 kai__classify_comment(Kai_string source, Kai_u32 i, Kai_u32 end, Kai_u32* depth)
+{
+    while (*depth>0)
+    {
+        i = kai_intrinsics_find_any4(source.data, i, end, 47, 42, 47, 42);
+        if (i>=end)
+            break;
+        if ((i+1<source.count&&(source.data)[i]==47)&&(source.data)[i+1]==42)
         {
-            expr->tag = kai__parser_create_tag(parser, token, tag_expr);
-            tag = expr->tag;
+            *depth += 1;
+            i += 2;
         }
         else
+        if ((i+1<source.count&&(source.data)[i]==42)&&(source.data)[i+1]==47)
         {
-            tag->next = kai__parser_create_tag(parser, token, tag_expr);
-            tag = tag->next;
+            *depth -= 1;
+            i += 2;
         }
+        else
+            i += 1;
     }
-    return expr;
+    return i;
 }
 
-KAI_INTERNAL Kai_bool kai__is_procedure_next(Kai_Parser* parser)
+KAI_INTERNAL Kai_u32 kai__classify_string(Kai_string source, Kai_u32 i, Kai_u32 end, Kai_bool* in_string)
 {
-    Kai_Token* peeked = kai__peek_token();
-    if (peeked->id==41)
-        return KAI_TRUE;
-    Kai_Tokenizer state = parser->tokenizer;
-    Kai_Token* current = kai__next_token();
-    Kai_bool found = KAI_FALSE;
-    while (current->id!=KAI_TOKEN_END&&current->id!=41)
+    while (i<end)
     {
-        if (current->id==58)
-        {
-            found = KAI_TRUE;
+        i = kai_intrinsics_find_any4(source.data, i, end, 34, 92, 34, 92);
+        if (i>=end)
             break;
+        if ((source.data)[i]==34)
+        {
+            *in_string = KAI_FALSE;
+            return i+1;
         }
-        kai__next_token();
+        i += 2;
     }
-    parser->tokenizer = state;
-    return found;
+    if (i>source.count)
+        return source.count;
+    return i;
 }
 
-KAI_API(Kai_Expr*) kai_parse_expression(Kai_Parser* parser, Kai_u32 flags)
+KAI_API(Kai_u32) kai_tokenize_classify(Kai_string source, Kai_u32 end, Kai_Classify_State* state, Kai_Token_Run* runs, Kai_u32 capacity)
 {
-    Kai_Expr* left = 0;
-    Kai_Token* current = &((parser->tokenizer).current_token);
-    switch (current->id)
+    if (end>source.count)
+        end = source.count;
+    Kai_Tokenizer symbols = {0};
+    symbols.source = source;
+    Kai_Token symbol = {0};
+    Kai_u32 cursor = state->offset;
+    Kai_u32 depth = state->comment_depth;
+    Kai_bool in_string = state->in_string;
+    Kai_u32 count = 0;
+    while (count<capacity&&cursor<end)
     {
-        break; case KAI_TOKEN_IDENTIFIER:
-        left = kai__parser_create_identifier(parser, *current);
-        break; case KAI_TOKEN_NUMBER:
-        left = kai__parser_create_number(parser, *current);
-        break; case KAI_TOKEN_STRING:
-        left = kai__parser_create_string(parser, *current);
-        break; case KAI_TOKEN_true:
-        left = kai__parser_create_special(parser, *current, KAI_SPECIAL_TRUE);
-        break; case KAI_TOKEN_false:
-        left = kai__parser_create_special(parser, *current, KAI_SPECIAL_FALSE);
-        break; case KAI_TOKEN_null:
-        left = kai__parser_create_special(parser, *current, KAI_SPECIAL_NULL);
-        break; case 40:
+        Kai_u32 start = cursor;
+        Kai_u8 kind = KAI_TOKEN_CLASS_SYMBOL;
+        if (depth!=0)
         {
-            kai_tokenizer_next(&(parser->tokenizer));
-            left = kai_parse_expression(parser, KAI_TOP_PRECEDENCE);
-            kai__expect(left!=NULL, "in expression", "should be an expression here");
-            kai_tokenizer_next(&(parser->tokenizer));
-            kai__expect(current->id==41, "in expression", "should be an operator or ')' here");
+            kind = KAI_TOKEN_CLASS_COMMENT;
+            cursor = kai__classify_comment(source, cursor, end, &depth);
         }
-        break; case 91:
+        else
+        if (in_string)
         {
-            Kai_Token* peeked = kai__peek_token();
-            if ((peeked->id==93||peeked->id==11822)||peeked->id==KAI_TOKEN_NUMBER)
-            {
-                left = kai_parse_type_expression(parser);
-            }
-            else
-            {
-                Kai_Token op_token = *current;
-                kai__next_token();
-                left = kai_parse_expression(parser, KAI_TOP_PRECEDENCE);
-                kai__expect(left, "in dereference expression", "should be an expression here");
-                kai__next_token();
-                kai__expect(current->id==93, "in dereference expression", "should be an operator or ']' here");
-                left = kai__parser_create_unary(parser, op_token, left);
-            }
+            kind = KAI_TOKEN_CLASS_STRING;
+            cursor = kai__classify_string(source, cursor, end, &in_string);
         }
-        break; case 123:
+        else
         {
-            Kai_Token token = *current;
-            Kai_Expr_List body = {0};
-            Kai_u32 count = {0};
-            kai__next_token();
-            while (current->id!=125)
+            Kai_u8 ch = (source.data)[cursor];
+            Kai_u32 where = 0;
+            if (!(ch&128))
+                where = kai__token_lookup_table[ch];
+            switch (where)
             {
-                Kai_Token token = *current;
-                Kai_string name = {0};
-                Kai_Token* peeked = kai__peek_token();
-                if (token.id==KAI_TOKEN_IDENTIFIER&&peeked->id==61)
+                break; case KAI__W:
                 {
-                    name = token.string;
-                    kai__next_token();
-                    kai__next_token();
+                    cursor += 1;
+                    if (((cursor<end&&(source.data)[cursor]<=32)&&(source.data)[cursor]!=10)&&(source.data)[cursor]!=13)
+                        cursor = kai_intrinsics_skip_whitespace(source.data, cursor+1, end);
+                    continue;
                 }
-                Kai_Expr* expr = kai_parse_expression(parser, KAI_TOP_PRECEDENCE);
-                kai__expect(expr!=NULL, "in literal expression", "should be an expression here");
-                expr->name = name;
-                kai__next_token();
-                if (current->id==44)
-                    kai__next_token();
-                else
-                    kai__expect(current->id==125, "in literal expression", "should be '}' or ',' here");
-                kai__linked_list_append(body, expr);
-                count += 1;
-            }
-            kai__expect(current->id==125, "in literal expression", "should be a '}' here");
-            return kai__parser_create_literal(parser, token, body.head, count);
-        }
-        break; case 46:
-        /* fall through */
-        case 126:
-        /* fall through */
-        case 33:
-        /* fall through */
-        case 45:
-        /* fall through */
-        case 43:
-        /* fall through */
-        case 42:
-        {
-            Kai_Token op_token = *current;
-            kai__next_token();
-            left = kai_parse_expression(parser, KAI__PREC_UNARY);
-            kai__expect(left, "in unary expression", "should be an expression here");
-            left = kai__parser_create_unary(parser, op_token, left);
-        }
-        break; case KAI_TOKEN_cast:
-        {
-            Kai_Token token = *current;
-            token.id = 15917;
-            kai__next_token();
-            Kai_Expr* type = 0;
-            if (current->id==40)
-            {
-                kai__next_token();
-                type = kai_parse_type_expression(parser);
-                kai__expect(type, "in cast expression", "should be a type expression here");
-                kai__next_token();
-                kai__expect(current->id==41, "in cast expression", "expected ')' here");
-                kai__next_token();
-            }
-            Kai_Expr* expr = kai_parse_expression(parser, KAI__PREC_CAST);
-            kai__expect(expr, "in expression", "should be expression here");
-            if (type==NULL)
-                left = kai__parser_create_unary(parser, token, expr);
-            else
-                left = kai__parser_create_binary(parser, expr, type, token.id);
-        }
-        break; case KAI_TOKEN_DIRECTIVE:
-        {
-            if (kai_string_equals((current->value).string, KAI_STRING("size")))
-            {
-                left = kai__parser_create_special(parser, *current, KAI_SPECIAL_EVAL_SIZE);
-            }
-            else
-            if (kai_string_equals((current->value).string, KAI_STRING("type")))
-            {
-                left = kai__parser_create_special(parser, *current, KAI_SPECIAL_EVAL_TYPE);
-            }
-            else
-            if (kai_string_equals((current->value).string, KAI_STRING("Type")))
-            {
-                return kai__parser_create_special(parser, *current, KAI_SPECIAL_TYPE);
-            }
-            else
-            if (kai_string_equals((current->value).string, KAI_STRING("Number")))
-            {
-                return kai__parser_create_special(parser, *current, KAI_SPECIAL_NUMBER);
-            }
-            else
-            if (kai_string_equals((current->value).string, KAI_STRING("Code")))
-            {
-                return kai__parser_create_special(parser, *current, KAI_SPECIAL_CODE);
-            }
-            else
-            if (kai_string_equals((current->value).string, KAI_STRING("import")))
-            {
-                Kai_Token token = *current;
-                kai__next_token();
-                kai__expect(current->id==KAI_TOKEN_STRING, "in import", "string");
-                left = kai__parser_create_import(parser, token, *current);
-            }
-            else
-            if (kai_string_equals((current->value).string, KAI_STRING("through")))
-            {
-                left = kai__parser_create_control(parser, *current, KAI_CONTROL_THROUGH, NULL);
-            }
-            else
-            if (kai_string_equals((current->value).string, KAI_STRING("char")))
-            {
-                kai__next_token();
-                kai__expect(current->id==KAI_TOKEN_STRING, "in character literal", "expected a string here");
-                Kai_u32 cp = {0};
-                if (((current->value).string).count>kai__utf8_decode((current->value).string, &cp))
+                break; case KAI__N:
                 {
-                    return kai__error_unexpected(parser, current, KAI_STRING("in character literal"), KAI_STRING("string must be a single codepoint"));
+                    kind = KAI_TOKEN_CLASS_NUMBER;
+                    cursor += 1;
+                    Kai_u32 base = 10;
+                    if (ch==48&&cursor<source.count)
+                    {
+                        if ((source.data)[cursor]==98)
+                            base = 2;
+                        if ((source.data)[cursor]==120)
+                            base = 16;
+                    }
+                    if (base!=10)
+                    {
+                        cursor = kai__classify_digits(source, cursor+1, base);
+                    }
+                    else
+                        cursor = kai__classify_fraction(source, kai__classify_digits(source, cursor, 10));
                 }
-                (current->value).number = kai_number_normalize(((Kai_Number){.n = (Kai_u64)(cp), .d = 1}));
-                left = kai__parser_create_number(parser, *current);
-            }
-            else
-            if (kai_string_equals((current->value).string, KAI_STRING("multi")))
-            {
-                kai__next_token();
-                kai__expect(current->id==KAI_TOKEN_STRING, "multi", "must be string");
-                kai__expect(((current->value).string).count>0, "multi", "string cannot be empty");
-                Kai_Number value = ((Kai_Number){0});
-                Kai_Number base = ((Kai_Number){.n = 1, .d = 1, .e = 8});
-                for (Kai_u32 i = 0; i < ((current->value).string).count; ++i)
+                break; case 0:
                 {
-                    Kai_u32 idx = (((current->value).string).count-1)-i;
-                    Kai_Number dg = kai_number_normalize(((Kai_Number){.n = (((current->value).string).data)[idx], .d = 1}));
-                    value = kai_number_add(kai_number_mul(value, base), dg);
+                    kind = KAI_TOKEN_CLASS_IDENTIFIER;
+                    cursor = kai_intrinsics_skip_identifier(source.data, cursor+1, source.count);
+                }
+                break; case KAI__K:
+                {
+                    kind = KAI_TOKEN_CLASS_IDENTIFIER;
+                    cursor = kai_intrinsics_skip_identifier(source.data, cursor+1, source.count);
+                    Kai_string name = ((Kai_string){.count = cursor-start, .data = source.data+start});
+                    if (kai_string_equals(kai__keywords[kai__string_to_keyword_index(name)], name))
+                        kind = KAI_TOKEN_CLASS_KEYWORD;
+                }
+                break; case KAI__S:
+                {
+                    kind = KAI_TOKEN_CLASS_STRING;
+                    in_string = KAI_TRUE;
+                    cursor = kai__classify_string(source, cursor+1, end, &in_string);
+                }
+                break; case KAI__D:
+                {
+                    kind = KAI_TOKEN_CLASS_DIRECTIVE;
+                    cursor = kai_intrinsics_skip_identifier(source.data, cursor+1, source.count);
+                }
+                break; case KAI__G:
+                {
+                    kind = KAI_TOKEN_CLASS_TAG;
+                    cursor = kai_intrinsics_skip_identifier(source.data, cursor+1, source.count);
+                }
+                break; case KAI__C:
+                {
+                    Kai_u8 next = 0;
+                    if (cursor+1<source.count)
+                        next = (source.data)[cursor+1];
+                    if (next==47)
+                    {
+                        kind = KAI_TOKEN_CLASS_COMMENT;
+                        cursor = kai_intrinsics_find_any4(source.data, cursor+1, source.count, 13, 10, 13, 10);
+                    }
+                    else
+                    if (next==42)
+                    {
+                        kind = KAI_TOKEN_CLASS_COMMENT;
+                        depth = 1;
+                        cursor = kai__classify_comment(source, cursor+2, end, &depth);
+                    }
+                    else
+                    {
+                        symbols.cursor = cursor+1;
+                        if (kai__make_multi_token(&symbols, &symbol, ch))
+                            symbols.cursor += 1;
+                        cursor = symbols.cursor;
+                    }
+                }
+                break; case KAI__Z:
+                {
+                    cursor += 1;
+                    if (cursor<source.count&&(source.data)[cursor]==46)
+                    {
+                        cursor += 1;
+                    }
+                    else
+                    if ((cursor<source.count&&(source.data)[cursor]>=48)&&(source.data)[cursor]<=57)
+                    {
+                        kind = KAI_TOKEN_CLASS_NUMBER;
+                        cursor = kai__classify_fraction(source, start);
+                    }
+                }
+                break; default:
+                {
+                    symbols.cursor = cursor+1;
+                    if (kai__make_multi_token(&symbols, &symbol, ch))
+                        symbols.cursor += 1;
+                    cursor = symbols.cursor;
                 }
-                (current->value).number = value;
-                left = kai__parser_create_number(parser, *current);
-            }
-            else
-            if ((kai_string_equals((current->value).string, KAI_STRING("array"))||kai_string_equals((current->value).string, KAI_STRING("map")))||kai_string_equals((current->value).string, KAI_STRING("proc")))
-            {
-                kai__next_token();
-                left = kai_parse_type_expression(parser);
-            }
-            else
-            if (kai_string_equals((current->value).string, KAI_STRING("Julie")))
-            {
-                (current->value).string = KAI_STRING("<3");
-                left = kai__parser_create_string(parser, *current);
             }
-            else
-                return kai__unexpected("in expression", "unknown directive");
         }
-        break; case KAI_TOKEN_union:
-        /* fall through */
-        case KAI_TOKEN_struct:
-        {
-            Kai_Token struct_token = *current;
-            Kai_Stmt_List body = {0};
-            Kai_u32 count = {0};
-            kai__next_token();
-            kai__expect(current->id==123, "in struct", "should be '{' here");
-            kai__next_token();
-            while (current->id!=125)
-            {
-                Kai_Stmt* stmt = kai_parse_statement(parser);
-                kai__expect(stmt, "in struct definition", "expected a statement here");
-                kai__linked_list_append(body, stmt);
-                kai__next_token();
-                count += 1;
-            }
-            left = kai__parser_create_struct(parser, struct_token, count, body.head);
-            if (struct_token.id==KAI_TOKEN_union)
-                left->flags |= KAI_FLAG_STRUCT_UNION;
-        }
-        break; case KAI_TOKEN_enum:
-        {
-            Kai_Token enum_token = *current;
-            kai__next_token();
-            kai__expect(current->id!=123, "in enum", "All enums must be given a sized integer type");
-            Kai_Expr* type = kai_parse_type_expression(parser);
-            kai__expect(type, "in enum type", "expected a type expression here");
-            kai__next_token();
-            Kai_Expr_List body = {0};
-            Kai_u32 count = {0};
-            kai__expect(type, "in enum expression", "should be '{' here");
-            kai__next_token();
-            while (current->id!=125)
-            {
-                Kai_Token token = *current;
-                kai__expect(token.id==KAI_TOKEN_IDENTIFIER, "in enum expression", "should be an identifier here");
-                Kai_Expr_Flags flags = 0;
-                Kai_string name = token.string;
-                Kai_Token* peeked = kai__peek_token();
-                if (peeked->id==61)
-                {
-                    kai__next_token();
-                    kai__next_token();
-                }
-                else
-                if (peeked->id==44||peeked->id==59)
-                {
-                    flags |= KAI_FLAG_ENUM_NO_VALUE;
-                }
-                else
-                {
-                    return kai__error_unexpected(parser, peeked, KAI_STRING("in enum expression"), KAI_STRING("should be a ',' or ';' here"));
-                }
-                Kai_Expr* expr = kai_parse_expression(parser, KAI_TOP_PRECEDENCE);
-                kai__expect(expr!=NULL, "in enum expression", "should be an expression here");
-                expr->flags = flags;
-                expr->name = name;
-                kai__next_token();
-                if (current->id==44||peeked->id==59)
-                {
-                    kai_parse_tag_to_expr(parser, expr);
-                    kai__next_token();
-                }
-                else
-                    kai__expect(current->id==125, "in enum expression", "should be '}' ',' or ';' here");
-                kai__linked_list_append(body, expr);
-                count += 1;
-            }
-            kai__expect(current->id==125, "in enum expression", "should be a '}' here");
-            left = kai__parser_create_enum(parser, enum_token, type, count, body.head);
-        }
-        break; default:
-        return NULL;
+        Kai_Token_Run* run = runs+count;
+        run->offset = start;
+        run->length = cursor-start;
+        run->kind = kind;
+        count += 1;
     }
-    Kai_Token* peeked = kai_tokenizer_peek(&(parser->tokenizer));
-    Kai__Operator op_info = kai__operator_info(peeked->id);
-    Kai_u32 prec = flags&KAI_PRECEDENCE_MASK;
-    while (op_info.prec!=0&&op_info.prec>prec)
+    state->offset = cursor;
+    state->comment_depth = depth;
+    state->in_string = in_string;
+    return count;
+}
+
+KAI_INTERNAL void* kai__parser_allocate(Kai_Parser* parser, Kai_u32 size)
+{
+    void* node = kai_arena_allocate(&(parser->arena), size);
+    if (parser->reused)
+        kai__memory_zero(node, size);
+    return node;
+}
+
+KAI_INTERNAL void kai__set_atom(Kai_Parser* parser, Kai_u32* dst, Kai_u32 atom)
+{
+    *dst = atom;
+    if (parser->atom_refs!=NULL&&atom!=0)
     {
-        Kai_u32 op = peeked->id;
-        if (op==15677)
-        {
-            Kai_Tokenizer prev_state = parser->tokenizer;
-            kai_tokenizer_next(&(parser->tokenizer));
-            kai_tokenizer_next(&(parser->tokenizer));
-            if (current->id==123)
-            {
-                parser->tokenizer = prev_state;
-                return left;
-            }
-        }
-        else
-        {
-            kai_tokenizer_next(&(parser->tokenizer));
-            kai_tokenizer_next(&(parser->tokenizer));
-        }
-        switch (op_info.type)
-        {
-            break; case KAI__OPERATOR_TYPE_BINARY:
-            {
-                Kai_Expr* right = kai_parse_expression(parser, op_info.prec);
-                kai__expect(right!=NULL, "in binary expression", "should be an expression after binary operator");
-                left = kai__parser_create_binary(parser, left, right, op);
-            }
-            break; case KAI__OPERATOR_TYPE_INDEX:
-            {
-                Kai_Expr* right = kai_parse_expression(parser, KAI_TOP_PRECEDENCE);
-                kai__expect(right, "in index operation", "should be an expression here");
-                kai__next_token();
-                kai__expect(current->id==93, "in index operation", "expected ']' here");
-                left = kai__parser_create_binary(parser, left, right, op);
-            }
-            break; case KAI__OPERATOR_TYPE_PROCEDURE_CALL:
-            {
-                Kai_u32 arg_count = {0};
-                Kai_Expr* args = kai_parse_procedure_call_arguments(parser, &arg_count);
-                left = kai__parser_create_procedure_call(parser, left, args, (Kai_u8)(arg_count));
-            }
-        }
-        kai_tokenizer_peek(&(parser->tokenizer));
-        op_info = kai__operator_info(peeked->id);
+        Kai_Allocator* allocator = &((parser->arena).base);
+        kai_array_push(parser->atom_refs, dst);
     }
-    return left;
 }
 
-KAI_API(Kai_Expr*) kai_parse_type_expression(Kai_Parser* parser)
+KAI_INTERNAL Kai_Expr* kai__error_unexpected(Kai_Parser* parser, Kai_Token* token, Kai_string where, Kai_string wanted)
 {
-    Kai_Token* current = &((parser->tokenizer).current_token);
-    switch (current->id)
+    if ((parser->error)->result!=KAI_SUCCESS)
+        return NULL;
+    Kai_Buffer buffer = ((Kai_Buffer){.allocator = (parser->arena).base});
+    Kai_u8 temp[32] = {0};
+    Kai_string temp_string = ((Kai_string){.count = sizeof(temp), .data = temp});
+    kai__buffer_append_string(&buffer, KAI_STRING("unexpected "));
+    kai__buffer_append_string(&buffer, kai_token_string(token->id, temp_string));
+    kai__buffer_append_string(&buffer, KAI_STRING(" "));
+    kai__buffer_append_string(&buffer, where);
+    Kai_Range message = kai__buffer_end(&buffer);
+    Kai_Memory memory = kai__buffer_done(&buffer);
+    *(parser->error) = ((Kai_Error){.result = KAI_ERROR_SYNTAX, .location = ((Kai_Location){.string = token->string, .line = kai_source_line(&(parser->source), token->offset)}), .message = kai__range_to_string(message, memory), .context = wanted, .memory = memory});
+    return NULL;
+}
+
+KAI_INTERNAL Kai__Operator kai__operator_info(Kai_u32 op)
+{
+    switch (op)
     {
-        break; case 91:
-        {
-            Kai_Token op_token = *current;
-            kai__next_token();
-            Kai_Expr* rows = 0;
-            Kai_Expr* cols = 0;
-            Kai_u8 expr_flags = {0};
-            if (current->id==11822)
-            {
-                kai__next_token();
-                expr_flags |= KAI_FLAG_ARRAY_DYNAMIC;
-            }
-            else
-            if (current->id!=93)
-            {
-                rows = kai_parse_expression(parser, KAI_TOP_PRECEDENCE);
-                kai__expect(rows, "in array type", "[todo]");
-                kai__next_token();
-                if (current->id==44)
-                {
-                    kai__next_token();
-                    cols = kai_parse_expression(parser, KAI_TOP_PRECEDENCE);
-                    kai__expect(cols, "in array type", "[todo]");
-                    kai__next_token();
-                }
-            }
-            kai__expect(current->id==93, "in array type", "array");
-            kai__next_token();
-            Kai_Expr* type = kai_parse_type_expression(parser);
-            kai__expect(type, "in array type", "expected type here");
-            return kai__parser_create_array(parser, op_token, type, rows, cols, expr_flags);
-        }
+        break; case 31868:
+        return ((Kai__Operator){16, KAI__OPERATOR_TYPE_BINARY});
+        break; case 9766:
+        return ((Kai__Operator){17, KAI__OPERATOR_TYPE_BINARY});
+        break; case 15676:
+        return ((Kai__Operator){64, KAI__OPERATOR_TYPE_BINARY});
+        break; case 15678:
+        return ((Kai__Operator){64, KAI__OPERATOR_TYPE_BINARY});
+        break; case 60:
+        return ((Kai__Operator){64, KAI__OPERATOR_TYPE_BINARY});
+        break; case 62:
+        return ((Kai__Operator){64, KAI__OPERATOR_TYPE_BINARY});
+        break; case 15677:
+        return ((Kai__Operator){80, KAI__OPERATOR_TYPE_BINARY});
+        break; case 15649:
+        return ((Kai__Operator){80, KAI__OPERATOR_TYPE_BINARY});
+        break; case 124:
+        return ((Kai__Operator){112, KAI__OPERATOR_TYPE_BINARY});
+        break; case 94:
+        return ((Kai__Operator){112, KAI__OPERATOR_TYPE_BINARY});
+        break; case 38:
+        return ((Kai__Operator){112, KAI__OPERATOR_TYPE_BINARY});
+        break; case 15420:
+        return ((Kai__Operator){128, KAI__OPERATOR_TYPE_BINARY});
+        break; case 15934:
+        return ((Kai__Operator){128, KAI__OPERATOR_TYPE_BINARY});
+        break; case 43:
+        return ((Kai__Operator){256, KAI__OPERATOR_TYPE_BINARY});
+        break; case 45:
+        return ((Kai__Operator){256, KAI__OPERATOR_TYPE_BINARY});
         break; case 42:
-        {
-            Kai_Token op_token = *current;
-            kai__next_token();
-            Kai_Expr* expr = kai_parse_type_expression(parser);
-            kai__expect(expr, "in unary expression", "should be an expression here");
-            return kai__parser_create_unary(parser, op_token, expr);
-        }
+        return ((Kai__Operator){512, KAI__OPERATOR_TYPE_BINARY});
+        break; case 47:
+        return ((Kai__Operator){512, KAI__OPERATOR_TYPE_BINARY});
+        break; case 37:
+        return ((Kai__Operator){512, KAI__OPERATOR_TYPE_BINARY});
+        break; case 46:
+        return ((Kai__Operator){65535, KAI__OPERATOR_TYPE_BINARY});
+        break; case 15917:
+        return ((Kai__Operator){KAI__PREC_CAST, KAI__OPERATOR_TYPE_BINARY});
+        break; case 91:
+        return ((Kai__Operator){48879, KAI__OPERATOR_TYPE_INDEX});
+        break; case 40:
+        return ((Kai__Operator){48879, KAI__OPERATOR_TYPE_PROCEDURE_CALL});
+        break; default:
+        return ((Kai__Operator){0});
     }
-    if (current->id!=40)
-        return kai_parse_expression(parser, KAI_TOP_PRECEDENCE);
-    kai__next_token();
-    Kai_u8 in_count = {0};
-    Kai_u8 out_count = {0};
-    Kai_Expr_List in_out = {0};
-    while (current->id!=41)
+}
+
+KAI_INTERNAL Kai_Expr* kai__parser_create_identifier(Kai_Parser* parser, Kai_Token token)
+{
+    Kai_Expr* node = ((Kai_Expr*)kai__parser_allocate(parser, sizeof(Kai_Expr)));
+    node->id = KAI_EXPR_IDENTIFIER;
+    node->source_code = token.string;
+    node->offset = token.offset;
+    kai__set_atom(parser, &(node->atom), token.atom);
+    return kai_parse_tag_to_expr(parser, (Kai_Expr*)(node));
+}
+
+KAI_INTERNAL Kai_Expr* kai__parser_create_string(Kai_Parser* parser, Kai_Token token)
+{
+    Kai_Expr_String* node = ((Kai_Expr_String*)kai__parser_allocate(parser, sizeof(Kai_Expr_String)));
+    node->id = KAI_EXPR_STRING;
+    node->source_code = token.string;
+    node->offset = token.offset;
+    node->value = (token.value).string;
+    Kai_u8* source_end = ((parser->tokenizer).source).data+((parser->tokenizer).source).count;
+    if (((parser->tokenizer).tokens!=NULL&&(node->value).count!=0)&&((node->value).data<((parser->tokenizer).source).data||(node->value).data>=source_end))
     {
-        Kai_string name = {0};
-        if (current->id==KAI_TOKEN_IDENTIFIER)
-        {
-            Kai_Token* peeked = kai__peek_token();
-            if (peeked->id==58)
-            {
-                name = current->string;
-                kai__next_token();
-                kai__next_token();
-            }
-        }
-        Kai_Expr* type = kai_parse_type_expression(parser);
-        kai__expect(type, "in procedure type", "should be a type here");
-        type->name = name;
-        kai__linked_list_append(in_out, type);
-        kai__expect(in_count!=255, "in procedure type", "too many inputs to procedure");
-        in_count += 1;
-        kai__next_token();
-        if (current->id==44)
-            kai__next_token();
-        else
-        if (current->id!=41)
-            return kai__unexpected("in procedure type", "',' or ')' expected here");
-    }
-    Kai_Token* peek = kai__peek_token();
-    if (peek->id==15917)
-    {
-        kai__next_token();
-        kai__next_token();
-        Kai_bool enclosed_return = KAI_FALSE;
-        if (current->id==40)
-        {
-            enclosed_return = KAI_TRUE;
-            kai__next_token();
-        }
-        while (current->id!=41)
-        {
-            Kai_Expr* type = kai_parse_type_expression(parser);
-            if (!type)
-                return NULL;
-            kai__linked_list_append(in_out, type);
-            kai__expect(out_count!=255, "in procedure type", "too many inputs to procedure");
-            out_count += 1;
-            kai__peek_token();
-            if (peek->id==44)
-            {
-                kai__next_token();
-                kai__next_token();
-            }
-            else
-                break;
-        }
-        if (enclosed_return)
-        {
-            if (peek->id!=41)
-            {
-                kai__next_token();
-                return kai__unexpected("in procedure type", "should be ')' after return types");
-            }
-            else
-                kai__next_token();
-        }
+        Kai_u8* data = ((Kai_u8*)kai_arena_allocate(&(parser->arena), (Kai_u32)(kai__ceil_div((node->value).count, 8))*8));
+        kai__memory_copy(data, (node->value).data, (node->value).count);
+        (node->value).data = data;
     }
-    return kai__parser_create_procedure_type(parser, in_out.head, in_count, out_count);
+    return (Kai_Expr*)(node);
 }
 
-KAI_API(Kai_Expr*) kai_parse_procedure(Kai_Parser* parser)
+KAI_INTERNAL Kai_Expr* kai__parser_create_number(Kai_Parser* parser, Kai_Token token)
 {
-    Kai_Token* current = &((parser->tokenizer).current_token);
-    Kai_Token token = *current;
-    kai__expect(current->id==40, "", "this is likely a compiler bug, sorry :c");
-    kai__next_token();
-    Kai_u8 in_count = {0};
-    Kai_u8 out_count = {0};
-    Kai_Expr_List in_out = {0};
-    while (current->id!=41)
-    {
-        Kai_u8 flags = {0};
-        if (current->id==KAI_TOKEN_using)
-        {
-            flags |= KAI_FLAG_PROC_USING;
-            kai__next_token();
-        }
-        kai__expect(current->id==KAI_TOKEN_IDENTIFIER, "in procedure input", "should be an identifier");
-        Kai_string name = current->string;
-        kai__next_token();
-        kai__expect(current->id==58, "in procedure input", "wanted a ':' here");
-        kai__next_token();
-        Kai_Expr* type = kai_parse_type_expression(parser);
-        kai__expect(type, "in procedure input", "should be type");
-        type->name = name;
-        type->flags = flags;
-        kai__linked_list_append(in_out, type);
-        kai__expect(in_count!=255, "in procedure call", "too many inputs to procedure");
-        in_count += 1;
-        kai__next_token();
-        switch (current->id)
-        {
-            break; case 41:
-            break; case 44:
-            kai__next_token();
-            break; default:
-            return kai__unexpected("in procedure input", "wanted ')' or ',' here");
-        }
-    }
-    kai__next_token();
-    if (current->id==15917)
-    {
-        kai__next_token();
-        Kai_Expr* type = kai_parse_type_expression(parser);
-        kai__expect(type, "in procedure return type", "should be type");
-        kai__linked_list_append(in_out, type);
-        kai__expect(out_count!=255, "in procedure call", "too many inputs to procedure");
-        out_count += 1;
-        kai__next_token();
-    }
-    Kai_Stmt* body = 0;
-    if (current->id==KAI_TOKEN_DIRECTIVE&&kai_string_equals(KAI_STRING("host"), current->string))
-    {
-        kai__next_token();
-        kai__expect(current->id==59, "???", "???");
-    }
-    else
-    {
-        body = kai_parse_statement(parser);
-        if (!body)
-            return kai__unexpected("[todo: remove this]", "");
-    }
-    return kai__parser_create_procedure(parser, token, in_out.head, body, in_count, out_count);
+    Kai_Expr_Number* node = ((Kai_Expr_Number*)kai__parser_allocate(parser, sizeof(Kai_Expr_Number)));
+    node->id = KAI_EXPR_NUMBER;
+    node->source_code = token.string;
+    node->offset = token.offset;
+    node->value = (token.value).number;
+    return kai_parse_tag_to_expr(parser, (Kai_Expr*)(node));
 }
 
-KAI_API(Kai_Stmt*) kai_parse_declaration(Kai_Parser* parser)
+KAI_INTERNAL Kai_Expr* kai__parser_create_literal(Kai_Parser* parser, Kai_Token token, Kai_Expr* head, Kai_u32 count)
 {
-    Kai_Token* current = &((parser->tokenizer).current_token);
-    if (current->id==KAI_TOKEN_DIRECTIVE)
-        return kai_parse_statement(parser);
-    if (current->id!=KAI_TOKEN_IDENTIFIER)
-        return kai__unexpected("in declaration", "expected an identifier");
-    Kai_string name = current->string;
-    Kai_u32 line_number = current->line_number;
-    kai__next_token();
-    if (current->id!=58)
-        return kai__unexpected("in declaration", "expected ':' here");
-    kai__next_token();
-    Kai_u8 flags = 0;
-    Kai_Expr* type = kai_parse_type_expression(parser);
-    if (type)
-        kai__next_token();
-    Kai_Expr* expr = 0;
-    switch (current->id)
-    {
-        break; case 58:
-        flags |= KAI_FLAG_DECL_CONST;
-        break; case 61:
-        break; case 59:
-        kai__expect(type!=NULL, "in declaration", "should be '=', ':', or expression here");
-        return kai__parser_create_declaration(parser, name, type, expr, flags, line_number);
-        break; default:
-        return kai__unexpected("in declaration", "should be '=', ':', or ';'");
-    }
-    kai__next_token();
-    Kai_bool require_semicolon = KAI_FALSE;
-    if (current->id==KAI_TOKEN_DIRECTIVE&&kai_string_equals((current->value).string, KAI_STRING("host_import")))
-    {
-        flags |= KAI_FLAG_DECL_HOST_IMPORT;
-        require_semicolon = KAI_TRUE;
-    }
-    else
-    if (current->id==40&&kai__is_procedure_next(parser))
-    {
-        expr = kai_parse_procedure(parser);
-        if (!expr)
-            return kai__unexpected("[todo]", "[todo]");
-    }
-    else
-    {
-        require_semicolon = KAI_TRUE;
-        if ((current->id==KAI_TOKEN_struct||current->id==KAI_TOKEN_union)||current->id==KAI_TOKEN_enum)
-            require_semicolon = KAI_FALSE;
-        expr = kai_parse_expression(parser, KAI_TOP_PRECEDENCE);
-        kai__expect(expr, "in declaration", "should be an expression here");
-    }
-    if (require_semicolon)
-    {
-        kai__next_token();
-        kai__expect(current->id==59, "after declaration", "there should be a ';' before this");
-    }
-    else
+    Kai_Expr_Literal* node = ((Kai_Expr_Literal*)kai__parser_allocate(parser, sizeof(Kai_Expr_Literal)));
+    node->id = KAI_EXPR_LITERAL;
+    node->source_code = token.string;
+    node->offset = token.offset;
+    node->head = head;
+    node->count = count;
+    return (Kai_Expr*)(node);
+}
+
+KAI_INTERNAL Kai_Expr* kai__parser_create_unary(Kai_Parser* parser, Kai_Token op_token, Kai_Expr* expr)
+{
+    Kai_Expr_Unary* node = ((Kai_Expr_Unary*)kai__parser_allocate(parser, sizeof(Kai_Expr_Unary)));
+    node->id = KAI_EXPR_UNARY;
+    node->source_code = kai_merge_strings(op_token.string, expr->source_code);
+    node->offset = kai__min_u32(op_token.offset, expr->offset);
+    node->op = op_token.id;
+    node->expr = expr;
+    return (Kai_Expr*)(node);
+}
+
+KAI_INTERNAL Kai_Expr* kai__parser_create_binary(Kai_Parser* parser, Kai_Expr* left, Kai_Expr* right, Kai_u32 op)
+{
+    Kai_Expr_Binary* node = ((Kai_Expr_Binary*)kai__parser_allocate(parser, sizeof(Kai_Expr_Binary)));
+    node->id = KAI_EXPR_BINARY;
+    node->source_code = kai_merge_strings(left->source_code, right->source_code);
+    node->offset = kai__min_u32(left->offset, right->offset);
+    node->op = op;
+    node->left = left;
+    node->right = right;
+    return (Kai_Expr*)(node);
+}
+
+KAI_INTERNAL Kai_Expr* kai__parser_create_array(Kai_Parser* parser, Kai_Token op_token, Kai_Expr* expr, Kai_Expr* rows, Kai_Expr* cols, Kai_u8 flags)
+{
+    Kai_Expr_Array* node = ((Kai_Expr_Array*)kai__parser_allocate(parser, sizeof(Kai_Expr_Array)));
+    node->id = KAI_EXPR_ARRAY;
+    node->source_code = kai_merge_strings(op_token.string, expr->source_code);
+    node->offset = kai__min_u32(op_token.offset, expr->offset);
+    node->flags = flags;
+    node->rows = rows;
+    node->cols = cols;
+    node->expr = expr;
+    return (Kai_Expr*)(node);
+}
+
+KAI_INTERNAL Kai_Expr* kai__parser_create_special(Kai_Parser* parser, Kai_Token token, Kai_u8 kind)
+{
+    Kai_Expr_Special* node = ((Kai_Expr_Special*)kai__parser_allocate(parser, sizeof(Kai_Expr_Special)));
+    node->id = KAI_EXPR_SPECIAL;
+    node->source_code = token.string;
+    node->offset = token.offset;
+    node->kind = kind;
+    return (Kai_Expr*)(node);
+}
+
+KAI_INTERNAL Kai_Expr* kai__parser_create_procedure_type(Kai_Parser* parser, Kai_Expr* in_out, Kai_u8 in_count, Kai_u8 out_count)
+{
+    Kai_Expr_Procedure_Type* node = ((Kai_Expr_Procedure_Type*)kai__parser_allocate(parser, sizeof(Kai_Expr_Procedure_Type)));
+    node->id = KAI_EXPR_PROCEDURE_TYPE;
+    if (in_out!=NULL)
     {
-        Kai_Token* peeked = kai__peek_token();
-        if (peeked->id==59)
-            kai__next_token();
+        node->source_code = in_out->source_code;
+        node->offset = in_out->offset;
     }
-    return kai__parser_create_declaration(parser, name, type, expr, flags, line_number);
+    node->in_out_expr = in_out;
+    node->in_count = in_count;
+    node->out_count = out_count;
+    return (Kai_Expr*)(node);
 }
 
-KAI_API(Kai_Stmt*) kai_parse_statement(Kai_Parser* parser)
+KAI_INTERNAL Kai_Expr* kai__parser_create_procedure_call(Kai_Parser* parser, Kai_Expr* proc, Kai_Expr* args, Kai_u8 arg_count)
 {
-    Kai_Token* current = &((parser->tokenizer).current_token);
-    switch (current->id)
-    {
-        break; case 123:
-        {
-            Kai_Token token = *current;
-            kai__next_token();
-            Kai_Stmt_List body = {0};
-            while (current->id!=125)
-            {
-                Kai_Stmt* statement = kai_parse_statement(parser);
-                if (!statement)
-                    return NULL;
-                kai__linked_list_append(body, statement);
-                kai__next_token();
-            }
-            return kai__parser_create_compound(parser, token, body.head);
-        }
-        break; case KAI_TOKEN_case:
-        /* fall through */
-        case KAI_TOKEN_break:
-        /* fall through */
-        case KAI_TOKEN_continue:
-        /* fall through */
-        case KAI_TOKEN_defer:
-        {
-            Kai_Token token = *current;
+    Kai_Expr_Procedure_Call* node = ((Kai_Expr_Procedure_Call*)kai__parser_allocate(parser, sizeof(Kai_Expr_Procedure_Call)));
+    node->id = KAI_EXPR_PROCEDURE_CALL;
+    node->source_code = proc->source_code;
+    node->offset = proc->offset;
+    node->proc = proc;
+    node->arg_head = args;
+    node->arg_count = arg_count;
+    return (Kai_Expr*)(node);
+}
+
+KAI_INTERNAL Kai_Expr* kai__parser_create_procedure(Kai_Parser* parser, Kai_Token token, Kai_Expr* in_out, Kai_Stmt* body, Kai_u8 in_count, Kai_u8 out_count)
+{
+    Kai_Expr_Procedure* node = ((Kai_Expr_Procedure*)kai__parser_allocate(parser, sizeof(Kai_Expr_Procedure)));
+    node->id = KAI_EXPR_PROCEDURE;
+    node->source_code = token.string;
+    node->offset = token.offset;
+    node->in_out_expr = in_out;
+    node->in_count = in_count;
+    node->out_count = out_count;
+    node->body = body;
+    return (Kai_Expr*)(node);
+}
+
+KAI_INTERNAL Kai_Expr* kai__parser_create_import(Kai_Parser* parser, Kai_Token token, Kai_Token import)
+{
+    Kai_Expr* node = ((Kai_Expr*)kai__parser_allocate(parser, sizeof(Kai_Expr)));
+    node->id = KAI_EXPR_IMPORT;
+    node->source_code = kai_merge_strings(token.string, import.string);
+    node->offset = token.offset;
+    node->name = (import.value).string;
+    if ((parser->tokenizer).atoms!=NULL)
+        kai__set_atom(parser, &(node->name_atom), kai_intern_atom((parser->tokenizer).atoms, node->name));
+    return (Kai_Expr*)(node);
+}
+
+KAI_INTERNAL Kai_Expr* kai__parser_create_struct(Kai_Parser* parser, Kai_Token token, Kai_u32 field_count, Kai_Stmt* body)
+{
+    Kai_Expr_Struct* node = ((Kai_Expr_Struct*)kai__parser_allocate(parser, sizeof(Kai_Expr_Struct)));
+    node->id = KAI_EXPR_STRUCT;
+    node->source_code = token.string;
+    node->offset = token.offset;
+    node->field_count = field_count;
+    node->head = body;
+    return (Kai_Expr*)(node);
+}
+
+KAI_INTERNAL Kai_Expr* kai__parser_create_enum(Kai_Parser* parser, Kai_Token token, Kai_Expr* type, Kai_u32 field_count, Kai_Stmt* body)
+{
+    Kai_Expr_Enum* node = ((Kai_Expr_Enum*)kai__parser_allocate(parser, sizeof(Kai_Expr_Enum)));
+    node->id = KAI_EXPR_ENUM;
+    node->source_code = token.string;
+    node->offset = token.offset;
+    node->type = type;
+    node->field_count = field_count;
+    node->head = body;
+    return (Kai_Expr*)(node);
+}
+
+KAI_INTERNAL Kai_Expr* kai__parser_create_return(Kai_Parser* parser, Kai_Token ret_token, Kai_Expr* expr)
+{
+    Kai_Stmt_Return* node = ((Kai_Stmt_Return*)kai__parser_allocate(parser, sizeof(Kai_Stmt_Return)));
+    node->id = KAI_STMT_RETURN;
+    node->source_code = ret_token.string;
+    node->offset = ret_token.offset;
+    node->expr = expr;
+    return (Kai_Expr*)(node);
+}
+
+KAI_INTERNAL Kai_Expr* kai__parser_create_declaration(Kai_Parser* parser, Kai_string name, Kai_u32 atom, Kai_Expr* type, Kai_Expr* value, Kai_u8 flags, Kai_u32 offset)
+{
+    Kai_Stmt_Declaration* node = ((Kai_Stmt_Declaration*)kai__parser_allocate(parser, sizeof(Kai_Stmt_Declaration)));
+    node->id = KAI_STMT_DECLARATION;
+    node->source_code = name;
+    node->offset = offset;
+    node->name = name;
+    kai__set_atom(parser, &(node->name_atom), atom);
+    node->type = type;
+    node->value = value;
+    node->flags = flags;
+    return kai_parse_tag_to_expr(parser, (Kai_Expr*)(node));
+}
+
+KAI_INTERNAL Kai_Expr* kai__parser_create_assignment(Kai_Parser* parser, Kai_u32 op, Kai_Expr* dest, Kai_Expr* value)
+{
+    Kai_Stmt_Assignment* node = ((Kai_Stmt_Assignment*)kai__parser_allocate(parser, sizeof(Kai_Stmt_Assignment)));
+    node->id = KAI_STMT_ASSIGNMENT;
+    node->source_code = dest->source_code;
+    node->offset = dest->offset;
+    node->op = op;
+    node->dest = dest;
+    node->value = value;
+    return (Kai_Expr*)(node);
+}
+
+KAI_INTERNAL Kai_Expr* kai__parser_create_if(Kai_Parser* parser, Kai_Token if_token, Kai_u8 flags, Kai_Expr* expr, Kai_Stmt* then_body, Kai_Stmt* else_body)
+{
+    Kai_Stmt_If* node = ((Kai_Stmt_If*)kai__parser_allocate(parser, sizeof(Kai_Stmt_If)));
+    node->id = KAI_STMT_IF;
+    node->source_code = if_token.string;
+    node->offset = if_token.offset;
+    node->flags = flags;
+    node->condition = expr;
+    node->then_body = then_body;
+    node->else_body = else_body;
+    return (Kai_Expr*)(node);
+}
+
+KAI_INTERNAL Kai_Expr* kai__parser_create_while(Kai_Parser* parser, Kai_Token while_token, Kai_Expr* expr, Kai_Stmt* body)
+{
+    Kai_Stmt_While* node = ((Kai_Stmt_While*)kai__parser_allocate(parser, sizeof(Kai_Stmt_While)));
+    node->id = KAI_STMT_WHILE;
+    node->source_code = while_token.string;
+    node->offset = while_token.offset;
+    node->body = body;
+    node->condition = expr;
+    return (Kai_Expr*)(node);
+}
+
+KAI_INTERNAL Kai_Expr* kai__parser_create_for(Kai_Parser* parser, Kai_Token for_token, Kai_Token name, Kai_Expr* from, Kai_Expr* to, Kai_Stmt* body, Kai_u8 flags)
+{
+    Kai_Stmt_For* node = ((Kai_Stmt_For*)kai__parser_allocate(parser, sizeof(Kai_Stmt_For)));
+    node->id = KAI_STMT_FOR;
+    node->source_code = for_token.string;
+    node->offset = for_token.offset;
+    node->body = body;
+    node->from = from;
+    node->to = to;
+    node->iterator_name = name.string;
+    kai__set_atom(parser, &(node->iterator_atom), name.atom);
+    node->flags = flags;
+    return (Kai_Expr*)(node);
+}
+
+KAI_INTERNAL Kai_Expr* kai__parser_create_control(Kai_Parser* parser, Kai_Token token, Kai_u8 kind, Kai_Expr* expr)
+{
+    Kai_Stmt_Control* node = ((Kai_Stmt_Control*)kai__parser_allocate(parser, sizeof(Kai_Stmt_Control)));
+    node->id = KAI_STMT_CONTROL;
+    node->source_code = token.string;
+    node->offset = token.offset;
+    node->kind = kind;
+    node->expr = expr;
+    return (Kai_Expr*)(node);
+}
+
+KAI_INTERNAL Kai_Expr* kai__parser_create_compound(Kai_Parser* parser, Kai_Token token, Kai_Stmt* body)
+{
+    Kai_Stmt_Compound* node = ((Kai_Stmt_Compound*)kai__parser_allocate(parser, sizeof(Kai_Stmt_Compound)));
+    node->id = KAI_STMT_COMPOUND;
+    node->source_code = token.string;
+    node->offset = token.offset;
+    node->head = body;
+    return (Kai_Expr*)(node);
+}
+
+KAI_INTERNAL Kai_Tag* kai__parser_create_tag(Kai_Parser* parser, Kai_Token token, Kai_Expr* expr)
+{
+    Kai_Tag* tag = ((Kai_Tag*)kai__parser_allocate(parser, sizeof(Kai_Tag)));
+    tag->name = (token.value).string;
+    tag->expr = expr;
+    return tag;
+}
+
+KAI_API(Kai_Expr*) kai_parse_procedure_call_arguments(Kai_Parser* parser, Kai_u32* arg_count)
+{
+    Kai_Token* current = &((parser->tokenizer).current_token);
+    Kai_Expr_List args = {0};
+    while (current->id!=41)
+    {
+        Kai_Expr* expr = kai_parse_expression(parser, KAI_TOP_PRECEDENCE);
+        kai__expect(expr, "in argument list", "expected an expression here");
+        kai__linked_list_append(args, expr);
+        kai__expect(*arg_count<255, "in argument list", "too many arguments");
+        *arg_count += 1;
+        kai__next_token();
+        if (current->id==44)
             kai__next_token();
-            Kai_Expr* expr = kai_parse_expression(parser, KAI_TOP_PRECEDENCE);
-            if (expr!=NULL)
-                kai__next_token();
-            kai__expect(current->id==59, "after control statement", "there should be a ';' before this");
-            Kai_u8 kind = KAI_CONTROL_CASE;
-            if (token.id==KAI_TOKEN_break)
-                kind = KAI_CONTROL_BREAK;
-            if (token.id==KAI_TOKEN_continue)
-                kind = KAI_CONTROL_CONTINUE;
-            if (token.id==KAI_TOKEN_defer)
-                kind = KAI_CONTROL_DEFER;
-            return kai__parser_create_control(parser, token, kind, expr);
-        }
-        break; case KAI_TOKEN_using:
+        else
+        if (current->id!=41)
+            return kai__unexpected("in argument list", "',' or ')' expected here");
+    }
+    return args.head;
+}
+
+KAI_API(Kai_Expr*) kai_parse_tag_to_expr(Kai_Parser* parser, Kai_Expr* expr)
+{
+    Kai_Token* peeked = kai__peek_token();
+    Kai_Tag* tag = 0;
+    while (peeked->id==KAI_TOKEN_TAG)
+    {
+        Kai_Token token = *peeked;
+        kai__next_token();
+        Kai_Expr* tag_expr = 0;
+        kai__peek_token();
+        if (peeked->id==40)
         {
             kai__next_token();
-            Kai_Expr* expr = kai_parse_expression(parser, KAI_TOP_PRECEDENCE);
-            kai__expect(expr, "in using statement", "should be an expression");
             kai__next_token();
-            kai__expect(current->id==59, "after statement", "there should be a ';' before this");
-            expr->flags = KAI_FLAG_EXPR_USING;
-            return expr;
+            Kai_u32 arg_count = {0};
+            tag_expr = kai_parse_procedure_call_arguments(parser, &arg_count);
+            kai__peek_token();
         }
-        break; case KAI_TOKEN_ret:
+        if (tag==NULL)
         {
-            Kai_Token ret_token = *current;
-            kai__next_token();
-            if (current->id==59)
-                return kai__parser_create_return(parser, ret_token, NULL);
-            Kai_Expr* expr = kai_parse_expression(parser, KAI_TOP_PRECEDENCE);
-            kai__expect(expr, "in return statement", "should be an expression");
-            kai__next_token();
-            kai__expect(current->id==59, "after statement", "there should be a ';' before this");
-            return kai__parser_create_return(parser, ret_token, expr);
+            expr->tag = kai__parser_create_tag(parser, token, tag_expr);
+            tag = expr->tag;
         }
-        break; case KAI_TOKEN_if:
+        else
+        {
+            tag->next = kai__parser_create_tag(parser, token, tag_expr);
+            tag = tag->next;
+        }
+    }
+    return expr;
+}
+
+KAI_INTERNAL Kai_bool kai__is_procedure_next(Kai_Parser* parser)
+{
+    Kai_Token* peeked = kai__peek_token();
+    if (peeked->id==41)
+        return KAI_TRUE;
+    Kai_Token_Buffer* tokens = (parser->tokenizer).tokens;
+    if (tokens!=NULL)
+    {
+        for (Kai_u32 i = (parser->tokenizer).token_index-1; i < (tokens->ids).count; ++i)
+        {
+            Kai_Token_Id id = ((tokens->ids).data)[i];
+            if (id==58)
+                return KAI_TRUE;
+            if (id==41||id==KAI_TOKEN_END)
+                return KAI_FALSE;
+        }
+        return KAI_FALSE;
+    }
+    Kai_Tokenizer state = parser->tokenizer;
+    Kai_Token* current = kai__next_token();
+    Kai_bool found = KAI_FALSE;
+    while (current->id!=KAI_TOKEN_END&&current->id!=41)
+    {
+        if (current->id==58)
+        {
+            found = KAI_TRUE;
+            break;
+        }
+        kai__next_token();
+    }
+    parser->tokenizer = state;
+    return found;
+}
+
+KAI_API(Kai_Expr*) kai_parse_expression(Kai_Parser* parser, Kai_u32 flags)
+{
+    Kai_Expr* left = 0;
+    Kai_Token* current = &((parser->tokenizer).current_token);
+    switch (current->id)
+    {
+        break; case KAI_TOKEN_IDENTIFIER:
+        left = kai__parser_create_identifier(parser, *current);
+        break; case KAI_TOKEN_NUMBER:
+        left = kai__parser_create_number(parser, *current);
+        break; case KAI_TOKEN_STRING:
+        left = kai__parser_create_string(parser, *current);
+        break; case KAI_TOKEN_true:
+        left = kai__parser_create_special(parser, *current, KAI_SPECIAL_TRUE);
+        break; case KAI_TOKEN_false:
+        left = kai__parser_create_special(parser, *current, KAI_SPECIAL_FALSE);
+        break; case KAI_TOKEN_null:
+        left = kai__parser_create_special(parser, *current, KAI_SPECIAL_NULL);
+        break; case 40:
+        {
+            kai_tokenizer_next(&(parser->tokenizer));
+            left = kai_parse_expression(parser, KAI_TOP_PRECEDENCE);
+            kai__expect(left!=NULL, "in expression", "should be an expression here");
+            kai_tokenizer_next(&(parser->tokenizer));
+            kai__expect(current->id==41, "in expression", "should be an operator or ')' here");
+        }
+        break; case 91:
+        {
+            Kai_Token* peeked = kai__peek_token();
+            if ((peeked->id==93||peeked->id==11822)||peeked->id==KAI_TOKEN_NUMBER)
+            {
+                left = kai_parse_type_expression(parser);
+            }
+            else
+            {
+                Kai_Token op_token = *current;
+                kai__next_token();
+                left = kai_parse_expression(parser, KAI_TOP_PRECEDENCE);
+                kai__expect(left, "in dereference expression", "should be an expression here");
+                kai__next_token();
+                kai__expect(current->id==93, "in dereference expression", "should be an operator or ']' here");
+                left = kai__parser_create_unary(parser, op_token, left);
+            }
+        }
+        break; case 123:
+        {
+            Kai_Token token = *current;
+            Kai_Expr_List body = {0};
+            Kai_u32 count = {0};
+            kai__next_token();
+            while (current->id!=125)
+            {
+                Kai_Token token = *current;
+                Kai_Token name = {0};
+                Kai_Token* peeked = kai__peek_token();
+                if (token.id==KAI_TOKEN_IDENTIFIER&&peeked->id==61)
+                {
+                    name = token;
+                    kai__next_token();
+                    kai__next_token();
+                }
+                Kai_Expr* expr = kai_parse_expression(parser, KAI_TOP_PRECEDENCE);
+                kai__expect(expr!=NULL, "in literal expression", "should be an expression here");
+                expr->name = name.string;
+                kai__set_atom(parser, &(expr->name_atom), name.atom);
+                kai__next_token();
+                if (current->id==44)
+                    kai__next_token();
+                else
+                    kai__expect(current->id==125, "in literal expression", "should be '}' or ',' here");
+                kai__linked_list_append(body, expr);
+                count += 1;
+            }
+            kai__expect(current->id==125, "in literal expression", "should be a '}' here");
+            return kai__parser_create_literal(parser, token, body.head, count);
+        }
+        break; case 46:
+        /* fall through */
+        case 126:
+        /* fall through */
+        case 33:
+        /* fall through */
+        case 45:
+        /* fall through */
+        case 43:
+        /* fall through */
+        case 42:
+        {
+            Kai_Token op_token = *current;
+            kai__next_token();
+            left = kai_parse_expression(parser, KAI__PREC_UNARY);
+            kai__expect(left, "in unary expression", "should be an expression here");
+            left = kai__parser_create_unary(parser, op_token, left);
+        }
+        break; case KAI_TOKEN_cast:
+        {
+            Kai_Token token = *current;
+            token.id = 15917;
+            kai__next_token();
+            Kai_Expr* type = 0;
+            if (current->id==40)
+            {
+                kai__next_token();
+                type = kai_parse_type_expression(parser);
+                kai__expect(type, "in cast expression", "should be a type expression here");
+                kai__next_token();
+                kai__expect(current->id==41, "in cast expression", "expected ')' here");
+                kai__next_token();
+            }
+            Kai_Expr* expr = kai_parse_expression(parser, KAI__PREC_CAST);
+            kai__expect(expr, "in expression", "should be expression here");
+            if (type==NULL)
+                left = kai__parser_create_unary(parser, token, expr);
+            else
+                left = kai__parser_create_binary(parser, expr, type, token.id);
+        }
+        break; case KAI_TOKEN_DIRECTIVE:
+        {
+            {
+                Kai_string kai__case_string = (current->value).string;
+                Kai_u32 kai__case_index = 13;
+                #define kai__case_char(I) ((I) < kai__case_string.count ? kai__case_string.data[I] : 0)
+                switch ((kai__case_string.count * 1u + kai__case_char(2) * 14u + kai__case_char(0)) % 17u)
+                {
+                case 8: if (kai_string_equals(kai__case_string, KAI_STRING("size"))) kai__case_index = 0; break;
+                case 5: if (kai_string_equals(kai__case_string, KAI_STRING("type"))) kai__case_index = 1; break;
+                case 7: if (kai_string_equals(kai__case_string, KAI_STRING("Type"))) kai__case_index = 2; break;
+                case 12: if (kai_string_equals(kai__case_string, KAI_STRING("Number"))) kai__case_index = 3; break;
+                case 9: if (kai_string_equals(kai__case_string, KAI_STRING("Code"))) kai__case_index = 4; break;
+                case 13: if (kai_string_equals(kai__case_string, KAI_STRING("import"))) kai__case_index = 5; break;
+                case 2: if (kai_string_equals(kai__case_string, KAI_STRING("through"))) kai__case_index = 6; break;
+                case 16: if (kai_string_equals(kai__case_string, KAI_STRING("char"))) kai__case_index = 7; break;
+                case 11: if (kai_string_equals(kai__case_string, KAI_STRING("multi"))) kai__case_index = 8; break;
+                case 15: if (kai_string_equals(kai__case_string, KAI_STRING("array"))) kai__case_index = 9; break;
+                case 14: if (kai_string_equals(kai__case_string, KAI_STRING("map"))) kai__case_index = 10; break;
+                case 4: if (kai_string_equals(kai__case_string, KAI_STRING("proc"))) kai__case_index = 11; break;
+                case 10: if (kai_string_equals(kai__case_string, KAI_STRING("Julie"))) kai__case_index = 12; break;
+                }
+                #undef kai__case_char
+                switch (kai__case_index)
+                {
+                    break; case 0:
+                    {
+                        left = kai__parser_create_special(parser, *current, KAI_SPECIAL_EVAL_SIZE);
+                    }
+                    break; case 1:
+                    {
+                        left = kai__parser_create_special(parser, *current, KAI_SPECIAL_EVAL_TYPE);
+                    }
+                    break; case 2:
+                    {
+                        return kai__parser_create_special(parser, *current, KAI_SPECIAL_TYPE);
+                    }
+                    break; case 3:
+                    {
+                        return kai__parser_create_special(parser, *current, KAI_SPECIAL_NUMBER);
+                    }
+                    break; case 4:
+                    {
+                        return kai__parser_create_special(parser, *current, KAI_SPECIAL_CODE);
+                    }
+                    break; case 5:
+                    {
+                        Kai_Token token = *current;
+                        kai__next_token();
+                        kai__expect(current->id==KAI_TOKEN_STRING, "in import", "string");
+                        left = kai__parser_create_import(parser, token, *current);
+                    }
+                    break; case 6:
+                    {
+                        left = kai__parser_create_control(parser, *current, KAI_CONTROL_THROUGH, NULL);
+                    }
+                    break; case 7:
+                    {
+                        kai__next_token();
+                        kai__expect(current->id==KAI_TOKEN_STRING, "in character literal", "expected a string here");
+                        Kai_u32 cp = {0};
+                        if (((current->value).string).count>kai__utf8_decode((current->value).string, &cp))
+                        {
+                            return kai__error_unexpected(parser, current, KAI_STRING("in character literal"), KAI_STRING("string must be a single codepoint"));
+                        }
+                        (current->value).number = kai_number_normalize(((Kai_Number){.n = (Kai_u64)(cp), .d = 1}));
+                        left = kai__parser_create_number(parser, *current);
+                    }
+                    break; case 8:
+                    {
+                        kai__next_token();
+                        kai__expect(current->id==KAI_TOKEN_STRING, "multi", "must be string");
+                        kai__expect(((current->value).string).count>0, "multi", "string cannot be empty");
+                        Kai_Number value = ((Kai_Number){0});
+                        Kai_Number base = ((Kai_Number){.n = 1, .d = 1, .e = 8});
+                        for (Kai_u32 i = 0; i < ((current->value).string).count; ++i)
+                        {
+                            Kai_u32 idx = (((current->value).string).count-1)-i;
+                            Kai_Number dg = kai_number_normalize(((Kai_Number){.n = (((current->value).string).data)[idx], .d = 1}));
+                            value = kai_number_add(kai_number_mul(value, base), dg);
+                        }
+                        (current->value).number = value;
+                        left = kai__parser_create_number(parser, *current);
+                    }
+                    break; case 9:
+                    /* fall through */
+                    case 10:
+                    /* fall through */
+                    case 11:
+                    {
+                        kai__next_token();
+                        left = kai_parse_type_expression(parser);
+                    }
+                    break; case 12:
+                    {
+                        (current->value).string = KAI_STRING("<3");
+                        left = kai__parser_create_string(parser, *current);
+                    }
+                    break; default:
+                    return kai__unexpected("in expression", "unknown directive");
+                }
+            }
+        }
+        break; case KAI_TOKEN_union:
+        /* fall through */
+        case KAI_TOKEN_struct:
+        {
+            Kai_Token struct_token = *current;
+            Kai_Stmt_List body = {0};
+            Kai_u32 count = {0};
+            kai__next_token();
+            kai__expect(current->id==123, "in struct", "should be '{' here");
+            kai__next_token();
+            while (current->id!=125)
+            {
+                Kai_Stmt* stmt = kai_parse_statement(parser);
+                kai__expect(stmt, "in struct definition", "expected a statement here");
+                kai__linked_list_append(body, stmt);
+                kai__next_token();
+                count += 1;
+            }
+            left = kai__parser_create_struct(parser, struct_token, count, body.head);
+            if (struct_token.id==KAI_TOKEN_union)
+                left->flags |= KAI_FLAG_STRUCT_UNION;
+        }
+        break; case KAI_TOKEN_enum:
+        {
+            Kai_Token enum_token = *current;
+            kai__next_token();
+            kai__expect(current->id!=123, "in enum", "All enums must be given a sized integer type");
+            Kai_Expr* type = kai_parse_type_expression(parser);
+            kai__expect(type, "in enum type", "expected a type expression here");
+            kai__next_token();
+            Kai_Expr_List body = {0};
+            Kai_u32 count = {0};
+            kai__expect(type, "in enum expression", "should be '{' here");
+            kai__next_token();
+            while (current->id!=125)
+            {
+                Kai_Token token = *current;
+                kai__expect(token.id==KAI_TOKEN_IDENTIFIER, "in enum expression", "should be an identifier here");
+                Kai_Expr_Flags flags = 0;
+                Kai_Token* peeked = kai__peek_token();
+                if (peeked->id==61)
+                {
+                    kai__next_token();
+                    kai__next_token();
+                }
+                else
+                if (peeked->id==44||peeked->id==59)
+                {
+                    flags |= KAI_FLAG_ENUM_NO_VALUE;
+                }
+                else
+                {
+                    return kai__error_unexpected(parser, peeked, KAI_STRING("in enum expression"), KAI_STRING("should be a ',' or ';' here"));
+                }
+                Kai_Expr* expr = kai_parse_expression(parser, KAI_TOP_PRECEDENCE);
+                kai__expect(expr!=NULL, "in enum expression", "should be an expression here");
+                expr->flags = flags;
+                expr->name = token.string;
+                kai__set_atom(parser, &(expr->name_atom), token.atom);
+                kai__next_token();
+                if (current->id==44||peeked->id==59)
+                {
+                    kai_parse_tag_to_expr(parser, expr);
+                    kai__next_token();
+                }
+                else
+                    kai__expect(current->id==125, "in enum expression", "should be '}' ',' or ';' here");
+                kai__linked_list_append(body, expr);
+                count += 1;
+            }
+            kai__expect(current->id==125, "in enum expression", "should be a '}' here");
+            left = kai__parser_create_enum(parser, enum_token, type, count, body.head);
+        }
+        break; default:
+        return NULL;
+    }
+    Kai_Token* peeked = kai_tokenizer_peek(&(parser->tokenizer));
+    Kai__Operator op_info = kai__operator_info(peeked->id);
+    Kai_u32 prec = flags&KAI_PRECEDENCE_MASK;
+    while (op_info.prec!=0&&op_info.prec>prec)
+    {
+        Kai_u32 op = peeked->id;
+        if (op==15677)
+        {
+            Kai_Tokenizer prev_state = parser->tokenizer;
+            kai_tokenizer_next(&(parser->tokenizer));
+            kai_tokenizer_next(&(parser->tokenizer));
+            if (current->id==123)
+            {
+                parser->tokenizer = prev_state;
+                return left;
+            }
+        }
+        else
+        {
+            kai_tokenizer_next(&(parser->tokenizer));
+            kai_tokenizer_next(&(parser->tokenizer));
+        }
+        switch (op_info.type)
+        {
+            break; case KAI__OPERATOR_TYPE_BINARY:
+            {
+                Kai_Expr* right = kai_parse_expression(parser, op_info.prec);
+                kai__expect(right!=NULL, "in binary expression", "should be an expression after binary operator");
+                left = kai__parser_create_binary(parser, left, right, op);
+            }
+            break; case KAI__OPERATOR_TYPE_INDEX:
+            {
+                Kai_Expr* right = kai_parse_expression(parser, KAI_TOP_PRECEDENCE);
+                kai__expect(right, "in index operation", "should be an expression here");
+                kai__next_token();
+                kai__expect(current->id==93, "in index operation", "expected ']' here");
+                left = kai__parser_create_binary(parser, left, right, op);
+            }
+            break; case KAI__OPERATOR_TYPE_PROCEDURE_CALL:
+            {
+                Kai_u32 arg_count = {0};
+                Kai_Expr* args = kai_parse_procedure_call_arguments(parser, &arg_count);
+                left = kai__parser_create_procedure_call(parser, left, args, (Kai_u8)(arg_count));
+            }
+        }
+        kai_tokenizer_peek(&(parser->tokenizer));
+        op_info = kai__operator_info(peeked->id);
+    }
+    return left;
+}
+
+KAI_API(Kai_Expr*) kai_parse_type_expression(Kai_Parser* parser)
+{
+    Kai_Token* current = &((parser->tokenizer).current_token);
+    switch (current->id)
+    {
+        break; case 91:
+        {
+            Kai_Token op_token = *current;
+            kai__next_token();
+            Kai_Expr* rows = 0;
+            Kai_Expr* cols = 0;
+            Kai_u8 expr_flags = {0};
+            if (current->id==11822)
+            {
+                kai__next_token();
+                expr_flags |= KAI_FLAG_ARRAY_DYNAMIC;
+            }
+            else
+            if (current->id!=93)
+            {
+                rows = kai_parse_expression(parser, KAI_TOP_PRECEDENCE);
+                kai__expect(rows, "in array type", "[todo]");
+                kai__next_token();
+                if (current->id==44)
+                {
+                    kai__next_token();
+                    cols = kai_parse_expression(parser, KAI_TOP_PRECEDENCE);
+                    kai__expect(cols, "in array type", "[todo]");
+                    kai__next_token();
+                }
+            }
+            kai__expect(current->id==93, "in array type", "array");
+            kai__next_token();
+            Kai_Expr* type = kai_parse_type_expression(parser);
+            kai__expect(type, "in array type", "expected type here");
+            return kai__parser_create_array(parser, op_token, type, rows, cols, expr_flags);
+        }
+        break; case 42:
+        {
+            Kai_Token op_token = *current;
+            kai__next_token();
+            Kai_Expr* expr = kai_parse_type_expression(parser);
+            kai__expect(expr, "in unary expression", "should be an expression here");
+            Kai_Expr* unary = kai__parser_create_unary(parser, op_token, expr);
+            unary->flags |= expr->flags&KAI_FLAG_EXPR_POLYMORPHIC;
+            return unary;
+        }
+        break; case 36:
+        {
+            kai__next_token();
+            kai__expect(current->id==KAI_TOKEN_IDENTIFIER, "in polymorphic type", "should be an identifier");
+            Kai_Expr* expr = kai__parser_create_identifier(parser, *current);
+            expr->flags |= KAI_FLAG_EXPR_POLYMORPHIC;
+            return expr;
+        }
+    }
+    if (current->id!=40)
+        return kai_parse_expression(parser, KAI_TOP_PRECEDENCE);
+    kai__next_token();
+    Kai_u8 in_count = {0};
+    Kai_u8 out_count = {0};
+    Kai_Expr_List in_out = {0};
+    while (current->id!=41)
+    {
+        Kai_Token name = {0};
+        if (current->id==KAI_TOKEN_IDENTIFIER)
+        {
+            Kai_Token* peeked = kai__peek_token();
+            if (peeked->id==58)
+            {
+                name = *current;
+                kai__next_token();
+                kai__next_token();
+            }
+        }
+        Kai_Expr* type = kai_parse_type_expression(parser);
+        kai__expect(type, "in procedure type", "should be a type here");
+        type->name = name.string;
+        kai__set_atom(parser, &(type->name_atom), name.atom);
+        kai__linked_list_append(in_out, type);
+        kai__expect(in_count!=255, "in procedure type", "too many inputs to procedure");
+        in_count += 1;
+        kai__next_token();
+        if (current->id==44)
+            kai__next_token();
+        else
+        if (current->id!=41)
+            return kai__unexpected("in procedure type", "',' or ')' expected here");
+    }
+    Kai_Token* peek = kai__peek_token();
+    if (peek->id==15917)
+    {
+        kai__next_token();
+        kai__next_token();
+        Kai_bool enclosed_return = KAI_FALSE;
+        if (current->id==40)
+        {
+            enclosed_return = KAI_TRUE;
+            kai__next_token();
+        }
+        while (current->id!=41)
+        {
+            Kai_Expr* type = kai_parse_type_expression(parser);
+            if (!type)
+                return NULL;
+            kai__linked_list_append(in_out, type);
+            kai__expect(out_count!=255, "in procedure type", "too many inputs to procedure");
+            out_count += 1;
+            kai__peek_token();
+            if (peek->id==44)
+            {
+                kai__next_token();
+                kai__next_token();
+            }
+            else
+                break;
+        }
+        if (enclosed_return)
+        {
+            if (peek->id!=41)
+            {
+                kai__next_token();
+                return kai__unexpected("in procedure type", "should be ')' after return types");
+            }
+            else
+                kai__next_token();
+        }
+    }
+    return kai__parser_create_procedure_type(parser, in_out.head, in_count, out_count);
+}
+
+KAI_API(Kai_Expr*) kai_parse_procedure(Kai_Parser* parser)
+{
+    Kai_Token* current = &((parser->tokenizer).current_token);
+    Kai_Token token = *current;
+    kai__expect(current->id==40, "", "this is likely a compiler bug, sorry :c");
+    kai__next_token();
+    Kai_u8 in_count = {0};
+    Kai_u8 out_count = {0};
+    Kai_Expr_List in_out = {0};
+    Kai_u8 proc_flags = {0};
+    while (current->id!=41)
+    {
+        Kai_u8 flags = {0};
+        if (current->id==KAI_TOKEN_using)
+        {
+            flags |= KAI_FLAG_PROC_USING;
+            kai__next_token();
+        }
+        kai__expect(current->id==KAI_TOKEN_IDENTIFIER, "in procedure input", "should be an identifier");
+        Kai_Token name = *current;
+        kai__next_token();
+        kai__expect(current->id==58, "in procedure input", "wanted a ':' here");
+        kai__next_token();
+        Kai_Expr* type = kai_parse_type_expression(parser);
+        kai__expect(type, "in procedure input", "should be type");
+        type->name = name.string;
+        kai__set_atom(parser, &(type->name_atom), name.atom);
+        type->flags |= flags;
+        proc_flags |= type->flags&KAI_FLAG_EXPR_POLYMORPHIC;
+        kai__linked_list_append(in_out, type);
+        kai__expect(in_count!=255, "in procedure call", "too many inputs to procedure");
+        in_count += 1;
+        kai__next_token();
+        switch (current->id)
+        {
+            break; case 41:
+            break; case 44:
+            kai__next_token();
+            break; default:
+            return kai__unexpected("in procedure input", "wanted ')' or ',' here");
+        }
+    }
+    kai__next_token();
+    if (current->id==15917)
+    {
+        kai__next_token();
+        Kai_Expr* type = kai_parse_type_expression(parser);
+        kai__expect(type, "in procedure return type", "should be type");
+        kai__linked_list_append(in_out, type);
+        kai__expect(out_count!=255, "in procedure call", "too many inputs to procedure");
+        out_count += 1;
+        kai__next_token();
+    }
+    Kai_Stmt* body = 0;
+    if (current->id==KAI_TOKEN_DIRECTIVE&&kai_string_equals(KAI_STRING("host"), current->string))
+    {
+        kai__next_token();
+        kai__expect(current->id==59, "???", "???");
+    }
+    else
+    {
+        body = kai_parse_statement(parser);
+        if (!body)
+            return kai__unexpected("[todo: remove this]", "");
+    }
+    Kai_Expr* proc = kai__parser_create_procedure(parser, token, in_out.head, body, in_count, out_count);
+    proc->flags = proc_flags;
+    return proc;
+}
+
+KAI_API(Kai_Stmt*) kai_parse_declaration(Kai_Parser* parser)
+{
+    Kai_Token* current = &((parser->tokenizer).current_token);
+    if (current->id==KAI_TOKEN_DIRECTIVE)
+        return kai_parse_statement(parser);
+    if (current->id!=KAI_TOKEN_IDENTIFIER)
+        return kai__unexpected("in declaration", "expected an identifier");
+    Kai_string name = current->string;
+    Kai_u32 atom = current->atom;
+    Kai_u32 offset = current->offset;
+    kai__next_token();
+    if (current->id!=58)
+        return kai__unexpected("in declaration", "expected ':' here");
+    kai__next_token();
+    Kai_u8 flags = 0;
+    Kai_Expr* type = kai_parse_type_expression(parser);
+    if (type)
+        kai__next_token();
+    Kai_Expr* expr = 0;
+    switch (current->id)
+    {
+        break; case 58:
+        flags |= KAI_FLAG_DECL_CONST;
+        break; case 61:
+        break; case 59:
+        kai__expect(type!=NULL, "in declaration", "should be '=', ':', or expression here");
+        return kai__parser_create_declaration(parser, name, atom, type, expr, flags, offset);
+        break; default:
+        return kai__unexpected("in declaration", "should be '=', ':', or ';'");
+    }
+    kai__next_token();
+    Kai_bool require_semicolon = KAI_FALSE;
+    if (current->id==KAI_TOKEN_DIRECTIVE&&kai_string_equals((current->value).string, KAI_STRING("host_import")))
+    {
+        flags |= KAI_FLAG_DECL_HOST_IMPORT;
+        require_semicolon = KAI_TRUE;
+    }
+    else
+    if (current->id==40&&kai__is_procedure_next(parser))
+    {
+        expr = kai_parse_procedure(parser);
+        if (!expr)
+            return kai__unexpected("[todo]", "[todo]");
+    }
+    else
+    {
+        require_semicolon = KAI_TRUE;
+        if ((current->id==KAI_TOKEN_struct||current->id==KAI_TOKEN_union)||current->id==KAI_TOKEN_enum)
+            require_semicolon = KAI_FALSE;
+        expr = kai_parse_expression(parser, KAI_TOP_PRECEDENCE);
+        kai__expect(expr, "in declaration", "should be an expression here");
+    }
+    if (require_semicolon)
+    {
+        kai__next_token();
+        kai__expect(current->id==59, "after declaration", "there should be a ';' before this");
+    }
+    else
+    {
+        Kai_Token* peeked = kai__peek_token();
+        if (peeked->id==59)
+            kai__next_token();
+    }
+    return kai__parser_create_declaration(parser, name, atom, type, expr, flags, offset);
+}
+
+KAI_API(Kai_Stmt*) kai_parse_statement(Kai_Parser* parser)
+{
+    Kai_Token* current = &((parser->tokenizer).current_token);
+    switch (current->id)
+    {
+        break; case 123:
+        {
+            Kai_Token token = *current;
+            kai__next_token();
+            Kai_Stmt_List body = {0};
+            while (current->id!=125)
+            {
+                Kai_Stmt* statement = kai_parse_statement(parser);
+                if (!statement)
+                    return NULL;
+                kai__linked_list_append(body, statement);
+                kai__next_token();
+            }
+            return kai__parser_create_compound(parser, token, body.head);
+        }
+        break; case KAI_TOKEN_case:
+        /* fall through */
+        case KAI_TOKEN_break:
+        /* fall through */
+        case KAI_TOKEN_continue:
+        /* fall through */
+        case KAI_TOKEN_defer:
+        {
+            Kai_Token token = *current;
+            kai__next_token();
+            Kai_Expr* expr = kai_parse_expression(parser, KAI_TOP_PRECEDENCE);
+            if (expr!=NULL)
+                kai__next_token();
+            kai__expect(current->id==59, "after control statement", "there should be a ';' before this");
+            Kai_u8 kind = KAI_CONTROL_CASE;
+            if (token.id==KAI_TOKEN_break)
+                kind = KAI_CONTROL_BREAK;
+            if (token.id==KAI_TOKEN_continue)
+                kind = KAI_CONTROL_CONTINUE;
+            if (token.id==KAI_TOKEN_defer)
+                kind = KAI_CONTROL_DEFER;
+            return kai__parser_create_control(parser, token, kind, expr);
+        }
+        break; case KAI_TOKEN_using:
+        {
+            kai__next_token();
+            Kai_Expr* expr = kai_parse_expression(parser, KAI_TOP_PRECEDENCE);
+            kai__expect(expr, "in using statement", "should be an expression");
+            kai__next_token();
+            kai__expect(current->id==59, "after statement", "there should be a ';' before this");
+            expr->flags = KAI_FLAG_EXPR_USING;
+            return expr;
+        }
+        break; case KAI_TOKEN_ret:
+        {
+            Kai_Token ret_token = *current;
+            kai__next_token();
+            if (current->id==59)
+                return kai__parser_create_return(parser, ret_token, NULL);
+            Kai_Expr* expr = kai_parse_expression(parser, KAI_TOP_PRECEDENCE);
+            kai__expect(expr, "in return statement", "should be an expression");
+            kai__next_token();
+            kai__expect(current->id==59, "after statement", "there should be a ';' before this");
+            return kai__parser_create_return(parser, ret_token, expr);
+        }
+        break; case KAI_TOKEN_if:
+        {
+            Kai_Token if_token = *current;
+            kai__next_token();
+            Kai_Expr* expr = kai_parse_expression(parser, KAI_TOP_PRECEDENCE);
+            kai__expect(expr, "in if statement", "should be an expression here");
+            kai__next_token();
+            Kai_u8 flags = 0;
+            if (current->id==KAI_TOKEN_then)
+            {
+                kai__next_token();
+            }
+            if (current->id==15677)
+            {
+                kai__next_token();
+                flags |= KAI_FLAG_IF_CASE;
+            }
+            Kai_Stmt* then_body = kai_parse_statement(parser);
+            if (!then_body)
+                return NULL;
+            Kai_Token* peeked = kai__peek_token();
+            Kai_Stmt* else_body = 0;
+            if (peeked->id==KAI_TOKEN_else)
+            {
+                kai__next_token();
+                kai__next_token();
+                else_body = kai_parse_statement(parser);
+                if (!else_body)
+                    return NULL;
+            }
+            return kai__parser_create_if(parser, if_token, flags, expr, then_body, else_body);
+        }
+        break; case KAI_TOKEN_while:
+        {
+            Kai_Token while_token = *current;
+            kai__next_token();
+            Kai_Expr* expr = kai_parse_expression(parser, KAI_TOP_PRECEDENCE);
+            kai__next_token();
+            Kai_Stmt* body = kai_parse_statement(parser);
+            return kai__parser_create_while(parser, while_token, expr, body);
+        }
+        break; case KAI_TOKEN_for:
+        {
+            Kai_Token for_token = *current;
+            kai__next_token();
+            kai__expect(current->id==KAI_TOKEN_IDENTIFIER, "in for statement", "should be the name of the iterator");
+            Kai_Token iterator_name = *current;
+            kai__next_token();
+            kai__expect(current->id==58, "in for statement", "should be ':' here");
+            kai__next_token();
+            Kai_Expr* from = kai_parse_expression(parser, KAI_TOP_PRECEDENCE);
+            kai__expect(from, "in for statement", "should be an expression here");
+            Kai_Expr* to = 0;
+            kai__next_token();
+            Kai_u8 flags = {0};
+            if (current->id==11822)
+            {
+                kai__next_token();
+                if (current->id==60)
+                {
+                    flags |= KAI_FLAG_FOR_LESS_THAN;
+                    kai__next_token();
+                }
+                to = kai_parse_expression(parser, KAI_TOP_PRECEDENCE);
+                kai__expect(to, "in for statement", "should be an expression here");
+                kai__next_token();
+            }
+            Kai_Stmt* body = kai_parse_statement(parser);
+            if (!body)
+                return NULL;
+            return kai__parser_create_for(parser, for_token, iterator_name, from, to, body, flags);
+        }
+        break; case KAI_TOKEN_DIRECTIVE:
+        {
+            if (kai_string_equals((current->value).string, KAI_STRING("export")))
+            {
+                kai__next_token();
+                Kai_Stmt* decl = kai_parse_declaration(parser);
+                kai__expect(decl, "in export statement", "should be declaration here");
+                decl->flags |= KAI_FLAG_DECL_EXPORT;
+                return decl;
+            }
+            else
+            {
+                Kai_Expr* expr = kai_parse_expression(parser, KAI_TOP_PRECEDENCE);
+                kai__expect(expr, "in statement", "there should be an expression here");
+                kai__next_token();
+                kai__expect(current->id==59, "after statement", "there should be a ';' before this");
+                return expr;
+            }
+        }
+        break; case KAI_TOKEN_IDENTIFIER:
+        {
+            Kai_Token* peeked = kai__peek_token();
+            if (peeked->id==58)
+                return kai_parse_declaration(parser);
+        }
+        /* fall through */
+        default:
+        {
+            Kai_bool requires_semicolon = KAI_TRUE;
+            Kai_Expr* expr = kai_parse_expression(parser, KAI_TOP_PRECEDENCE);
+            kai__expect(expr, "in statement", "should be an expression or statement");
+            Kai_Token* peeked = kai__peek_token();
+            switch (peeked->id)
+            {
+                break; case 61:
+                /* fall through */
+                case 15740:
+                /* fall through */
+                case 15654:
+                /* fall through */
+                case 15659:
+                /* fall through */
+                case 15661:
+                /* fall through */
+                case 15658:
+                /* fall through */
+                case 15663:
+                {
+                    kai__next_token();
+                    Kai_u32 op = current->id;
+                    kai__next_token();
+                    Kai_Expr* right = kai_parse_expression(parser, KAI_TOP_PRECEDENCE);
+                    kai__expect(right, "in assignment statement", "should be an expression");
+                    expr = kai__parser_create_assignment(parser, op, expr, right);
+                    kai__next_token();
+                    kai__expect(current->id==59, "in assignment statement", "should be ';' before this");
+                }
+                break; default:
+                {
+                    if (requires_semicolon)
+                    {
+                        kai__next_token();
+                        kai__expect(current->id==59, "in expression statement", "should be ';' before this");
+                    }
+                    kai_parse_tag_to_expr(parser, expr);
+                }
+            }
+            return expr;
+        }
+    }
+}
+
+KAI_INTERNAL void kai__find_tree_lines(Kai_Syntax_Tree* tree, Kai_Source* source, Kai_Allocator* allocator)
+{
+    kai_find_line_starts_into(source->contents, &(tree->lines), allocator);
+    (source->line_starts).data = (tree->lines).data;
+    (source->line_starts).count = (tree->lines).count;
+}
+
+KAI_INTERNAL void kai__update_tree_lines(Kai_Syntax_Tree* tree, Kai_Source* source, Kai_Allocator* allocator, Kai_Source_Edit edit)
+{
+    if ((tree->lines).data==NULL||((tree->source).line_starts).data!=(tree->lines).data)
+    {
+        kai__find_tree_lines(tree, source, allocator);
+        return;
+    }
+    Kai_string to = source->contents;
+    Kai_u32* old = (tree->lines).data;
+    Kai_u32 old_count = ((tree->source).line_starts).count;
+    Kai_u32 old_end = edit.offset+edit.removed;
+    Kai_u32 edit_end = edit.offset+edit.inserted;
+    Kai_u32 delta = edit.inserted-edit.removed;
+    Kai_u32 keep = 1;
+    while (keep<old_count&&old[keep]<edit.offset)
+        keep += 1;
+    Kai_u32 tail = keep;
+    while (tail<old_count&&old[tail]<old_end+2)
+        tail += 1;
+    Kai_u32 limit = edit_end+2;
+    Kai_u32 scan_end = kai__min_u32(limit, to.count);
+    Kai_u32 middle = 0;
+    for (Kai_u32 pass = 0; pass < 2; ++pass)
+    {
+        Kai_u32 i = old[keep-1];
+        Kai_u32 count = 0;
+        while (i<scan_end)
+        {
+            i = kai_intrinsics_find_any4(to.data, i, scan_end, 10, 13, 10, 13);
+            if (i==scan_end)
+                break;
+            if (((to.data)[i]==13&&i+1<to.count)&&(to.data)[i+1]==10)
+                i += 1;
+            i += 1;
+            if (i>=limit)
+                break;
+            if (pass==1)
+                ((tree->lines).data)[keep+count] = i;
+            count += 1;
+        }
+        if (pass==1)
+            break;
+        middle = count;
+        Kai_u32 line_count = ((keep+middle)+old_count)-tail;
+        if ((tree->lines).capacity<line_count)
+        {
+            Kai_u32* data = (Kai_u32*)(kai__allocate(NULL, (line_count*2)*sizeof(Kai_u32), 0));
+            kai__memory_copy(data, old, keep*sizeof(Kai_u32));
+            kai__memory_copy((data+keep)+middle, old+tail, (old_count-tail)*sizeof(Kai_u32));
+            kai__free(old, (tree->lines).capacity*sizeof(Kai_u32));
+            (tree->lines).data = data;
+            (tree->lines).capacity = line_count*2;
+        }
+        else
+        if (keep+middle<tail)
+        {
+            for (Kai_u32 k = tail; k < old_count; ++k)
+            {
+                old[((k-tail)+keep)+middle] = old[k];
+            }
+        }
+        else
+        if (keep+middle>tail)
+        {
+            Kai_u32 k = old_count;
+            while (k>tail)
+            {
+                k -= 1;
+                old[((k-tail)+keep)+middle] = old[k];
+            }
+        }
+        old = (tree->lines).data;
+    }
+    (tree->lines).count = ((keep+middle)+old_count)-tail;
+    for (Kai_u32 k = keep+middle; k < (tree->lines).count; ++k)
+    {
+        ((tree->lines).data)[k] += delta;
+    }
+    (source->line_starts).data = (tree->lines).data;
+    (source->line_starts).count = (tree->lines).count;
+}
+
+KAI_API(Kai_Result) kai_create_syntax_tree(Kai_Syntax_Tree_Create_Info* info, Kai_Syntax_Tree* out_tree)
+{
+    return kai__create_syntax_tree(info, out_tree, NULL);
+}
+
+KAI_INTERNAL Kai_Result kai__create_syntax_tree(Kai_Syntax_Tree_Create_Info* info, Kai_Syntax_Tree* out_tree, Kai__Atom_Ref_DynArray* atom_refs)
+{
+    Kai_Parser parser = {0};
+    parser.atom_refs = atom_refs;
+    parser.source = info->source;
+    (parser.tokenizer).source = (info->source).contents;
+    (parser.tokenizer).atoms = info->atoms;
+    (parser.tokenizer).tokens = info->tokens;
+    parser.error = info->error;
+    Kai_Allocator* allocator = &(info->allocator);
+    (out_tree->allocator).base = info->allocator;
+    if (info->arena!=NULL)
+    {
+        out_tree->arena = info->arena;
+        out_tree->arena_start = kai_arena_save(info->arena);
+        parser.arena = *(info->arena);
+        parser.reused = KAI_TRUE;
+    }
+    else
+    {
+        out_tree->arena = NULL;
+        if ((out_tree->allocator).current_bucket==NULL)
+        {
+            kai_arena_create(&(out_tree->allocator), allocator);
+            out_tree->arena_start = kai_arena_save(&(out_tree->allocator));
+        }
+        else
+            parser.reused = KAI_TRUE;
+        parser.arena = out_tree->allocator;
+    }
+    (parser.tokenizer).string_arena = &(parser.arena);
+    if (((parser.source).line_starts).count==0)
+        kai__find_tree_lines(out_tree, &(parser.source), allocator);
+    Kai_Stmt_List statements = {0};
+    (out_tree->spans).count = 0;
+    Kai_Token* token = kai_tokenizer_next(&(parser.tokenizer));
+    while (token->id!=KAI_TOKEN_END)
+    {
+        Kai_Statement_Span span = {0};
+        span.start = token->offset;
+        span.stmt = kai_parse_declaration(&parser);
+        if (span.stmt==NULL)
+            break;
+        kai__linked_list_append(statements, span.stmt);
+        kai_array_push(&(out_tree->spans), span);
+        kai_tokenizer_next(&(parser.tokenizer));
+    }
+    (out_tree->root).id = KAI_STMT_COMPOUND;
+    (out_tree->root).head = statements.head;
+    out_tree->source = parser.source;
+    out_tree->incomplete = (parser.error)->result!=KAI_SUCCESS;
+    out_tree->update_bytes = 0;
+    if (info->arena!=NULL)
+    {
+        *(info->arena) = parser.arena;
+    }
+    else
+        out_tree->allocator = parser.arena;
+    if ((parser.error)->result!=KAI_SUCCESS)
+        ((parser.error)->location).source = parser.source;
+    return (parser.error)->result;
+}
+
+KAI_API(void) kai_reset_syntax_tree(Kai_Syntax_Tree* tree)
+{
+    if (tree->arena!=NULL)
+        kai_arena_restore(tree->arena, tree->arena_start);
+    else
+    if ((tree->allocator).current_bucket!=NULL)
+        kai_arena_restore(&(tree->allocator), tree->arena_start);
+    (tree->root).head = NULL;
+    tree->source = ((Kai_Source){0});
+    (tree->spans).count = 0;
+}
+
+KAI_API(void) kai_destroy_syntax_tree(Kai_Syntax_Tree* tree)
+{
+    Kai_Allocator* allocator = &((tree->allocator).base);
+    kai_array_destroy(&(tree->lines));
+    kai_array_destroy(&(tree->spans));
+    if ((tree->allocator).current_bucket!=NULL)
+        kai_arena_destroy(&(tree->allocator));
+    kai__memory_zero(tree, sizeof(Kai_Syntax_Tree));
+}
+
+KAI_INTERNAL void kai__push_expr_list(Kai__Expr_Ref_DynArray* list, Kai_Allocator* allocator, Kai_Expr* head, Kai_u32 limit)
+{
+    Kai_Expr* current = head;
+    Kai_u32 count = 0;
+    while (current!=NULL&&count<limit)
+    {
+        kai_array_push(list, current);
+        current = current->next;
+        count += 1;
+    }
+}
+
+KAI_INTERNAL void kai__push_expr_children(Kai__Expr_Ref_DynArray* list, Kai_Allocator* allocator, Kai_Expr* expr)
+{
+    switch (expr->id)
+    {
+        break; case KAI_EXPR_LITERAL:
+        {
+            Kai_Expr_Literal* l = ((Kai_Expr_Literal*)expr);
+            kai__push_expr_list(list, allocator, l->head, 4294967295);
+        }
+        break; case KAI_EXPR_UNARY:
+        {
+            Kai_Expr_Unary* u = ((Kai_Expr_Unary*)expr);
+            kai_array_push(list, u->expr);
+        }
+        break; case KAI_EXPR_BINARY:
+        {
+            Kai_Expr_Binary* b = ((Kai_Expr_Binary*)expr);
+            kai_array_push(list, b->left);
+            kai_array_push(list, b->right);
+        }
+        break; case KAI_EXPR_PROCEDURE_TYPE:
+        {
+            Kai_Expr_Procedure_Type* p = ((Kai_Expr_Procedure_Type*)expr);
+            kai__push_expr_list(list, allocator, p->in_out_expr, p->in_count+p->out_count);
+        }
+        break; case KAI_EXPR_PROCEDURE_CALL:
+        {
+            Kai_Expr_Procedure_Call* c = ((Kai_Expr_Procedure_Call*)expr);
+            kai_array_push(list, c->proc);
+            kai__push_expr_list(list, allocator, c->arg_head, 4294967295);
+        }
+        break; case KAI_EXPR_PROCEDURE:
+        {
+            Kai_Expr_Procedure* p = ((Kai_Expr_Procedure*)expr);
+            kai__push_expr_list(list, allocator, p->in_out_expr, p->in_count+p->out_count);
+            kai_array_push(list, p->body);
+        }
+        break; case KAI_EXPR_STRUCT:
+        {
+            Kai_Expr_Struct* s = ((Kai_Expr_Struct*)expr);
+            kai__push_expr_list(list, allocator, s->head, 4294967295);
+        }
+        break; case KAI_EXPR_ENUM:
+        {
+            Kai_Expr_Enum* e = ((Kai_Expr_Enum*)expr);
+            kai_array_push(list, e->type);
+            kai__push_expr_list(list, allocator, e->head, 4294967295);
+        }
+        break; case KAI_EXPR_ARRAY:
+        {
+            Kai_Expr_Array* a = ((Kai_Expr_Array*)expr);
+            kai_array_push(list, a->rows);
+            kai_array_push(list, a->cols);
+            kai_array_push(list, a->expr);
+        }
+        break; case KAI_STMT_RETURN:
+        {
+            Kai_Stmt_Return* r = ((Kai_Stmt_Return*)expr);
+            kai_array_push(list, r->expr);
+        }
+        break; case KAI_STMT_DECLARATION:
+        {
+            Kai_Stmt_Declaration* d = ((Kai_Stmt_Declaration*)expr);
+            kai_array_push(list, d->type);
+            kai_array_push(list, d->value);
+        }
+        break; case KAI_STMT_ASSIGNMENT:
+        {
+            Kai_Stmt_Assignment* a = ((Kai_Stmt_Assignment*)expr);
+            kai_array_push(list, a->dest);
+            kai_array_push(list, a->value);
+        }
+        break; case KAI_STMT_COMPOUND:
+        {
+            Kai_Stmt_Compound* c = ((Kai_Stmt_Compound*)expr);
+            kai__push_expr_list(list, allocator, c->head, 4294967295);
+        }
+        break; case KAI_STMT_IF:
+        {
+            Kai_Stmt_If* i = ((Kai_Stmt_If*)expr);
+            kai_array_push(list, i->condition);
+            kai_array_push(list, i->then_body);
+            kai_array_push(list, i->else_body);
+        }
+        break; case KAI_STMT_WHILE:
+        {
+            Kai_Stmt_While* w = ((Kai_Stmt_While*)expr);
+            kai_array_push(list, w->condition);
+            kai_array_push(list, w->body);
+        }
+        break; case KAI_STMT_FOR:
+        {
+            Kai_Stmt_For* f = ((Kai_Stmt_For*)expr);
+            kai_array_push(list, f->from);
+            kai_array_push(list, f->to);
+            kai_array_push(list, f->body);
+        }
+        break; case KAI_STMT_CONTROL:
+        {
+            Kai_Stmt_Control* c = ((Kai_Stmt_Control*)expr);
+            kai_array_push(list, c->expr);
+        }
+    }
+}
+
+KAI_INTERNAL void kai__rebase_string(Kai_string* s, Kai_string from, Kai_string to, Kai_u32 delta)
+{
+    if (s->data<from.data||s->data>=from.data+(Kai_uint)(from.count))
+        return;
+    Kai_u32 offset = (Kai_u32)(s->data-from.data)+delta;
+    s->data = to.data+(Kai_uint)(offset);
+}
+
+KAI_INTERNAL void kai__relocate_statement(Kai_Stmt* stmt, Kai__Expr_Ref_DynArray* stack, Kai_Allocator* allocator, Kai_string from, Kai_string to, Kai_u32 delta)
+{
+    kai_array_push(stack, stmt);
+    while (stack->count!=0)
+    {
+        Kai_Expr* expr = kai_array_pop(stack);
+        if (expr==NULL)
+            continue;
+        expr->offset += delta;
+        kai__rebase_string(&(expr->source_code), from, to, delta);
+        kai__rebase_string(&(expr->name), from, to, delta);
+        if (expr->id==KAI_STMT_FOR)
+        {
+            Kai_Stmt_For* f = ((Kai_Stmt_For*)expr);
+            kai__rebase_string(&(f->iterator_name), from, to, delta);
+        }
+        else
+        if (expr->id==KAI_EXPR_STRING)
+        {
+            Kai_Expr_String* s = ((Kai_Expr_String*)expr);
+            kai__rebase_string(&(s->value), from, to, delta);
+        }
+        Kai_Tag* tag = expr->tag;
+        while (tag!=NULL)
+        {
+            kai__rebase_string(&(tag->name), from, to, delta);
+            kai__push_expr_list(stack, allocator, tag->expr, 4294967295);
+            tag = tag->next;
+        }
+        kai__push_expr_children(stack, allocator, expr);
+    }
+}
+
+KAI_API(void) kai_settle_syntax_tree(Kai_Syntax_Tree* tree)
+{
+    if ((tree->spans).count==0)
+        return;
+    Kai_Allocator* allocator = &((tree->allocator).base);
+    Kai__Expr_Ref_DynArray stack = {0};
+    for (Kai_u32 i = 0; i < (tree->spans).count; ++i)
+    {
+        Kai_Statement_Span* span = &(((tree->spans).data)[i]);
+        if ((span->base).data==NULL)
+            continue;
+        kai__relocate_statement(span->stmt, &stack, allocator, span->base, (tree->source).contents, span->moved);
+        span->base = ((Kai_string){0});
+        span->moved = 0;
+    }
+    kai_array_destroy(&stack);
+}
+
+KAI_INTERNAL Kai_Result kai__reparse_syntax_tree(Kai_Syntax_Tree_Create_Info* info, Kai_Syntax_Tree* tree)
+{
+    kai_reset_syntax_tree(tree);
+    return kai_create_syntax_tree(info, tree);
+}
+
+KAI_API(Kai_Result) kai_update_syntax_tree(Kai_Syntax_Tree_Create_Info* info, Kai_Syntax_Tree* tree, Kai_Source_Edit edit)
+{
+    Kai_string from = (tree->source).contents;
+    Kai_string to = (info->source).contents;
+    Kai_u32 delta = edit.inserted-edit.removed;
+    Kai_u32 n = (tree->spans).count;
+    Kai_bool full = (info->tokens!=NULL||tree->incomplete)||n==0;
+    if (edit.offset+edit.removed>from.count||from.count+delta!=to.count)
+        full = KAI_TRUE;
+    if (full)
+        return kai__reparse_syntax_tree(info, tree);
+    Kai_u32 first = 0;
+    Kai_u32 high = n;
+    while (first<high)
+    {
+        Kai_u32 mid = (first+high)/2;
+        Kai_Statement_Span span = ((tree->spans).data)[mid];
+        if (span.start<edit.offset)
+            first = mid+1;
+        else
+            high = mid;
+    }
+    Kai_u32 start = 0;
+    if (first!=0)
+    {
+        first -= 1;
+        Kai_Statement_Span span = ((tree->spans).data)[first];
+        start = span.start;
+    }
+    if (tree->update_bytes>to.count)
+        return kai__reparse_syntax_tree(info, tree);
+    Kai_Parser parser = {0};
+    parser.source = info->source;
+    (parser.tokenizer).source = to;
+    (parser.tokenizer).cursor = start;
+    (parser.tokenizer).atoms = info->atoms;
+    parser.error = info->error;
+    Kai_Allocator* allocator = &(info->allocator);
+    if (tree->arena!=NULL)
+    {
+        parser.arena = *(tree->arena);
+    }
+    else
+        parser.arena = tree->allocator;
+    parser.reused = KAI_TRUE;
+    (parser.tokenizer).string_arena = &(parser.arena);
+    if (((parser.source).line_starts).count==0)
+        kai__update_tree_lines(tree, &(parser.source), allocator, edit);
+    Kai_u32 old_end = edit.offset+edit.removed;
+    Kai_u32 edit_end = edit.offset+edit.inserted;
+    Kai_u32 kept = first;
+    Kai_bool same = KAI_FALSE;
+    Kai_Stmt_List statements = {0};
+    Kai_Token* token = kai_tokenizer_next(&(parser.tokenizer));
+    while (token->id!=KAI_TOKEN_END)
+    {
+        if (token->offset>=edit_end)
+        {
+            while (kept<n)
+            {
+                Kai_Statement_Span old = ((tree->spans).data)[kept];
+                if (old.start>=old_end&&old.start+delta>=token->offset)
+                    break;
+                kept += 1;
+            }
+            if (kept<n)
+            {
+                Kai_Statement_Span old = ((tree->spans).data)[kept];
+                same = ((old.start)+delta)==token->offset;
+            }
+            if (same)
+                break;
+        }
+        Kai_Statement_Span span = {0};
+        span.start = token->offset;
+        span.stmt = kai_parse_declaration(&parser);
+        if (span.stmt==NULL)
+            break;
+        kai__linked_list_append(statements, span.stmt);
+        kai_array_push(&(tree->spans), span);
+        kai_tokenizer_next(&(parser.tokenizer));
+    }
+    Kai_u32 end = to.count;
+    if (same)
+        end = token->offset;
+    else
+        kept = n;
+    if (from.data!=to.data)
+    {
+        for (Kai_u32 i = 0; i < first; ++i)
+        {
+            Kai_Statement_Span* span = &(((tree->spans).data)[i]);
+            if ((span->base).data==NULL)
+                span->base = from;
+        }
+    }
+    for (Kai_u32 i = kept; i < n; ++i)
+    {
+        Kai_Statement_Span span = ((tree->spans).data)[i];
+        if ((span.base).data==NULL)
+            span.base = from;
+        span.start += delta;
+        span.moved += delta;
+        kai_array_push(&(tree->spans), span);
+    }
+    Kai_u32 parsed = ((tree->spans).count-n)-(n-kept);
+    Kai_u32 moved = (tree->spans).count-n;
+    for (Kai_u32 i = 0; i < moved; ++i)
+    {
+        ((tree->spans).data)[first+i] = ((tree->spans).data)[n+i];
+    }
+    (tree->spans).count = first+moved;
+    Kai_Stmt* rest = NULL;
+    if (kept<n)
+    {
+        Kai_Statement_Span span = ((tree->spans).data)[first+parsed];
+        rest = span.stmt;
+    }
+    Kai_Stmt* head = rest;
+    if (statements.head!=NULL)
+    {
+        head = statements.head;
+        Kai_Stmt* last = statements.last;
+        last->next = rest;
+    }
+    if (first==0)
+    {
+        (tree->root).head = head;
+    }
+    else
+    {
+        Kai_Statement_Span before = ((tree->spans).data)[first-1];
+        (before.stmt)->next = head;
+    }
+    tree->source = parser.source;
+    tree->incomplete = (parser.error)->result!=KAI_SUCCESS;
+    tree->update_bytes += end-start;
+    if (tree->arena!=NULL)
+    {
+        *(tree->arena) = parser.arena;
+    }
+    else
+        tree->allocator = parser.arena;
+    if ((parser.error)->result!=KAI_SUCCESS)
+        ((parser.error)->location).source = parser.source;
+    return (parser.error)->result;
+}
+
+KAI_API(Kai_Result) kai_create_source_stream(Kai_Source_Stream_Create_Info* info, Kai_Source_Stream* out_stream)
+{
+    Kai_Allocator* allocator = &(info->allocator);
+    kai__memory_zero(out_stream, sizeof(Kai_Source_Stream));
+    out_stream->window_size = info->window_size;
+    if (out_stream->window_size==0)
+        out_stream->window_size = 1048576;
+    ((out_stream->source).contents).data = (Kai_u8*)(kai__allocate(NULL, out_stream->window_size, 0));
+    if (((out_stream->source).contents).data==NULL)
+        return KAI_ERROR_MEMORY;
+    (out_stream->source).name = info->name;
+    out_stream->line = 1;
+    out_stream->read = info->read;
+    out_stream->user = info->user;
+    out_stream->allocator = info->allocator;
+    out_stream->error = info->error;
+    out_stream->atoms = info->atoms;
+    kai_arena_create(&(out_stream->arena), allocator);
+    out_stream->arena_start = kai_arena_save(&(out_stream->arena));
+    return KAI_SUCCESS;
+}
+
+KAI_API(void) kai_destroy_source_stream(Kai_Source_Stream* stream)
+{
+    Kai_Allocator* allocator = &(stream->allocator);
+    if (((stream->source).contents).data!=NULL)
+        kai__free(((stream->source).contents).data, stream->window_size);
+    if ((stream->arena).current_bucket!=NULL)
+        kai_arena_destroy(&(stream->arena));
+    kai__memory_zero(stream, sizeof(Kai_Source_Stream));
+}
+
+KAI_INTERNAL Kai_bool kai__source_stream_fill(Kai_Source_Stream* stream)
+{
+    Kai_u8* data = ((stream->source).contents).data;
+    Kai_u32 count = ((stream->source).contents).count;
+    if (stream->start!=0)
+    {
+        stream->line += kai_find_line_starts(((Kai_string){.count = stream->start, .data = data}), NULL)-1;
+        stream->offset += stream->start;
+        count -= stream->start;
+        kai__memory_move(data, data+stream->start, count);
+        stream->start = 0;
+        ((stream->source).contents).count = count;
+    }
+    if (count==stream->window_size)
+        return KAI_FALSE;
+    while (count<stream->window_size&&!(stream->ended))
+    {
+        Kai_u32 n = stream->read(stream->user, data+count, stream->window_size-count);
+        if (n==0)
+            stream->ended = KAI_TRUE;
+        count += n;
+    }
+    ((stream->source).contents).count = count;
+    return KAI_TRUE;
+}
+
+KAI_API(Kai_Stmt*) kai_source_stream_next(Kai_Source_Stream* stream)
+{
+    Kai_Allocator* allocator = &(stream->allocator);
+    kai_arena_restore(&(stream->arena), stream->arena_start);
+    while (!(stream->failed))
+    {
+        Kai_Error error = {0};
+        Kai_Parser parser = {0};
+        parser.source = stream->source;
+        (parser.tokenizer).source = (stream->source).contents;
+        (parser.tokenizer).cursor = stream->start;
+        (parser.tokenizer).atoms = stream->atoms;
+        parser.error = &error;
+        parser.arena = stream->arena;
+        parser.reused = KAI_TRUE;
+        (parser.tokenizer).string_arena = &(parser.arena);
+        Kai_Stmt* stmt = NULL;
+        Kai_Token* token = kai_tokenizer_next(&(parser.tokenizer));
+        if (token->id!=KAI_TOKEN_END)
+        {
+            stmt = kai_parse_declaration(&parser);
+            if (stmt!=NULL)
+                token = kai_tokenizer_next(&(parser.tokenizer));
+        }
+        stream->arena = parser.arena;
+        if (stream->ended||(parser.tokenizer).cursor<((stream->source).contents).count)
+        {
+            if (error.result!=KAI_SUCCESS)
+            {
+                (error.location).source = stream->source;
+                (error.location).line += stream->line-1;
+                *(stream->error) = error;
+                stream->failed = KAI_TRUE;
+                return NULL;
+            }
+            if (stmt!=NULL&&token->id!=KAI_TOKEN_END)
+                stream->start = token->offset;
+            else
+                stream->start = ((stream->source).contents).count;
+            return stmt;
+        }
+        if ((error.memory).size>0)
+            kai__free((error.memory).data, (error.memory).size);
+        kai_arena_restore(&(stream->arena), stream->arena_start);
+        if (!kai__source_stream_fill(stream))
+        {
+            *(stream->error) = ((Kai_Error){.result = KAI_ERROR_INTERNAL, .location = ((Kai_Location){.source = stream->source, .string = ((Kai_string){.count = 1, .data = ((stream->source).contents).data}), .line = stream->line}), .message = KAI_STRING("declaration does not fit in the window of the source stream")});
+            stream->failed = KAI_TRUE;
+        }
+    }
+    return NULL;
+}
+
+KAI_INTERNAL Kai_u32 kai__compact_reserve(Kai_Compact_Tree* tree, Kai_u32 count)
+{
+    Kai_Allocator* allocator = &(tree->allocator);
+    Kai_u32 first = (tree->nodes).count;
+    kai_array_grow(&(tree->nodes), count);
+    (tree->nodes).count += count;
+    kai__memory_zero((tree->nodes).data+first, count*sizeof(Kai_Compact_Node));
+    for (Kai_u32 i = first; i < (tree->nodes).count; ++i)
+    {
+        Kai_Compact_Node* node = &(((tree->nodes).data)[i]);
+        node->id = KAI_COMPACT_EMPTY;
+    }
+    return first;
+}
+
+KAI_INTERNAL Kai_u32 kai__compact_string(Kai_Compact_Tree* tree, Kai_string s)
+{
+    Kai_Allocator* allocator = &(tree->allocator);
+    Kai_u32 index = (tree->strings).count;
+    kai_array_push(&(tree->strings), ((Kai_Range){.start = (tree->string_data).count, .count = s.count}));
+    kai_array_grow(&(tree->string_data), s.count);
+    kai__memory_copy((tree->string_data).data+(tree->string_data).count, s.data, s.count);
+    (tree->string_data).count += s.count;
+    return index;
+}
+
+KAI_INTERNAL Kai_Compact_Node kai__compact_expr(Kai__Compactor* compactor, Kai_Expr* expr)
+{
+    Kai_Compact_Tree* tree = compactor->tree;
+    Kai_Allocator* allocator = &(tree->allocator);
+    Kai_string source = (tree->source).contents;
+    Kai_Compact_Node node = {0};
+    node.id = expr->id;
+    node.flags = expr->flags;
+    switch (expr->id)
+    {
+        break; case KAI_EXPR_STRING:
+        {
+            Kai_Expr_String* s = ((Kai_Expr_String*)expr);
+            node.value = kai__compact_string(tree, s->value);
+        }
+        break; case KAI_EXPR_NUMBER:
+        {
+            Kai_Expr_Number* n = ((Kai_Expr_Number*)expr);
+            node.value = (tree->numbers).count;
+            kai_array_push(&(tree->numbers), n->value);
+        }
+        break; case KAI_EXPR_UNARY:
+        {
+            Kai_Expr_Unary* u = ((Kai_Expr_Unary*)expr);
+            node.value = u->op;
+        }
+        break; case KAI_EXPR_BINARY:
+        {
+            Kai_Expr_Binary* b = ((Kai_Expr_Binary*)expr);
+            node.value = b->op;
+        }
+        break; case KAI_STMT_ASSIGNMENT:
+        {
+            Kai_Stmt_Assignment* a = ((Kai_Stmt_Assignment*)expr);
+            node.value = a->op;
+        }
+        break; case KAI_EXPR_PROCEDURE_TYPE:
+        {
+            Kai_Expr_Procedure_Type* p = ((Kai_Expr_Procedure_Type*)expr);
+            node.value = p->in_count;
+        }
+        break; case KAI_EXPR_PROCEDURE:
+        {
+            Kai_Expr_Procedure* p = ((Kai_Expr_Procedure*)expr);
+            node.value = p->in_count;
+        }
+        break; case KAI_EXPR_SPECIAL:
+        {
+            Kai_Expr_Special* s = ((Kai_Expr_Special*)expr);
+            node.value = s->kind;
+        }
+        break; case KAI_STMT_CONTROL:
+        {
+            Kai_Stmt_Control* c = ((Kai_Stmt_Control*)expr);
+            node.value = c->kind;
+        }
+        break; case KAI_STMT_FOR:
+        {
+            Kai_Stmt_For* f = ((Kai_Stmt_For*)expr);
+            node.atom = kai_intern_atom(tree->atoms, f->iterator_name);
+        }
+    }
+    if (expr->id==KAI_EXPR_IDENTIFIER)
+        node.atom = kai_intern_atom(tree->atoms, expr->source_code);
+    node.name_atom = kai_intern_atom(tree->atoms, expr->name);
+    node.offset = expr->offset;
+    if ((expr->source_code).data>=source.data&&(expr->source_code).data+(expr->source_code).count<=source.data+source.count)
+    {
+        node.offset = (Kai_u32)((expr->source_code).data-source.data);
+        node.length = (expr->source_code).count;
+    }
+    Kai_u32 base = (compactor->children).count;
+    kai__push_expr_children(&(compactor->children), allocator, expr);
+    Kai_u32 child_count = (compactor->children).count-base;
+    Kai_u32 tag_count = 0;
+    Kai_Tag* tag = expr->tag;
+    while (tag!=NULL)
+    {
+        tag_count += 1;
+        tag = tag->next;
+    }
+    kai_assert(tag_count<=65535);
+    node.tag_count = tag_count;
+    node.first_child = kai__compact_reserve(tree, child_count+tag_count);
+    node.child_count = child_count+tag_count;
+    for (Kai_u32 i = 0; i < child_count; ++i)
+    {
+        Kai_Expr* child = ((compactor->children).data)[base+i];
+        if (child!=NULL)
+            kai__compact_fill(compactor, node.first_child+i, child);
+    }
+    (compactor->children).count = base;
+    tag = expr->tag;
+    for (Kai_u32 i = 0; i < tag_count; ++i)
+    {
+        Kai_u32 tag_index = (node.first_child+child_count)+i;
+        Kai_u32 tag_base = (compactor->children).count;
+        kai__push_expr_list(&(compactor->children), allocator, tag->expr, 4294967295);
+        Kai_u32 expr_count = (compactor->children).count-tag_base;
+        Kai_u32 tag_first = kai__compact_reserve(tree, expr_count);
+        Kai_Compact_Node* tag_node = &(((tree->nodes).data)[tag_index]);
+        tag_node->id = KAI_COMPACT_TAG;
+        tag_node->name_atom = kai_intern_atom(tree->atoms, tag->name);
+        tag_node->first_child = tag_first;
+        tag_node->child_count = expr_count;
+        for (Kai_u32 k = 0; k < expr_count; ++k)
+        {
+            Kai_Expr* tag_expr = ((compactor->children).data)[tag_base+k];
+            kai__compact_fill(compactor, tag_first+k, tag_expr);
+        }
+        (compactor->children).count = tag_base;
+        tag = tag->next;
+    }
+    return node;
+}
+
+KAI_INTERNAL void kai__compact_fill(Kai__Compactor* compactor, Kai_u32 index, Kai_Expr* expr)
+{
+    Kai_Compact_Node node = kai__compact_expr(compactor, expr);
+    Kai_Compact_Tree* tree = compactor->tree;
+    ((tree->nodes).data)[index] = node;
+}
+
+KAI_INTERNAL void kai__compact_begin(Kai__Compactor* compactor, Kai_Compact_Tree* out_tree, Kai_Source source, Kai_Atom_Table* atoms, Kai_Allocator* allocator)
+{
+    kai__memory_zero(out_tree, sizeof(Kai_Compact_Tree));
+    out_tree->source = source;
+    out_tree->atoms = atoms;
+    out_tree->allocator = *allocator;
+    compactor->tree = out_tree;
+    kai__compact_reserve(out_tree, 2);
+}
+
+KAI_INTERNAL void kai__compact_end(Kai__Compactor* compactor)
+{
+    Kai_Compact_Tree* tree = compactor->tree;
+    Kai_Allocator* allocator = &(tree->allocator);
+    Kai_u32 count = (compactor->statements).count;
+    Kai_u32 first = kai__compact_reserve(tree, count);
+    kai__memory_copy((tree->nodes).data+first, (compactor->statements).data, count*sizeof(Kai_Compact_Node));
+    Kai_Compact_Node* root = &(((tree->nodes).data)[1]);
+    root->id = KAI_STMT_COMPOUND;
+    root->first_child = first;
+    root->child_count = count;
+    kai_array_destroy(&(compactor->children));
+    kai_array_destroy(&(compactor->statements));
+}
+
+KAI_API(void) kai_create_compact_tree(Kai_Syntax_Tree* tree, Kai_Atom_Table* atoms, Kai_Allocator* allocator, Kai_Compact_Tree* out_tree)
+{
+    kai_settle_syntax_tree(tree);
+    Kai__Compactor compactor = {0};
+    kai__compact_begin(&compactor, out_tree, tree->source, atoms, allocator);
+    Kai_Stmt* stmt = (tree->root).head;
+    while (stmt!=NULL)
+    {
+        Kai_Compact_Node node = kai__compact_expr(&compactor, stmt);
+        kai_array_push(&(compactor.statements), node);
+        stmt = stmt->next;
+    }
+    kai__compact_end(&compactor);
+}
+
+KAI_API(Kai_Result) kai_parse_compact_tree(Kai_Syntax_Tree_Create_Info* info, Kai_Compact_Tree* out_tree)
+{
+    kai_assert(info->atoms!=NULL);
+    Kai_Allocator* allocator = &(info->allocator);
+    Kai__Compactor compactor = {0};
+    kai__compact_begin(&compactor, out_tree, info->source, info->atoms, allocator);
+    if (((out_tree->source).line_starts).count==0)
+    {
+        kai_find_line_starts_into((out_tree->source).contents, &(out_tree->lines), allocator);
+        ((out_tree->source).line_starts).data = (out_tree->lines).data;
+        ((out_tree->source).line_starts).count = (out_tree->lines).count;
+    }
+    Kai_Parser parser = {0};
+    parser.source = out_tree->source;
+    (parser.tokenizer).source = (info->source).contents;
+    (parser.tokenizer).atoms = info->atoms;
+    (parser.tokenizer).tokens = info->tokens;
+    parser.error = info->error;
+    if (info->arena!=NULL)
+        parser.arena = *(info->arena);
+    else
+        kai_arena_create(&(parser.arena), allocator);
+    parser.reused = KAI_TRUE;
+    (parser.tokenizer).string_arena = &(parser.arena);
+    Kai_Arena_Checkpoint start = kai_arena_save(&(parser.arena));
+    Kai_Token* token = kai_tokenizer_next(&(parser.tokenizer));
+    while (token->id!=KAI_TOKEN_END)
+    {
+        Kai_Stmt* stmt = kai_parse_declaration(&parser);
+        if (stmt==NULL)
+            break;
+        Kai_Compact_Node node = kai__compact_expr(&compactor, stmt);
+        kai_array_push(&(compactor.statements), node);
+        token = kai_tokenizer_next(&(parser.tokenizer));
+        kai_arena_restore(&(parser.arena), start);
+        if (token->id!=KAI_TOKEN_END&&info->tokens==NULL)
+        {
+            (parser.tokenizer).cursor = token->offset;
+            (parser.tokenizer).peeking = KAI_FALSE;
+            token = kai_tokenizer_next(&(parser.tokenizer));
+        }
+    }
+    kai__compact_end(&compactor);
+    if (info->arena!=NULL)
+    {
+        kai_arena_restore(&(parser.arena), start);
+        *(info->arena) = parser.arena;
+    }
+    else
+        kai_arena_destroy(&(parser.arena));
+    if ((parser.error)->result!=KAI_SUCCESS)
+        ((parser.error)->location).source = parser.source;
+    return (parser.error)->result;
+}
+
+KAI_API(void) kai_destroy_compact_tree(Kai_Compact_Tree* tree)
+{
+    Kai_Allocator* allocator = &(tree->allocator);
+    kai_array_destroy(&(tree->nodes));
+    kai_array_destroy(&(tree->numbers));
+    kai_array_destroy(&(tree->strings));
+    kai_array_destroy(&(tree->string_data));
+    kai_array_destroy(&(tree->lines));
+}
+
+KAI_API(Kai_Compact_Node*) kai_compact_node(Kai_Compact_Tree* tree, Kai_u32 index)
+{
+    return &(((tree->nodes).data)[index]);
+}
+
+KAI_API(Kai_u32) kai_compact_child(Kai_Compact_Tree* tree, Kai_u32 index, Kai_u32 i)
+{
+    Kai_Compact_Node* node = &(((tree->nodes).data)[index]);
+    if (i>=node->child_count)
+        return 0;
+    Kai_Compact_Node* child = &(((tree->nodes).data)[node->first_child+i]);
+    if (child->id==KAI_COMPACT_EMPTY)
+        return 0;
+    return node->first_child+i;
+}
+
+KAI_API(Kai_string) kai_compact_source(Kai_Compact_Tree* tree, Kai_u32 index)
+{
+    Kai_Compact_Node* node = &(((tree->nodes).data)[index]);
+    return ((Kai_string){.count = node->length, .data = ((tree->source).contents).data+node->offset});
+}
+
+KAI_API(Kai_string) kai_compact_name(Kai_Compact_Tree* tree, Kai_u32 index)
+{
+    Kai_Compact_Node* node = &(((tree->nodes).data)[index]);
+    return (((tree->atoms)->names).data)[node->name_atom];
+}
+
+KAI_API(Kai_string) kai_compact_string(Kai_Compact_Tree* tree, Kai_u32 index)
+{
+    Kai_Compact_Node* node = &(((tree->nodes).data)[index]);
+    Kai_Range range = ((tree->strings).data)[node->value];
+    return ((Kai_string){.count = range.count, .data = (tree->string_data).data+range.start});
+}
+
+KAI_API(Kai_Number) kai_compact_number(Kai_Compact_Tree* tree, Kai_u32 index)
+{
+    Kai_Compact_Node* node = &(((tree->nodes).data)[index]);
+    return ((tree->numbers).data)[node->value];
+}
+
+KAI_INTERNAL Kai_u32 kai__compact_expr_size(Kai_u8 id)
+{
+    switch (id)
+    {
+        break; case KAI_EXPR_STRING:
+        return sizeof(Kai_Expr_String);
+        break; case KAI_EXPR_NUMBER:
+        return sizeof(Kai_Expr_Number);
+        break; case KAI_EXPR_LITERAL:
+        return sizeof(Kai_Expr_Literal);
+        break; case KAI_EXPR_UNARY:
+        return sizeof(Kai_Expr_Unary);
+        break; case KAI_EXPR_BINARY:
+        return sizeof(Kai_Expr_Binary);
+        break; case KAI_EXPR_PROCEDURE_TYPE:
+        return sizeof(Kai_Expr_Procedure_Type);
+        break; case KAI_EXPR_PROCEDURE_CALL:
+        return sizeof(Kai_Expr_Procedure_Call);
+        break; case KAI_EXPR_PROCEDURE:
+        return sizeof(Kai_Expr_Procedure);
+        break; case KAI_EXPR_STRUCT:
+        return sizeof(Kai_Expr_Struct);
+        break; case KAI_EXPR_ENUM:
+        return sizeof(Kai_Expr_Enum);
+        break; case KAI_EXPR_ARRAY:
+        return sizeof(Kai_Expr_Array);
+        break; case KAI_EXPR_SPECIAL:
+        return sizeof(Kai_Expr_Special);
+        break; case KAI_STMT_RETURN:
+        return sizeof(Kai_Stmt_Return);
+        break; case KAI_STMT_DECLARATION:
+        return sizeof(Kai_Stmt_Declaration);
+        break; case KAI_STMT_ASSIGNMENT:
+        return sizeof(Kai_Stmt_Assignment);
+        break; case KAI_STMT_IF:
+        return sizeof(Kai_Stmt_If);
+        break; case KAI_STMT_WHILE:
+        return sizeof(Kai_Stmt_While);
+        break; case KAI_STMT_FOR:
+        return sizeof(Kai_Stmt_For);
+        break; case KAI_STMT_CONTROL:
+        return sizeof(Kai_Stmt_Control);
+        break; case KAI_STMT_COMPOUND:
+        return sizeof(Kai_Stmt_Compound);
+    }
+    return sizeof(Kai_Expr);
+}
+
+KAI_INTERNAL Kai_string kai__compact_copy_string(Kai_string s, Kai_Arena_Allocator* arena)
+{
+    if (s.count==0)
+        return ((Kai_string){0});
+    Kai_u8* data = ((Kai_u8*)kai_arena_allocate(arena, (Kai_u32)(kai__ceil_div(s.count, 8))*8));
+    kai__memory_copy(data, s.data, s.count);
+    return ((Kai_string){.count = s.count, .data = data});
+}
+
+KAI_API(Kai_Expr*) kai_compact_expand_node(Kai_Compact_Tree* tree, Kai_u32 index, Kai_Arena_Allocator* arena)
+{
+    if (index==0)
+        return NULL;
+    Kai_Compact_Node* node = &(((tree->nodes).data)[index]);
+    Kai_u32 size = kai__compact_expr_size(node->id);
+    Kai_Expr* expr = ((Kai_Expr*)kai_arena_allocate(arena, size));
+    kai__memory_zero(expr, size);
+    expr->id = node->id;
+    expr->flags = node->flags;
+    expr->source_code = kai_compact_source(tree, index);
+    expr->offset = node->offset;
+    expr->name_atom = node->name_atom;
+    if (node->id==KAI_STMT_DECLARATION)
+        expr->name = expr->source_code;
+    else
+        expr->name = kai__compact_copy_string((((tree->atoms)->names).data)[node->name_atom], arena);
+    switch (node->id)
+    {
+        break; case KAI_EXPR_IDENTIFIER:
+        {
+            expr->atom = node->atom;
+        }
+        break; case KAI_EXPR_STRING:
+        {
+            Kai_Expr_String* s = ((Kai_Expr_String*)expr);
+            s->value = kai__compact_copy_string(kai_compact_string(tree, index), arena);
+        }
+        break; case KAI_EXPR_NUMBER:
+        {
+            Kai_Expr_Number* n = ((Kai_Expr_Number*)expr);
+            n->value = kai_compact_number(tree, index);
+        }
+        break; case KAI_EXPR_UNARY:
+        {
+            Kai_Expr_Unary* u = ((Kai_Expr_Unary*)expr);
+            u->op = node->value;
+        }
+        break; case KAI_EXPR_BINARY:
+        {
+            Kai_Expr_Binary* b = ((Kai_Expr_Binary*)expr);
+            b->op = node->value;
+        }
+        break; case KAI_STMT_ASSIGNMENT:
+        {
+            Kai_Stmt_Assignment* a = ((Kai_Stmt_Assignment*)expr);
+            a->op = node->value;
+        }
+        break; case KAI_EXPR_PROCEDURE_TYPE:
+        {
+            Kai_Expr_Procedure_Type* p = ((Kai_Expr_Procedure_Type*)expr);
+            p->in_count = node->value;
+            p->out_count = (node->child_count-node->tag_count)-node->value;
+        }
+        break; case KAI_EXPR_PROCEDURE:
+        {
+            Kai_Expr_Procedure* p = ((Kai_Expr_Procedure*)expr);
+            p->in_count = node->value;
+            p->out_count = ((node->child_count-node->tag_count)-node->value)-1;
+        }
+        break; case KAI_EXPR_SPECIAL:
+        {
+            Kai_Expr_Special* s = ((Kai_Expr_Special*)expr);
+            s->kind = node->value;
+        }
+        break; case KAI_STMT_CONTROL:
+        {
+            Kai_Stmt_Control* c = ((Kai_Stmt_Control*)expr);
+            c->kind = node->value;
+        }
+        break; case KAI_STMT_FOR:
+        {
+            Kai_Stmt_For* f = ((Kai_Stmt_For*)expr);
+            f->iterator_atom = node->atom;
+            f->iterator_name = kai__compact_copy_string((((tree->atoms)->names).data)[node->atom], arena);
+        }
+    }
+    return expr;
+}
+
+KAI_INTERNAL Kai_Expr* kai__compact_expand_list(Kai_Compact_Tree* tree, Kai_u32 index, Kai_u32 first, Kai_u32 count, Kai_Arena_Allocator* arena)
+{
+    Kai_Expr* head = NULL;
+    Kai_Expr* last = NULL;
+    for (Kai_u32 i = first; i < first+count; ++i)
+    {
+        Kai_Expr* expr = kai_compact_expand(tree, kai_compact_child(tree, index, i), arena);
+        if (last==NULL)
+            head = expr;
+        else
+            last->next = expr;
+        last = expr;
+    }
+    return head;
+}
+
+KAI_API(Kai_Expr*) kai_compact_expand(Kai_Compact_Tree* tree, Kai_u32 index, Kai_Arena_Allocator* arena)
+{
+    Kai_Expr* expr = kai_compact_expand_node(tree, index, arena);
+    if (expr==NULL)
+        return NULL;
+    Kai_Compact_Node* node = &(((tree->nodes).data)[index]);
+    Kai_u32 count = node->child_count-node->tag_count;
+    switch (expr->id)
+    {
+        break; case KAI_EXPR_LITERAL:
+        {
+            Kai_Expr_Literal* l = ((Kai_Expr_Literal*)expr);
+            l->head = kai__compact_expand_list(tree, index, 0, count, arena);
+            l->count = count;
+        }
+        break; case KAI_EXPR_UNARY:
+        {
+            Kai_Expr_Unary* u = ((Kai_Expr_Unary*)expr);
+            u->expr = kai_compact_expand(tree, kai_compact_child(tree, index, 0), arena);
+        }
+        break; case KAI_EXPR_BINARY:
+        {
+            Kai_Expr_Binary* b = ((Kai_Expr_Binary*)expr);
+            b->left = kai_compact_expand(tree, kai_compact_child(tree, index, 0), arena);
+            b->right = kai_compact_expand(tree, kai_compact_child(tree, index, 1), arena);
+        }
+        break; case KAI_EXPR_PROCEDURE_TYPE:
+        {
+            Kai_Expr_Procedure_Type* p = ((Kai_Expr_Procedure_Type*)expr);
+            p->in_out_expr = kai__compact_expand_list(tree, index, 0, count, arena);
+        }
+        break; case KAI_EXPR_PROCEDURE_CALL:
+        {
+            Kai_Expr_Procedure_Call* c = ((Kai_Expr_Procedure_Call*)expr);
+            c->proc = kai_compact_expand(tree, kai_compact_child(tree, index, 0), arena);
+            c->arg_head = kai__compact_expand_list(tree, index, 1, count-1, arena);
+            c->arg_count = count-1;
+        }
+        break; case KAI_EXPR_PROCEDURE:
+        {
+            Kai_Expr_Procedure* p = ((Kai_Expr_Procedure*)expr);
+            p->in_out_expr = kai__compact_expand_list(tree, index, 0, count-1, arena);
+            p->body = kai_compact_expand(tree, kai_compact_child(tree, index, count-1), arena);
+        }
+        break; case KAI_EXPR_STRUCT:
+        {
+            Kai_Expr_Struct* s = ((Kai_Expr_Struct*)expr);
+            s->head = kai__compact_expand_list(tree, index, 0, count, arena);
+            s->field_count = count;
+        }
+        break; case KAI_EXPR_ENUM:
+        {
+            Kai_Expr_Enum* e = ((Kai_Expr_Enum*)expr);
+            e->type = kai_compact_expand(tree, kai_compact_child(tree, index, 0), arena);
+            e->head = kai__compact_expand_list(tree, index, 1, count-1, arena);
+            e->field_count = count-1;
+        }
+        break; case KAI_EXPR_ARRAY:
+        {
+            Kai_Expr_Array* a = ((Kai_Expr_Array*)expr);
+            a->rows = kai_compact_expand(tree, kai_compact_child(tree, index, 0), arena);
+            a->cols = kai_compact_expand(tree, kai_compact_child(tree, index, 1), arena);
+            a->expr = kai_compact_expand(tree, kai_compact_child(tree, index, 2), arena);
+        }
+        break; case KAI_STMT_RETURN:
+        {
+            Kai_Stmt_Return* r = ((Kai_Stmt_Return*)expr);
+            r->expr = kai_compact_expand(tree, kai_compact_child(tree, index, 0), arena);
+        }
+        break; case KAI_STMT_DECLARATION:
+        {
+            Kai_Stmt_Declaration* d = ((Kai_Stmt_Declaration*)expr);
+            d->type = kai_compact_expand(tree, kai_compact_child(tree, index, 0), arena);
+            d->value = kai_compact_expand(tree, kai_compact_child(tree, index, 1), arena);
+        }
+        break; case KAI_STMT_ASSIGNMENT:
+        {
+            Kai_Stmt_Assignment* a = ((Kai_Stmt_Assignment*)expr);
+            a->dest = kai_compact_expand(tree, kai_compact_child(tree, index, 0), arena);
+            a->value = kai_compact_expand(tree, kai_compact_child(tree, index, 1), arena);
+        }
+        break; case KAI_STMT_COMPOUND:
+        {
+            Kai_Stmt_Compound* c = ((Kai_Stmt_Compound*)expr);
+            c->head = kai__compact_expand_list(tree, index, 0, count, arena);
+        }
+        break; case KAI_STMT_IF:
+        {
+            Kai_Stmt_If* i = ((Kai_Stmt_If*)expr);
+            i->condition = kai_compact_expand(tree, kai_compact_child(tree, index, 0), arena);
+            i->then_body = kai_compact_expand(tree, kai_compact_child(tree, index, 1), arena);
+            i->else_body = kai_compact_expand(tree, kai_compact_child(tree, index, 2), arena);
+        }
+        break; case KAI_STMT_WHILE:
+        {
+            Kai_Stmt_While* w = ((Kai_Stmt_While*)expr);
+            w->condition = kai_compact_expand(tree, kai_compact_child(tree, index, 0), arena);
+            w->body = kai_compact_expand(tree, kai_compact_child(tree, index, 1), arena);
+        }
+        break; case KAI_STMT_FOR:
+        {
+            Kai_Stmt_For* f = ((Kai_Stmt_For*)expr);
+            f->from = kai_compact_expand(tree, kai_compact_child(tree, index, 0), arena);
+            f->to = kai_compact_expand(tree, kai_compact_child(tree, index, 1), arena);
+            f->body = kai_compact_expand(tree, kai_compact_child(tree, index, 2), arena);
+        }
+        break; case KAI_STMT_CONTROL:
+        {
+            Kai_Stmt_Control* c = ((Kai_Stmt_Control*)expr);
+            c->expr = kai_compact_expand(tree, kai_compact_child(tree, index, 0), arena);
+        }
+    }
+    Kai_Tag* last = NULL;
+    for (Kai_u32 t = 0; t < node->tag_count; ++t)
+    {
+        Kai_u32 tag_index = (node->first_child+count)+t;
+        Kai_Compact_Node* tag_node = &(((tree->nodes).data)[tag_index]);
+        Kai_Tag* tag = ((Kai_Tag*)kai_arena_allocate(arena, sizeof(Kai_Tag)));
+        kai__memory_zero(tag, sizeof(Kai_Tag));
+        tag->name = kai__compact_copy_string((((tree->atoms)->names).data)[tag_node->name_atom], arena);
+        tag->expr = kai__compact_expand_list(tree, tag_index, 0, tag_node->child_count, arena);
+        if (last==NULL)
+            expr->tag = tag;
+        else
+            last->next = tag;
+        last = tag;
+    }
+    return expr;
+}
+
+KAI_API(Kai_u32) kai_asm_create_label(Kai_Assembler* assembler)
+{
+    return (assembler->code).count*4;
+}
+
+KAI_API(Kai_s32) kai_asm_relative_location(Kai_u32 label_from, Kai_u32 label_to)
+{
+    return (Kai_s32)(label_to>>2)-(Kai_s32)(label_from>>2);
+}
+
+KAI_API(Kai_u32) kai_asm_insert_jump(Kai_Assembler* assembler, Kai_u32 condition, Kai_s32 relative)
+{
+    if (assembler->backend<=0)
+        return 0;
+    Kai_Allocator* allocator = assembler->allocator;
+    Kai_u32 label = (assembler->code).count*4;
+    kai_array_push(&(assembler->code), kai__arm64_b(relative, condition));
+    return label;
+}
+
+KAI_API(void) kai_asm_modify_jump(Kai_Assembler* assembler, Kai_u32 label, Kai_s32 relative)
+{
+    if (assembler->backend<=0)
+        return;
+    ((assembler->code).data)[label/4] |= kai__arm64_b(relative, 0);
+}
+
+KAI_API(void) kai_asm_insert_ret(Kai_Assembler* assembler)
+{
+    if (assembler->backend<=0)
+        return;
+    Kai_Allocator* allocator = assembler->allocator;
+    kai_array_push(&(assembler->code), kai__arm64_ret());
+}
+
+KAI_API(void) kai_asm_insert_load_constant(Kai_Assembler* assembler, Kai_u32 reg, Kai_u64 value)
+{
+    if (assembler->backend<=0)
+        return;
+    Kai_Allocator* allocator = assembler->allocator;
+    kai_array_push(&(assembler->code), kai__arm64_movz(reg, (Kai_u16)(value), 0));
+    Kai_u8 shift = 1;
+    value = value>>16;
+    while (value!=0)
+    {
+        if ((Kai_u16)(value)!=0)
+            kai_array_push(&(assembler->code), kai__arm64_movk(reg, (Kai_u16)(value), shift));
+        value = value>>16;
+        shift += 1;
+    }
+}
+
+KAI_API(void) kai_asm_insert_stack_load(Kai_Assembler* assembler, Kai_u32 index, Kai_u32 reg)
+{
+    if (assembler->backend<=0)
+        return;
+    Kai_Allocator* allocator = assembler->allocator;
+    kai_array_push(&(assembler->code), kai__arm64_ldr(31, reg, -index*8));
+}
+
+KAI_API(void) kai_asm_insert_stack_store(Kai_Assembler* assembler, Kai_u32 index, Kai_u32 reg)
+{
+    if (assembler->backend<=0)
+        return;
+    Kai_Allocator* allocator = assembler->allocator;
+    kai_array_push(&(assembler->code), kai__arm64_str(31, reg, -index*8));
+}
+
+KAI_API(void) kai_asm_insert_add(Kai_Assembler* assembler, Kai_u32 dst, Kai_u32 a, Kai_u32 b)
+{
+    if (assembler->backend<=0)
+        return;
+    Kai_Allocator* allocator = assembler->allocator;
+    kai_array_push(&(assembler->code), kai__arm64_add(dst, a, b, 1));
+}
+
+KAI_API(void) kai_asm_insert_sub(Kai_Assembler* assembler, Kai_u32 dst, Kai_u32 a, Kai_u32 b)
+{
+    if (assembler->backend<=0)
+        return;
+    Kai_Allocator* allocator = assembler->allocator;
+    kai_array_push(&(assembler->code), kai__arm64_sub(dst, a, b, 1));
+}
+
+KAI_API(void) kai_asm_insert_cmp(Kai_Assembler* assembler, Kai_u32 a, Kai_u32 b)
+{
+    if (assembler->backend<=0)
+        return;
+    Kai_Allocator* allocator = assembler->allocator;
+    kai_array_push(&(assembler->code), kai__arm64_cmp(a, b, 1));
+}
+
+KAI_API(void) kai_asm_insert_move(Kai_Assembler* assembler, Kai_u32 dst, Kai_u32 src)
+{
+    if (assembler->backend<=0)
+        return;
+    Kai_Allocator* allocator = assembler->allocator;
+    kai_array_push(&(assembler->code), kai__arm64_mov(dst, src, 1));
+}
+
+KAI_API(void) kai_asm_insert_test(Kai_Assembler* assembler, Kai_u32 reg)
+{
+    if (assembler->backend<=0)
+        return;
+    Kai_Allocator* allocator = assembler->allocator;
+    kai_array_push(&(assembler->code), kai__arm64_tst_1(reg, 1));
+}
+
+KAI_API(void) kai_asm_insert_extend(Kai_Assembler* assembler, Kai_u32 reg, Kai_u8 bits, Kai_bool is_signed)
+{
+    if (assembler->backend<=0)
+        return;
+    if (bits>=64)
+        return;
+    Kai_Allocator* allocator = assembler->allocator;
+    if (is_signed)
+        kai_array_push(&(assembler->code), kai__arm64_sbfm(reg, reg, 0, bits-1, 1));
+    else
+        kai_array_push(&(assembler->code), kai__arm64_ubfm(reg, reg, 0, bits-1, 1));
+}
+
+KAI_API(Kai_u32) kai_asm_insert_jump_table(Kai_Assembler* assembler, Kai_u32 reg, Kai_u32 count)
+{
+    if (assembler->backend<=0)
+        return 0;
+    Kai_Allocator* allocator = assembler->allocator;
+    kai_array_push(&(assembler->code), kai__arm64_adr(1, 16));
+    kai_array_push(&(assembler->code), kai__arm64_ldrsw_lsl2(2, 1, reg));
+    kai_array_push(&(assembler->code), kai__arm64_add(1, 1, 2, 1));
+    kai_array_push(&(assembler->code), kai__arm64_br(1));
+    Kai_u32 table = kai_asm_create_label(assembler);
+    for (Kai_u32 i = 0; i < count; ++i)
+    {
+        kai_array_push(&(assembler->code), 0);
+    }
+    return table;
+}
+
+KAI_API(void) kai_asm_set_jump_table_entry(Kai_Assembler* assembler, Kai_u32 table, Kai_u32 index, Kai_u32 target)
+{
+    if (assembler->backend<=0)
+        return;
+    ((assembler->code).data)[table/4+index] = target-table;
+}
+
+KAI_API(void) kai_asm_insert_string_hash(Kai_Assembler* assembler, Kai_u32 count, Kai_u32 data, Kai_u32 a, Kai_u32 b, Kai_u32 p, Kai_u32 q, Kai_u32 n)
+{
+    if (assembler->backend<=0)
+        return;
+    Kai_Allocator* allocator = assembler->allocator;
+    kai_asm_insert_load_constant(assembler, 2, 0);
+    kai_array_push(&(assembler->code), kai__arm64_subs(p, count, 1));
+    kai_array_push(&(assembler->code), kai__arm64_b(2, KAI_CONDITION_LS));
+    kai_array_push(&(assembler->code), kai__arm64_ldrb_12(data, 2, p));
+    kai_asm_insert_load_constant(assembler, 3, 0);
+    kai_array_push(&(assembler->code), kai__arm64_subs(q, count, 1));
+    kai_array_push(&(assembler->code), kai__arm64_b(2, KAI_CONDITION_LS));
+    kai_array_push(&(assembler->code), kai__arm64_ldrb_12(data, 3, q));
+    kai_asm_insert_load_constant(assembler, 5, a);
+    kai_array_push(&(assembler->code), kai__arm64_madd(4, count, 5, 3));
+    kai_asm_insert_load_constant(assembler, 5, b);
+    kai_array_push(&(assembler->code), kai__arm64_madd(4, 2, 5, 4));
+    kai_asm_insert_load_constant(assembler, 5, n);
+    kai_array_push(&(assembler->code), kai__arm64_udiv(6, 4, 5));
+    kai_array_push(&(assembler->code), kai__arm64_msub(4, 6, 5, 4));
+}
+
+KAI_API(Kai_u32) kai_asm_insert_string_compare(Kai_Assembler* assembler, Kai_u32 count, Kai_u32 data, Kai_string text)
+{
+    if (assembler->backend<=0)
+        return 0;
+    Kai_Allocator* allocator = assembler->allocator;
+    kai_asm_insert_load_constant(assembler, 2, text.count);
+    kai_asm_insert_cmp(assembler, 2, count);
+    Kai_u32 other_count = kai_asm_insert_jump(assembler, KAI_CONDITION_NE, 0);
+    if (text.count==0)
+    {
+        Kai_u32 equal = kai_asm_insert_jump(assembler, KAI_CONDITION_AL, 0);
+        kai_asm_modify_jump(assembler, other_count, kai_asm_relative_location(other_count, kai_asm_create_label(assembler)));
+        return equal;
+    }
+    Kai_u32 address = kai_asm_create_label(assembler);
+    kai_array_push(&(assembler->code), 0);
+    kai_array_push(&(assembler->code), kai__arm64_mov(4, data, 1));
+    kai_asm_insert_load_constant(assembler, 5, text.count);
+    kai_array_push(&(assembler->code), kai__arm64_ldrb_post(3, 2, 1));
+    kai_array_push(&(assembler->code), kai__arm64_ldrb_post(4, 6, 1));
+    kai_asm_insert_cmp(assembler, 6, 2);
+    Kai_u32 other_byte = kai_asm_insert_jump(assembler, KAI_CONDITION_NE, 0);
+    kai_array_push(&(assembler->code), kai__arm64_subs_imm(5, 5, 1, 1));
+    kai_array_push(&(assembler->code), kai__arm64_b(-5, KAI_CONDITION_NE));
+    Kai_u32 equal = kai_asm_insert_jump(assembler, KAI_CONDITION_AL, 0);
+    ((assembler->code).data)[address/4] = kai__arm64_adr(3, (Kai_s32)(kai_asm_create_label(assembler)-address));
+    Kai_u32 word = 0;
+    for (Kai_u32 k = 0; k < text.count; ++k)
+    {
+        word |= ((Kai_u32)((text.data)[k]))<<((k%4)*8);
+        if (k%4==3||(k+1)==text.count)
+        {
+            kai_array_push(&(assembler->code), word);
+            word = 0;
+        }
+    }
+    Kai_u32 after = kai_asm_create_label(assembler);
+    kai_asm_modify_jump(assembler, other_count, kai_asm_relative_location(other_count, after));
+    kai_asm_modify_jump(assembler, other_byte, kai_asm_relative_location(other_byte, after));
+    return equal;
+}
+
+KAI_API(void) kai_asm_insert_count_leading_zeros(Kai_Assembler* assembler, Kai_u32 reg, Kai_u8 bits)
+{
+    if (assembler->backend<=0)
+        return;
+    Kai_Allocator* allocator = assembler->allocator;
+    Kai_u8 sf = (Kai_u8)(bits==64);
+    kai__asm_insert_zero_extend(assembler, reg, bits);
+    kai_array_push(&(assembler->code), kai__arm64_clz(reg, reg, sf));
+    if (bits<32)
+    {
+        kai_array_push(&(assembler->code), kai__arm64_sub_imm(reg, reg, 32-bits, 0));
+    }
+}
+
+KAI_API(void) kai_asm_insert_count_trailing_zeros(Kai_Assembler* assembler, Kai_u32 reg, Kai_u8 bits)
+{
+    if (assembler->backend<=0)
+        return;
+    Kai_Allocator* allocator = assembler->allocator;
+    Kai_u8 sf = (Kai_u8)(bits==64);
+    if (bits<32)
+    {
+        kai_array_push(&(assembler->code), kai__arm64_orr_bit(reg, reg, bits));
+    }
+    kai_array_push(&(assembler->code), kai__arm64_rbit(reg, reg, sf));
+    kai_array_push(&(assembler->code), kai__arm64_clz(reg, reg, sf));
+}
+
+KAI_API(void) kai_asm_insert_popcount(Kai_Assembler* assembler, Kai_u32 reg, Kai_u8 bits)
+{
+    if (assembler->backend<=0)
+        return;
+    Kai_Allocator* allocator = assembler->allocator;
+    kai__asm_insert_zero_extend(assembler, reg, bits);
+    if (bits==64)
+        kai_array_push(&(assembler->code), kai__arm64_fmov_to_d(0, reg));
+    else
+        kai_array_push(&(assembler->code), kai__arm64_fmov_to_s(0, reg));
+    kai_array_push(&(assembler->code), kai__arm64_cnt_8b(0, 0));
+    kai_array_push(&(assembler->code), kai__arm64_addv_8b(0, 0));
+    kai_array_push(&(assembler->code), kai__arm64_fmov_from_s(reg, 0));
+}
+
+KAI_API(void) kai_asm_insert_byte_swap(Kai_Assembler* assembler, Kai_u32 reg, Kai_u8 bits)
+{
+    if (assembler->backend<=0)
+        return;
+    Kai_Allocator* allocator = assembler->allocator;
+    switch (bits)
+    {
+        break; case 8:
+        return;
+        break; case 16:
+        {
+            kai__asm_insert_zero_extend(assembler, reg, bits);
+            kai_array_push(&(assembler->code), kai__arm64_rev16(reg, reg));
+        }
+        break; case 32:
+        kai_array_push(&(assembler->code), kai__arm64_rev(reg, reg, 0));
+        break; case 64:
+        kai_array_push(&(assembler->code), kai__arm64_rev(reg, reg, 1));
+    }
+}
+
+KAI_API(void) kai_asm_insert_rotate_left(Kai_Assembler* assembler, Kai_u32 dst, Kai_u32 value, Kai_u32 shift, Kai_u8 bits)
+{
+    if (assembler->backend<=0)
+        return;
+    Kai_Allocator* allocator = assembler->allocator;
+    Kai_u8 sf = (Kai_u8)(bits==64);
+    kai_array_push(&(assembler->code), kai__arm64_sub(shift, 31, shift, sf));
+    kai_array_push(&(assembler->code), kai__arm64_rorv(dst, value, shift, sf));
+}
+
+KAI_API(void) kai_asm_insert_multiply_high(Kai_Assembler* assembler, Kai_u32 dst, Kai_u32 a, Kai_u32 b)
+{
+    if (assembler->backend<=0)
+        return;
+    Kai_Allocator* allocator = assembler->allocator;
+    kai_array_push(&(assembler->code), kai__arm64_umulh(dst, a, b));
+}
+
+KAI_API(void) kai_asm_insert_memory_copy(Kai_Assembler* assembler, Kai_u32 dst, Kai_u32 src, Kai_u32 size)
+{
+    if (assembler->backend<=0)
+        return;
+    Kai_Allocator* allocator = assembler->allocator;
+    kai_array_push(&(assembler->code), kai__arm64_cbz(5, size, 1));
+    kai_array_push(&(assembler->code), kai__arm64_ldrb_post(src, 3, 1));
+    kai_array_push(&(assembler->code), kai__arm64_strb_post(dst, 3, 1));
+    kai_array_push(&(assembler->code), kai__arm64_subs_imm(size, size, 1, 1));
+    kai_array_push(&(assembler->code), kai__arm64_b(-3, KAI_CONDITION_NE));
+}
+
+KAI_API(void) kai_asm_insert_memory_set(Kai_Assembler* assembler, Kai_u32 dst, Kai_u32 byte, Kai_u32 size)
+{
+    if (assembler->backend<=0)
+        return;
+    Kai_Allocator* allocator = assembler->allocator;
+    kai_array_push(&(assembler->code), kai__arm64_cbz(4, size, 1));
+    kai_array_push(&(assembler->code), kai__arm64_strb_post(dst, byte, 1));
+    kai_array_push(&(assembler->code), kai__arm64_subs_imm(size, size, 1, 1));
+    kai_array_push(&(assembler->code), kai__arm64_b(-2, KAI_CONDITION_NE));
+}
+
+KAI_INTERNAL void kai__asm_insert_zero_extend(Kai_Assembler* assembler, Kai_u32 reg, Kai_u8 bits)
+{
+    Kai_Allocator* allocator = assembler->allocator;
+    if (bits==8)
+        kai_array_push(&(assembler->code), kai__arm64_ubfm(reg, reg, 0, 7, 0));
+    if (bits==16)
+        kai_array_push(&(assembler->code), kai__arm64_ubfm(reg, reg, 0, 15, 0));
+}
+
+KAI_INTERNAL Kai_u32 kai__arm64_add(Kai_u32 Rd, Kai_u32 Rn, Kai_u32 Rm, Kai_u8 sf)
+{
+    return (((sf<<31|11<<24)|Rn<<5)|Rm<<16)|Rd;
+}
+
+KAI_INTERNAL Kai_u32 kai__arm64_sub(Kai_u32 Rd, Kai_u32 Rn, Kai_u32 Rm, Kai_u8 sf)
+{
+    return (((sf<<31|75<<24)|Rn<<5)|Rm<<16)|Rd;
+}
+
+KAI_INTERNAL Kai_u32 kai__arm64_subs(Kai_u32 imm12, Kai_u32 Rn, Kai_u8 sf)
+{
+    return (((sf<<31|226<<23)|imm12<<10)|Rn<<5)|31;
+}
+
+KAI_INTERNAL Kai_u32 kai__arm64_cmp(Kai_u32 Rm, Kai_u32 Rn, Kai_u8 sf)
+{
+    return (((sf<<31|107<<24)|Rm<<16)|Rn<<5)|31;
+}
+
+KAI_INTERNAL Kai_u32 kai__arm64_tst_1(Kai_u32 Rn, Kai_u8 sf)
+{
+    return ((sf<<31|457<<22)|Rn<<5)|31;
+}
+
+KAI_INTERNAL Kai_u32 kai__arm64_mov(Kai_u32 Rd, Kai_u32 Rs, Kai_u8 sf)
+{
+    return (((sf<<31|42<<24)|Rs<<16)|31<<5)|Rd;
+}
+
+KAI_INTERNAL Kai_u32 kai__arm64_movz(Kai_u32 Rd, Kai_u16 imm16, Kai_u8 sf)
+{
+    return ((sf<<31|165<<23)|imm16<<5)|Rd;
+}
+
+KAI_INTERNAL Kai_u32 kai__arm64_movk(Kai_u32 Rd, Kai_u16 imm16, Kai_u8 shift)
+{
+    return ((485<<23|(shift&3)<<21)|imm16<<5)|Rd;
+}
+
+KAI_INTERNAL Kai_u32 kai__arm64_bl(Kai_s32 imm26)
+{
+    return 37<<26|(imm26&67108863);
+}
+
+KAI_INTERNAL Kai_u32 kai__arm64_b(Kai_s32 imm19, Kai_u8 cond)
+{
+    return (84<<24|(imm19&524287)<<5)|cond;
+}
+
+KAI_INTERNAL Kai_u32 kai__arm64_str_12(Kai_u32 Rn, Kai_u32 Rt, Kai_u16 offset12)
+{
+    return ((996<<22|offset12<<10)|Rn<<5)|Rt;
+}
+
+KAI_INTERNAL Kai_u32 kai__arm64_ldr_12(Kai_u32 Rn, Kai_u32 Rt, Kai_u16 offset12)
+{
+    return ((997<<22|offset12<<10)|Rn<<5)|Rt;
+}
+
+KAI_INTERNAL Kai_u32 kai__arm64_str(Kai_u32 Rn, Kai_u32 Rt, Kai_s16 offset9)
+{
+    return ((1984<<21|((Kai_u32)(offset9&511))<<12)|Rn<<5)|Rt;
+}
+
+KAI_INTERNAL Kai_u32 kai__arm64_ldr(Kai_u32 Rn, Kai_u32 Rt, Kai_s16 offset9)
+{
+    return ((1986<<21|((Kai_u32)(offset9&511))<<12)|Rn<<5)|Rt;
+}
+
+KAI_INTERNAL Kai_u32 kai__arm64_ret(void)
+{
+    return 3596551104;
+}
+
+KAI_INTERNAL Kai_u32 kai__arm64_sub_imm(Kai_u32 Rd, Kai_u32 Rn, Kai_u32 imm12, Kai_u8 sf)
+{
+    return (((sf<<31|162<<23)|imm12<<10)|Rn<<5)|Rd;
+}
+
+KAI_INTERNAL Kai_u32 kai__arm64_subs_imm(Kai_u32 Rd, Kai_u32 Rn, Kai_u32 imm12, Kai_u8 sf)
+{
+    return (((sf<<31|226<<23)|imm12<<10)|Rn<<5)|Rd;
+}
+
+KAI_INTERNAL Kai_u32 kai__arm64_orr_bit(Kai_u32 Rd, Kai_u32 Rn, Kai_u32 bit)
+{
+    return ((100<<23|((32-bit)&31)<<16)|Rn<<5)|Rd;
+}
+
+KAI_INTERNAL Kai_u32 kai__arm64_ubfm(Kai_u32 Rd, Kai_u32 Rn, Kai_u32 immr, Kai_u32 imms, Kai_u8 sf)
+{
+    return (((((sf<<31|166<<23)|sf<<22)|immr<<16)|imms<<10)|Rn<<5)|Rd;
+}
+
+KAI_INTERNAL Kai_u32 kai__arm64_sbfm(Kai_u32 Rd, Kai_u32 Rn, Kai_u32 immr, Kai_u32 imms, Kai_u8 sf)
+{
+    return (((((sf<<31|38<<23)|sf<<22)|immr<<16)|imms<<10)|Rn<<5)|Rd;
+}
+
+KAI_INTERNAL Kai_u32 kai__arm64_clz(Kai_u32 Rd, Kai_u32 Rn, Kai_u8 sf)
+{
+    return (((sf<<31|726<<21)|4<<10)|Rn<<5)|Rd;
+}
+
+KAI_INTERNAL Kai_u32 kai__arm64_rbit(Kai_u32 Rd, Kai_u32 Rn, Kai_u8 sf)
+{
+    return ((sf<<31|726<<21)|Rn<<5)|Rd;
+}
+
+KAI_INTERNAL Kai_u32 kai__arm64_rev16(Kai_u32 Rd, Kai_u32 Rn)
+{
+    return ((726<<21|1<<10)|Rn<<5)|Rd;
+}
+
+KAI_INTERNAL Kai_u32 kai__arm64_rev(Kai_u32 Rd, Kai_u32 Rn, Kai_u8 sf)
+{
+    return (((sf<<31|726<<21)|(2|sf)<<10)|Rn<<5)|Rd;
+}
+
+KAI_INTERNAL Kai_u32 kai__arm64_rorv(Kai_u32 Rd, Kai_u32 Rn, Kai_u32 Rm, Kai_u8 sf)
+{
+    return ((((sf<<31|214<<21)|Rm<<16)|11<<10)|Rn<<5)|Rd;
+}
+
+KAI_INTERNAL Kai_u32 kai__arm64_umulh(Kai_u32 Rd, Kai_u32 Rn, Kai_u32 Rm)
+{
+    return (((1246<<21|Rm<<16)|31<<10)|Rn<<5)|Rd;
+}
+
+KAI_INTERNAL Kai_u32 kai__arm64_cbz(Kai_s32 imm19, Kai_u32 Rt, Kai_u8 sf)
+{
+    return ((sf<<31|26<<25)|(imm19&524287)<<5)|Rt;
+}
+
+KAI_INTERNAL Kai_u32 kai__arm64_ldrb_post(Kai_u32 Rn, Kai_u32 Rt, Kai_s16 offset9)
+{
+    return (((450<<21|((Kai_u32)(offset9&511))<<12)|1<<10)|Rn<<5)|Rt;
+}
+
+KAI_INTERNAL Kai_u32 kai__arm64_strb_post(Kai_u32 Rn, Kai_u32 Rt, Kai_s16 offset9)
+{
+    return (((448<<21|((Kai_u32)(offset9&511))<<12)|1<<10)|Rn<<5)|Rt;
+}
+
+KAI_INTERNAL Kai_u32 kai__arm64_adr(Kai_u32 Rd, Kai_s32 imm21)
+{
+    return (((imm21&3)<<29|16<<24)|(imm21>>2&524287)<<5)|Rd;
+}
+
+KAI_INTERNAL Kai_u32 kai__arm64_ldrb_12(Kai_u32 Rn, Kai_u32 Rt, Kai_u32 offset12)
+{
+    return ((960495616|offset12<<10)|Rn<<5)|Rt;
+}
+
+KAI_INTERNAL Kai_u32 kai__arm64_madd(Kai_u32 Rd, Kai_u32 Rn, Kai_u32 Rm, Kai_u32 Ra)
+{
+    return (((2600468480|Rm<<16)|Ra<<10)|Rn<<5)|Rd;
+}
+
+KAI_INTERNAL Kai_u32 kai__arm64_msub(Kai_u32 Rd, Kai_u32 Rn, Kai_u32 Rm, Kai_u32 Ra)
+{
+    return (((2600501248|Rm<<16)|Ra<<10)|Rn<<5)|Rd;
+}
+
+KAI_INTERNAL Kai_u32 kai__arm64_udiv(Kai_u32 Rd, Kai_u32 Rn, Kai_u32 Rm)
+{
+    return ((2596276224|Rm<<16)|Rn<<5)|Rd;
+}
+
+KAI_INTERNAL Kai_u32 kai__arm64_ldrsw_lsl2(Kai_u32 Rt, Kai_u32 Rn, Kai_u32 Rm)
+{
+    return ((3097524224|Rm<<16)|Rn<<5)|Rt;
+}
+
+KAI_INTERNAL Kai_u32 kai__arm64_br(Kai_u32 Rn)
+{
+    return 3592355840|Rn<<5;
+}
+
+KAI_INTERNAL Kai_u32 kai__arm64_fmov_to_d(Kai_u32 Vd, Kai_u32 Rn)
+{
+    return (2657550336|Rn<<5)|Vd;
+}
+
+KAI_INTERNAL Kai_u32 kai__arm64_fmov_to_s(Kai_u32 Vd, Kai_u32 Rn)
+{
+    return (505872384|Rn<<5)|Vd;
+}
+
+KAI_INTERNAL Kai_u32 kai__arm64_fmov_from_s(Kai_u32 Rd, Kai_u32 Vn)
+{
+    return (505806848|Vn<<5)|Rd;
+}
+
+KAI_INTERNAL Kai_u32 kai__arm64_cnt_8b(Kai_u32 Vd, Kai_u32 Vn)
+{
+    return (237000704|Vn<<5)|Vd;
+}
+
+KAI_INTERNAL Kai_u32 kai__arm64_addv_8b(Kai_u32 Vd, Kai_u32 Vn)
+{
+    return (238139392|Vn<<5)|Vd;
+}
+
+KAI_INTERNAL void kai__parse_sources(void* data, Kai_u32 index)
+{
+    Kai__Parse_Batch* batch = ((Kai__Parse_Batch*)data);
+    Kai_u32 i = index;
+    while (i<(batch->sources).count)
+    {
+        Kai__Parse_Result* result = batch->results+i;
+        kai_create_atom_table(&(result->atoms), &(batch->allocator));
+        Kai_Syntax_Tree_Create_Info info = ((Kai_Syntax_Tree_Create_Info){.source = ((batch->sources).data)[i], .allocator = batch->allocator, .error = &(result->error), .atoms = &(result->atoms)});
+        if (batch->compact_trees!=NULL)
+            kai_parse_compact_tree(&info, batch->compact_trees+i);
+        else
+            kai__create_syntax_tree(&info, batch->trees+i, &(result->atom_refs));
+        i += batch->worker_count;
+    }
+}
+
+KAI_INTERNAL Kai_bool kai__create_syntax_trees(Kai_Compiler_Context* context, Kai_Source_Slice sources)
+{
+    Kai_Allocator* allocator = &(context->allocator);
+    Kai_bool compact = ((context->options).flags&KAI_COMPILE_COMPACT_TREES)!=0;
+    if (compact)
+    {
+        (context->compact_trees).data = (Kai_Compact_Tree*)(kai__allocate(NULL, sources.count*sizeof(Kai_Compact_Tree), 0));
+        (context->compact_trees).count = sources.count;
+        kai__memory_zero((context->compact_trees).data, sources.count*sizeof(Kai_Compact_Tree));
+    }
+    else
+    {
+        (context->trees).data = (Kai_Syntax_Tree*)(kai__allocate(NULL, sources.count*sizeof(Kai_Syntax_Tree), 0));
+        (context->trees).count = sources.count;
+        kai__memory_zero((context->trees).data, sources.count*sizeof(Kai_Syntax_Tree));
+    }
+    if (context->jobs==NULL||sources.count<2)
+    {
+        for (Kai_u32 i = 0; i < sources.count; ++i)
         {
-            Kai_Token if_token = *current;
-            kai__next_token();
-            Kai_Expr* expr = kai_parse_expression(parser, KAI_TOP_PRECEDENCE);
-            kai__expect(expr, "in if statement", "should be an expression here");
-            kai__next_token();
-            Kai_u8 flags = 0;
-            if (current->id==KAI_TOKEN_then)
-            {
-                kai__next_token();
-            }
-            if (current->id==15677)
+            Kai_Syntax_Tree_Create_Info info = ((Kai_Syntax_Tree_Create_Info){.source = sources.data[i], .allocator = context->allocator, .error = context->error, .atoms = &(context->atoms)});
+            if (compact)
             {
-                kai__next_token();
-                flags |= KAI_FLAG_IF_CASE;
-            }
-            Kai_Stmt* then_body = kai_parse_statement(parser);
-            if (!then_body)
-                return NULL;
-            Kai_Token* peeked = kai__peek_token();
-            Kai_Stmt* else_body = 0;
-            if (peeked->id==KAI_TOKEN_else)
-            {
-                kai__next_token();
-                kai__next_token();
-                else_body = kai_parse_statement(parser);
-                if (!else_body)
-                    return NULL;
+                if (kai_parse_compact_tree(&info, (context->compact_trees).data+i)!=KAI_SUCCESS)
+                    return KAI_TRUE;
             }
-            return kai__parser_create_if(parser, if_token, flags, expr, then_body, else_body);
+            else
+            if (kai_create_syntax_tree(&info, (context->trees).data+i)!=KAI_SUCCESS)
+                return KAI_TRUE;
         }
-        break; case KAI_TOKEN_while:
+        return KAI_FALSE;
+    }
+    Kai__Parse_Batch batch = ((Kai__Parse_Batch){.sources = sources, .trees = (context->trees).data, .compact_trees = (context->compact_trees).data, .results = (Kai__Parse_Result*)(kai__allocate(NULL, sources.count*sizeof(Kai__Parse_Result), 0)), .allocator = context->allocator, .worker_count = kai__min_u32(kai__max_u32((context->options).worker_count, 1), sources.count)});
+    kai__memory_zero(batch.results, sources.count*sizeof(Kai__Parse_Result));
+    (context->jobs)->dispatch((context->jobs)->user, kai__parse_sources, &batch, batch.worker_count);
+    for (Kai_u32 i = 0; i < sources.count; ++i)
+    {
+        Kai__Parse_Result* result = batch.results+i;
+        Kai_Atom_Table* atoms = &(result->atoms);
+        Kai__Atom_Ref_DynArray* refs = &(result->atom_refs);
+        Kai_u32* remap = (Kai_u32*)(kai__allocate(NULL, (atoms->names).count*sizeof(Kai_u32), 0));
+        remap[0] = 0;
+        for (Kai_u32 k = 1; k < (atoms->names).count; ++k)
         {
-            Kai_Token while_token = *current;
-            kai__next_token();
-            Kai_Expr* expr = kai_parse_expression(parser, KAI_TOP_PRECEDENCE);
-            kai__next_token();
-            Kai_Stmt* body = kai_parse_statement(parser);
-            return kai__parser_create_while(parser, while_token, expr, body);
+            remap[k] = kai_intern_atom(&(context->atoms), ((atoms->names).data)[k]);
         }
-        break; case KAI_TOKEN_for:
+        for (Kai_u32 k = 0; k < refs->count; ++k)
         {
-            Kai_Token for_token = *current;
-            kai__next_token();
-            kai__expect(current->id==KAI_TOKEN_IDENTIFIER, "in for statement", "should be the name of the iterator");
-            Kai_string iterator_name = current->string;
-            kai__next_token();
-            kai__expect(current->id==58, "in for statement", "should be ':' here");
-            kai__next_token();
-            Kai_Expr* from = kai_parse_expression(parser, KAI_TOP_PRECEDENCE);
-            kai__expect(from, "in for statement", "should be an expression here");
-            Kai_Expr* to = 0;
-            kai__next_token();
-            Kai_u8 flags = {0};
-            if (current->id==11822)
-            {
-                kai__next_token();
-                if (current->id==60)
-                {
-                    flags |= KAI_FLAG_FOR_LESS_THAN;
-                    kai__next_token();
-                }
-                to = kai_parse_expression(parser, KAI_TOP_PRECEDENCE);
-                kai__expect(to, "in for statement", "should be an expression here");
-                kai__next_token();
-            }
-            Kai_Stmt* body = kai_parse_statement(parser);
-            if (!body)
-                return NULL;
-            return kai__parser_create_for(parser, for_token, iterator_name, from, to, body, flags);
+            Kai__Atom_Ref ref = (refs->data)[k];
+            *ref = remap[*ref];
         }
-        break; case KAI_TOKEN_DIRECTIVE:
+        if (compact)
         {
-            if (kai_string_equals((current->value).string, KAI_STRING("export")))
-            {
-                kai__next_token();
-                Kai_Stmt* decl = kai_parse_declaration(parser);
-                kai__expect(decl, "in export statement", "should be declaration here");
-                decl->flags |= KAI_FLAG_DECL_EXPORT;
-                return decl;
-            }
-            else
+            Kai_Compact_Tree* tree = (context->compact_trees).data+i;
+            for (Kai_u32 k = 0; k < (tree->nodes).count; ++k)
             {
-                Kai_Expr* expr = kai_parse_expression(parser, KAI_TOP_PRECEDENCE);
-                kai__expect(expr, "in statement", "there should be an expression here");
-                kai__next_token();
-                kai__expect(current->id==59, "after statement", "there should be a ';' before this");
-                return expr;
+                Kai_Compact_Node* node = &(((tree->nodes).data)[k]);
+                node->atom = remap[node->atom];
+                node->name_atom = remap[node->name_atom];
             }
+            tree->atoms = &(context->atoms);
         }
-        break; case KAI_TOKEN_IDENTIFIER:
+        kai__free(remap, (atoms->names).count*sizeof(Kai_u32));
+        kai_array_destroy(refs);
+        kai_destroy_atom_table(atoms);
+    }
+    Kai_bool failed = KAI_FALSE;
+    for (Kai_u32 i = 0; i < sources.count; ++i)
+    {
+        Kai_Error* error = &(((batch.results)+i)->error);
+        if (error->result==KAI_SUCCESS)
+            continue;
+        if (failed)
         {
-            Kai_Token* peeked = kai__peek_token();
-            if (peeked->id==58)
-                return kai_parse_declaration(parser);
+            kai__free((error->memory).data, (error->memory).size);
+            continue;
         }
-        /* fall through */
-        default:
+        *(context->error) = *error;
+        failed = KAI_TRUE;
+    }
+    kai__free(batch.results, sources.count*sizeof(Kai__Parse_Result));
+    return failed;
+}
+
+KAI_INTERNAL void kai__write_expression_name(Kai_Writer* writer, Kai_Expr* expr)
+{
+    kai_assert(expr!=NULL);
+    switch (expr->id)
+    {
+        break; case KAI_EXPR_IDENTIFIER:
         {
-            Kai_bool requires_semicolon = KAI_TRUE;
-            Kai_Expr* expr = kai_parse_expression(parser, KAI_TOP_PRECEDENCE);
-            kai__expect(expr, "in statement", "should be an expression or statement");
-            Kai_Token* peeked = kai__peek_token();
-            switch (peeked->id)
-            {
-                break; case 61:
-                /* fall through */
-                case 15740:
-                /* fall through */
-                case 15654:
-                /* fall through */
-                case 15659:
-                /* fall through */
-                case 15661:
-                /* fall through */
-                case 15658:
-                /* fall through */
-                case 15663:
-                {
-                    kai__next_token();
-                    Kai_u32 op = current->id;
-                    kai__next_token();
-                    Kai_Expr* right = kai_parse_expression(parser, KAI_TOP_PRECEDENCE);
-                    kai__expect(right, "in assignment statement", "should be an expression");
-                    expr = kai__parser_create_assignment(parser, op, expr, right);
-                    kai__next_token();
-                    kai__expect(current->id==59, "in assignment statement", "should be ';' before this");
-                }
-                break; default:
-                {
-                    if (requires_semicolon)
-                    {
-                        kai__next_token();
-                        kai__expect(current->id==59, "in expression statement", "should be ';' before this");
-                    }
-                    kai_parse_tag_to_expr(parser, expr);
-                }
-            }
-            return expr;
+            (writer->write(writer->user, KAI_WRITE_STRING, (Kai_Value){.string = KAI_STRING("\"")}, (Kai_Write_Format){0}), writer->write(writer->user, KAI_WRITE_STRING, (Kai_Value){.string = expr->source_code}, (Kai_Write_Format){0}), writer->write(writer->user, KAI_WRITE_STRING, (Kai_Value){.string = KAI_STRING("\"")}, (Kai_Write_Format){0}));
         }
+        break; case KAI_EXPR_STRING:
+        kai__write("string");
+        break; case KAI_EXPR_NUMBER:
+        kai__write("number");
+        break; case KAI_EXPR_LITERAL:
+        kai__write("literal");
+        break; case KAI_EXPR_UNARY:
+        kai__write("expression");
+        break; case KAI_EXPR_BINARY:
+        kai__write("expression");
+        break; case KAI_EXPR_PROCEDURE_TYPE:
+        kai__write("procedure type");
+        break; case KAI_EXPR_PROCEDURE_CALL:
+        kai__write("procedure call");
+        break; case KAI_EXPR_PROCEDURE:
+        kai__write("procedure");
+        break; case KAI_EXPR_CODE:
+        kai__write("code");
+        break; case KAI_EXPR_IMPORT:
+        kai__write("import");
+        break; case KAI_EXPR_STRUCT:
+        kai__write("struct");
+        break; case KAI_EXPR_ENUM:
+        kai__write("enum");
+        break; case KAI_EXPR_ARRAY:
+        kai__write("array");
+        break; case KAI_EXPR_SPECIAL:
+        kai__write_string(expr->source_code);
+        break; default:
+        kai__write("UNKNOWN");
+    }
+}
+
+KAI_INTERNAL Kai_bool kai__inside_procedure_scope(Kai_Compiler_Context* context)
+{
+    for (Kai_u32 i = 0; i < (context->scopes).count; ++i)
+    {
+        Kai_u32 ri = ((context->scopes).count-1)-i;
+        Kai_Scope* scope = &(((context->scopes).data)[ri]);
+        if (scope->is_proc_scope)
+            return KAI_TRUE;
+    }
+    return KAI_FALSE;
+}
+
+KAI_INTERNAL Kai_bool kai__error_fatal(Kai_Compiler_Context* context, Kai_string message)
+{
+    (context->error)->result = KAI_ERROR_FATAL;
+    (context->error)->message = message;
+    ((context->error)->location).source = context->current_source;
+    kai__debug_print_stacktrace();
+    return KAI_TRUE;
+}
+
+KAI_INTERNAL Kai_Location kai__location_with_line(Kai_Location location)
+{
+    Kai_u8* begin = ((location.source).contents).data;
+    if ((location.line==0&&(location.string).data>=begin)&&(location.string).data<=begin+((location.source).contents).count)
+        location.line = kai_source_line(&(location.source), (Kai_u32)((location.string).data-begin));
+    return location;
+}
+
+KAI_INTERNAL Kai_bool kai__error_unsupported(Kai_Compiler_Context* context, Kai_Expr* expr, Kai_string message)
+{
+    *(context->error) = ((Kai_Error){.result = KAI_ERROR_SEMANTIC, .location = ((Kai_Location){.source = context->current_source, .string = expr->source_code, .line = kai_source_line(&(context->current_source), expr->offset)}), .message = message});
+    return KAI_TRUE;
+}
+
+KAI_INTERNAL Kai_bool kai__error_redefinition(Kai_Compiler_Context* context, Kai_Location location, Kai_u32 original)
+{
+    *(context->error) = ((Kai_Error){.result = KAI_ERROR_SEMANTIC, .location = kai__location_with_line(location)});
+    Kai_Buffer buffer = ((Kai_Buffer){.allocator = context->allocator});
+    {
+        kai__buffer_append_string(&buffer, KAI_STRING("identifier \""));
+        kai__buffer_append_string(&buffer, location.string);
+        kai__buffer_append_string(&buffer, KAI_STRING("\" has already been declared"));
+        Kai_Range range = kai__buffer_end(&buffer);
+        (context->error)->memory = kai__buffer_done(&buffer);
+        (context->error)->message = kai__range_to_string(range, (context->error)->memory);
+    }
+    {
+        Kai_Range info_range = kai__buffer_push(&buffer, sizeof(Kai_Error));
+        kai__buffer_append_string(&buffer, KAI_STRING("see original definition of \""));
+        kai__buffer_append_string(&buffer, location.string);
+        kai__buffer_append_string(&buffer, KAI_STRING("\""));
+        Kai_Range message_range = kai__buffer_end(&buffer);
+        Kai_Memory memory = kai__buffer_done(&buffer);
+        Kai_Node* existing = &(((context->nodes).data)[original]);
+        Kai_Error* info = (Kai_Error*)((Kai_u8*)(memory.data)+info_range.start);
+        *info = ((Kai_Error){.result = KAI_ERROR_INFO, .location = kai__location_with_line(existing->location), .message = kai__range_to_string(message_range, memory), .memory = memory});
+        (context->error)->next = info;
     }
+    return KAI_TRUE;
+}
+
+KAI_INTERNAL Kai_bool kai__error_not_declared(Kai_Compiler_Context* context, Kai_Location location)
+{
+    *(context->error) = ((Kai_Error){.result = KAI_ERROR_SEMANTIC, .location = location});
+    Kai_Writer error_writer = kai_writer_from_arena(&(context->error_arena));
+    Kai_Writer* writer = &error_writer;
+    Kai_u32 message_offset = ((context->error_arena).buffer).count;
+    (writer->write(writer->user, KAI_WRITE_STRING, (Kai_Value){.string = KAI_STRING("identifier \"")}, (Kai_Write_Format){0}), writer->write(writer->user, KAI_WRITE_STRING, (Kai_Value){.string = location.string}, (Kai_Write_Format){0}), writer->write(writer->user, KAI_WRITE_STRING, (Kai_Value){.string = KAI_STRING("\" not declared")}, (Kai_Write_Format){0}));
+    Kai_u32 message_count = ((context->error_arena).buffer).count-message_offset;
+    (context->error)->message = kai_string_from_data(((context->error_arena).buffer).data+message_offset, message_count);
+    return KAI_TRUE;
 }
 
-KAI_API(Kai_Result) kai_create_syntax_tree(Kai_Syntax_Tree_Create_Info* info, Kai_Syntax_Tree* out_tree)
+KAI_INTERNAL void kai__write_circular_dependency(Kai_Compiler_Context* context, Kai_u32* ends)
 {
-    Kai_Parser parser = {0};
-    (parser.tokenizer).source = (info->source).contents;
-    (parser.tokenizer).line_number = 1;
-    parser.error = info->error;
-    (parser.tokenizer).string_arena = ((Kai_Fixed_Allocator){.data = (info->allocator).heap_allocate((info->allocator).user, NULL, ((info->source).contents).count, 0), .size = ((info->source).contents).count});
-    kai_arena_create(&(parser.arena), &(info->allocator));
-    Kai_Stmt_List statements = {0};
-    Kai_Token* token = kai_tokenizer_next(&(parser.tokenizer));
-    while (token->id!=KAI_TOKEN_END)
+    Kai_Node* node = &(((context->nodes).data)[(context->current_node).index]);
+    Kai_Writer error_writer = kai_writer_from_arena(&(context->error_arena));
+    Kai_Writer* writer = &error_writer;
+    (writer->write(writer->user, KAI_WRITE_STRING, (Kai_Value){.string = KAI_STRING("detected circular dependency on \"")}, (Kai_Write_Format){0}), writer->write(writer->user, KAI_WRITE_STRING, (Kai_Value){.string = (node->location).string}, (Kai_Write_Format){0}), writer->write(writer->user, KAI_WRITE_STRING, (Kai_Value){.string = KAI_STRING("\"")}, (Kai_Write_Format){0}));
+    ends[0] = ((context->error_arena).buffer).count;
+    Kai_Node_Reference prev_ref = context->current_node;
+    Kai_Node* prev_node = node;
+    Kai_Writer* temp = context->debug_writer;
+    context->debug_writer = writer;
+    for (Kai_u32 i = 0; i < (context->current_dependencies).count; ++i)
     {
-        Kai_Stmt* statement = kai_parse_declaration(&parser);
-        if (statement==NULL)
-            break;
-        kai__linked_list_append(statements, statement);
-        kai_tokenizer_next(&(parser.tokenizer));
+        Kai_Node_Reference ref = ((context->current_dependencies).data)[i];
+        Kai_Node* node = &(((context->nodes).data)[ref.index]);
+        kai__write_node(writer, prev_node, prev_ref.flags);
+        kai__write(" depends on ");
+        kai__write_node(writer, node, ref.flags);
+        ends[i+1] = ((context->error_arena).buffer).count;
+        prev_ref = ref;
+        prev_node = node;
     }
-    (out_tree->root).id = KAI_STMT_COMPOUND;
-    (out_tree->root).head = statements.head;
-    out_tree->source = info->source;
-    out_tree->allocator = parser.arena;
-    if ((parser.error)->result!=KAI_SUCCESS)
-        ((parser.error)->location).source = info->source;
-    return (parser.error)->result;
+    context->debug_writer = temp;
 }
 
-KAI_API(void) kai_destroy_syntax_tree(Kai_Syntax_Tree* tree)
+KAI_INTERNAL Kai_bool kai__error_type_check(Kai_Compiler_Context* context, Kai_Expr* expr, Kai_Type expected, Kai_Type got)
 {
-    (void)(tree);
+    Kai_Location location = ((Kai_Location){.source = context->current_source, .string = expr->source_code, .line = kai_source_line(&(context->current_source), expr->offset)});
+    *(context->error) = ((Kai_Error){.result = KAI_ERROR_TYPE, .location = location});
+    Kai_Writer error_writer = kai_writer_from_arena(&(context->error_arena));
+    Kai_Writer* writer = &error_writer;
+    Kai_u32 message_offset = ((context->error_arena).buffer).count;
+    kai__write("expected ");
+    kai__write_expression_name(writer, expr);
+    kai__write(" of type ");
+    kai_write_type(writer, got);
+    kai__write(" to be of type ");
+    kai_write_type(writer, expected);
+    Kai_u32 message_count = ((context->error_arena).buffer).count-message_offset;
+    (context->error)->message = kai_string_from_data(((context->error_arena).buffer).data+message_offset, message_count);
+    return KAI_TRUE;
 }
 
-KAI_API(Kai_u32) kai_asm_create_label(Kai_Assembler* assembler)
+KAI_INTERNAL Kai_bool kai__error_no_member(Kai_Compiler_Context* context, Kai_Type type, Kai_Expr* identifier)
 {
-    return (assembler->code).count*4;
+    Kai_Location location = ((Kai_Location){.source = context->current_source, .string = identifier->source_code, .line = kai_source_line(&(context->current_source), identifier->offset)});
+    *(context->error) = ((Kai_Error){.result = KAI_ERROR_SEMANTIC, .location = location});
+    Kai_Writer error_writer = kai_writer_from_arena(&(context->error_arena));
+    Kai_Writer* writer = &error_writer;
+    Kai_u32 message_offset = ((context->error_arena).buffer).count;
+    kai__write("type ");
+    kai_write_type(writer, type);
+    (writer->write(writer->user, KAI_WRITE_STRING, (Kai_Value){.string = KAI_STRING(" has no member named \"")}, (Kai_Write_Format){0}), writer->write(writer->user, KAI_WRITE_STRING, (Kai_Value){.string = identifier->source_code}, (Kai_Write_Format){0}), writer->write(writer->user, KAI_WRITE_STRING, (Kai_Value){.string = KAI_STRING("\"")}, (Kai_Write_Format){0}));
+    Kai_u32 message_count = ((context->error_arena).buffer).count-message_offset;
+    (context->error)->message = kai_string_from_data(((context->error_arena).buffer).data+message_offset, message_count);
+    return KAI_TRUE;
 }
 
-KAI_API(Kai_s32) kai_asm_relative_location(Kai_u32 label_from, Kai_u32 label_to)
+KAI_INTERNAL Kai_bool kai__error_host_import_not_found(Kai_Compiler_Context* context, Kai_Location location)
 {
-    return (Kai_s32)(label_to>>2)-(Kai_s32)(label_from>>2);
+    *(context->error) = ((Kai_Error){.result = KAI_ERROR_SEMANTIC, .location = kai__location_with_line(location)});
+    Kai_Buffer buffer = ((Kai_Buffer){.allocator = context->allocator});
+    kai__buffer_append_string(&buffer, KAI_STRING("could not find host import \""));
+    kai__buffer_append_string(&buffer, location.string);
+    kai__buffer_append_string(&buffer, KAI_STRING("\""));
+    Kai_Range range = kai__buffer_end(&buffer);
+    (context->error)->memory = kai__buffer_done(&buffer);
+    (context->error)->message = kai__range_to_string(range, (context->error)->memory);
+    return KAI_TRUE;
 }
 
-KAI_API(Kai_u32) kai_asm_insert_jump(Kai_Assembler* assembler, Kai_u32 condition, Kai_s32 relative)
+KAI_INTERNAL void kai__write_node(Kai_Writer* writer, Kai_Node* node, Kai_Node_Flags flags)
 {
-    if (assembler->backend<=0)
-        return 0;
-    Kai_Allocator* allocator = assembler->allocator;
-    Kai_u32 label = (assembler->code).count*4;
-    kai_array_push(&(assembler->code), kai__arm64_b(relative, condition));
-    return label;
+    if (flags&KAI_NODE_TYPE)
+        (writer->write(writer->user, KAI_WRITE_STRING, (Kai_Value){.string = KAI_STRING("type of \"")}, (Kai_Write_Format){0}), writer->write(writer->user, KAI_WRITE_STRING, (Kai_Value){.string = (node->location).string}, (Kai_Write_Format){0}), writer->write(writer->user, KAI_WRITE_STRING, (Kai_Value){.string = KAI_STRING("\"")}, (Kai_Write_Format){0}));
+    else
+        (writer->write(writer->user, KAI_WRITE_STRING, (Kai_Value){.string = KAI_STRING("value of \"")}, (Kai_Write_Format){0}), writer->write(writer->user, KAI_WRITE_STRING, (Kai_Value){.string = (node->location).string}, (Kai_Write_Format){0}), writer->write(writer->user, KAI_WRITE_STRING, (Kai_Value){.string = KAI_STRING("\"")}, (Kai_Write_Format){0}));
 }
 
-KAI_API(void) kai_asm_modify_jump(Kai_Assembler* assembler, Kai_u32 label, Kai_s32 relative)
+KAI_INTERNAL Kai_bool kai__create_nodes(Kai_Compiler_Context* context, Kai_Expr* expr)
 {
-    if (assembler->backend<=0)
-        return;
-    ((assembler->code).data)[label/4] |= kai__arm64_b(relative, 0);
+    Kai_Allocator* allocator = &(context->allocator);
+    switch (expr->id)
+    {
+        break; case KAI_EXPR_IMPORT:
+        {
+            Kai_Writer* writer = context->debug_writer;
+            if (writer!=NULL)
+            {
+                (writer->write(writer->user, KAI_WRITE_STRING, (Kai_Value){.string = KAI_STRING("import: \"")}, (Kai_Write_Format){0}), writer->write(writer->user, KAI_WRITE_STRING, (Kai_Value){.string = expr->name}, (Kai_Write_Format){0}), writer->write(writer->user, KAI_WRITE_STRING, (Kai_Value){.string = KAI_STRING("\"\n")}, (Kai_Write_Format){0}));
+            }
+            kai__todo("what's an import again?");
+        }
+        break; case KAI_STMT_DECLARATION:
+        {
+            Kai_Stmt_Declaration* d = ((Kai_Stmt_Declaration*)expr);
+            if (!((d->flags)&KAI_FLAG_DECL_CONST)&&kai__inside_procedure_scope(context))
+                return KAI_FALSE;
+            Kai_Location location = ((Kai_Location){.source = context->current_source, .string = d->name});
+            Kai_Scope* scope = &kai_array_last(&(context->scopes));
+            {
+                Kai__Binding binding = kai__lookup_binding(context, d->name_atom);
+                if (!(((binding.ref).flags)&KAI_NODE_NOT_FOUND)&&binding.scope==(((context->scopes).count)-1))
+                {
+                    (context->error)->result = KAI_ERROR_FATAL;
+                    return kai__error_redefinition(context, location, (binding.ref).index);
+                }
+            }
+            if (context->is_worker)
+                return KAI_TRUE;
+            {
+                Kai_Node_Reference reference = ((Kai_Node_Reference){.index = (context->nodes).count});
+                Kai_Node node = ((Kai_Node){.location = location, .value_expr = d->value, .type_expr = d->type, .decl = expr, .compact = context->current_compact, .compact_tree = context->current_compact_tree});
+                if (d->flags&KAI_FLAG_DECL_HOST_IMPORT)
+                {
+                    kai__expand_node(context, &node);
+                    node.flags |= KAI_NODE_IMPORT;
+                    Kai_Import* import = kai__find_host_import(context, (node.location).string);
+                    if (import==NULL)
+                        return kai__error_host_import_not_found(context, node.location);
+                    if (node.type_expr==NULL)
+                    {
+                        if ((import->type).count==0)
+                            return kai__error_fatal(context, KAI_STRING("host import must be typed"));
+                        node.type_expr = kai__type_expression_from_string(context, import->type);
+                        if (node.type_expr==NULL)
+                            return KAI_TRUE;
+                    }
+                    node.value = import->value;
+                    node.flags |= KAI_NODE_VALUE_EVALUATED;
+                }
+                if (d->flags&KAI_FLAG_DECL_EXPORT||kai__is_host_export(context, d->name_atom))
+                    node.flags |= KAI_NODE_EXPORT;
+                Kai_Writer* writer = context->debug_writer;
+                if (writer!=NULL)
+                {
+                    (writer->write(writer->user, KAI_WRITE_STRING, (Kai_Value){.string = KAI_STRING("inserting node for \"")}, (Kai_Write_Format){0}), writer->write(writer->user, KAI_WRITE_STRING, (Kai_Value){.string = d->name}, (Kai_Write_Format){0}), writer->write(writer->user, KAI_WRITE_STRING, (Kai_Value){.string = KAI_STRING("\"\n")}, (Kai_Write_Format){0}));
+                }
+                kai__bind(context, d->name_atom, reference);
+                if ((!(((context->options).flags)&KAI_COMPILE_REACHABLE_ONLY)||node.flags&KAI_NODE_EXPORT)||(context->scopes).count!=1)
+                {
+                    node.flags |= KAI_NODE_QUEUED;
+                    kai_array_push(&(scope->ready_nodes), ((Kai_Node_Reference){.flags = KAI_NODE_TYPE, .index = reference.index}));
+                }
+                kai_array_push(&(context->nodes), node);
+            }
+        }
+        break; case KAI_STMT_COMPOUND:
+        {
+            Kai_Stmt_Compound* c = ((Kai_Stmt_Compound*)expr);
+            Kai_Stmt* current = c->head;
+            while (current)
+            {
+                if (kai__create_nodes(context, current))
+                    return KAI_TRUE;
+                current = current->next;
+            }
+        }
+    }
+    return KAI_FALSE;
 }
 
-KAI_API(void) kai_asm_insert_ret(Kai_Assembler* assembler)
+KAI_INTERNAL Kai_bool kai__generate_nodes(Kai_Compiler_Context* context)
 {
-    if (assembler->backend<=0)
-        return;
-    Kai_Allocator* allocator = assembler->allocator;
-    kai_array_push(&(assembler->code), kai__arm64_ret());
+    kai__push_scope(context, KAI_FALSE);
+    if (kai__generate_builtin_types(context))
+        return KAI_TRUE;
+    for (Kai_u32 i = 0; i < (context->trees).count; ++i)
+    {
+        Kai_Syntax_Tree* tree = &(((context->trees).data)[i]);
+        context->current_source = tree->source;
+        Kai_Stmt* current = (tree->root).head;
+        while (current)
+        {
+            if (kai__create_nodes(context, current))
+                return KAI_TRUE;
+            current = current->next;
+        }
+    }
+    for (Kai_u32 i = 0; i < (context->compact_trees).count; ++i)
+    {
+        Kai_Compact_Tree* tree = &(((context->compact_trees).data)[i]);
+        context->current_source = tree->source;
+        if (kai__create_compact_nodes(context, tree))
+            return KAI_TRUE;
+    }
+    return KAI_FALSE;
 }
 
-KAI_API(void) kai_asm_insert_load_constant(Kai_Assembler* assembler, Kai_u64 value)
+KAI_INTERNAL Kai_bool kai__create_compact_nodes(Kai_Compiler_Context* context, Kai_Compact_Tree* tree)
 {
-    if (assembler->backend<=0)
-        return;
-    Kai_Allocator* allocator = assembler->allocator;
-    kai_array_push(&(assembler->code), kai__arm64_movz(0, (Kai_u16)(value), 0));
-    value = value>>16;
-    while (value!=0)
+    Kai_Compact_Node* root = kai_compact_node(tree, 1);
+    for (Kai_u32 i = 0; i < root->child_count; ++i)
     {
-        kai_array_push(&(assembler->code), kai__arm64_movk(0, (Kai_u16)(value), 1));
-        value = value>>16;
+        Kai_u32 index = kai_compact_child(tree, 1, i);
+        Kai_Compact_Node* node = kai_compact_node(tree, index);
+        Kai_Expr* stmt = 0;
+        if (node->id==KAI_STMT_DECLARATION)
+        {
+            stmt = kai_compact_expand_node(tree, index, &((context->program)->tree_arena));
+            context->current_compact = index;
+            context->current_compact_tree = tree;
+        }
+        else
+            stmt = kai_compact_expand(tree, index, &((context->program)->tree_arena));
+        Kai_bool failed = kai__create_nodes(context, stmt);
+        context->current_compact = 0;
+        context->current_compact_tree = NULL;
+        if (failed)
+            return KAI_TRUE;
     }
+    return KAI_FALSE;
 }
 
-KAI_API(void) kai_asm_insert_stack_load(Kai_Assembler* assembler, Kai_u32 index, Kai_u32 reg)
+KAI_INTERNAL void kai__expand_node(Kai_Compiler_Context* context, Kai_Node* node)
 {
-    if (assembler->backend<=0)
+    if (node->compact==0)
         return;
-    Kai_Allocator* allocator = assembler->allocator;
-    kai_array_push(&(assembler->code), kai__arm64_ldr(31, reg, -index*8));
+    kai_assert(!(context->is_worker));
+    Kai_Compact_Tree* tree = node->compact_tree;
+    Kai_Stmt_Declaration* d = ((Kai_Stmt_Declaration*)node->decl);
+    d->type = kai_compact_expand(tree, kai_compact_child(tree, node->compact, 0), &((context->program)->tree_arena));
+    d->value = kai_compact_expand(tree, kai_compact_child(tree, node->compact, 1), &((context->program)->tree_arena));
+    node->type_expr = d->type;
+    node->value_expr = d->value;
+    node->compact = 0;
 }
 
-KAI_API(void) kai_asm_insert_stack_store(Kai_Assembler* assembler, Kai_u32 index, Kai_u32 reg)
+KAI_INTERNAL void kai__push_scope(Kai_Compiler_Context* context, Kai_bool is_proc_scope)
 {
-    if (assembler->backend<=0)
-        return;
-    Kai_Allocator* allocator = assembler->allocator;
-    kai_array_push(&(assembler->code), kai__arm64_str(31, reg, -index*8));
+    Kai_Allocator* allocator = &(context->allocator);
+    kai_array_push(&(context->scopes), ((Kai_Scope){.trail_start = (context->symbol_trail).count, .is_proc_scope = is_proc_scope}));
 }
 
-KAI_API(void) kai_asm_insert_add(Kai_Assembler* assembler, Kai_u32 dst, Kai_u32 a, Kai_u32 b)
+KAI_INTERNAL void kai__pop_scope(Kai_Compiler_Context* context)
 {
-    if (assembler->backend<=0)
-        return;
-    Kai_Allocator* allocator = assembler->allocator;
-    kai_array_push(&(assembler->code), kai__arm64_add(dst, a, b, 1));
+    Kai_Scope* scope = &kai_array_last(&(context->scopes));
+    kai__unbind_to(context, scope->trail_start);
+    kai_array_pop(&(context->scopes));
 }
 
-KAI_API(void) kai_asm_insert_sub(Kai_Assembler* assembler, Kai_u32 dst, Kai_u32 a, Kai_u32 b)
+KAI_INTERNAL void kai__unbind_to(Kai_Compiler_Context* context, Kai_u32 count)
 {
-    if (assembler->backend<=0)
-        return;
-    Kai_Allocator* allocator = assembler->allocator;
-    kai_array_push(&(assembler->code), kai__arm64_sub(dst, a, b, 1));
+    while ((context->symbol_trail).count>count)
+    {
+        (context->symbol_trail).count -= 1;
+        Kai__Shadowed* shadowed = (context->symbol_trail).data+(context->symbol_trail).count;
+        Kai_int index = kai_table_find(u32, &(context->symbols), shadowed->atom);
+        ((context->symbols).values)[index] = shadowed->previous;
+    }
 }
 
-KAI_API(void) kai_asm_insert_cmp(Kai_Assembler* assembler, Kai_u32 a, Kai_u32 b)
+KAI_INTERNAL void kai__bind(Kai_Compiler_Context* context, Kai_u32 atom, Kai_Node_Reference ref)
 {
-    if (assembler->backend<=0)
-        return;
-    Kai_Allocator* allocator = assembler->allocator;
-    kai_array_push(&(assembler->code), kai__arm64_cmp(a, b, 1));
+    Kai_Allocator* allocator = &(context->allocator);
+    Kai__Binding binding = ((Kai__Binding){.ref = ref, .scope = (context->scopes).count-1});
+    Kai__Shadowed shadowed = ((Kai__Shadowed){.atom = atom, .previous = ((Kai__Binding){.ref = ((Kai_Node_Reference){.flags = KAI_NODE_NOT_FOUND})})});
+    Kai_int index = kai_table_find(u32, &(context->symbols), atom);
+    if (index!=-1)
+    {
+        shadowed.previous = ((context->symbols).values)[index];
+        ((context->symbols).values)[index] = binding;
+    }
+    else
+        kai_table_set(u32, &(context->symbols), atom, binding);
+    kai_array_push(&(context->symbol_trail), shadowed);
 }
 
-KAI_API(void) kai_asm_insert_test(Kai_Assembler* assembler, Kai_u32 reg)
+KAI_INTERNAL Kai__Binding kai__lookup_binding(Kai_Compiler_Context* context, Kai_u32 atom)
 {
-    if (assembler->backend<=0)
-        return;
-    Kai_Allocator* allocator = assembler->allocator;
-    kai_array_push(&(assembler->code), kai__arm64_tst_1(reg, 1));
+    Kai_int index = kai_table_find(u32, &(context->symbols), atom);
+    if (index!=-1)
+    {
+        Kai__Binding binding = ((context->symbols).values)[index];
+        if (!(((binding.ref).flags)&KAI_NODE_NOT_FOUND))
+            return binding;
+    }
+    if ((context->shared_symbols).count!=0)
+    {
+        index = kai_table_find(u32, &(context->shared_symbols), atom);
+        if (index!=-1)
+            return ((context->shared_symbols).values)[index];
+    }
+    if (atom!=0&&atom<=KAI__BUILTIN_NAME_COUNT)
+        return ((Kai__Binding){.ref = ((Kai_Node_Reference){.index = atom})});
+    return ((Kai__Binding){.ref = ((Kai_Node_Reference){.flags = KAI_NODE_NOT_FOUND})});
 }
 
-KAI_INTERNAL Kai_u32 kai__arm64_add(Kai_u32 Rd, Kai_u32 Rn, Kai_u32 Rm, Kai_u8 sf)
+KAI_INTERNAL Kai_Node_Reference kai__lookup_node(Kai_Compiler_Context* context, Kai_u32 atom)
 {
-    return (((sf<<31|11<<24)|Rn<<5)|Rm<<16)|Rd;
+    Kai__Binding binding = kai__lookup_binding(context, atom);
+    return binding.ref;
 }
 
-KAI_INTERNAL Kai_u32 kai__arm64_sub(Kai_u32 Rd, Kai_u32 Rn, Kai_u32 Rm, Kai_u8 sf)
+KAI_INTERNAL void kai__debug_show_type(Kai_Compiler_Context* context, Kai_Type type)
 {
-    return (((sf<<31|75<<24)|Rn<<5)|Rm<<16)|Rd;
+    Kai_Writer* writer = context->debug_writer;
+    if (writer!=NULL)
+    {
+        kai__set_color(KAI_WRITE_COLOR_TYPE);
+        kai_write_type(writer, type);
+        kai__set_color(KAI_WRITE_COLOR_DEFAULT);
+        kai__write(" ");
+        writer->write(writer->user, KAI_WRITE_U64, ((Kai_Value){.u64 = (Kai_u64)(type)}), ((Kai_Write_Format){.flags = KAI_WRITE_FLAGS_BASE_16, .fill_character = 48, .min_count = 16}));
+        kai__write("\n");
+    }
 }
 
-KAI_INTERNAL Kai_u32 kai__arm64_subs(Kai_u32 imm12, Kai_u32 Rn, Kai_u8 sf)
-{
-    return (((sf<<31|226<<23)|imm12<<10)|Rn<<5)|31;
-}
+static Kai_Type_Info kai__builtin_type_infos[4] = {
+    {.id = KAI_TYPE_ID_TYPE, .hash = 1}, {.id = KAI_TYPE_ID_VOID, .hash = 0}, {.id = KAI_TYPE_ID_BOOLEAN, .hash = 2}, 
+    {.id = KAI_TYPE_ID_NUMBER, .hash = 3}
+};
+
+static Kai_Type_Info_Integer kai__builtin_integer_types[8] = {
+    {.id = KAI_TYPE_ID_INTEGER, .hash = 24, .is_signed = KAI_TRUE, .bits = 8}, {.id = KAI_TYPE_ID_INTEGER, .hash = 25, .is_signed = KAI_TRUE, .bits = 16}, 
+    {.id = KAI_TYPE_ID_INTEGER, .hash = 26, .is_signed = KAI_TRUE, .bits = 32}, {.id = KAI_TYPE_ID_INTEGER, .hash = 27, .is_signed = KAI_TRUE, .bits = 64}, 
+    {.id = KAI_TYPE_ID_INTEGER, .hash = 16, .is_signed = KAI_FALSE, .bits = 8}, {.id = KAI_TYPE_ID_INTEGER, .hash = 17, .is_signed = KAI_FALSE, .bits = 16}, 
+    {.id = KAI_TYPE_ID_INTEGER, .hash = 18, .is_signed = KAI_FALSE, .bits = 32}, {.id = KAI_TYPE_ID_INTEGER, .hash = 19, .is_signed = KAI_FALSE, .bits = 64}
+};
+
+static Kai_Type_Info_Float kai__builtin_float_types[2] = {
+    {.id = KAI_TYPE_ID_FLOAT, .hash = 6, .bits = 32}, {.id = KAI_TYPE_ID_FLOAT, .hash = 7, .bits = 64}
+};
+
+static Kai_Type_Info_Pointer kai__builtin_u8_pointer[1] = {
+    {.id = KAI_TYPE_ID_POINTER, .hash = 410, .sub_type = (Kai_Type)(&(kai__builtin_integer_types[4]))}
+};
 
-KAI_INTERNAL Kai_u32 kai__arm64_cmp(Kai_u32 Rm, Kai_u32 Rn, Kai_u8 sf)
-{
-    return (((sf<<31|107<<24)|Rm<<16)|Rn<<5)|31;
-}
+static Kai_Struct_Field kai__builtin_string_fields[2] = {
+    {.name = KAI_CONST_STRING("count"), .offset = 0, .type = (Kai_Type)(&(kai__builtin_integer_types[5+sizeof(Kai_uint)/4]))}, 
+    {.name = KAI_CONST_STRING("data"), .offset = sizeof(Kai_uint), .type = (Kai_Type)(&(kai__builtin_u8_pointer[0]))}
+};
 
-KAI_INTERNAL Kai_u32 kai__arm64_tst_1(Kai_u32 Rn, Kai_u8 sf)
-{
-    return ((sf<<31|457<<22)|Rn<<5)|31;
-}
+static Kai_Type_Info_Struct kai__builtin_string_type[1] = {
+    {.id = KAI_TYPE_ID_STRING, .hash = 35, .size = sizeof(Kai_uint)+sizeof(Kai_u8*), .fields = {.count = 2, .data = kai__builtin_string_fields}}
+};
 
-KAI_INTERNAL Kai_u32 kai__arm64_mov(Kai_u32 Rd, Kai_u32 Rs, Kai_u8 sf)
-{
-    return sizeof(Rd, Rs, sf);
-}
+static Kai_Type kai__builtin_types[KAI_BUILTIN_COUNT] = {
+    &(kai__builtin_type_infos[0]), &(kai__builtin_type_infos[1]), &(kai__builtin_type_infos[2]), 
+    (Kai_Type)(&(kai__builtin_integer_types[4])), (Kai_Type)(&(kai__builtin_integer_types[5])), 
+    (Kai_Type)(&(kai__builtin_integer_types[6])), (Kai_Type)(&(kai__builtin_integer_types[7])), 
+    (Kai_Type)(&(kai__builtin_integer_types[0])), (Kai_Type)(&(kai__builtin_integer_types[1])), 
+    (Kai_Type)(&(kai__builtin_integer_types[2])), (Kai_Type)(&(kai__builtin_integer_types[3])), 
+    (Kai_Type)(&(kai__builtin_float_types[0])), (Kai_Type)(&(kai__builtin_float_types[1])), 
+    (Kai_Type)(&(kai__builtin_string_type[0])), &(kai__builtin_type_infos[3]), NULL, 
+    NULL
+};
 
-KAI_INTERNAL Kai_u32 kai__arm64_movz(Kai_u32 Rd, Kai_u16 imm16, Kai_u8 sf)
-{
-    return ((sf<<31|165<<23)|imm16<<5)|Rd;
-}
+static Kai_string kai__builtin_names[KAI__BUILTIN_NAME_COUNT] = {
+    KAI_CONST_STRING("void"), KAI_CONST_STRING("s8"), KAI_CONST_STRING("s16"), KAI_CONST_STRING("s32"), 
+    KAI_CONST_STRING("s64"), KAI_CONST_STRING("u8"), KAI_CONST_STRING("u16"), KAI_CONST_STRING("u32"), 
+    KAI_CONST_STRING("u64"), KAI_CONST_STRING("f32"), KAI_CONST_STRING("f64"), KAI_CONST_STRING("bool"), 
+    KAI_CONST_STRING("string")
+};
 
-KAI_INTERNAL Kai_u32 kai__arm64_movk(Kai_u32 Rd, Kai_u16 imm16, Kai_u8 shift)
-{
-    return ((485<<23|(shift&3)<<21)|imm16<<5)|Rd;
-}
+static Kai_Node kai__builtin_nodes[KAI__BUILTIN_NODE_COUNT] = {
+    {.type = &(kai__builtin_type_infos[0]), .value = {.type = &(kai__builtin_type_infos[0])}, .flags = KAI_NODE_EVALUATED}, 
+    {.type = &(kai__builtin_type_infos[0]), .value = {.type = &(kai__builtin_type_infos[1])}, .flags = KAI_NODE_EVALUATED}, 
+    {.type = &(kai__builtin_type_infos[0]), .value = {.type = (Kai_Type)(&(kai__builtin_integer_types[0]))}, .flags = KAI_NODE_EVALUATED}, 
+    {.type = &(kai__builtin_type_infos[0]), .value = {.type = (Kai_Type)(&(kai__builtin_integer_types[1]))}, .flags = KAI_NODE_EVALUATED}, 
+    {.type = &(kai__builtin_type_infos[0]), .value = {.type = (Kai_Type)(&(kai__builtin_integer_types[2]))}, .flags = KAI_NODE_EVALUATED}, 
+    {.type = &(kai__builtin_type_infos[0]), .value = {.type = (Kai_Type)(&(kai__builtin_integer_types[3]))}, .flags = KAI_NODE_EVALUATED}, 
+    {.type = &(kai__builtin_type_infos[0]), .value = {.type = (Kai_Type)(&(kai__builtin_integer_types[4]))}, .flags = KAI_NODE_EVALUATED}, 
+    {.type = &(kai__builtin_type_infos[0]), .value = {.type = (Kai_Type)(&(kai__builtin_integer_types[5]))}, .flags = KAI_NODE_EVALUATED}, 
+    {.type = &(kai__builtin_type_infos[0]), .value = {.type = (Kai_Type)(&(kai__builtin_integer_types[6]))}, .flags = KAI_NODE_EVALUATED}, 
+    {.type = &(kai__builtin_type_infos[0]), .value = {.type = (Kai_Type)(&(kai__builtin_integer_types[7]))}, .flags = KAI_NODE_EVALUATED}, 
+    {.type = &(kai__builtin_type_infos[0]), .value = {.type = (Kai_Type)(&(kai__builtin_float_types[0]))}, .flags = KAI_NODE_EVALUATED}, 
+    {.type = &(kai__builtin_type_infos[0]), .value = {.type = (Kai_Type)(&(kai__builtin_float_types[1]))}, .flags = KAI_NODE_EVALUATED}, 
+    {.type = &(kai__builtin_type_infos[0]), .value = {.type = &(kai__builtin_type_infos[2])}, .flags = KAI_NODE_EVALUATED}, 
+    {.type = &(kai__builtin_type_infos[0]), .value = {.type = (Kai_Type)(&(kai__builtin_string_type[0]))}, .flags = KAI_NODE_EVALUATED}, 
+    {.type = &(kai__builtin_type_infos[0]), .value = {.type = &(kai__builtin_type_infos[3])}, .flags = KAI_NODE_EVALUATED}
+};
 
-KAI_INTERNAL Kai_u32 kai__arm64_bl(Kai_s32 imm26)
+KAI_INTERNAL void kai__intern_builtin_names(Kai_Compiler_Context* context)
 {
-    return 37<<26|(imm26&67108863);
+    for (Kai_u32 i = 0; i < KAI__BUILTIN_NAME_COUNT; ++i)
+    {
+        kai_intern_atom(&(context->atoms), kai__builtin_names[i]);
+    }
 }
 
-KAI_INTERNAL Kai_u32 kai__arm64_b(Kai_s32 imm19, Kai_u8 cond)
+KAI_INTERNAL Kai_bool kai__generate_builtin_types(Kai_Compiler_Context* context)
 {
-    return (84<<24|(imm19&524287)<<5)|cond;
+    Kai_Allocator* allocator = &(context->allocator);
+    kai_array_reserve(&(context->nodes), KAI__BUILTIN_NODE_COUNT);
+    kai__memory_copy((context->nodes).data, &(kai__builtin_nodes[0]), KAI__BUILTIN_NODE_COUNT*sizeof(Kai_Node));
+    (context->nodes).count = KAI__BUILTIN_NODE_COUNT;
+    kai_assert((kai__builtin_u8_pointer[0]).hash==kai__compute_type_hash((Kai_Type)(&(kai__builtin_u8_pointer[0]))));
+    for (Kai_u32 i = 0; i < KAI_BUILTIN_COUNT; ++i)
+    {
+        Kai_Type_Info* info = ((Kai_Type_Info*)kai__builtin_types[i]);
+        kai_assert(info==NULL||info->hash==kai__compute_type_hash(info));
+    }
+    (context->builtin_types).data = &(kai__builtin_types[0]);
+    (context->builtin_types).count = KAI_BUILTIN_COUNT;
+    context->type_type = kai__builtin_types[KAI_BUILTIN_TYPE];
+    context->bool_type = kai__builtin_types[KAI_BUILTIN_BOOL];
+    context->number_type = kai__builtin_types[KAI_BUILTIN_NUMBER];
+    context->string_type = kai__builtin_types[KAI_BUILTIN_STRING];
+    return KAI_FALSE;
 }
 
-KAI_INTERNAL Kai_u32 kai__arm64_str_12(Kai_u32 Rn, Kai_u32 Rt, Kai_u16 offset12)
+KAI_INTERNAL Kai_bool kai__value_to_number(Kai_Value value, Kai_Type_Info* type, Kai_Number* out_number)
 {
-    return ((996<<22|offset12<<10)|Rn<<5)|Rt;
+    switch (type->id)
+    {
+        break; case KAI_TYPE_ID_INTEGER:
+        {
+            Kai_Type_Info_Integer* info = ((Kai_Type_Info_Integer*)type);
+            Kai_Number num = ((Kai_Number){.d = 1});
+            if (info->is_signed)
+            {
+                num.is_neg = value.s64<0;
+                if (num.is_neg)
+                {
+                    num.n = (Kai_u64)(-(value.s64));
+                }
+                else
+                {
+                    num.n = (Kai_u64)(value.s64);
+                }
+            }
+            else
+            {
+                num.n = value.u64;
+            }
+            *out_number = kai_number_normalize(num);
+            return KAI_FALSE;
+        }
+        break; default:
+        {
+            return KAI_TRUE;
+        }
+    }
 }
 
-KAI_INTERNAL Kai_u32 kai__arm64_ldr_12(Kai_u32 Rn, Kai_u32 Rt, Kai_u16 offset12)
+KAI_INTERNAL Kai_Value kai__evaluate_binary_operation(Kai_u32 op, Kai_Type_Info* type, Kai_Value a, Kai_Value b)
 {
-    return ((997<<22|offset12<<10)|Rn<<5)|Rt;
+    switch (type->id)
+    {
+        break; case KAI_TYPE_ID_INTEGER:
+        {
+            Kai_Type_Info_Integer* info = ((Kai_Type_Info_Integer*)type);
+            if (info->is_signed)
+            {
+                switch (info->bits)
+                {
+                    break; case 32:
+                    {
+                        switch (op)
+                        {
+                            break; case 43:
+                            return ((Kai_Value){.s32 = a.s32+b.s32});
+                            break; case 45:
+                            return ((Kai_Value){.s32 = a.s32-b.s32});
+                            break; case 42:
+                            return ((Kai_Value){.s32 = a.s32*b.s32});
+                        }
+                    }
+                }
+            }
+            else
+            {
+                switch (info->bits)
+                {
+                    break; case 64:
+                    {
+                        switch (op)
+                        {
+                            break; case 43:
+                            return ((Kai_Value){.u64 = a.u64+b.u64});
+                            break; case 45:
+                            return ((Kai_Value){.u64 = a.u64-b.u64});
+                        }
+                    }
+                    break; case 32:
+                    {
+                        switch (op)
+                        {
+                            break; case 43:
+                            return ((Kai_Value){.u32 = a.u32+b.u32});
+                            break; case 45:
+                            return ((Kai_Value){.u32 = a.u32-b.u32});
+                        }
+                    }
+                }
+            }
+            kai__todo("integer op = %i, is_signed = %i, bits = %i", op, info->is_signed, info->bits);
+        }
+        break; case KAI_TYPE_ID_FLOAT:
+        {
+            Kai_Type_Info_Float* info = ((Kai_Type_Info_Float*)type);
+            switch (info->bits)
+            {
+                break; case 32:
+                {
+                    switch (op)
+                    {
+                        break; case 43:
+                        return ((Kai_Value){.f32 = a.f32+b.f32});
+                        break; case 45:
+                        return ((Kai_Value){.f32 = a.f32-b.f32});
+                    }
+                }
+            }
+            kai__todo("float op = %i, bits = %i", op, info->bits);
+        }
+        break; case KAI_TYPE_ID_NUMBER:
+        {
+            switch (op)
+            {
+                break; case 15677:
+                return ((Kai_Value){.u8 = kai_number_equals(a.number, b.number)});
+                break; case 43:
+                return ((Kai_Value){.number = kai_number_add(a.number, b.number)});
+                break; case 45:
+                return ((Kai_Value){.number = kai_number_sub(a.number, b.number)});
+                break; case 42:
+                return ((Kai_Value){.number = kai_number_mul(a.number, b.number)});
+                break; case 47:
+                return ((Kai_Value){.number = kai_number_div(a.number, b.number)});
+                break; case 15420:
+                {
+                    Kai_s64 e = (Kai_s64)(kai_number_to_u64(b.number));
+                    return ((Kai_Value){.number = kai_number_normalize(((Kai_Number){(a.number).n, (a.number).d, (a.number).e+e, (a.number).is_neg}))});
+                }
+                break; case 15934:
+                {
+                    Kai_s64 e = (Kai_s64)(kai_number_to_u64(b.number));
+                    return ((Kai_Value){.number = kai_number_normalize(((Kai_Number){(a.number).n, (a.number).d, (a.number).e-e, (a.number).is_neg}))});
+                }
+            }
+            kai__todo("number op = %i", op);
+        }
+        break; default:
+        {
+            kai__todo("type.id = %i", type->id);
+        }
+    }
+    return ((Kai_Value){0});
 }
 
-KAI_INTERNAL Kai_u32 kai__arm64_str(Kai_u32 Rn, Kai_u32 Rt, Kai_s16 offset9)
+KAI_INTERNAL void kai__add_dependency(Kai_Compiler_Context* context, Kai_Node_Reference ref)
 {
-    return ((1984<<21|((Kai_u32)(offset9&511))<<12)|Rn<<5)|Rt;
+    for (Kai_u32 i = 0; i < (context->current_dependencies).count; ++i)
+    {
+        Kai_Node_Reference it = ((context->current_dependencies).data)[i];
+        if (it.index==ref.index&&it.flags==ref.flags)
+            return;
+    }
+    Kai_Allocator* allocator = &(context->allocator);
+    kai_array_push(&(context->current_dependencies), ref);
 }
 
-KAI_INTERNAL Kai_u32 kai__arm64_ldr(Kai_u32 Rn, Kai_u32 Rt, Kai_s16 offset9)
+KAI_INTERNAL Kai_u8 kai__intrinsic_from_name(Kai_string name)
 {
-    return ((1986<<21|((Kai_u32)(offset9&511))<<12)|Rn<<5)|Rt;
+    if (kai_string_equals(name, KAI_STRING("clz")))
+        return KAI_INTRINSIC_CLZ;
+    if (kai_string_equals(name, KAI_STRING("ctz")))
+        return KAI_INTRINSIC_CTZ;
+    if (kai_string_equals(name, KAI_STRING("popcount")))
+        return KAI_INTRINSIC_POPCOUNT;
+    if (kai_string_equals(name, KAI_STRING("bswap")))
+        return KAI_INTRINSIC_BSWAP;
+    if (kai_string_equals(name, KAI_STRING("rotl")))
+        return KAI_INTRINSIC_ROTL;
+    if (kai_string_equals(name, KAI_STRING("multiply_high")))
+        return KAI_INTRINSIC_MULTIPLY_HIGH;
+    if (kai_string_equals(name, KAI_STRING("memcpy")))
+        return KAI_INTRINSIC_MEMORY_COPY;
+    if (kai_string_equals(name, KAI_STRING("memset")))
+        return KAI_INTRINSIC_MEMORY_SET;
+    return KAI_INTRINSIC_NONE;
 }
 
-KAI_INTERNAL Kai_u32 kai__arm64_ret(void)
+KAI_INTERNAL Kai_u8 kai__intrinsic_of_call(Kai_Compiler_Context* context, Kai_Expr* expr)
 {
-    return 3596551104;
+    Kai_Expr_Procedure_Call* c = ((Kai_Expr_Procedure_Call*)expr);
+    if ((c->proc)->id!=KAI_EXPR_IDENTIFIER)
+        return KAI_INTRINSIC_NONE;
+    Kai_u8 intrinsic = kai__intrinsic_from_name((c->proc)->source_code);
+    if (intrinsic==KAI_INTRINSIC_NONE)
+        return KAI_INTRINSIC_NONE;
+    Kai_Node_Reference ref = kai__lookup_node(context, (c->proc)->atom);
+    if (!((ref.flags)&KAI_NODE_NOT_FOUND))
+        return KAI_INTRINSIC_NONE;
+    return intrinsic;
 }
 
-KAI_INTERNAL Kai_bool kai__create_syntax_trees(Kai_Compiler_Context* context, Kai_Source_Slice sources)
+KAI_INTERNAL Kai_u64 kai__evaluate_intrinsic(Kai_u8 intrinsic, Kai_u8 bits, Kai_u64 a, Kai_u64 b)
 {
-    Kai_Allocator* allocator = &(context->allocator);
-    (context->trees).data = (Kai_Syntax_Tree*)(kai__allocate(NULL, sources.count*sizeof(Kai_Syntax_Tree), 0));
-    (context->trees).count = sources.count;
-    for (Kai_u32 i = 0; i < sources.count; ++i)
+    if (bits<64)
     {
-        Kai_Syntax_Tree_Create_Info info = ((Kai_Syntax_Tree_Create_Info){.source = sources.data[i], .allocator = context->allocator, .error = context->error});
-        if (kai_create_syntax_tree(&info, &kai_array_last(&(context->trees)))!=KAI_SUCCESS)
-            return KAI_TRUE;
+        a &= (((Kai_u64)(1))<<bits)-1;
     }
-    return KAI_FALSE;
+    switch (intrinsic)
+    {
+        break; case KAI_INTRINSIC_CLZ:
+        {
+            if (a==0)
+                return bits;
+            return kai_intrinsics_clz64(a)-(64-bits);
+        }
+        break; case KAI_INTRINSIC_CTZ:
+        {
+            if (a==0)
+                return bits;
+            return kai_intrinsics_ctz64(a);
+        }
+        break; case KAI_INTRINSIC_POPCOUNT:
+        {
+            return kai_intrinsics_popcount64(a);
+        }
+        break; case KAI_INTRINSIC_BSWAP:
+        {
+            return kai_intrinsics_bswap64(a)>>(64-bits);
+        }
+        break; case KAI_INTRINSIC_ROTL:
+        {
+            if (bits==32)
+                return kai_intrinsics_rotl32((Kai_u32)(a), (Kai_u32)(b));
+            return kai_intrinsics_rotl64(a, (Kai_u32)(b));
+        }
+        break; case KAI_INTRINSIC_MULTIPLY_HIGH:
+        {
+            return kai_intrinsics_u128_high(kai_intrinsics_u128_multiply(a, b));
+        }
+    }
+    return 0;
 }
 
-KAI_INTERNAL void kai__write_expression_name(Kai_Writer* writer, Kai_Expr* expr)
+KAI_INTERNAL Kai_bool kai__value_of_intrinsic(Kai_Compiler_Context* context, Kai_Expr* expr, Kai_u8 intrinsic, Kai_Value* out_value, Kai_Type* expected_type)
 {
-    kai_assert(expr!=NULL);
-    switch (expr->id)
+    Kai_Expr_Procedure_Call* c = ((Kai_Expr_Procedure_Call*)expr);
+    Kai_u32 argument_count = 1;
+    switch (intrinsic)
     {
-        break; case KAI_EXPR_IDENTIFIER:
+        break; case KAI_INTRINSIC_ROTL:
+        /* fall through */
+        case KAI_INTRINSIC_MULTIPLY_HIGH:
+        argument_count = 2;
+        break; case KAI_INTRINSIC_MEMORY_COPY:
+        /* fall through */
+        case KAI_INTRINSIC_MEMORY_SET:
+        argument_count = 3;
+    }
+    if (c->arg_count!=argument_count)
+        return kai__error_fatal(context, KAI_STRING("wrong number of arguments to intrinsic"));
+    Kai_Type_Info* output_type = 0;
+    if (intrinsic==KAI_INTRINSIC_MEMORY_COPY||intrinsic==KAI_INTRINSIC_MEMORY_SET)
+    {
+        if (out_value!=NULL)
+            return kai__error_fatal(context, KAI_STRING("memory intrinsics cannot be evaluated at compile time"));
+        Kai_Expr* dst = c->arg_head;
+        Kai_Type_Info* dt = 0;
+        if (kai__value_of_expr(context, dst, NULL, &dt))
+            return KAI_TRUE;
+        if (dt->id!=KAI_TYPE_ID_POINTER)
+            return kai__error_fatal(context, KAI_STRING("destination of memory intrinsic must be a pointer"));
+        context->stack_index += 1;
+        kai_asm_insert_stack_store(&(context->assembler), context->stack_index, 0);
+        Kai_Type_Info* st = 0;
+        if (intrinsic==KAI_INTRINSIC_MEMORY_SET)
+            st = ((context->builtin_types).data)[KAI_BUILTIN_U8];
+        if (kai__value_of_expr(context, dst->next, NULL, &st))
+            return KAI_TRUE;
+        if (intrinsic==KAI_INTRINSIC_MEMORY_COPY&&st->id!=KAI_TYPE_ID_POINTER)
+            return kai__error_fatal(context, KAI_STRING("source of memcpy must be a pointer"));
+        context->stack_index += 1;
+        kai_asm_insert_stack_store(&(context->assembler), context->stack_index, 0);
+        Kai_Type_Info* size_type = 0;
+        if (kai__value_of_expr(context, (dst->next)->next, NULL, &size_type))
+            return KAI_TRUE;
+        if (size_type->id!=KAI_TYPE_ID_INTEGER&&size_type->id!=KAI_TYPE_ID_NUMBER)
+            return kai__error_fatal(context, KAI_STRING("size of memory intrinsic must be an integer"));
+        kai_asm_insert_stack_load(&(context->assembler), context->stack_index, 2);
+        kai_asm_insert_stack_load(&(context->assembler), context->stack_index-1, 1);
+        context->stack_index -= 2;
+        if (intrinsic==KAI_INTRINSIC_MEMORY_COPY)
+            kai_asm_insert_memory_copy(&(context->assembler), 1, 2, 0);
+        else
+            kai_asm_insert_memory_set(&(context->assembler), 1, 2, 0);
+        output_type = ((context->builtin_types).data)[KAI_BUILTIN_VOID];
+    }
+    else
+    {
+        Kai_Value a = {0};
+        Kai_Value b = {0};
+        Kai_Value* out_a = 0;
+        Kai_Value* out_b = 0;
+        if (out_value!=NULL)
         {
-            kai__write("\"");
-            kai__write_string(expr->source_code);
-            kai__write("\"");
+            out_a = &a;
+            out_b = &b;
         }
-        break; case KAI_EXPR_STRING:
-        kai__write("string");
-        break; case KAI_EXPR_NUMBER:
-        kai__write("number");
-        break; case KAI_EXPR_LITERAL:
-        kai__write("literal");
-        break; case KAI_EXPR_UNARY:
-        kai__write("expression");
-        break; case KAI_EXPR_BINARY:
-        kai__write("expression");
-        break; case KAI_EXPR_PROCEDURE_TYPE:
-        kai__write("procedure type");
-        break; case KAI_EXPR_PROCEDURE_CALL:
-        kai__write("procedure call");
-        break; case KAI_EXPR_PROCEDURE:
-        kai__write("procedure");
-        break; case KAI_EXPR_CODE:
-        kai__write("code");
-        break; case KAI_EXPR_IMPORT:
-        kai__write("import");
-        break; case KAI_EXPR_STRUCT:
-        kai__write("struct");
-        break; case KAI_EXPR_ENUM:
-        kai__write("enum");
-        break; case KAI_EXPR_ARRAY:
-        kai__write("array");
-        break; case KAI_EXPR_SPECIAL:
-        kai__write_string(expr->source_code);
-        break; default:
-        kai__write("UNKNOWN");
+        Kai_Type_Info* value_type = 0;
+        if (intrinsic==KAI_INTRINSIC_BSWAP||intrinsic==KAI_INTRINSIC_ROTL)
+        {
+            value_type = *expected_type;
+            if (value_type!=NULL&&value_type->id!=KAI_TYPE_ID_INTEGER)
+                value_type = NULL;
+        }
+        if (kai__value_of_expr(context, c->arg_head, out_a, &value_type))
+            return KAI_TRUE;
+        if (value_type->id!=KAI_TYPE_ID_INTEGER)
+            return kai__error_fatal(context, KAI_STRING("argument of intrinsic must be a sized integer"));
+        Kai_Type_Info_Integer* info = ((Kai_Type_Info_Integer*)value_type);
+        Kai_u8 bits = info->bits;
+        output_type = value_type;
+        switch (intrinsic)
+        {
+            break; case KAI_INTRINSIC_CLZ:
+            /* fall through */
+            case KAI_INTRINSIC_CTZ:
+            /* fall through */
+            case KAI_INTRINSIC_POPCOUNT:
+            {
+                output_type = ((context->builtin_types).data)[KAI_BUILTIN_U32];
+            }
+            break; case KAI_INTRINSIC_ROTL:
+            {
+                if (bits<32)
+                    return kai__error_fatal(context, KAI_STRING("rotl requires a 32 or 64 bit integer"));
+            }
+            break; case KAI_INTRINSIC_MULTIPLY_HIGH:
+            {
+                if (bits!=64||info->is_signed)
+                    return kai__error_fatal(context, KAI_STRING("multiply_high requires u64 arguments"));
+            }
+        }
+        if (argument_count==2)
+        {
+            context->stack_index += 1;
+            kai_asm_insert_stack_store(&(context->assembler), context->stack_index, 0);
+            Kai_Type_Info* second_type = 0;
+            if (intrinsic==KAI_INTRINSIC_MULTIPLY_HIGH)
+                second_type = value_type;
+            if (kai__value_of_expr(context, (c->arg_head)->next, out_b, &second_type))
+                return KAI_TRUE;
+            if (second_type->id==KAI_TYPE_ID_NUMBER&&out_b!=NULL)
+            {
+                if (!kai_number_is_integer(b.number)||(b.number).is_neg)
+                    return kai__error_fatal(context, KAI_STRING("rotate amount must be a positive integer"));
+                b.u64 = kai_number_to_u64(b.number);
+            }
+            else
+            if (second_type->id!=KAI_TYPE_ID_INTEGER&&second_type->id!=KAI_TYPE_ID_NUMBER)
+                return kai__error_fatal(context, KAI_STRING("argument of intrinsic must be an integer"));
+            kai_asm_insert_stack_load(&(context->assembler), context->stack_index, 1);
+            context->stack_index -= 1;
+        }
+        if (out_value!=NULL)
+        {
+            *out_value = ((Kai_Value){.u64 = kai__evaluate_intrinsic(intrinsic, bits, a.u64, b.u64)});
+        }
+        else
+        switch (intrinsic)
+        {
+            break; case KAI_INTRINSIC_CLZ:
+            kai_asm_insert_count_leading_zeros(&(context->assembler), 0, bits);
+            break; case KAI_INTRINSIC_CTZ:
+            kai_asm_insert_count_trailing_zeros(&(context->assembler), 0, bits);
+            break; case KAI_INTRINSIC_POPCOUNT:
+            kai_asm_insert_popcount(&(context->assembler), 0, bits);
+            break; case KAI_INTRINSIC_BSWAP:
+            kai_asm_insert_byte_swap(&(context->assembler), 0, bits);
+            break; case KAI_INTRINSIC_ROTL:
+            kai_asm_insert_rotate_left(&(context->assembler), 0, 1, 0, bits);
+            break; case KAI_INTRINSIC_MULTIPLY_HIGH:
+            kai_asm_insert_multiply_high(&(context->assembler), 0, 1, 0);
+        }
+    }
+    if (*expected_type==NULL)
+    {
+        *expected_type = output_type;
     }
+    if (*expected_type!=output_type)
+        return kai__error_type_check(context, expr, *expected_type, output_type);
+    expr->this_type = output_type;
+    return KAI_FALSE;
 }
 
-KAI_INTERNAL Kai_bool kai__inside_procedure_scope(Kai_Compiler_Context* context)
+KAI_INTERNAL Kai_u64 kai__normalize_case_value(Kai_u64 value, Kai_Type_Info_Integer* info)
 {
-    for (Kai_u32 i = 0; i < (context->scopes).count; ++i)
+    if (info->bits>=64)
+        return value;
+    Kai_u32 shift = 64-info->bits;
+    value = value<<shift;
+    if (info->is_signed)
     {
-        Kai_u32 ri = ((context->scopes).count-1)-i;
-        Kai_Scope* scope = &(((context->scopes).data)[ri]);
-        if (scope->is_proc_scope)
-            return KAI_TRUE;
+        Kai_s64 extended = ((Kai_s64)(value))>>shift;
+        return (Kai_u64)(extended);
     }
-    return KAI_FALSE;
+    return value>>shift;
 }
 
-KAI_INTERNAL Kai_bool kai__error_fatal(Kai_Compiler_Context* context, Kai_string message)
+KAI_INTERNAL Kai_bool kai__case_value_less(Kai_u64 a, Kai_u64 b, Kai_bool is_signed)
 {
-    (context->error)->result = KAI_ERROR_FATAL;
-    (context->error)->message = message;
-    ((context->error)->location).source = context->current_source;
-    kai__debug_print_stacktrace();
-    return KAI_TRUE;
+    if (is_signed)
+        return (Kai_s64)(a)<(Kai_s64)(b);
+    return a<b;
 }
 
-KAI_INTERNAL Kai_bool kai__error_redefinition(Kai_Compiler_Context* context, Kai_Location location, Kai_u32 original)
+KAI_INTERNAL Kai_u64 kai__sorted_case_value(Kai__Case_Lowering* lowering, Kai_u32 k)
 {
-    *(context->error) = ((Kai_Error){.result = KAI_ERROR_SEMANTIC, .location = location});
-    Kai_Buffer buffer = ((Kai_Buffer){.allocator = context->allocator});
-    {
-        kai__buffer_append_string(&buffer, KAI_STRING("identifier \""));
-        kai__buffer_append_string(&buffer, location.string);
-        kai__buffer_append_string(&buffer, KAI_STRING("\" has already been declared"));
-        Kai_Range range = kai__buffer_end(&buffer);
-        (context->error)->memory = kai__buffer_done(&buffer);
-        (context->error)->message = kai__range_to_string(range, (context->error)->memory);
-    }
-    {
-        Kai_Range info_range = kai__buffer_push(&buffer, sizeof(Kai_Error));
-        kai__buffer_append_string(&buffer, KAI_STRING("see original definition of \""));
-        kai__buffer_append_string(&buffer, location.string);
-        kai__buffer_append_string(&buffer, KAI_STRING("\""));
-        Kai_Range message_range = kai__buffer_end(&buffer);
-        Kai_Memory memory = kai__buffer_done(&buffer);
-        Kai_Node* existing = &(((context->nodes).data)[original]);
-        Kai_Error* info = (Kai_Error*)((Kai_u8*)(memory.data)+info_range.start);
-        *info = ((Kai_Error){.result = KAI_ERROR_INFO, .location = existing->location, .message = kai__range_to_string(message_range, memory), .memory = memory});
-        (context->error)->next = info;
-    }
-    return KAI_TRUE;
+    Kai__Case* c = &((lowering->cases)[(lowering->sorted)[k]]);
+    return c->value;
 }
 
-KAI_INTERNAL Kai_bool kai__error_not_declared(Kai_Compiler_Context* context, Kai_Location location)
+KAI_INTERNAL void kai__add_case_jump(Kai__Case_Lowering* lowering, Kai_u32 label, Kai_u32 target)
 {
-    *(context->error) = ((Kai_Error){.result = KAI_ERROR_SEMANTIC, .location = location});
-    Kai_Writer error_writer = kai_writer_from_arena(&(context->error_arena));
-    Kai_Writer* writer = &error_writer;
-    Kai_u32 message_offset = ((context->error_arena).buffer).count;
-    kai__write("identifier \"");
-    kai__write_string(location.string);
-    kai__write("\" not declared");
-    Kai_u32 message_count = ((context->error_arena).buffer).count-message_offset;
-    (context->error)->message = kai_string_from_data(((context->error_arena).buffer).data+message_offset, message_count);
-    return KAI_TRUE;
+    (lowering->jumps)[lowering->jump_count] = ((Kai__Case_Jump){.label = label, .target = target});
+    lowering->jump_count += 1;
 }
 
-KAI_INTERNAL Kai_bool kai__error_circular_dependency(Kai_Compiler_Context* context)
+KAI_INTERNAL void kai__lower_case_tree(Kai_Compiler_Context* context, Kai__Case_Lowering* lowering, Kai_u32 low, Kai_u32 high, Kai_u32 default_target)
 {
-    Kai_Node* node = &(((context->nodes).data)[(context->current_node).index]);
-    *(context->error) = ((Kai_Error){.result = KAI_ERROR_SEMANTIC, .location = node->location});
-    Kai_Allocator* allocator = &(context->allocator);
-    kai_array_reserve(&((context->error_arena).buffer), 2*1024);
-    Kai_Writer error_writer = kai_writer_from_arena(&(context->error_arena));
-    Kai_Writer* writer = &error_writer;
-    Kai_u32 message_offset = ((context->error_arena).buffer).count;
-    kai__write("detected circular dependency on \"");
-    kai__write_string((node->location).string);
-    kai__write("\"");
-    Kai_u32 message_count = ((context->error_arena).buffer).count-message_offset;
-    (context->error)->message = kai_string_from_data(((context->error_arena).buffer).data+message_offset, message_count);
-    Kai_Error* current_error = context->error;
-    Kai_Node_Reference prev_ref = context->current_node;
-    Kai_Node* prev_node = node;
-    Kai_Error error = ((Kai_Error){0});
-    Kai_Writer* temp = context->debug_writer;
-    context->debug_writer = writer;
-    for (Kai_u32 i = 0; i < (context->current_dependencies).count; ++i)
+    Kai_Assembler* assembler = &(context->assembler);
+    if (high-low<=3)
     {
-        Kai_Node_Reference ref = ((context->current_dependencies).data)[i];
-        Kai_Node* node = &(((context->nodes).data)[ref.index]);
-        Kai_Error* next = ((Kai_Error*)kai_growing_arena_push(&(context->error_arena), &error, sizeof(Kai_Error)));
-        Kai_u32 message_offset = ((context->error_arena).buffer).count;
-        kai__write_node(writer, prev_node, prev_ref.flags);
-        kai__write(" depends on ");
-        kai__write_node(writer, node, ref.flags);
-        Kai_u32 message_count = ((context->error_arena).buffer).count-message_offset;
-        *next = ((Kai_Error){.result = KAI_ERROR_INFO, .location = node->location, .message = kai_string_from_data(((context->error_arena).buffer).data+message_offset, message_count)});
-        current_error->next = next;
-        current_error = next;
-        prev_ref = ref;
-        prev_node = node;
+        for (Kai_u32 k = low; k < high; ++k)
+        {
+            Kai_u32 index = (lowering->sorted)[k];
+            Kai__Case* c = &((lowering->cases)[index]);
+            kai_asm_insert_load_constant(assembler, 1, c->value);
+            kai_asm_insert_cmp(assembler, 1, 0);
+            kai__add_case_jump(lowering, kai_asm_insert_jump(assembler, KAI_CONDITION_EQ, 0), index);
+        }
+        kai__add_case_jump(lowering, kai_asm_insert_jump(assembler, KAI_CONDITION_AL, 0), default_target);
+        return;
     }
-    context->debug_writer = temp;
-    return KAI_TRUE;
+    Kai_u32 mid = (low+high)/2;
+    Kai_u32 index = (lowering->sorted)[mid];
+    Kai__Case* c = &((lowering->cases)[index]);
+    kai_asm_insert_load_constant(assembler, 1, c->value);
+    kai_asm_insert_cmp(assembler, 1, 0);
+    kai__add_case_jump(lowering, kai_asm_insert_jump(assembler, KAI_CONDITION_EQ, 0), index);
+    Kai_u32 less = KAI_CONDITION_CC;
+    if (lowering->is_signed)
+        less = KAI_CONDITION_LT;
+    Kai_u32 left_jump = kai_asm_insert_jump(assembler, less, 0);
+    kai__lower_case_tree(context, lowering, mid+1, high, default_target);
+    kai_asm_modify_jump(assembler, left_jump, kai_asm_relative_location(left_jump, kai_asm_create_label(assembler)));
+    kai__lower_case_tree(context, lowering, low, mid, default_target);
 }
 
-KAI_INTERNAL Kai_bool kai__error_type_check(Kai_Compiler_Context* context, Kai_Expr* expr, Kai_Type expected, Kai_Type got)
+KAI_INTERNAL Kai_u32 kai__case_target_label(Kai__Case_Lowering* lowering, Kai_u32 target, Kai_u32 case_count)
 {
-    Kai_Location location = ((Kai_Location){.source = context->current_source, .string = expr->source_code, .line = expr->line_number});
-    *(context->error) = ((Kai_Error){.result = KAI_ERROR_TYPE, .location = location});
-    Kai_Writer error_writer = kai_writer_from_arena(&(context->error_arena));
-    Kai_Writer* writer = &error_writer;
-    Kai_u32 message_offset = ((context->error_arena).buffer).count;
-    kai__write("expected ");
-    kai__write_expression_name(writer, expr);
-    kai__write(" of type ");
-    kai_write_type(writer, got);
-    kai__write(" to be of type ");
-    kai_write_type(writer, expected);
-    Kai_u32 message_count = ((context->error_arena).buffer).count-message_offset;
-    (context->error)->message = kai_string_from_data(((context->error_arena).buffer).data+message_offset, message_count);
-    return KAI_TRUE;
+    if (target==case_count)
+        return lowering->end_label;
+    Kai__Case* c = &((lowering->cases)[target]);
+    return c->label;
 }
 
-KAI_INTERNAL Kai_bool kai__error_no_member(Kai_Compiler_Context* context, Kai_Type type, Kai_Expr* identifier)
+KAI_INTERNAL Kai_bool kai__lower_case_bodies(Kai_Compiler_Context* context, Kai__Case_Lowering* lowering, Kai_u32 case_count, Kai_Type* expected_type)
 {
-    Kai_Location location = ((Kai_Location){.source = context->current_source, .string = identifier->source_code, .line = identifier->line_number});
-    *(context->error) = ((Kai_Error){.result = KAI_ERROR_SEMANTIC, .location = location});
-    Kai_Writer error_writer = kai_writer_from_arena(&(context->error_arena));
-    Kai_Writer* writer = &error_writer;
-    Kai_u32 message_offset = ((context->error_arena).buffer).count;
-    kai__write("type ");
-    kai_write_type(writer, type);
-    kai__write(" has no member named \"");
-    kai__write_string(identifier->source_code);
-    kai__write("\"");
-    Kai_u32 message_count = ((context->error_arena).buffer).count-message_offset;
-    (context->error)->message = kai_string_from_data(((context->error_arena).buffer).data+message_offset, message_count);
-    return KAI_TRUE;
+    Kai_Assembler* assembler = &(context->assembler);
+    kai__push_scope(context, KAI_FALSE);
+    Kai_u32* end_jumps = ((Kai_u32*)kai_arena_allocate(&(context->temp_allocator), case_count*sizeof(Kai_u32)));
+    Kai_u32 end_jump_count = 0;
+    for (Kai_u32 k = 0; k < case_count; ++k)
+    {
+        Kai__Case* c = &((lowering->cases)[k]);
+        c->label = kai_asm_create_label(assembler);
+        Kai_bool falls_through = KAI_FALSE;
+        Kai_Stmt* current = c->body;
+        while (current!=NULL)
+        {
+            if (current->id==KAI_STMT_CONTROL)
+            {
+                Kai_Stmt_Control* control = ((Kai_Stmt_Control*)current);
+                if (control->kind==KAI_CONTROL_CASE)
+                    break;
+                if (control->kind!=KAI_CONTROL_THROUGH)
+                    return kai__error_fatal(context, KAI_STRING("control statement is not supported in if-case"));
+                falls_through = KAI_TRUE;
+            }
+            else
+            {
+                Kai_Type t = *expected_type;
+                if (kai__value_of_expr(context, current, NULL, &t))
+                    return KAI_TRUE;
+            }
+            current = current->next;
+        }
+        if (!falls_through&&k+1<case_count)
+        {
+            end_jumps[end_jump_count] = kai_asm_insert_jump(assembler, KAI_CONDITION_AL, 0);
+            end_jump_count += 1;
+        }
+    }
+    kai__pop_scope(context);
+    lowering->end_label = kai_asm_create_label(assembler);
+    for (Kai_u32 k = 0; k < lowering->jump_count; ++k)
+    {
+        Kai__Case_Jump jump = (lowering->jumps)[k];
+        Kai_u32 target = kai__case_target_label(lowering, jump.target, case_count);
+        kai_asm_modify_jump(assembler, jump.label, kai_asm_relative_location(jump.label, target));
+    }
+    for (Kai_u32 k = 0; k < end_jump_count; ++k)
+    {
+        kai_asm_modify_jump(assembler, end_jumps[k], kai_asm_relative_location(end_jumps[k], lowering->end_label));
+    }
+    return KAI_FALSE;
 }
 
-KAI_INTERNAL Kai_bool kai__error_host_import_not_found(Kai_Compiler_Context* context, Kai_Location location)
+KAI_INTERNAL Kai_u32 kai__string_case_char(Kai_string s, Kai_u32 i)
 {
-    *(context->error) = ((Kai_Error){.result = KAI_ERROR_SEMANTIC, .location = location});
-    Kai_Buffer buffer = ((Kai_Buffer){.allocator = context->allocator});
-    kai__buffer_append_string(&buffer, KAI_STRING("could not find host import \""));
-    kai__buffer_append_string(&buffer, location.string);
-    kai__buffer_append_string(&buffer, KAI_STRING("\""));
-    Kai_Range range = kai__buffer_end(&buffer);
-    (context->error)->memory = kai__buffer_done(&buffer);
-    (context->error)->message = kai__range_to_string(range, (context->error)->memory);
-    return KAI_TRUE;
+    if (i<s.count)
+        return (Kai_u32)((s.data)[i]);
+    return 0;
 }
 
-KAI_INTERNAL void kai__write_node(Kai_Writer* writer, Kai_Node* node, Kai_Node_Flags flags)
+KAI_INTERNAL Kai_u32 kai__string_case_hash(Kai__String_Case_Hash h, Kai_string s)
 {
-    if (flags&KAI_NODE_TYPE)
-        kai__write("type of \"");
-    else
-        kai__write("value of \"");
-    kai__write_string((node->location).string);
-    kai__write("\"");
+    return ((s.count*h.a+kai__string_case_char(s, h.p)*h.b)+kai__string_case_char(s, h.q))%h.n;
 }
 
-KAI_INTERNAL Kai_bool kai__create_nodes(Kai_Compiler_Context* context, Kai_Expr* expr)
+KAI_INTERNAL Kai_bool kai__find_string_case_hash(Kai_Compiler_Context* context, Kai__Case_Lowering* lowering, Kai_u32 value_count, Kai__String_Case_Hash* out)
 {
-    Kai_Allocator* allocator = &(context->allocator);
-    switch (expr->id)
+    Kai_u8* used = ((Kai_u8*)kai_arena_allocate(&(context->temp_allocator), 256));
+    Kai_u32 n = value_count;
+    while (n<=4*value_count+8&&n<=256)
     {
-        break; case KAI_EXPR_IMPORT:
+        for (Kai_u32 a = 0; a < 8; ++a)
         {
-            Kai_Writer* writer = context->debug_writer;
-            if (writer!=NULL)
+            for (Kai_u32 b = 1; b < 32; ++b)
             {
-                kai__write("import: \"");
-                kai__write_string(expr->name);
-                kai__write("\"\n");
+                for (Kai_u32 p = 0; p < 8; ++p)
+                {
+                    for (Kai_u32 q = 0; q < 8; ++q)
+                    {
+                        Kai__String_Case_Hash h = ((Kai__String_Case_Hash){.a = a, .b = b, .p = p, .q = q, .n = n});
+                        for (Kai_u32 k = 0; k < n; ++k)
+                        {
+                            used[k] = 0;
+                        }
+                        Kai_u32 j = 0;
+                        while (j<value_count)
+                        {
+                            Kai__Case* c = &((lowering->cases)[(lowering->sorted)[j]]);
+                            Kai_u32 slot = kai__string_case_hash(h, c->text);
+                            if (used[slot])
+                                break;
+                            used[slot] = 1;
+                            j += 1;
+                        }
+                        if (j==value_count)
+                        {
+                            *out = h;
+                            return KAI_TRUE;
+                        }
+                    }
+                }
             }
-            kai__todo("what's an import again?");
         }
-        break; case KAI_STMT_DECLARATION:
+        n += 1;
+    }
+    return KAI_FALSE;
+}
+
+KAI_INTERNAL Kai_bool kai__value_of_string_if_case(Kai_Compiler_Context* context, Kai_Stmt_If* i, Kai_Type* expected_type)
+{
+    Kai_Assembler* assembler = &(context->assembler);
+    if ((i->then_body)->id!=KAI_STMT_COMPOUND)
+        return kai__error_fatal(context, KAI_STRING("if-case must have a compound body"));
+    Kai_Stmt_Compound* body = ((Kai_Stmt_Compound*)i->then_body);
+    Kai_u32 case_count = 0;
+    Kai_Stmt* current = body->head;
+    while (current!=NULL)
+    {
+        if (current->id==KAI_STMT_CONTROL)
         {
-            Kai_Stmt_Declaration* d = ((Kai_Stmt_Declaration*)expr);
-            if (!((d->flags)&KAI_FLAG_DECL_CONST)&&kai__inside_procedure_scope(context))
-                return KAI_FALSE;
-            Kai_Location location = ((Kai_Location){.source = context->current_source, .string = d->name, .line = d->line_number});
-            Kai_Scope* scope = &kai_array_last(&(context->scopes));
-            {
-                Kai_int index = kai_table_find(string, &(scope->identifiers), d->name);
-                if (index!=-1)
+            Kai_Stmt_Control* control = ((Kai_Stmt_Control*)current);
+            if (control->kind==KAI_CONTROL_CASE)
+                case_count += 1;
+        }
+        else
+        if (case_count==0)
+            return kai__error_fatal(context, KAI_STRING("statement in if-case must come after a case"));
+        current = current->next;
+    }
+    Kai_Arena_Checkpoint checkpoint = kai_arena_save(&(context->temp_allocator));
+    Kai__Case_Lowering lowering = ((Kai__Case_Lowering){0});
+    lowering.cases = (Kai__Case*)(kai_arena_allocate(&(context->temp_allocator), case_count*sizeof(Kai__Case)));
+    lowering.sorted = (Kai_u32*)(kai_arena_allocate(&(context->temp_allocator), case_count*sizeof(Kai_u32)));
+    lowering.jumps = (Kai__Case_Jump*)(kai_arena_allocate(&(context->temp_allocator), (2*case_count+2)*sizeof(Kai__Case_Jump)));
+    Kai_u32 default_target = case_count;
+    Kai_u32 value_count = 0;
+    Kai_u32 index = 0;
+    current = body->head;
+    while (current!=NULL)
+    {
+        if (current->id==KAI_STMT_CONTROL)
+        {
+            Kai_Stmt_Control* control = ((Kai_Stmt_Control*)current);
+            if (control->kind==KAI_CONTROL_CASE)
+            {
+                Kai__Case* c = &((lowering.cases)[index]);
+                *c = ((Kai__Case){.body = current->next});
+                if (control->expr==NULL)
                 {
-                    Kai_Node_Reference reference = ((scope->identifiers).values)[index];
-                    (context->error)->result = KAI_ERROR_FATAL;
-                    return kai__error_redefinition(context, location, reference.index);
+                    if (default_target!=case_count)
+                    {
+                        kai_arena_restore(&(context->temp_allocator), checkpoint);
+                        return kai__error_fatal(context, KAI_STRING("if-case has more than one default case"));
+                    }
+                    default_target = index;
                 }
-            }
-            {
-                Kai_Node_Reference reference = ((Kai_Node_Reference){.index = (context->nodes).count});
-                Kai_Node node = ((Kai_Node){.location = location, .value_expr = d->value, .type_expr = d->type, .decl = expr});
-                if (d->flags&KAI_FLAG_DECL_HOST_IMPORT)
+                else
                 {
-                    node.flags |= KAI_NODE_IMPORT;
-                    Kai_Import* import = kai__find_host_import(context, (node.location).string);
-                    if (import==NULL)
-                        return kai__error_host_import_not_found(context, node.location);
-                    if (node.type_expr==NULL)
+                    Kai_Value value = {0};
+                    Kai_Type_Info* case_type = context->string_type;
+                    if (kai__value_of_expr(context, control->expr, &value, &case_type))
                     {
-                        if ((import->type).count==0)
-                            return kai__error_fatal(context, KAI_STRING("host import must be typed"));
-                        node.type_expr = kai__type_expression_from_string(context, import->type);
-                        if (node.type_expr==NULL)
-                            return KAI_TRUE;
+                        kai_arena_restore(&(context->temp_allocator), checkpoint);
+                        return KAI_TRUE;
                     }
-                    node.value = import->value;
-                    node.flags |= KAI_NODE_VALUE_EVALUATED;
+                    c->text = value.string;
+                    for (Kai_u32 k = 0; k < value_count; ++k)
+                    {
+                        Kai__Case* other = &((lowering.cases)[(lowering.sorted)[k]]);
+                        if (kai_string_equals(other->text, c->text))
+                        {
+                            kai_arena_restore(&(context->temp_allocator), checkpoint);
+                            return kai__error_fatal(context, KAI_STRING("duplicate case value"));
+                        }
+                    }
+                    (lowering.sorted)[value_count] = index;
+                    value_count += 1;
                 }
-                if (d->flags&KAI_FLAG_DECL_EXPORT)
-                    node.flags |= KAI_NODE_EXPORT;
-                Kai_Writer* writer = context->debug_writer;
-                if (writer!=NULL)
+                index += 1;
+            }
+        }
+        current = current->next;
+    }
+    kai_asm_insert_move(assembler, 7, 1);
+    Kai__String_Case_Hash hash = {0};
+    Kai_u32 table = 0;
+    Kai_u32* entries = ((Kai_u32*)kai_arena_allocate(&(context->temp_allocator), case_count*sizeof(Kai_u32)));
+    Kai_bool has_table = (assembler->backend>0&&value_count!=0)&&kai__find_string_case_hash(context, &lowering, value_count, &hash);
+    if (has_table)
+    {
+        kai_asm_insert_string_hash(assembler, 0, 7, hash.a, hash.b, hash.p, hash.q, hash.n);
+        table = kai_asm_insert_jump_table(assembler, 4, hash.n);
+        for (Kai_u32 k = 0; k < value_count; ++k)
+        {
+            Kai__Case* c = &((lowering.cases)[(lowering.sorted)[k]]);
+            entries[k] = kai_asm_create_label(assembler);
+            kai__add_case_jump(&lowering, kai_asm_insert_string_compare(assembler, 0, 7, c->text), (lowering.sorted)[k]);
+            kai__add_case_jump(&lowering, kai_asm_insert_jump(assembler, KAI_CONDITION_AL, 0), default_target);
+        }
+        context->jump_table_count += 1;
+    }
+    else
+    {
+        for (Kai_u32 k = 0; k < value_count; ++k)
+        {
+            Kai__Case* c = &((lowering.cases)[(lowering.sorted)[k]]);
+            kai__add_case_jump(&lowering, kai_asm_insert_string_compare(assembler, 0, 7, c->text), (lowering.sorted)[k]);
+        }
+        kai__add_case_jump(&lowering, kai_asm_insert_jump(assembler, KAI_CONDITION_AL, 0), default_target);
+        context->compare_tree_count += 1;
+    }
+    if (kai__lower_case_bodies(context, &lowering, case_count, expected_type))
+    {
+        kai_arena_restore(&(context->temp_allocator), checkpoint);
+        return KAI_TRUE;
+    }
+    if (has_table)
+    {
+        Kai_u32 default_label = kai__case_target_label(&lowering, default_target, case_count);
+        for (Kai_u32 k = 0; k < hash.n; ++k)
+        {
+            kai_asm_set_jump_table_entry(assembler, table, k, default_label);
+        }
+        for (Kai_u32 k = 0; k < value_count; ++k)
+        {
+            Kai__Case* c = &((lowering.cases)[(lowering.sorted)[k]]);
+            kai_asm_set_jump_table_entry(assembler, table, kai__string_case_hash(hash, c->text), entries[k]);
+        }
+    }
+    kai_arena_restore(&(context->temp_allocator), checkpoint);
+    return KAI_FALSE;
+}
+
+KAI_INTERNAL Kai_bool kai__value_of_if_case(Kai_Compiler_Context* context, Kai_Stmt_If* i, Kai_Type* expected_type)
+{
+    Kai_Assembler* assembler = &(context->assembler);
+    Kai_Type_Info* type = 0;
+    if (kai__value_of_expr(context, i->condition, NULL, &type))
+        return KAI_TRUE;
+    if (type->id==KAI_TYPE_ID_STRING)
+        return kai__value_of_string_if_case(context, i, expected_type);
+    if (type->id!=KAI_TYPE_ID_INTEGER)
+        return kai__error_type_check(context, i->condition, ((context->builtin_types).data)[KAI_BUILTIN_S32], type);
+    Kai_Type_Info_Integer* info = ((Kai_Type_Info_Integer*)type);
+    if ((i->then_body)->id!=KAI_STMT_COMPOUND)
+        return kai__error_fatal(context, KAI_STRING("if-case must have a compound body"));
+    Kai_Stmt_Compound* body = ((Kai_Stmt_Compound*)i->then_body);
+    Kai_u32 case_count = 0;
+    Kai_Stmt* current = body->head;
+    while (current!=NULL)
+    {
+        if (current->id==KAI_STMT_CONTROL)
+        {
+            Kai_Stmt_Control* control = ((Kai_Stmt_Control*)current);
+            if (control->kind==KAI_CONTROL_CASE)
+                case_count += 1;
+        }
+        else
+        if (case_count==0)
+            return kai__error_fatal(context, KAI_STRING("statement in if-case must come after a case"));
+        current = current->next;
+    }
+    Kai_Arena_Checkpoint checkpoint = kai_arena_save(&(context->temp_allocator));
+    Kai__Case_Lowering lowering = ((Kai__Case_Lowering){.is_signed = info->is_signed});
+    lowering.cases = (Kai__Case*)(kai_arena_allocate(&(context->temp_allocator), case_count*sizeof(Kai__Case)));
+    lowering.sorted = (Kai_u32*)(kai_arena_allocate(&(context->temp_allocator), case_count*sizeof(Kai_u32)));
+    lowering.jumps = (Kai__Case_Jump*)(kai_arena_allocate(&(context->temp_allocator), (2*case_count+2)*sizeof(Kai__Case_Jump)));
+    Kai_u32 default_target = case_count;
+    Kai_u32 value_count = 0;
+    Kai_u32 index = 0;
+    current = body->head;
+    while (current!=NULL)
+    {
+        if (current->id==KAI_STMT_CONTROL)
+        {
+            Kai_Stmt_Control* control = ((Kai_Stmt_Control*)current);
+            if (control->kind==KAI_CONTROL_CASE)
+            {
+                Kai__Case* c = &((lowering.cases)[index]);
+                *c = ((Kai__Case){.body = current->next});
+                if (control->expr==NULL)
                 {
-                    kai__write("inserting node for \"");
-                    kai__write_string(d->name);
-                    kai__write("\"\n");
+                    if (default_target!=case_count)
+                    {
+                        kai_arena_restore(&(context->temp_allocator), checkpoint);
+                        return kai__error_fatal(context, KAI_STRING("if-case has more than one default case"));
+                    }
+                    default_target = index;
                 }
-                kai_table_set(string, &(scope->identifiers), d->name, reference);
-                Kai_Node_Reference type_reference = ((Kai_Node_Reference){.flags = KAI_NODE_TYPE, .index = reference.index});
-                kai_array_push(&(scope->pending_nodes), ((Kai_Pending_Node){.ref = type_reference}));
-                if (!((d->flags)&KAI_FLAG_DECL_HOST_IMPORT))
+                else
                 {
-                    Kai_Node_Reference_DynArray value_dependencies = {0};
-                    kai_array_push(&value_dependencies, type_reference);
-                    kai_array_push(&(scope->pending_nodes), ((Kai_Pending_Node){.ref = reference, .dependencies = value_dependencies}));
+                    Kai_Value value = {0};
+                    Kai_Type_Info* case_type = type;
+                    if (kai__value_of_expr(context, control->expr, &value, &case_type))
+                    {
+                        kai_arena_restore(&(context->temp_allocator), checkpoint);
+                        return KAI_TRUE;
+                    }
+                    c->value = kai__normalize_case_value(value.u64, info);
+                    Kai_u32 j = value_count;
+                    while (j>0&&kai__case_value_less(c->value, kai__sorted_case_value(&lowering, j-1), info->is_signed))
+                    {
+                        (lowering.sorted)[j] = (lowering.sorted)[j-1];
+                        j -= 1;
+                    }
+                    if (j>0&&kai__sorted_case_value(&lowering, j-1)==c->value)
+                    {
+                        kai_arena_restore(&(context->temp_allocator), checkpoint);
+                        return kai__error_fatal(context, KAI_STRING("duplicate case value"));
+                    }
+                    (lowering.sorted)[j] = index;
+                    value_count += 1;
                 }
-                kai_array_push(&(context->nodes), node);
+                index += 1;
             }
         }
-        break; case KAI_STMT_COMPOUND:
+        current = current->next;
+    }
+    kai_asm_insert_extend(assembler, 0, info->bits, info->is_signed);
+    Kai_u32 table = 0;
+    Kai_u32 table_count = 0;
+    Kai_u64 low = 0;
+    if (value_count>=4)
+    {
+        low = kai__sorted_case_value(&lowering, 0);
+        Kai_u64 range = kai__sorted_case_value(&lowering, value_count-1)-low;
+        if (range<2*value_count)
+        {
+            table_count = (Kai_u32)(range)+1;
+        }
+    }
+    if (table_count!=0)
+    {
+        if (low!=0)
         {
-            Kai_Stmt_Compound* c = ((Kai_Stmt_Compound*)expr);
-            Kai_Stmt* current = c->head;
-            while (current)
-            {
-                if (kai__create_nodes(context, current))
-                    return KAI_TRUE;
-                current = current->next;
-            }
+            kai_asm_insert_load_constant(assembler, 1, low);
+            kai_asm_insert_sub(assembler, 0, 0, 1);
+        }
+        kai_asm_insert_load_constant(assembler, 1, table_count);
+        kai_asm_insert_cmp(assembler, 1, 0);
+        kai__add_case_jump(&lowering, kai_asm_insert_jump(assembler, KAI_CONDITION_CS, 0), default_target);
+        table = kai_asm_insert_jump_table(assembler, 0, table_count);
+        context->jump_table_count += 1;
+    }
+    else
+    {
+        kai__lower_case_tree(context, &lowering, 0, value_count, default_target);
+        context->compare_tree_count += 1;
+    }
+    if (kai__lower_case_bodies(context, &lowering, case_count, expected_type))
+    {
+        kai_arena_restore(&(context->temp_allocator), checkpoint);
+        return KAI_TRUE;
+    }
+    if (table_count!=0)
+    {
+        Kai_u32 default_label = kai__case_target_label(&lowering, default_target, case_count);
+        for (Kai_u32 k = 0; k < table_count; ++k)
+        {
+            kai_asm_set_jump_table_entry(assembler, table, k, default_label);
+        }
+        for (Kai_u32 k = 0; k < value_count; ++k)
+        {
+            Kai__Case* c = &((lowering.cases)[(lowering.sorted)[k]]);
+            kai_asm_set_jump_table_entry(assembler, table, (Kai_u32)(c->value-low), c->label);
         }
     }
+    kai_arena_restore(&(context->temp_allocator), checkpoint);
     return KAI_FALSE;
 }
 
-KAI_INTERNAL Kai_bool kai__generate_nodes(Kai_Compiler_Context* context)
+KAI_INTERNAL Kai_Node* kai__polymorphic_node_of_call(Kai_Compiler_Context* context, Kai_Expr_Procedure_Call* c)
 {
-    Kai_Allocator* allocator = &(context->allocator);
-    kai_array_push(&(context->scopes), ((Kai_Scope){.is_proc_scope = KAI_FALSE}));
-    if (kai__generate_builtin_types(context))
-        return KAI_TRUE;
-    for (Kai_u32 i = 0; i < (context->trees).count; ++i)
+    if ((c->proc)->id!=KAI_EXPR_IDENTIFIER)
+        return NULL;
+    Kai_Node_Reference ref = kai__lookup_node(context, (c->proc)->atom);
+    if (ref.flags&(KAI_NODE_NOT_FOUND|KAI_NODE_LOCAL))
+        return NULL;
+    Kai_Node* node = &(((context->nodes).data)[ref.index]);
+    if (node->compact!=0)
     {
-        Kai_Syntax_Tree* tree = &(((context->trees).data)[i]);
-        context->current_source = tree->source;
-        Kai_Stmt* current = (tree->root).head;
-        while (current)
+        if (context->is_worker)
+            return NULL;
+        kai__expand_node(context, node);
+    }
+    if (node->value_expr==NULL||(node->value_expr)->id!=KAI_EXPR_PROCEDURE)
+        return NULL;
+    if (!(((node->value_expr)->flags)&KAI_FLAG_EXPR_POLYMORPHIC))
+        return NULL;
+    return node;
+}
+
+KAI_INTERNAL Kai_bool kai__bind_polymorphic_type(Kai_Compiler_Context* context, Kai_Expr* pattern, Kai_Expr* arg, Kai_Type_Info* type, Kai__Instance* instance)
+{
+    if (!((pattern->flags)&KAI_FLAG_EXPR_POLYMORPHIC))
+        return KAI_FALSE;
+    if (pattern->id==KAI_EXPR_UNARY)
+    {
+        Kai_Expr_Unary* u = ((Kai_Expr_Unary*)pattern);
+        if (type->id!=KAI_TYPE_ID_POINTER)
+            return kai__error_fatal(context, KAI_STRING("expected a pointer for polymorphic input"));
+        Kai_Type_Info_Pointer* pt = ((Kai_Type_Info_Pointer*)type);
+        return kai__bind_polymorphic_type(context, u->expr, arg, pt->sub_type, instance);
+    }
+    kai_assert(pattern->id==KAI_EXPR_IDENTIFIER);
+    Kai_Type_Info_Procedure* bindings = instance->bindings;
+    for (Kai_u32 i = 0; i < (bindings->inputs).count; ++i)
+    {
+        if ((instance->atoms)[i]==pattern->atom)
         {
-            if (kai__create_nodes(context, current))
-                return KAI_TRUE;
-            current = current->next;
+            if (((bindings->inputs).data)[i]!=type)
+                return kai__error_type_check(context, arg, ((bindings->inputs).data)[i], type);
+            return KAI_FALSE;
         }
     }
+    (instance->names)[(bindings->inputs).count] = pattern->source_code;
+    (instance->atoms)[(bindings->inputs).count] = pattern->atom;
+    ((bindings->inputs).data)[(bindings->inputs).count] = type;
+    (bindings->inputs).count += 1;
     return KAI_FALSE;
 }
 
-KAI_INTERNAL Kai_Node_Reference kai__lookup_node(Kai_Compiler_Context* context, Kai_string name)
+KAI_INTERNAL void kai__push_instance_scope(Kai_Compiler_Context* context, Kai__Instance* instance)
 {
-    for (Kai_u32 i = 0; i < (context->scopes).count; ++i)
+    Kai_Allocator* allocator = &(context->allocator);
+    kai__push_scope(context, KAI_FALSE);
+    Kai_Type_Info_Procedure* bindings = instance->bindings;
+    for (Kai_u32 i = 0; i < (bindings->inputs).count; ++i)
     {
-        Kai_u32 ri = ((context->scopes).count-1)-i;
-        Kai_Scope* scope = &(((context->scopes).data)[ri]);
-        Kai_int k = kai_table_find(string, &(scope->identifiers), name);
-        if (k==-1)
-            continue;
-        return ((scope->identifiers).values)[k];
+        Kai_Node_Reference ref = ((Kai_Node_Reference){.index = (context->nodes).count});
+        kai_array_push(&(context->nodes), ((Kai_Node){.type = context->type_type, .value = ((Kai_Value){.type = ((bindings->inputs).data)[i]}), .location = ((Kai_Location){.source = instance->source, .string = (instance->names)[i]}), .flags = KAI_NODE_EVALUATED}));
+        kai__bind(context, (instance->atoms)[i], ref);
     }
-    return ((Kai_Node_Reference){.flags = KAI_NODE_NOT_FOUND});
+    context->current_instance = instance;
 }
 
-KAI_INTERNAL void kai__debug_show_type(Kai_Compiler_Context* context, Kai_Type type)
+KAI_INTERNAL void kai__pop_instance_scope(Kai_Compiler_Context* context, Kai__Instance* instance, Kai__Instance* previous)
 {
-    Kai_Writer* writer = context->debug_writer;
-    if (writer!=NULL)
-    {
-        kai__set_color(KAI_WRITE_COLOR_TYPE);
-        kai_write_type(writer, type);
-        kai__set_color(KAI_WRITE_COLOR_DEFAULT);
-        kai__write(" ");
-        writer->write(writer->user, KAI_WRITE_U64, ((Kai_Value){.u64 = (Kai_u64)(type)}), ((Kai_Write_Format){.flags = KAI_WRITE_FLAGS_BASE_16, .fill_character = 48, .min_count = 16}));
-        kai__write("\n");
-    }
+    kai__pop_scope(context);
+    (context->nodes).count -= ((instance->bindings)->inputs).count;
+    context->current_instance = previous;
 }
 
-KAI_INTERNAL Kai_bool kai__generate_builtin_types(Kai_Compiler_Context* context)
+KAI_INTERNAL Kai_bool kai__instantiate_procedure(Kai_Compiler_Context* context, Kai_Expr_Procedure_Call* c, Kai_Node* node, Kai_Type_Info_Procedure** out_type)
 {
     Kai_Allocator* allocator = &(context->allocator);
-    Kai_Scope* scope = &kai_array_last(&(context->scopes));
-    Kai_Node_Reference ref = {0};
-    ref.index = (context->nodes).count;
-    (context->builtin_types).data = kai__allocate(NULL, KAI_BUILTIN_COUNT*sizeof(Kai_Type), 0);
-    (context->builtin_types).count = KAI_BUILTIN_COUNT;
-    kai_table_set(string, &(scope->identifiers), KAI_STRING("void"), ((Kai_Node_Reference){.index = (context->nodes).count+1}));
-    kai_table_set(string, &(scope->identifiers), KAI_STRING("s8"), ((Kai_Node_Reference){.index = (context->nodes).count+2}));
-    kai_table_set(string, &(scope->identifiers), KAI_STRING("s16"), ((Kai_Node_Reference){.index = (context->nodes).count+3}));
-    kai_table_set(string, &(scope->identifiers), KAI_STRING("s32"), ((Kai_Node_Reference){.index = (context->nodes).count+4}));
-    kai_table_set(string, &(scope->identifiers), KAI_STRING("s64"), ((Kai_Node_Reference){.index = (context->nodes).count+5}));
-    kai_table_set(string, &(scope->identifiers), KAI_STRING("u8"), ((Kai_Node_Reference){.index = (context->nodes).count+6}));
-    kai_table_set(string, &(scope->identifiers), KAI_STRING("u16"), ((Kai_Node_Reference){.index = (context->nodes).count+7}));
-    kai_table_set(string, &(scope->identifiers), KAI_STRING("u32"), ((Kai_Node_Reference){.index = (context->nodes).count+8}));
-    kai_table_set(string, &(scope->identifiers), KAI_STRING("u64"), ((Kai_Node_Reference){.index = (context->nodes).count+9}));
-    kai_table_set(string, &(scope->identifiers), KAI_STRING("f32"), ((Kai_Node_Reference){.index = (context->nodes).count+10}));
-    kai_table_set(string, &(scope->identifiers), KAI_STRING("f64"), ((Kai_Node_Reference){.index = (context->nodes).count+11}));
-    kai_table_set(string, &(scope->identifiers), KAI_STRING("bool"), ((Kai_Node_Reference){.index = (context->nodes).count+12}));
-    kai_table_set(string, &(scope->identifiers), KAI_STRING("string"), ((Kai_Node_Reference){.index = (context->nodes).count+14}));
-    Kai_Type_Info* type_type = ((Kai_Type_Info*)kai_arena_allocate(&(context->type_allocator), sizeof(Kai_Type_Info)));
-    type_type->id = KAI_TYPE_ID_TYPE;
-    kai_array_push(&(context->nodes), ((Kai_Node){.type = type_type, .value = ((Kai_Value){.type = type_type}), .flags = KAI_NODE_EVALUATED}));
-    context->type_type = type_type;
-    ((context->builtin_types).data)[KAI_BUILTIN_TYPE] = type_type;
-    kai__debug_show_type(context, type_type);
-    Kai_Type_Info* void_type = ((Kai_Type_Info*)kai_arena_allocate(&(context->type_allocator), sizeof(Kai_Type_Info)));
-    void_type->id = KAI_TYPE_ID_VOID;
-    kai_array_push(&(context->nodes), ((Kai_Node){.type = type_type, .value = ((Kai_Value){.type = void_type}), .flags = KAI_NODE_EVALUATED}));
-    ((context->builtin_types).data)[KAI_BUILTIN_VOID] = void_type;
-    kai__debug_show_type(context, void_type);
-    Kai_u8 bits = 8;
-    Kai_u32 i = 0;
-    while (bits<=64)
-    {
-        Kai_Type_Info_Integer* type = ((Kai_Type_Info_Integer*)kai_arena_allocate(&(context->type_allocator), sizeof(Kai_Type_Info_Integer)));
-        type->id = KAI_TYPE_ID_INTEGER;
-        type->is_signed = KAI_TRUE;
-        type->bits = bits;
-        kai_array_push(&(context->nodes), ((Kai_Node){.type = type_type, .value = ((Kai_Value){.type = (Kai_Type)(type)}), .flags = KAI_NODE_EVALUATED}));
-        ((context->builtin_types).data)[KAI_BUILTIN_U8+i] = (Kai_Type)(type);
-        bits *= 2;
-        i += 1;
+    Kai_Expr_Procedure* p = ((Kai_Expr_Procedure*)node->value_expr);
+    if (c->arg_count!=p->in_count)
+        return kai__error_fatal(context, KAI_STRING("wrong number of arguments to polymorphic procedure"));
+    Kai_Arena_Checkpoint checkpoint = kai_arena_save(&(context->type_allocator));
+    Kai_Type_Info_Procedure* bindings = ((Kai_Type_Info_Procedure*)kai_arena_allocate(&(context->type_allocator), sizeof(Kai_Type_Info_Procedure)));
+    bindings->id = KAI_TYPE_ID_PROCEDURE;
+    (bindings->inputs).count = 0;
+    (bindings->inputs).data = (Kai_Type*)(kai_arena_allocate(&(context->type_allocator), p->in_count*sizeof(Kai_Type)));
+    (bindings->outputs).count = 0;
+    Kai__Instance instance = ((Kai__Instance){.proc = p, .source = (node->location).source, .names = (Kai_string*)(kai_arena_allocate(&(context->type_allocator), p->in_count*sizeof(Kai_string))), .atoms = (Kai_u32*)(kai_arena_allocate(&(context->type_allocator), (Kai_u32)(kai__ceil_div(p->in_count, 2))*8)), .bindings = bindings});
+    Kai_Expr* input = p->in_out_expr;
+    Kai_Expr* arg = c->arg_head;
+    for (Kai_u32 i = 0; i < p->in_count; ++i)
+    {
+        Kai_Type type = {0};
+        if (kai__type_of_expression(context, arg, &type)||kai__bind_polymorphic_type(context, input, arg, type, &instance))
+        {
+            kai_arena_restore(&(context->type_allocator), checkpoint);
+            return KAI_TRUE;
+        }
+        input = input->next;
+        arg = arg->next;
     }
-    Kai_Type u8_type = {0};
-    Kai_Type uint_type = {0};
-    bits = 8;
-    i = 0;
-    while (bits<=64)
+    if (node->polymorph==0)
     {
-        Kai_Type_Info_Integer* type = ((Kai_Type_Info_Integer*)kai_arena_allocate(&(context->type_allocator), sizeof(Kai_Type_Info_Integer)));
-        type->id = KAI_TYPE_ID_INTEGER;
-        type->is_signed = KAI_FALSE;
-        type->bits = bits;
-        if (bits==8*sizeof(Kai_uint))
+        if (context->is_worker)
         {
-            uint_type = (Kai_Type)(type);
+            kai_arena_restore(&(context->type_allocator), checkpoint);
+            return KAI_TRUE;
         }
-        if (bits==8)
+        kai_array_push(&(context->polymorphs), ((Kai__Polymorph){.proc = p}));
+        node->polymorph = (context->polymorphs).count;
+    }
+    Kai_u32 polymorph_index = node->polymorph-1;
+    Kai__Polymorph* polymorph = &(((context->polymorphs).data)[polymorph_index]);
+    bindings->hash = kai__compute_type_hash((Kai_Type)(bindings));
+    Kai_int index = kai_table_find(Type, &(polymorph->instances), (Kai_Type)(bindings));
+    if (index!=-1)
+    {
+        kai_arena_restore(&(context->type_allocator), checkpoint);
+        Kai__Instance* existing = &(((context->instances).data)[((polymorph->instances).values)[index]]);
+        *out_type = existing->type;
+        return KAI_FALSE;
+    }
+    if (context->is_worker)
+    {
+        kai_arena_restore(&(context->type_allocator), checkpoint);
+        return KAI_TRUE;
+    }
+    Kai__Instance* previous = context->current_instance;
+    kai__push_instance_scope(context, &instance);
+    Kai_Type type = {0};
+    Kai_bool failed = kai__type_of_expression(context, (Kai_Expr*)(p), &type);
+    kai__pop_instance_scope(context, &instance, previous);
+    if (failed)
+        return KAI_TRUE;
+    instance.type = (Kai_Type_Info_Procedure*)(type);
+    polymorph = &(((context->polymorphs).data)[polymorph_index]);
+    kai_table_set(type, &(polymorph->instances), (Kai_Type)(bindings), (context->instances).count);
+    kai_array_push(&(context->instances), instance);
+    *out_type = instance.type;
+    return KAI_FALSE;
+}
+
+KAI_INTERNAL Kai_bool kai__compile_instances(Kai_Compiler_Context* context)
+{
+    Kai_u32 i = context->instances_compiled;
+    while (i<(context->instances).count)
+    {
+        Kai__Instance instance = ((context->instances).data)[i];
+        context->current_source = instance.source;
+        kai__push_instance_scope(context, &instance);
+        Kai_Attempt_Checkpoint checkpoint = kai__save_attempt(context);
+        (context->current_dependencies).count = 0;
+        Kai_Type type = (Kai_Type)(instance.type);
+        Kai_Value value = {0};
+        if (kai__value_of_expr(context, (Kai_Expr*)(instance.proc), &value, &type))
         {
-            u8_type = (Kai_Type)(type);
+            if ((context->error)->result!=KAI_SUCCESS)
+                return KAI_TRUE;
+            kai__restore_attempt(context, checkpoint, NULL);
+            context->stack_index = 0;
+            kai__pop_instance_scope(context, &instance, NULL);
+            if (kai__compile_dependencies(context))
+            {
+                if ((context->error)->result==KAI_SUCCESS)
+                    return kai__error_fatal(context, KAI_STRING("polymorphic procedure has unresolved dependencies"));
+                return KAI_TRUE;
+            }
+            continue;
         }
-        kai_array_push(&(context->nodes), ((Kai_Node){.type = type_type, .value = ((Kai_Value){.type = (Kai_Type)(type)}), .flags = KAI_NODE_EVALUATED}));
-        ((context->builtin_types).data)[KAI_BUILTIN_S8+i] = (Kai_Type)(type);
-        bits *= 2;
+        kai__pop_instance_scope(context, &instance, NULL);
+        Kai__Instance* compiled = &(((context->instances).data)[i]);
+        compiled->value = value;
         i += 1;
     }
-    bits = 32;
-    i = 0;
-    while (bits<=64)
+    context->instances_compiled = i;
+    return KAI_FALSE;
+}
+
+KAI_INTERNAL Kai_Type kai__intern_type(Kai_Compiler_Context* context, Kai_Type_Info* type, Kai_Arena_Checkpoint checkpoint)
+{
+    Kai_Allocator* allocator = &((context->type_allocator).base);
+    type->hash = kai__compute_type_hash(type);
+    if (kai_type_equals(type, (Kai_Type_Info*)(&(kai__builtin_u8_pointer[0]))))
+    {
+        kai_arena_restore(&(context->type_allocator), checkpoint);
+        return (Kai_Type)(&(kai__builtin_u8_pointer[0]));
+    }
+    if ((context->shared_type_cache).count!=0)
     {
-        Kai_Type_Info_Float* type = ((Kai_Type_Info_Float*)kai_arena_allocate(&(context->type_allocator), sizeof(Kai_Type_Info_Float)));
-        type->id = KAI_TYPE_ID_FLOAT;
-        type->bits = bits;
-        kai_array_push(&(context->nodes), ((Kai_Node){.type = type_type, .value = ((Kai_Value){.type = (Kai_Type)(type)}), .flags = KAI_NODE_EVALUATED}));
-        ((context->builtin_types).data)[KAI_BUILTIN_F32+i] = (Kai_Type)(type);
-        bits *= 2;
-        i += 1;
+        Kai_int index = kai_table_find(Type, &(context->shared_type_cache), type);
+        if (index!=-1)
+        {
+            kai_arena_restore(&(context->type_allocator), checkpoint);
+            return ((context->shared_type_cache).keys)[index];
+        }
     }
-    Kai_Type_Info* bool_type = ((Kai_Type_Info*)kai_arena_allocate(&(context->type_allocator), sizeof(Kai_Type_Info)));
-    bool_type->id = KAI_TYPE_ID_BOOLEAN;
-    kai_array_push(&(context->nodes), ((Kai_Node){.type = type_type, .value = ((Kai_Value){.type = (Kai_Type)(bool_type)}), .flags = KAI_NODE_EVALUATED}));
-    context->bool_type = bool_type;
-    ((context->builtin_types).data)[KAI_BUILTIN_BOOL] = bool_type;
-    Kai_Type_Info* number_type = ((Kai_Type_Info*)kai_arena_allocate(&(context->type_allocator), sizeof(Kai_Type_Info)));
-    number_type->id = KAI_TYPE_ID_NUMBER;
-    kai_array_push(&(context->nodes), ((Kai_Node){.type = type_type, .value = ((Kai_Value){.type = number_type}), .flags = KAI_NODE_EVALUATED}));
-    context->number_type = number_type;
-    ((context->builtin_types).data)[KAI_BUILTIN_NUMBER] = number_type;
-    Kai_Type_Info_Pointer* pu8_type = ((Kai_Type_Info_Pointer*)kai_arena_allocate(&(context->type_allocator), sizeof(Kai_Type_Info_Pointer)));
-    pu8_type->id = KAI_TYPE_ID_POINTER;
-    pu8_type->sub_type = u8_type;
-    Kai_Type_Info_Struct* string_type = ((Kai_Type_Info_Struct*)kai_arena_allocate(&(context->type_allocator), sizeof(Kai_Type_Info_Struct)));
-    string_type->id = KAI_TYPE_ID_STRING;
-    string_type->size = sizeof(Kai_uint)+sizeof(Kai_u8*);
-    (string_type->fields).count = 2;
-    (string_type->fields).data = (Kai_Struct_Field*)(kai_arena_allocate(&(context->type_allocator), (string_type->fields).count*sizeof(Kai_Struct_Field)));
-    ((string_type->fields).data)[0] = ((Kai_Struct_Field){.name = KAI_STRING("count"), .offset = 0, .type = uint_type});
-    ((string_type->fields).data)[1] = ((Kai_Struct_Field){.name = KAI_STRING("data"), .offset = sizeof(Kai_uint), .type = (Kai_Type)(pu8_type)});
-    kai_array_push(&(context->nodes), ((Kai_Node){.type = type_type, .value = ((Kai_Value){.type = (Kai_Type)(string_type)}), .flags = KAI_NODE_EVALUATED}));
-    context->string_type = (Kai_Type)(string_type);
-    ((context->builtin_types).data)[KAI_BUILTIN_STRING] = (Kai_Type)(string_type);
+    Kai_int index = kai_table_find(Type, &(context->type_cache), type);
+    if (index!=-1)
+    {
+        kai_arena_restore(&(context->type_allocator), checkpoint);
+        return ((context->type_cache).keys)[index];
+    }
+    kai_table_set(type, &(context->type_cache), type, 0);
+    return type;
+}
+
+KAI_INTERNAL Kai_bool kai__compile_procedure_job(Kai_Compiler_Context* context, Kai__Procedure_Job* job)
+{
+    context->current_source = job->source;
+    (context->current_dependencies).count = 0;
+    Kai_Attempt_Checkpoint checkpoint = kai__save_attempt(context);
+    Kai_u32_DynArray code = (context->assembler).code;
+    (context->assembler).code = job->code;
+    Kai__Instance instance = job->instance;
+    if (instance.proc!=NULL)
+        kai__push_instance_scope(context, &instance);
+    Kai_bool failed = kai__compile_procedure_body(context, job->proc, job->type);
+    if (instance.proc!=NULL)
+        kai__pop_instance_scope(context, &instance, NULL);
+    job->code = (context->assembler).code;
+    (context->assembler).code = code;
+    if (failed)
+    {
+        (job->code).count = 0;
+        kai__restore_attempt(context, checkpoint, NULL);
+        context->stack_index = 0;
+        return KAI_TRUE;
+    }
+    job->compiled = KAI_TRUE;
     return KAI_FALSE;
 }
 
-KAI_INTERNAL Kai_bool kai__value_to_number(Kai_Value value, Kai_Type_Info* type, Kai_Number* out_number)
+KAI_INTERNAL void kai__create_worker(Kai_Compiler_Context* main, Kai__Worker* worker)
 {
-    switch (type->id)
+    worker->error = ((Kai_Error){0});
+    worker->context = ((Kai_Compiler_Context){.error = &(worker->error), .allocator = main->allocator, .program = main->program, .options = main->options, .imports = main->imports, .builtin_types = main->builtin_types, .nodes = main->nodes, .trees = main->trees, .atoms = main->atoms, .polymorphs = main->polymorphs, .instances = main->instances, .shared_type_cache = main->type_cache, .shared_symbols = main->symbols, .is_worker = KAI_TRUE, .number_type = main->number_type, .string_type = main->string_type, .type_type = main->type_type, .bool_type = main->bool_type});
+    Kai_Compiler_Context* context = &(worker->context);
+    kai_arena_create(&(context->type_allocator), &(context->allocator));
+    kai_arena_create(&(context->temp_allocator), &(context->allocator));
+    (context->error_arena).allocator = context->allocator;
+    (context->assembler).backend = (main->assembler).backend;
+    (context->assembler).allocator = &(context->allocator);
+    kai__push_scope(context, KAI_FALSE);
+}
+
+KAI_INTERNAL void kai__destroy_worker(Kai__Worker* worker)
+{
+    Kai_Compiler_Context* context = &(worker->context);
+    Kai_Allocator* allocator = &(context->allocator);
+    for (Kai_u32 i = 0; i < (context->scopes).count; ++i)
     {
-        break; case KAI_TYPE_ID_INTEGER:
+        Kai_Scope* scope = &(((context->scopes).data)[i]);
+        kai_array_destroy(&(scope->ready_nodes));
+        kai_array_destroy(&(scope->pending_nodes));
+        kai_array_destroy(&(scope->waiters));
+    }
+    kai_array_destroy(&(context->scopes));
+    kai_array_destroy(&(context->local_nodes));
+    kai_array_destroy(&(context->symbol_trail));
+    kai_array_destroy(&(context->current_dependencies));
+    kai_array_destroy(&((context->assembler).code));
+    kai_array_destroy(&((context->error_arena).buffer));
+    if ((context->symbols).capacity!=0)
+        kai__free((context->symbols).occupied, kai_raw_table_size((context->symbols).capacity, sizeof(Kai_u32), sizeof(Kai__Binding)).total);
+    if ((context->type_cache).capacity!=0)
+        kai__free((context->type_cache).occupied, kai_raw_table_size((context->type_cache).capacity, sizeof(Kai_Type), sizeof(Kai_u32)).total);
+    kai_arena_destroy(&(context->type_allocator));
+    kai_arena_destroy(&(context->temp_allocator));
+}
+
+KAI_INTERNAL void kai__run_procedure_jobs(void* data, Kai_u32 index)
+{
+    Kai__Job_Batch* batch = ((Kai__Job_Batch*)data);
+    Kai__Worker* worker = batch->workers+index;
+    Kai_Compiler_Context* context = &(worker->context);
+    Kai_u32 i = batch->first+index;
+    while (i<batch->end)
+    {
+        Kai__Procedure_Job* job = &((((batch->main)->procedure_jobs).data)[i]);
+        if (((!(job->compiled)&&(job->instance).proc==NULL)&&kai__compile_procedure_job(context, job))&&(context->error)->result!=KAI_SUCCESS)
         {
-            Kai_Type_Info_Integer* info = ((Kai_Type_Info_Integer*)type);
-            Kai_Number num = ((Kai_Number){.d = 1});
-            if (info->is_signed)
-            {
-                num.is_neg = value.s64<0;
-                if (num.is_neg)
-                {
-                    num.n = (Kai_u64)(-(value.s64));
-                }
-                else
-                {
-                    num.n = (Kai_u64)(value.s64);
-                }
-            }
-            else
+            job->error = *(context->error);
+            if (((job->error).memory).size==0)
             {
-                num.n = value.u64;
+                (job->error).memory = ((Kai_Memory){.size = ((context->error_arena).buffer).capacity, .data = ((context->error_arena).buffer).data});
+                ((context->error_arena).buffer).data = NULL;
+                ((context->error_arena).buffer).count = 0;
+                ((context->error_arena).buffer).capacity = 0;
             }
-            *out_number = kai_number_normalize(num);
-            return KAI_FALSE;
-        }
-        break; default:
-        {
-            return KAI_TRUE;
+            return;
         }
+        i += batch->worker_count;
     }
 }
 
-KAI_INTERNAL Kai_Value kai__evaluate_binary_operation(Kai_u32 op, Kai_Type_Info* type, Kai_Value a, Kai_Value b)
+KAI_INTERNAL Kai_bool kai__compile_procedure_jobs(Kai_Compiler_Context* context)
 {
-    switch (type->id)
+    Kai_Allocator* allocator = &(context->allocator);
+    Kai_u32 first = 0;
+    while (first<(context->procedure_jobs).count)
     {
-        break; case KAI_TYPE_ID_INTEGER:
+        Kai_u32 end = (context->procedure_jobs).count;
+        while (first<end)
         {
-            Kai_Type_Info_Integer* info = ((Kai_Type_Info_Integer*)type);
-            if (info->is_signed)
+            Kai__Job_Batch batch = ((Kai__Job_Batch){.main = context, .worker_count = kai__min_u32(kai__max_u32((context->options).worker_count, 1), end-first), .first = first, .end = end});
+            batch.workers = (Kai__Worker*)(kai__allocate(NULL, batch.worker_count*sizeof(Kai__Worker), 0));
+            for (Kai_u32 i = 0; i < batch.worker_count; ++i)
             {
-                switch (info->bits)
-                {
-                    break; case 32:
-                    {
-                        switch (op)
-                        {
-                            break; case 43:
-                            return ((Kai_Value){.s32 = a.s32+b.s32});
-                            break; case 45:
-                            return ((Kai_Value){.s32 = a.s32-b.s32});
-                            break; case 42:
-                            return ((Kai_Value){.s32 = a.s32*b.s32});
-                        }
-                    }
-                }
+                kai__create_worker(context, batch.workers+i);
             }
-            else
+            (context->jobs)->dispatch((context->jobs)->user, kai__run_procedure_jobs, &batch, batch.worker_count);
+            for (Kai_u32 i = 0; i < batch.worker_count; ++i)
             {
-                switch (info->bits)
-                {
-                    break; case 64:
-                    {
-                        switch (op)
-                        {
-                            break; case 43:
-                            return ((Kai_Value){.u64 = a.u64+b.u64});
-                            break; case 45:
-                            return ((Kai_Value){.u64 = a.u64-b.u64});
-                        }
-                    }
-                    break; case 32:
-                    {
-                        switch (op)
-                        {
-                            break; case 43:
-                            return ((Kai_Value){.u32 = a.u32+b.u32});
-                            break; case 45:
-                            return ((Kai_Value){.u32 = a.u32-b.u32});
-                        }
-                    }
-                }
+                Kai__Worker* worker = batch.workers+i;
+                context->jump_table_count += (worker->context).jump_table_count;
+                context->compare_tree_count += (worker->context).compare_tree_count;
+                kai__destroy_worker(worker);
             }
-            kai__todo("integer op = %i, is_signed = %i, bits = %i", op, info->is_signed, info->bits);
-        }
-        break; case KAI_TYPE_ID_FLOAT:
-        {
-            Kai_Type_Info_Float* info = ((Kai_Type_Info_Float*)type);
-            switch (info->bits)
+            kai__free(batch.workers, batch.worker_count*sizeof(Kai__Worker));
+            while (first<end)
             {
-                break; case 32:
+                Kai__Procedure_Job* job = &(((context->procedure_jobs).data)[first]);
+                first += 1;
+                if (job->compiled)
+                    continue;
+                if ((job->error).result!=KAI_SUCCESS)
                 {
-                    switch (op)
+                    *(context->error) = job->error;
+                    for (Kai_u32 i = first; i < end; ++i)
                     {
-                        break; case 43:
-                        return ((Kai_Value){.f32 = a.f32+b.f32});
-                        break; case 45:
-                        return ((Kai_Value){.f32 = a.f32-b.f32});
+                        Kai__Procedure_Job* later = &(((context->procedure_jobs).data)[i]);
+                        if ((later->error).result!=KAI_SUCCESS)
+                            kai_destroy_error(&(later->error), allocator);
                     }
+                    return KAI_TRUE;
                 }
-            }
-            kai__todo("float op = %i, bits = %i", op, info->bits);
-        }
-        break; case KAI_TYPE_ID_NUMBER:
-        {
-            switch (op)
-            {
-                break; case 15677:
-                return ((Kai_Value){.u8 = kai_number_equals(a.number, b.number)});
-                break; case 43:
-                return ((Kai_Value){.number = kai_number_add(a.number, b.number)});
-                break; case 45:
-                return ((Kai_Value){.number = kai_number_sub(a.number, b.number)});
-                break; case 42:
-                return ((Kai_Value){.number = kai_number_mul(a.number, b.number)});
-                break; case 47:
-                return ((Kai_Value){.number = kai_number_div(a.number, b.number)});
-                break; case 15420:
-                {
-                    Kai_s64 e = (Kai_s64)(kai_number_to_u64(b.number));
-                    return ((Kai_Value){.number = kai_number_normalize(((Kai_Number){(a.number).n, (a.number).d, (a.number).e+e, (a.number).is_neg}))});
-                }
-                break; case 15934:
+                Kai_u32 instance_count = (context->instances).count;
+                if (kai__compile_procedure_job(context, job))
                 {
-                    Kai_s64 e = (Kai_s64)(kai_number_to_u64(b.number));
-                    return ((Kai_Value){.number = kai_number_normalize(((Kai_Number){(a.number).n, (a.number).d, (a.number).e-e, (a.number).is_neg}))});
+                    if ((context->error)->result!=KAI_SUCCESS)
+                        return KAI_TRUE;
+                    if (kai__compile_dependencies(context))
+                    {
+                        if ((context->error)->result==KAI_SUCCESS)
+                            return kai__error_fatal(context, KAI_STRING("procedure has unresolved dependencies"));
+                        return KAI_TRUE;
+                    }
+                    first -= 1;
+                    continue;
                 }
+                if ((context->instances).count!=instance_count)
+                    break;
             }
-            kai__todo("number op = %i", op);
-        }
-        break; default:
-        {
-            kai__todo("type.id = %i", type->id);
         }
+        if (kai__compile_instances(context))
+            return KAI_TRUE;
     }
-    return ((Kai_Value){0});
+    return KAI_FALSE;
 }
 
-KAI_INTERNAL void kai__add_dependency(Kai_Compiler_Context* context, Kai_Node_Reference ref)
+KAI_INTERNAL void kai__link_procedures(Kai_Compiler_Context* context)
 {
-    for (Kai_u32 i = 0; i < (context->current_dependencies).count; ++i)
+    Kai_Allocator* allocator = &(context->allocator);
+    for (Kai_u32 i = 0; i < (context->procedure_jobs).count; ++i)
+    {
+        Kai__Procedure_Job* job = &(((context->procedure_jobs).data)[i]);
+        job->label = kai_asm_create_label(&(context->assembler));
+        kai_array_grow(&((context->assembler).code), (job->code).count);
+        kai__memory_copy(((context->assembler).code).data+((context->assembler).code).count, (job->code).data, (job->code).count*sizeof(Kai_u32));
+        ((context->assembler).code).count += (job->code).count;
+        kai_array_destroy(&(job->code));
+    }
+    for (Kai_u32 i = 0; i < (context->label_fixups).count; ++i)
+    {
+        Kai__Label_Fixup fixup = ((context->label_fixups).data)[i];
+        Kai__Procedure_Job* job = &(((context->procedure_jobs).data)[fixup.job]);
+        Kai_u32* slot = (Kai_u32*)(((context->program)->data).data+fixup.location);
+        *slot = job->label;
+    }
+}
+
+KAI_INTERNAL Kai_bool kai__compile_procedure_body(Kai_Compiler_Context* context, Kai_Expr_Procedure* p, Kai_Type_Info_Procedure* pt)
+{
+    Kai_Allocator* allocator = &(context->allocator);
+    kai__push_scope(context, KAI_TRUE);
+    Kai_u32 prev_node_count = (context->nodes).count;
+    Kai_u32 local_node_count = (context->local_nodes).count;
+    Kai_u32 stack_index = context->stack_index;
+    context->stack_index = 0;
+    if (kai__create_nodes(context, p->body))
+        return KAI_TRUE;
+    if (prev_node_count!=(context->nodes).count)
+        return kai__error_fatal(context, KAI_STRING("nested const is not yet ready, please make non-const, sorry :("));
+    if (kai__compile_all_nodes_in_scope(context))
+        return KAI_TRUE;
+    Kai_Expr* current = p->in_out_expr;
+    for (Kai_u32 i = 0; i < p->in_count; ++i)
     {
-        Kai_Node_Reference it = ((context->current_dependencies).data)[i];
-        if (it.index==ref.index&&it.flags==ref.flags)
-            return;
+        Kai_Type type = ((pt->inputs).data)[i];
+        Kai_Node_Reference ref = ((Kai_Node_Reference){.flags = KAI_NODE_LOCAL, .index = (context->local_nodes).count});
+        kai_array_push(&(context->local_nodes), ((Kai_Local_Node){.type = type, .location = ((Kai_Location){.string = current->name})}));
+        kai__bind(context, current->name_atom, ref);
+        current = current->next;
     }
-    Kai_Allocator* allocator = &(context->allocator);
-    kai_array_push(&(context->current_dependencies), ref);
+    if ((p->body)->id==KAI_STMT_COMPOUND)
+    {
+        Kai_Stmt_Compound* c = ((Kai_Stmt_Compound*)p->body);
+        Kai_Stmt* current = c->head;
+        while (current)
+        {
+            if (current->id==KAI_STMT_DECLARATION&&current->flags&KAI_FLAG_DECL_CONST)
+                continue;
+            Kai_Type_Info* t = 0;
+            if ((pt->outputs).count!=0)
+            {
+                t = ((pt->outputs).data)[0];
+            }
+            if (current->id==KAI_STMT_DECLARATION)
+            {
+                t = NULL;
+            }
+            if (kai__value_of_expr(context, current, NULL, &t))
+                return KAI_TRUE;
+            current = current->next;
+        }
+    }
+    else
+        kai__todo("non compound procedures");
+    kai__pop_scope(context);
+    (context->nodes).count = prev_node_count;
+    (context->local_nodes).count = local_node_count;
+    context->stack_index = stack_index;
+    return KAI_FALSE;
 }
 
 KAI_INTERNAL Kai_bool kai__value_of_expr(Kai_Compiler_Context* context, Kai_Expr* expr, Kai_Value* out_value, Kai_Type* expected_type)
@@ -6155,10 +10700,10 @@ KAI_INTERNAL Kai_bool kai__value_of_expr(Kai_Compiler_Context* context, Kai_Expr
     {
         break; case KAI_EXPR_IDENTIFIER:
         {
-            Kai_Node_Reference ref = kai__lookup_node(context, expr->source_code);
+            Kai_Node_Reference ref = kai__lookup_node(context, expr->atom);
             if (ref.flags&KAI_NODE_NOT_FOUND)
             {
-                Kai_Location location = ((Kai_Location){.source = context->current_source, .string = expr->source_code, .line = expr->line_number});
+                Kai_Location location = ((Kai_Location){.source = context->current_source, .string = expr->source_code, .line = kai_source_line(&(context->current_source), expr->offset)});
                 return kai__error_not_declared(context, location);
             }
             if (out_value==NULL)
@@ -6214,9 +10759,7 @@ KAI_INTERNAL Kai_bool kai__value_of_expr(Kai_Compiler_Context* context, Kai_Expr
             {
                 if (writer!=NULL)
                 {
-                    kai__write(" - node: ");
-                    kai__write_string(expr->source_code);
-                    kai__write("\n");
+                    (writer->write(writer->user, KAI_WRITE_STRING, (Kai_Value){.string = KAI_STRING(" - node: ")}, (Kai_Write_Format){0}), writer->write(writer->user, KAI_WRITE_STRING, (Kai_Value){.string = expr->source_code}, (Kai_Write_Format){0}), writer->write(writer->user, KAI_WRITE_STRING, (Kai_Value){.string = KAI_STRING("\n")}, (Kai_Write_Format){0}));
                 }
                 return kai__error_fatal(context, KAI_STRING("node type cannot be null"));
             }
@@ -6239,7 +10782,7 @@ KAI_INTERNAL Kai_bool kai__value_of_expr(Kai_Compiler_Context* context, Kai_Expr
             Kai_Expr_Number* n = ((Kai_Expr_Number*)expr);
             if (out_value==NULL)
             {
-                kai_asm_insert_load_constant(&(context->assembler), kai_number_to_u64(n->value));
+                kai_asm_insert_load_constant(&(context->assembler), 0, kai_number_to_u64(n->value));
                 if (*expected_type==NULL)
                 {
                     *expected_type = context->number_type;
@@ -6418,13 +10961,14 @@ KAI_INTERNAL Kai_bool kai__value_of_expr(Kai_Compiler_Context* context, Kai_Expr
                     return KAI_TRUE;
                 if (rt->id==KAI_TYPE_ID_NUMBER)
                 {
+                    Kai_Arena_Checkpoint checkpoint = kai_arena_save(&(context->type_allocator));
                     Kai_Type_Info_Array* ai = ((Kai_Type_Info_Array*)kai_arena_allocate(&(context->type_allocator), sizeof(Kai_Type_Info_Array)));
                     ai->id = KAI_TYPE_ID_ARRAY;
                     kai_assert(kai_number_is_integer(rv.number));
                     ai->rows = (Kai_u32)(kai_number_to_u64(rv.number));
                     ai->cols = 1;
                     ai->sub_type = ev.type;
-                    type = (Kai_Type)(ai);
+                    type = kai__intern_type(context, (Kai_Type)(ai), checkpoint);
                 }
                 else
                 {
@@ -6494,24 +11038,13 @@ KAI_INTERNAL Kai_bool kai__value_of_expr(Kai_Compiler_Context* context, Kai_Expr
                     Kai_Type_Info* expr_type = 0;
                     if (kai__value_of_expr(context, u->expr, out_value, &expr_type))
                         return KAI_TRUE;
-                    Kai_Allocator* allocator = &(context->allocator);
                     if (expr_type->id==KAI_TYPE_ID_TYPE)
                     {
                         Kai_Arena_Checkpoint checkpoint = kai_arena_save(&(context->type_allocator));
                         Kai_Type_Info_Pointer* pt = ((Kai_Type_Info_Pointer*)kai_arena_allocate(&(context->type_allocator), sizeof(Kai_Type_Info_Pointer)));
                         pt->id = KAI_TYPE_ID_POINTER;
                         pt->sub_type = out_value->type;
-                        Kai_Type type = (Kai_Type)(pt);
-                        Kai_int index = kai_table_find(Type, &(context->type_cache), type);
-                        if (index!=-1)
-                        {
-                            type = ((context->type_cache).keys)[index];
-                            kai_arena_restore(&(context->type_allocator), checkpoint);
-                        }
-                        else
-                        {
-                            kai_table_set(type, &(context->type_cache), (Kai_Type)(pt), 0);
-                        }
+                        Kai_Type type = kai__intern_type(context, (Kai_Type)(pt), checkpoint);
                         if (out_value!=NULL)
                             out_value->type = type;
                         kai__debug_show_type(context, type);
@@ -6527,21 +11060,7 @@ KAI_INTERNAL Kai_bool kai__value_of_expr(Kai_Compiler_Context* context, Kai_Expr
                         pt->sub_type = expr_type;
                         if (out_value!=NULL)
                             kai__todo("evaluate pointer to value");
-                        Kai_Type type = (Kai_Type)(pt);
-                        Kai_int index = kai_table_find(Type, &(context->type_cache), type);
-                        if (writer!=NULL)
-                        {
-                            printf("index: %li ???\n", index);
-                        }
-                        if (index!=-1)
-                        {
-                            type = ((context->type_cache).keys)[index];
-                            kai_arena_restore(&(context->type_allocator), checkpoint);
-                        }
-                        else
-                        {
-                            kai_table_set(type, &(context->type_cache), type, 0);
-                        }
+                        Kai_Type type = kai__intern_type(context, (Kai_Type)(pt), checkpoint);
                         kai__debug_show_type(context, type);
                         *expected_type = type;
                         u->this_type = type;
@@ -6854,27 +11373,30 @@ KAI_INTERNAL Kai_bool kai__value_of_expr(Kai_Compiler_Context* context, Kai_Expr
         {
             Kai_Allocator* allocator = &(context->allocator);
             Kai_Expr_Procedure* p = ((Kai_Expr_Procedure*)expr);
+            if (p->flags&KAI_FLAG_EXPR_POLYMORPHIC&&(context->current_instance==NULL||(context->current_instance)->proc!=p))
+            {
+                if (out_value!=NULL)
+                    out_value->ptr = p;
+                return KAI_FALSE;
+            }
             kai_assert(*expected_type!=NULL);
             Kai_Type_Info_Procedure* pt = ((Kai_Type_Info_Procedure*)*expected_type);
             kai_assert(pt->id==KAI_TYPE_ID_PROCEDURE);
-            kai_array_push(&(context->scopes), ((Kai_Scope){.is_proc_scope = KAI_TRUE}));
-            Kai_Scope* scope = &kai_array_last(&(context->scopes));
-            Kai_u32 prev_node_count = (context->nodes).count;
-            Kai_u32 local_node_count = (context->local_nodes).count;
-            if (kai__create_nodes(context, p->body))
-                return KAI_TRUE;
-            if (prev_node_count!=(context->nodes).count)
-                return kai__error_fatal(context, KAI_STRING("nested const is not yet ready, please make non-const, sorry :("));
-            if (kai__compile_all_nodes_in_scope(context))
-                return KAI_TRUE;
-            Kai_Expr* current = p->in_out_expr;
-            for (Kai_u32 i = 0; i < p->in_count; ++i)
+            if (context->jobs!=NULL)
             {
-                Kai_Type type = ((pt->inputs).data)[i];
-                Kai_Node_Reference ref = ((Kai_Node_Reference){.flags = KAI_NODE_LOCAL, .index = (context->local_nodes).count});
-                kai_array_push(&(context->local_nodes), ((Kai_Local_Node){.type = type, .location = ((Kai_Location){.string = current->name, .line = current->line_number})}));
-                kai_table_set(string, &(scope->identifiers), current->name, ref);
-                current = current->next;
+                Kai__Procedure_Job job = ((Kai__Procedure_Job){.proc = p, .type = pt, .source = context->current_source});
+                if (context->current_instance!=NULL)
+                    job.instance = *(context->current_instance);
+                if (out_value!=NULL)
+                {
+                    if ((context->options).flags&KAI_COMPILE_NO_CODE_GEN)
+                        out_value->ptr = p;
+                    else
+                        out_value->u32 = (context->procedure_jobs).count;
+                }
+                kai_array_push(&(context->procedure_jobs), job);
+                p->this_type = *expected_type;
+                return KAI_FALSE;
             }
             if (out_value!=NULL)
             {
@@ -6883,49 +11405,35 @@ KAI_INTERNAL Kai_bool kai__value_of_expr(Kai_Compiler_Context* context, Kai_Expr
                 else
                     out_value->u32 = kai_asm_create_label(&(context->assembler));
             }
-            if ((p->body)->id==KAI_STMT_COMPOUND)
-            {
-                Kai_Stmt_Compound* c = ((Kai_Stmt_Compound*)p->body);
-                Kai_Stmt* current = c->head;
-                while (current)
-                {
-                    if (current->id==KAI_STMT_DECLARATION&&current->flags&KAI_FLAG_DECL_CONST)
-                        continue;
-                    Kai_Type_Info* t = 0;
-                    if ((pt->outputs).count!=0)
-                    {
-                        t = ((pt->outputs).data)[0];
-                    }
-                    if (current->id==KAI_STMT_DECLARATION)
-                    {
-                        t = NULL;
-                    }
-                    if (kai__value_of_expr(context, current, NULL, &t))
-                        return KAI_TRUE;
-                    current = current->next;
-                }
-            }
-            else
-                kai__todo("non compound procedures");
-            kai_array_pop(&(context->scopes));
-            (context->nodes).count = prev_node_count;
-            (context->local_nodes).count = local_node_count;
+            if (kai__compile_procedure_body(context, p, pt))
+                return KAI_TRUE;
             p->this_type = *expected_type;
             return KAI_FALSE;
         }
         break; case KAI_EXPR_STRUCT:
         {
             Kai_Expr_Struct* s = ((Kai_Expr_Struct*)expr);
-            Kai_Type_Info_Struct* st = ((Kai_Type_Info_Struct*)kai_arena_allocate(&(context->type_allocator), sizeof(Kai_Type_Info_Struct)));
-            st->id = KAI_TYPE_ID_STRUCT;
-            (st->fields).count = s->field_count;
-            (st->fields).data = (Kai_Struct_Field*)(kai_arena_allocate(&(context->type_allocator), sizeof(Kai_Struct_Field)*(st->fields).count));
-            st->size = 0;
             Kai_Node* node = &(((context->nodes).data)[(context->current_node).index]);
+            Kai_Type_Info_Struct* st = ((Kai_Type_Info_Struct*)node->partial);
+            if (st==NULL)
+            {
+                st = (Kai_Type_Info_Struct*)(kai_arena_allocate(&(context->type_allocator), sizeof(Kai_Type_Info_Struct)));
+                st->id = KAI_TYPE_ID_STRUCT;
+                st->hash = kai__compute_type_hash((Kai_Type)(st));
+                (st->fields).count = s->field_count;
+                (st->fields).data = (Kai_Struct_Field*)(kai_arena_allocate(&(context->type_allocator), sizeof(Kai_Struct_Field)*(st->fields).count));
+                st->size = 0;
+                node->resume = 0;
+            }
             node->flags |= KAI_NODE_VALUE_EVALUATED;
             (node->value).type = (Kai_Type)(st);
             Kai_Expr* current = s->head;
-            for (Kai_u32 i = 0; i < s->field_count; ++i)
+            for (Kai_u32 i = 0; i < node->resume; ++i)
+            {
+                current = current->next;
+            }
+            Kai_u32 start = node->resume;
+            for (Kai_u32 i = start; i < s->field_count; ++i)
             {
                 kai_assert(current->id==KAI_STMT_DECLARATION);
                 Kai_Stmt_Declaration* d = ((Kai_Stmt_Declaration*)current);
@@ -6933,18 +11441,24 @@ KAI_INTERNAL Kai_bool kai__value_of_expr(Kai_Compiler_Context* context, Kai_Expr
                 Kai_Value value = {0};
                 if (kai__value_of_expr(context, d->type, &value, &type))
                 {
+                    node = &(((context->nodes).data)[(context->current_node).index]);
                     node->flags &= (~KAI_NODE_VALUE_EVALUATED);
+                    node->partial = (Kai_Type)(st);
+                    node->resume = i;
                     return KAI_TRUE;
                 }
                 if (type->id!=KAI_TYPE_ID_TYPE)
                 {
                     node->flags &= (~KAI_NODE_VALUE_EVALUATED);
-                    return KAI_TRUE;
+                    return kai__error_type_check(context, d->type, context->type_type, type);
                 }
                 ((st->fields).data)[i] = ((Kai_Struct_Field){.name = d->name, .offset = st->size, .type = value.type});
                 st->size += kai__type_size(value.type);
                 current = current->next;
             }
+            node = &(((context->nodes).data)[(context->current_node).index]);
+            node->partial = NULL;
+            node->resume = 0;
             out_value->type = (Kai_Type)(st);
             *expected_type = context->type_type;
             return KAI_FALSE;
@@ -6962,6 +11476,7 @@ KAI_INTERNAL Kai_bool kai__value_of_expr(Kai_Compiler_Context* context, Kai_Expr
                 kai__todo("non integral enum type");
             Kai_Type_Info_Enum* et = ((Kai_Type_Info_Enum*)kai_arena_allocate(&(context->type_allocator), sizeof(Kai_Type_Info_Enum)));
             et->id = KAI_TYPE_ID_ENUM;
+            et->hash = kai__compute_type_hash((Kai_Type)(et));
             et->sub_type = sv.type;
             (et->values).count = e->field_count;
             (et->values).data = (Kai_Enum_Value*)(kai_arena_allocate(&(context->type_allocator), sizeof(Kai_Enum_Value)*(et->values).count));
@@ -6984,6 +11499,7 @@ KAI_INTERNAL Kai_bool kai__value_of_expr(Kai_Compiler_Context* context, Kai_Expr
         break; case KAI_EXPR_PROCEDURE_TYPE:
         {
             Kai_Expr_Procedure_Type* p = ((Kai_Expr_Procedure_Type*)expr);
+            Kai_Arena_Checkpoint checkpoint = kai_arena_save(&(context->type_allocator));
             Kai_Type_Info_Procedure* pt = ((Kai_Type_Info_Procedure*)kai_arena_allocate(&(context->type_allocator), sizeof(Kai_Type_Info_Procedure)));
             pt->id = KAI_TYPE_ID_PROCEDURE;
             (pt->inputs).count = p->in_count;
@@ -7018,15 +11534,27 @@ KAI_INTERNAL Kai_bool kai__value_of_expr(Kai_Compiler_Context* context, Kai_Expr
                 ((pt->outputs).data)[i] = value.type;
                 current = current->next;
             }
-            out_value->type = (Kai_Type)(pt);
+            out_value->type = kai__intern_type(context, (Kai_Type)(pt), checkpoint);
             *expected_type = context->type_type;
             return KAI_FALSE;
         }
         break; case KAI_EXPR_PROCEDURE_CALL:
         {
             Kai_Expr_Procedure_Call* c = ((Kai_Expr_Procedure_Call*)expr);
+            Kai_u8 intrinsic = kai__intrinsic_of_call(context, expr);
+            if (intrinsic!=KAI_INTRINSIC_NONE)
+                return kai__value_of_intrinsic(context, expr, intrinsic, out_value, expected_type);
             kai_assert(out_value==NULL);
             Kai_Type_Info* t = 0;
+            Kai_Node* polymorphic = kai__polymorphic_node_of_call(context, c);
+            if (polymorphic!=NULL)
+            {
+                Kai_Type_Info_Procedure* instance_type = 0;
+                if (kai__instantiate_procedure(context, c, polymorphic, &instance_type))
+                    return KAI_TRUE;
+                t = (Kai_Type)(instance_type);
+            }
+            else
             if (kai__value_of_expr(context, c->proc, NULL, &t))
                 return KAI_TRUE;
             kai_assert(t->id==KAI_TYPE_ID_PROCEDURE);
@@ -7056,8 +11584,7 @@ KAI_INTERNAL Kai_bool kai__value_of_expr(Kai_Compiler_Context* context, Kai_Expr
         }
         break; case KAI_STMT_COMPOUND:
         {
-            Kai_Allocator* allocator = &(context->allocator);
-            kai_array_push(&(context->scopes), ((Kai_Scope){0}));
+            kai__push_scope(context, KAI_FALSE);
             Kai_Stmt_Compound* c = ((Kai_Stmt_Compound*)expr);
             Kai_Stmt* current = c->head;
             while (current!=NULL)
@@ -7067,7 +11594,7 @@ KAI_INTERNAL Kai_bool kai__value_of_expr(Kai_Compiler_Context* context, Kai_Expr
                     return KAI_TRUE;
                 current = current->next;
             }
-            kai_array_pop(&(context->scopes));
+            kai__pop_scope(context);
             return KAI_FALSE;
         }
         break; case KAI_STMT_RETURN:
@@ -7110,9 +11637,8 @@ KAI_INTERNAL Kai_bool kai__value_of_expr(Kai_Compiler_Context* context, Kai_Expr
                 kai_asm_insert_stack_store(&(context->assembler), context->stack_index, 0);
             }
             Kai_Node_Reference ref = ((Kai_Node_Reference){.flags = KAI_NODE_LOCAL, .index = (context->local_nodes).count});
-            kai_array_push(&(context->local_nodes), ((Kai_Local_Node){.type = type, .location = ((Kai_Location){.string = d->name, .line = d->line_number}), .stack_index = context->stack_index}));
-            Kai_Scope* scope = &kai_array_last(&(context->scopes));
-            kai_table_set(string, &(scope->identifiers), d->name, ref);
+            kai_array_push(&(context->local_nodes), ((Kai_Local_Node){.type = type, .location = ((Kai_Location){.string = d->name}), .stack_index = context->stack_index}));
+            kai__bind(context, d->name_atom, ref);
             d->this_type = type;
             return KAI_FALSE;
         }
@@ -7136,6 +11662,8 @@ KAI_INTERNAL Kai_bool kai__value_of_expr(Kai_Compiler_Context* context, Kai_Expr
         break; case KAI_STMT_IF:
         {
             Kai_Stmt_If* i = ((Kai_Stmt_If*)expr);
+            if (i->flags&KAI_FLAG_IF_CASE)
+                return kai__value_of_if_case(context, i, expected_type);
             Kai_Type_Info* type = context->bool_type;
             if (kai__value_of_expr(context, i->condition, NULL, &type))
                 return KAI_TRUE;
@@ -7178,13 +11706,12 @@ KAI_INTERNAL Kai_bool kai__value_of_expr(Kai_Compiler_Context* context, Kai_Expr
                 return KAI_TRUE;
             Kai_Allocator* allocator = &(context->allocator);
             Kai_Node_Reference ref = ((Kai_Node_Reference){.flags = KAI_NODE_LOCAL, .index = (context->local_nodes).count});
-            kai_array_push(&(context->local_nodes), ((Kai_Local_Node){.type = (f->from)->this_type, .location = ((Kai_Location){.string = f->iterator_name, .line = f->line_number})}));
-            kai_array_push(&(context->scopes), ((Kai_Scope){0}));
-            Kai_Scope* scope = &kai_array_last(&(context->scopes));
-            kai_table_set(string, &(scope->identifiers), f->iterator_name, ref);
+            kai_array_push(&(context->local_nodes), ((Kai_Local_Node){.type = (f->from)->this_type, .location = ((Kai_Location){.string = f->iterator_name})}));
+            kai__push_scope(context, KAI_FALSE);
+            kai__bind(context, f->iterator_atom, ref);
             if (kai__value_of_expr(context, f->body, NULL, expected_type))
                 return KAI_TRUE;
-            kai_array_pop(&(context->scopes));
+            kai__pop_scope(context);
             return KAI_FALSE;
         }
         break; default:
@@ -7227,12 +11754,18 @@ KAI_INTERNAL Kai_bool kai__type_of_expression(Kai_Compiler_Context* context, Kai
     {
         break; case KAI_EXPR_IDENTIFIER:
         {
-            Kai_Node_Reference ref = kai__lookup_node(context, expr->source_code);
+            Kai_Node_Reference ref = kai__lookup_node(context, expr->atom);
             if (ref.flags&KAI_NODE_NOT_FOUND)
             {
-                Kai_Location location = ((Kai_Location){.source = context->current_source, .string = expr->source_code, .line = expr->line_number});
+                Kai_Location location = ((Kai_Location){.source = context->current_source, .string = expr->source_code, .line = kai_source_line(&(context->current_source), expr->offset)});
                 return kai__error_not_declared(context, location);
             }
+            if (ref.flags&KAI_NODE_LOCAL)
+            {
+                Kai_Local_Node* local_node = &(((context->local_nodes).data)[ref.index]);
+                *out_type = local_node->type;
+                return KAI_FALSE;
+            }
             Kai_Node* node = &(((context->nodes).data)[ref.index]);
             if (!((node->flags)&KAI_NODE_TYPE_EVALUATED))
             {
@@ -7248,9 +11781,7 @@ KAI_INTERNAL Kai_bool kai__type_of_expression(Kai_Compiler_Context* context, Kai
             }
             if (writer!=NULL)
             {
-                kai__write("node.type ");
-                kai__write_string((node->location).string);
-                kai__write(" ");
+                (writer->write(writer->user, KAI_WRITE_STRING, (Kai_Value){.string = KAI_STRING("node.type ")}, (Kai_Write_Format){0}), writer->write(writer->user, KAI_WRITE_STRING, (Kai_Value){.string = (node->location).string}, (Kai_Write_Format){0}), writer->write(writer->user, KAI_WRITE_STRING, (Kai_Value){.string = KAI_STRING(" ")}, (Kai_Write_Format){0}));
                 kai_write_type(writer, node->type);
                 kai__write("\n");
             }
@@ -7259,10 +11790,7 @@ KAI_INTERNAL Kai_bool kai__type_of_expression(Kai_Compiler_Context* context, Kai
         }
         break; case KAI_EXPR_NUMBER:
         {
-            Kai_Node_Reference ref = kai__lookup_node(context, KAI_STRING("s32"));
-            kai_assert(!((ref.flags)&KAI_NODE_NOT_FOUND));
-            Kai_Node* node = &(((context->nodes).data)[ref.index]);
-            *out_type = (node->value).type;
+            *out_type = ((context->builtin_types).data)[KAI_BUILTIN_S32];
             return KAI_FALSE;
         }
         break; case KAI_EXPR_STRING:
@@ -7305,11 +11833,13 @@ KAI_INTERNAL Kai_bool kai__type_of_expression(Kai_Compiler_Context* context, Kai
                     *out_type = et;
                     return KAI_FALSE;
                 }
+                Kai_Arena_Checkpoint checkpoint = kai_arena_save(&(context->type_allocator));
                 Kai_Type_Info_Pointer* pt = ((Kai_Type_Info_Pointer*)kai_arena_allocate(&(context->type_allocator), sizeof(Kai_Type_Info_Pointer)));
                 pt->id = KAI_TYPE_ID_POINTER;
                 pt->sub_type = et;
-                kai__debug_show_type(context, (Kai_Type)(pt));
-                *out_type = (Kai_Type)(pt);
+                Kai_Type type = kai__intern_type(context, (Kai_Type)(pt), checkpoint);
+                kai__debug_show_type(context, type);
+                *out_type = type;
                 return KAI_FALSE;
             }
             *out_type = et;
@@ -7363,8 +11893,16 @@ KAI_INTERNAL Kai_bool kai__type_of_expression(Kai_Compiler_Context* context, Kai
         break; case KAI_EXPR_PROCEDURE:
         {
             Kai_Expr_Procedure* p = ((Kai_Expr_Procedure*)expr);
+            Kai_Arena_Checkpoint checkpoint = kai_arena_save(&(context->type_allocator));
             Kai_Type_Info_Procedure* pt = ((Kai_Type_Info_Procedure*)kai_arena_allocate(&(context->type_allocator), sizeof(Kai_Type_Info_Procedure)));
             pt->id = KAI_TYPE_ID_PROCEDURE;
+            if (p->flags&KAI_FLAG_EXPR_POLYMORPHIC&&(context->current_instance==NULL||(context->current_instance)->proc!=p))
+            {
+                (pt->inputs).count = 0;
+                (pt->outputs).count = 0;
+                *out_type = kai__intern_type(context, (Kai_Type)(pt), checkpoint);
+                return KAI_FALSE;
+            }
             (pt->inputs).count = p->in_count;
             (pt->inputs).data = (Kai_Type*)(kai_arena_allocate(&(context->type_allocator), sizeof(Kai_Type)*(pt->inputs).count));
             (pt->outputs).count = p->out_count;
@@ -7392,13 +11930,15 @@ KAI_INTERNAL Kai_bool kai__type_of_expression(Kai_Compiler_Context* context, Kai
                 ((pt->outputs).data)[i] = value.type;
                 current = current->next;
             }
-            *out_type = (Kai_Type)(pt);
+            *out_type = kai__intern_type(context, (Kai_Type)(pt), checkpoint);
             return KAI_FALSE;
         }
         break; case KAI_EXPR_STRUCT:
         /* fall through */
         case KAI_EXPR_ENUM:
         /* fall through */
+        case KAI_EXPR_ARRAY:
+        /* fall through */
         case KAI_EXPR_PROCEDURE_TYPE:
         {
             *out_type = context->type_type;
@@ -7406,9 +11946,30 @@ KAI_INTERNAL Kai_bool kai__type_of_expression(Kai_Compiler_Context* context, Kai
         }
         break; case KAI_EXPR_PROCEDURE_CALL:
         {
-            Kai_Node_Reference ref = kai__lookup_node(context, KAI_STRING("u32"));
-            Kai_Node* u32_node = &(((context->nodes).data)[ref.index]);
-            *out_type = (u32_node->value).type;
+            Kai_Expr_Procedure_Call* c = ((Kai_Expr_Procedure_Call*)expr);
+            switch (kai__intrinsic_of_call(context, expr))
+            {
+                break; case KAI_INTRINSIC_NONE:
+                break; case KAI_INTRINSIC_BSWAP:
+                /* fall through */
+                case KAI_INTRINSIC_ROTL:
+                {
+                    return kai__type_of_expression(context, c->arg_head, out_type);
+                }
+                break; case KAI_INTRINSIC_MULTIPLY_HIGH:
+                {
+                    *out_type = ((context->builtin_types).data)[KAI_BUILTIN_U64];
+                    return KAI_FALSE;
+                }
+                break; case KAI_INTRINSIC_MEMORY_COPY:
+                /* fall through */
+                case KAI_INTRINSIC_MEMORY_SET:
+                {
+                    *out_type = ((context->builtin_types).data)[KAI_BUILTIN_VOID];
+                    return KAI_FALSE;
+                }
+            }
+            *out_type = ((context->builtin_types).data)[KAI_BUILTIN_U32];
             return KAI_FALSE;
         }
         break; default:
@@ -7419,6 +11980,13 @@ KAI_INTERNAL Kai_bool kai__type_of_expression(Kai_Compiler_Context* context, Kai
     return KAI_FALSE;
 }
 
+KAI_INTERNAL Kai_bool kai__is_host_export(Kai_Compiler_Context* context, Kai_u32 atom)
+{
+    if ((context->export_atoms).count==0)
+        return KAI_FALSE;
+    return kai_table_find(u32, &(context->export_atoms), atom)!=-1;
+}
+
 KAI_INTERNAL Kai_Import* kai__find_host_import(Kai_Compiler_Context* context, Kai_string name)
 {
     for (Kai_u32 i = 0; i < (context->imports).count; ++i)
@@ -7433,10 +12001,13 @@ KAI_INTERNAL Kai_Import* kai__find_host_import(Kai_Compiler_Context* context, Ka
 KAI_INTERNAL Kai_Expr* kai__type_expression_from_string(Kai_Compiler_Context* context, Kai_string s)
 {
     Kai_Parser parser = {0};
+    (parser.source).contents = s;
     (parser.tokenizer).source = s;
-    (parser.tokenizer).line_number = 1;
+    (parser.tokenizer).atoms = &(context->atoms);
     parser.error = context->error;
     parser.arena = context->temp_allocator;
+    parser.reused = KAI_TRUE;
+    (parser.tokenizer).string_arena = &(parser.arena);
     kai_tokenizer_next(&(parser.tokenizer));
     Kai_Expr* type = kai_parse_type_expression(&parser);
     if (type==NULL)
@@ -7609,103 +12180,352 @@ KAI_INTERNAL Kai_bool kai__node_reference_equals(Kai_Node_Reference a, Kai_Node_
     return (a.flags&(~KAI_NODE_VISITED))==(b.flags&(~KAI_NODE_VISITED))&&a.index==b.index;
 }
 
-KAI_INTERNAL Kai_bool kai__explore_nodes(Kai_Compiler_Context* context, Kai_Pending_Node* pending)
+KAI_INTERNAL void kai__wait_for_dependencies(Kai_Compiler_Context* context, Kai_Node_Reference ref)
 {
     Kai_Allocator* allocator = &(context->allocator);
+    Kai_Writer* writer = context->debug_writer;
     Kai_Scope* scope = &kai_array_last(&(context->scopes));
-    (pending->ref).flags |= KAI_NODE_VISITED;
-    for (Kai_u32 i = 0; i < (pending->dependencies).count; ++i)
-    {
-        Kai_Node_Reference dep = ((pending->dependencies).data)[i];
-        if (kai__node_reference_equals(dep, context->current_node))
-        {
-            kai_array_push(&(context->current_dependencies), context->current_node);
-            return kai__error_circular_dependency(context);
+    Kai_Pending_Node pending = ((Kai_Pending_Node){.ref = ref, .dependencies = context->current_dependencies});
+    (context->current_dependencies).data = NULL;
+    (context->current_dependencies).count = 0;
+    (context->current_dependencies).capacity = 0;
+    Kai_u32 pending_index = (scope->pending_nodes).count;
+    for (Kai_u32 i = 0; i < (pending.dependencies).count; ++i)
+    {
+        Kai_Node_Reference dep = ((pending.dependencies).data)[i];
+        Kai_Node* node = &(((context->nodes).data)[dep.index]);
+        Kai_u32* head = &(node->value_waiters);
+        if (dep.flags&KAI_NODE_TYPE)
+        {
+            if (node->flags&KAI_NODE_TYPE_EVALUATED)
+                continue;
+            head = &(node->type_waiters);
         }
-        for (Kai_u32 j = 0; j < (scope->pending_nodes).count; ++j)
+        else
+        if (node->flags&KAI_NODE_VALUE_EVALUATED)
+            continue;
+        kai__queue_node(context, scope, dep.index);
+        kai_array_push(&(scope->waiters), ((Kai_Node_Waiter){.pending = pending_index, .next = *head}));
+        *head = (scope->waiters).count;
+        pending.unresolved += 1;
+    }
+    if (pending.unresolved==0)
+    {
+        kai_array_push(&(scope->ready_nodes), ref);
+        return;
+    }
+    if (writer!=NULL)
+    {
+        kai__write("dependencies for ");
+        kai__write_node_ref(context, ref);
+        kai__write(" are not resolved: ");
+        for (Kai_u32 i = 0; i < (pending.dependencies).count; ++i)
         {
-            Kai_Pending_Node* other = &(((scope->pending_nodes).data)[j]);
-            if (!(((other->ref).flags)&KAI_NODE_VISITED)&&kai__node_reference_equals(other->ref, dep))
-            {
-                kai_array_push(&(context->current_dependencies), other->ref);
-                if (kai__explore_nodes(context, other))
-                    return KAI_TRUE;
-                kai_array_pop(&(context->current_dependencies));
-            }
+            kai__write_node_ref(context, ((pending.dependencies).data)[i]);
+            kai__write(" ");
         }
+        kai__write("\n");
     }
-    (pending->ref).flags &= (~KAI_NODE_VISITED);
-    return KAI_FALSE;
+    kai_array_push(&(scope->pending_nodes), pending);
+    scope->waiting_count += 1;
 }
 
-KAI_INTERNAL Kai_bool kai__compile_all_nodes_in_scope(Kai_Compiler_Context* context)
+KAI_INTERNAL Kai_bool kai__queue_node(Kai_Compiler_Context* context, Kai_Scope* scope, Kai_u32 index)
 {
     Kai_Allocator* allocator = &(context->allocator);
-    Kai_Writer* writer = context->debug_writer;
+    Kai_Node* node = &(((context->nodes).data)[index]);
+    if (node->flags&KAI_NODE_QUEUED)
+        return KAI_FALSE;
+    node->flags |= KAI_NODE_QUEUED;
+    kai_array_push(&(scope->ready_nodes), ((Kai_Node_Reference){.flags = KAI_NODE_TYPE, .index = index}));
+    return KAI_TRUE;
+}
+
+KAI_INTERNAL Kai_bool kai__compile_dependencies(Kai_Compiler_Context* context)
+{
     Kai_Scope* scope = &kai_array_last(&(context->scopes));
-    while ((scope->pending_nodes).count>0)
+    Kai_bool queued = KAI_FALSE;
+    for (Kai_u32 i = 0; i < (context->current_dependencies).count; ++i)
     {
-        Kai_Pending_Node pending = ((scope->pending_nodes).data)[0];
-        kai_array_remove(&(scope->pending_nodes), 0);
-        for (Kai_u32 i = 0; i < (pending.dependencies).count; ++i)
+        Kai_Node_Reference dep = ((context->current_dependencies).data)[i];
+        if (kai__queue_node(context, scope, dep.index))
+            queued = KAI_TRUE;
+    }
+    (context->current_dependencies).count = 0;
+    if (!queued)
+        return KAI_TRUE;
+    return kai__compile_all_nodes_in_scope(context);
+}
+
+KAI_INTERNAL void kai__resolve_waiters(Kai_Compiler_Context* context, Kai_u32 head)
+{
+    Kai_Allocator* allocator = &(context->allocator);
+    Kai_Scope* scope = &kai_array_last(&(context->scopes));
+    while (head!=0)
+    {
+        Kai_Node_Waiter waiter = ((scope->waiters).data)[head-1];
+        Kai_Pending_Node* pending = &(((scope->pending_nodes).data)[waiter.pending]);
+        pending->unresolved -= 1;
+        if (pending->unresolved==0)
         {
-            Kai_Node_Reference dep = ((pending.dependencies).data)[i];
-            Kai_Node* node = &(((context->nodes).data)[dep.index]);
-            if (dep.flags&KAI_NODE_TYPE)
-            {
-                if (node->flags&KAI_NODE_TYPE_EVALUATED)
+            scope->waiting_count -= 1;
+            kai_array_push(&(scope->ready_nodes), pending->ref);
+        }
+        head = waiter.next;
+    }
+}
+
+KAI_INTERNAL Kai_u32 kai__pending_slot(Kai_Node_Reference ref)
+{
+    if (ref.flags&KAI_NODE_TYPE)
+        return ref.index*2;
+    return ref.index*2+1;
+}
+
+KAI_INTERNAL Kai_u32 kai__pending_of_dependency(Kai_Compiler_Context* context, Kai_u32* pending_index, Kai_Node_Reference dep)
+{
+    Kai_u32 k = pending_index[kai__pending_slot(dep)];
+    if (k!=0)
+        return k;
+    Kai_Node* node = &(((context->nodes).data)[dep.index]);
+    if (!((dep.flags)&KAI_NODE_TYPE)&&!((node->flags)&KAI_NODE_TYPE_EVALUATED))
+        return pending_index[dep.index*2];
+    return 0;
+}
+
+KAI_INTERNAL Kai_bool kai__error_unresolved_dependencies(Kai_Compiler_Context* context)
+{
+    Kai_Allocator* allocator = &(context->allocator);
+    Kai_Scope* scope = &kai_array_last(&(context->scopes));
+    Kai_u32 n = (scope->pending_nodes).count;
+    Kai_u32 index_size = (2*(context->nodes).count)*sizeof(Kai_u32);
+    Kai_u32* pending_index = (Kai_u32*)(kai__allocate(NULL, index_size, 0));
+    kai__memory_zero(pending_index, index_size);
+    for (Kai_u32 i = 0; i < n; ++i)
+    {
+        Kai_Pending_Node* pending = &(((scope->pending_nodes).data)[i]);
+        if (pending->unresolved!=0)
+            pending_index[kai__pending_slot(pending->ref)] = i+1;
+    }
+    Kai_u32 work_size = (9*n)*sizeof(Kai_u32);
+    Kai_u32* work = (Kai_u32*)(kai__allocate(NULL, work_size, 0));
+    kai__memory_zero(work, work_size);
+    Kai_u32* order = work;
+    Kai_u32* low = work+n;
+    Kai_u32* component = work+2*n;
+    Kai_u32* stack = work+3*n;
+    Kai_u32* frames = work+4*n;
+    Kai_u32* edges = work+5*n;
+    Kai_u32* walk = work+6*n;
+    Kai_u32* walk_index = work+7*n;
+    Kai_u32* cycle_ends = work+8*n;
+    Kai_u32 stack_count = 0;
+    Kai_u32 visit_count = 0;
+    Kai_u32 component_count = 0;
+    Kai_u32 walk_count = 0;
+    Kai_u32 cycle_count = 0;
+    for (Kai_u32 root = 0; root < n; ++root)
+    {
+        Kai_Pending_Node* root_pending = &(((scope->pending_nodes).data)[root]);
+        if (root_pending->unresolved==0||order[root]!=0)
+            continue;
+        visit_count += 1;
+        order[root] = visit_count;
+        low[root] = visit_count;
+        stack[stack_count] = root;
+        stack_count += 1;
+        frames[0] = root;
+        edges[0] = 0;
+        Kai_u32 frame_count = 1;
+        while (frame_count!=0)
+        {
+            Kai_u32 top = frame_count-1;
+            Kai_u32 v = frames[top];
+            Kai_Pending_Node* pending = &(((scope->pending_nodes).data)[v]);
+            if (edges[top]<(pending->dependencies).count)
+            {
+                Kai_Node_Reference dep = ((pending->dependencies).data)[edges[top]];
+                edges[top] += 1;
+                Kai_u32 w = kai__pending_of_dependency(context, pending_index, dep);
+                if (w==0)
+                    continue;
+                w -= 1;
+                if (order[w]==0)
                 {
-                    kai_array_remove(&(pending.dependencies), i);
-                    i -= 1;
+                    visit_count += 1;
+                    order[w] = visit_count;
+                    low[w] = visit_count;
+                    stack[stack_count] = w;
+                    stack_count += 1;
+                    frames[frame_count] = w;
+                    edges[frame_count] = 0;
+                    frame_count += 1;
                 }
+                else
+                if (component[w]==0&&order[w]<low[v])
+                    low[v] = order[w];
+                continue;
             }
-            else
+            frame_count -= 1;
+            if (frame_count!=0)
             {
-                if (node->flags&KAI_NODE_VALUE_EVALUATED)
-                {
-                    kai_array_remove(&(pending.dependencies), i);
-                    i -= 1;
-                }
+                Kai_u32 u = frames[frame_count-1];
+                if (low[v]<low[u])
+                    low[u] = low[v];
             }
-        }
-        context->current_node = pending.ref;
-        if ((pending.dependencies).count!=0)
-        {
-            if (writer!=NULL)
+            if (low[v]!=order[v])
+                continue;
+            component_count += 1;
+            while (KAI_TRUE)
+            {
+                stack_count -= 1;
+                Kai_u32 w = stack[stack_count];
+                component[w] = component_count;
+                if (w==v)
+                    break;
+            }
+            Kai_u32 start = walk_count;
+            Kai_u32 current = v;
+            Kai_bool is_cycle = KAI_FALSE;
+            while (KAI_TRUE)
             {
-                kai__write("dependencies for ");
-                kai__write_node_ref(context, pending.ref);
-                kai__write(" are not resolved: ");
-                for (Kai_u32 i = 0; i < (pending.dependencies).count; ++i)
+                if (walk_index[current]!=0)
                 {
-                    Kai_Node_Reference dep = ((pending.dependencies).data)[i];
-                    kai__write_node_ref(context, dep);
-                    kai__write(" ");
+                    is_cycle = KAI_TRUE;
+                    break;
                 }
-                kai__write("\n");
-                for (Kai_u32 i = 0; i < (scope->pending_nodes).count; ++i)
+                walk_index[current] = walk_count+1;
+                walk[walk_count] = current;
+                walk_count += 1;
+                Kai_u32 next = n;
+                Kai_Pending_Node* current_pending = &(((scope->pending_nodes).data)[current]);
+                for (Kai_u32 i = 0; i < (current_pending->dependencies).count; ++i)
                 {
-                    Kai_Pending_Node pending = ((scope->pending_nodes).data)[i];
-                    kai__write(".. ");
-                    kai__write_node_ref(context, pending.ref);
-                    kai__write(" depends on ");
-                    for (Kai_u32 i = 0; i < (pending.dependencies).count; ++i)
+                    Kai_u32 w = kai__pending_of_dependency(context, pending_index, ((current_pending->dependencies).data)[i]);
+                    if (w!=0&&component[w-1]==component_count)
                     {
-                        Kai_Node_Reference dep = ((pending.dependencies).data)[i];
-                        kai__write_node_ref(context, dep);
-                        kai__write(" ");
+                        next = w-1;
+                        break;
                     }
-                    kai__write("\n");
                 }
+                if (next==n)
+                    break;
+                current = next;
             }
-            if (kai__explore_nodes(context, &pending))
-                return KAI_TRUE;
-            kai_array_push(&(scope->pending_nodes), pending);
-            (context->current_dependencies).count = 0;
-            continue;
-        }
+            if (!is_cycle)
+            {
+                walk_count = start;
+                continue;
+            }
+            Kai_u32 cycle_start = walk_index[current]-1;
+            for (Kai_u32 i = cycle_start; i < walk_count; ++i)
+            {
+                walk[(start+i)-cycle_start] = walk[i];
+            }
+            walk_count = (start+walk_count)-cycle_start;
+            cycle_ends[cycle_count] = walk_count;
+            cycle_count += 1;
+        }
+    }
+    if (cycle_count==0)
+    {
+        kai__free(work, work_size);
+        kai__free(pending_index, index_size);
+        return kai__error_fatal(context, KAI_STRING("dependencies could not be resolved"));
+    }
+    Kai_u32 error_count = walk_count+cycle_count;
+    Kai_u32 ends_size = error_count*sizeof(Kai_u32);
+    Kai_u32* ends = (Kai_u32*)(kai__allocate(NULL, ends_size, 0));
+    Kai_u32 first_message = ((context->error_arena).buffer).count;
+    Kai_u32 end_index = 0;
+    Kai_u32 cycle_start = 0;
+    for (Kai_u32 c = 0; c < cycle_count; ++c)
+    {
+        Kai_Pending_Node* root_pending = &(((scope->pending_nodes).data)[walk[cycle_start]]);
+        context->current_node = root_pending->ref;
+        (context->current_dependencies).count = 0;
+        Kai_u32 first = cycle_start+1;
+        for (Kai_u32 i = first; i < cycle_ends[c]; ++i)
+        {
+            Kai_Pending_Node* pending = &(((scope->pending_nodes).data)[walk[i]]);
+            kai_array_push(&(context->current_dependencies), pending->ref);
+        }
+        kai_array_push(&(context->current_dependencies), root_pending->ref);
+        kai__write_circular_dependency(context, ends+end_index);
+        end_index += (cycle_ends[c]-cycle_start)+1;
+        cycle_start = cycle_ends[c];
+    }
+    Kai_u8_DynArray* buffer = &((context->error_arena).buffer);
+    Kai_u32 error_offset = (Kai_u32)(kai__ceil_div(buffer->count, 8))*8;
+    kai_array_grow(buffer, (error_offset-buffer->count)+(error_count-1)*sizeof(Kai_Error));
+    buffer->count = error_offset+(error_count-1)*sizeof(Kai_Error);
+    Kai_Error* errors = (Kai_Error*)(buffer->data+error_offset);
+    Kai_Error* out = context->error;
+    Kai_u32 message_start = first_message;
+    end_index = 0;
+    cycle_start = 0;
+    for (Kai_u32 c = 0; c < cycle_count; ++c)
+    {
+        for (Kai_u32 i = cycle_start; i < cycle_ends[c]+1; ++i)
+        {
+            Kai_u32 at = cycle_start;
+            if (i<cycle_ends[c])
+                at = i;
+            Kai_Pending_Node* pending = &(((scope->pending_nodes).data)[walk[at]]);
+            Kai_Node* node = &(((context->nodes).data)[(pending->ref).index]);
+            Kai_Result result = KAI_ERROR_INFO;
+            if (i==cycle_start)
+                result = KAI_ERROR_SEMANTIC;
+            if (end_index!=0)
+            {
+                out->next = &(errors[end_index-1]);
+                out = out->next;
+            }
+            *out = ((Kai_Error){.result = result, .location = kai__location_with_line(node->location), .message = kai_string_from_data(buffer->data+message_start, ends[end_index]-message_start)});
+            message_start = ends[end_index];
+            end_index += 1;
+        }
+        cycle_start = cycle_ends[c];
+    }
+    kai__free(ends, ends_size);
+    kai__free(work, work_size);
+    kai__free(pending_index, index_size);
+    return KAI_TRUE;
+}
+
+KAI_INTERNAL Kai_Attempt_Checkpoint kai__save_attempt(Kai_Compiler_Context* context)
+{
+    return ((Kai_Attempt_Checkpoint){.types = kai_arena_save(&(context->type_allocator)), .type_count = (context->type_cache).count, .instance_count = (context->instances).count, .code_count = ((context->assembler).code).count, .scope_count = (context->scopes).count, .trail_count = (context->symbol_trail).count, .local_node_count = (context->local_nodes).count, .jump_table_count = context->jump_table_count, .compare_tree_count = context->compare_tree_count, .procedure_job_count = (context->procedure_jobs).count});
+}
+
+KAI_INTERNAL void kai__restore_attempt(Kai_Compiler_Context* context, Kai_Attempt_Checkpoint checkpoint, Kai_Node* node)
+{
+    ((context->assembler).code).count = checkpoint.code_count;
+    kai__unbind_to(context, checkpoint.trail_count);
+    (context->scopes).count = checkpoint.scope_count;
+    (context->local_nodes).count = checkpoint.local_node_count;
+    context->jump_table_count = checkpoint.jump_table_count;
+    context->compare_tree_count = checkpoint.compare_tree_count;
+    (context->procedure_jobs).count = checkpoint.procedure_job_count;
+    if (((context->type_cache).count==checkpoint.type_count&&(context->instances).count==checkpoint.instance_count)&&(node==NULL||node->partial==NULL))
+        kai_arena_restore(&(context->type_allocator), checkpoint.types);
+}
+
+KAI_INTERNAL Kai_bool kai__compile_all_nodes_in_scope(Kai_Compiler_Context* context)
+{
+    Kai_Allocator* allocator = &(context->allocator);
+    Kai_Writer* writer = context->debug_writer;
+    Kai_u32 scope_index = (context->scopes).count-1;
+    Kai_Scope* scope = &(((context->scopes).data)[scope_index]);
+    while (scope->ready_head<(scope->ready_nodes).count)
+    {
+        Kai_Pending_Node pending = ((Kai_Pending_Node){.ref = ((scope->ready_nodes).data)[scope->ready_head]});
+        scope->ready_head += 1;
+        context->current_node = pending.ref;
+        Kai_Attempt_Checkpoint checkpoint = kai__save_attempt(context);
         Kai_Node* node = &(((context->nodes).data)[(pending.ref).index]);
         context->current_source = (node->location).source;
+        kai__expand_node(context, node);
         if (writer!=NULL)
         {
             kai__write("compiling ");
@@ -7721,20 +12541,24 @@ KAI_INTERNAL Kai_bool kai__compile_all_nodes_in_scope(Kai_Compiler_Context* cont
                 failed = kai__value_of_expr(context, node->type_expr, &type_value, &type_type);
             else
                 failed = kai__type_of_expression(context, node->value_expr, &(type_value.type));
+            node = &(((context->nodes).data)[(pending.ref).index]);
+            scope = &(((context->scopes).data)[scope_index]);
             node->type = type_value.type;
             if (failed)
             {
                 if ((context->error)->result!=KAI_SUCCESS)
                     return KAI_TRUE;
-                kai_array_push(&(scope->pending_nodes), ((Kai_Pending_Node){.ref = pending.ref, .dependencies = context->current_dependencies}));
-                (context->current_dependencies).data = NULL;
-                (context->current_dependencies).count = 0;
-                (context->current_dependencies).capacity = 0;
+                kai__restore_attempt(context, checkpoint, node);
+                kai__wait_for_dependencies(context, pending.ref);
             }
             else
             {
                 (node->decl)->this_type = node->type;
                 node->flags |= KAI_NODE_TYPE_EVALUATED;
+                if (!((node->flags)&KAI_NODE_VALUE_EVALUATED))
+                    kai_array_push(&(scope->ready_nodes), ((Kai_Node_Reference){.index = (pending.ref).index}));
+                kai__resolve_waiters(context, node->type_waiters);
+                node->type_waiters = 0;
             }
             if (writer!=NULL)
             {
@@ -7747,19 +12571,24 @@ KAI_INTERNAL Kai_bool kai__compile_all_nodes_in_scope(Kai_Compiler_Context* cont
         {
             kai_assert(node->type!=NULL);
             Kai_Type type = node->type;
-            if (node->value_expr!=NULL&&kai__value_of_expr(context, node->value_expr, &(node->value), &type))
+            Kai_Value value = node->value;
+            Kai_bool failed = node->value_expr!=NULL&&kai__value_of_expr(context, node->value_expr, &value, &type);
+            node = &(((context->nodes).data)[(pending.ref).index]);
+            scope = &(((context->scopes).data)[scope_index]);
+            node->value = value;
+            if (failed)
             {
                 if ((context->error)->result!=KAI_SUCCESS)
                     return KAI_TRUE;
-                kai_array_push(&(scope->pending_nodes), ((Kai_Pending_Node){.ref = pending.ref, .dependencies = context->current_dependencies}));
-                (context->current_dependencies).data = NULL;
-                (context->current_dependencies).count = 0;
-                (context->current_dependencies).capacity = 0;
+                kai__restore_attempt(context, checkpoint, node);
+                kai__wait_for_dependencies(context, pending.ref);
                 continue;
             }
             else
             {
                 node->flags |= KAI_NODE_VALUE_EVALUATED;
+                kai__resolve_waiters(context, node->value_waiters);
+                node->value_waiters = 0;
             }
             if (writer!=NULL)
             {
@@ -7799,24 +12628,43 @@ KAI_INTERNAL Kai_bool kai__compile_all_nodes_in_scope(Kai_Compiler_Context* cont
         {
             if (writer!=NULL)
             {
-                kai__write("exporting ");
-                kai__write_string((node->location).string);
-                kai__write(" [");
+                (writer->write(writer->user, KAI_WRITE_STRING, (Kai_Value){.string = KAI_STRING("exporting ")}, (Kai_Write_Format){0}), writer->write(writer->user, KAI_WRITE_STRING, (Kai_Value){.string = (node->location).string}, (Kai_Write_Format){0}), writer->write(writer->user, KAI_WRITE_STRING, (Kai_Value){.string = KAI_STRING(" [")}, (Kai_Write_Format){0}));
                 kai_write_type(writer, node->type);
                 kai__write("]\n");
             }
             Kai_u32 location = kai__push_value(context, node->type, node->value);
             kai_table_set(string, &((context->program)->variable_table), (node->location).string, ((Kai_Variable){.type = node->type, .location = location}));
+            if (((((context->jobs!=NULL&&(node->type)->id==KAI_TYPE_ID_PROCEDURE)&&!(((context->options).flags)&KAI_COMPILE_NO_CODE_GEN))&&node->value_expr!=NULL)&&(node->value_expr)->id==KAI_EXPR_PROCEDURE)&&!(((node->value_expr)->flags)&KAI_FLAG_EXPR_POLYMORPHIC))
+                kai_array_push(&(context->label_fixups), ((Kai__Label_Fixup){.location = location, .job = (node->value).u32}));
         }
     }
+    if (scope->waiting_count!=0)
+        return kai__error_unresolved_dependencies(context);
+    (scope->ready_nodes).count = 0;
+    scope->ready_head = 0;
     return KAI_FALSE;
 }
 
 KAI_API(Kai_Result) kai_create_program(Kai_Program_Create_Info* info, Kai_Program* out_program)
 {
-    Kai_Compiler_Context context = ((Kai_Compiler_Context){.error = info->error, .allocator = info->allocator, .program = out_program, .options = info->options, .imports = info->imports, .debug_writer = info->debug_writer});
-    kai_arena_create(&(context.type_allocator), &(info->allocator));
+    Kai_Compiler_Context context = ((Kai_Compiler_Context){.error = info->error, .allocator = info->allocator, .program = out_program, .options = info->options, .imports = info->imports, .debug_writer = info->debug_writer, .jobs = info->jobs});
+    if (info->types!=NULL)
+    {
+        context.type_allocator = (info->types)->arena;
+        context.type_cache = (info->types)->types;
+    }
+    else
+        kai_arena_create(&(context.type_allocator), &(info->allocator));
     kai_arena_create(&(context.temp_allocator), &(info->allocator));
+    if ((info->options).flags&KAI_COMPILE_COMPACT_TREES)
+        kai_arena_create(&((context.program)->tree_arena), &(info->allocator));
+    kai_create_atom_table(&(context.atoms), &(info->allocator));
+    kai__intern_builtin_names(&context);
+    for (Kai_u32 i = 0; i < (info->exports).count; ++i)
+    {
+        Kai_Allocator* allocator = &(context.allocator);
+        kai_table_set(u32, &(context.export_atoms), kai_intern_atom(&(context.atoms), ((info->exports).data)[i]), KAI_TRUE);
+    }
     (context.error_arena).allocator = info->allocator;
     (context.assembler).allocator = &(info->allocator);
     if (!(((info->options).flags)&KAI_COMPILE_NO_CODE_GEN))
@@ -7829,10 +12677,15 @@ KAI_API(Kai_Result) kai_create_program(Kai_Program_Create_Info* info, Kai_Progra
             break;
         if (kai__compile_all_nodes_in_scope(&context))
             break;
+        if (kai__compile_instances(&context))
+            break;
+        if (kai__compile_procedure_jobs(&context))
+            break;
         if (!(((info->options).flags)&KAI_COMPILE_NO_CODE_GEN))
         {
+            kai__link_procedures(&context);
             Kai_Allocator allocator = info->allocator;
-            void* machine_code = allocator.platform_allocate(allocator.user, NULL, 65536, KAI_MEMORY_COMMAND_ALLOCATE_WRITE_ONLY);
+            void* machine_code = allocator.platform_allocate(allocator.user, NULL, kai__max_u32(((context.assembler).code).count*4, 65536), KAI_MEMORY_COMMAND_ALLOCATE_WRITE_ONLY);
             kai__memory_copy(machine_code, ((context.assembler).code).data, ((context.assembler).code).count*4);
             if (context.debug_writer!=NULL)
             {
@@ -7858,13 +12711,68 @@ KAI_API(Kai_Result) kai_create_program(Kai_Program_Create_Info* info, Kai_Progra
         }
         break;
     }
+    if (info->statistics!=NULL)
+    {
+        kai__memory_zero(info->statistics, sizeof(Kai_Compile_Statistics));
+        for (Kai_u32 i = 0; i < (context.nodes).count; ++i)
+        {
+            Kai_Node* node = &(((context.nodes).data)[i]);
+            if (node->decl==NULL)
+                continue;
+            (info->statistics)->declaration_count += 1;
+            if (!((node->flags)&KAI_NODE_QUEUED))
+                (info->statistics)->skipped_count += 1;
+            if (node->compact_tree!=NULL&&node->compact==0)
+                (info->statistics)->expanded_count += 1;
+        }
+        (info->statistics)->instance_count = (context.instances).count;
+        (info->statistics)->jump_table_count = context.jump_table_count;
+        (info->statistics)->compare_tree_count = context.compare_tree_count;
+    }
+    if (info->types!=NULL)
+    {
+        (info->types)->arena = context.type_allocator;
+        (info->types)->types = context.type_cache;
+    }
     (context.program)->trees = context.trees;
+    for (Kai_u32 i = 0; i < (context.compact_trees).count; ++i)
+    {
+        kai_destroy_compact_tree(&(((context.compact_trees).data)[i]));
+    }
+    if ((context.compact_trees).count!=0)
+    {
+        Kai_Allocator* allocator = &(context.allocator);
+        kai__free((context.compact_trees).data, (context.compact_trees).count*sizeof(Kai_Compact_Tree));
+    }
+    kai_destroy_atom_table(&(context.atoms));
+    if ((context.export_atoms).capacity!=0)
+    {
+        Kai_Allocator* allocator = &(context.allocator);
+        kai__free((context.export_atoms).occupied, kai_raw_table_size((context.export_atoms).capacity, sizeof(Kai_u32), sizeof(Kai_bool)).total);
+    }
     return (context.error)->result;
 }
 
 KAI_API(void) kai_destroy_program(Kai_Program* program)
 {
-    (void)(program);
+    if ((program->tree_arena).current_bucket!=NULL)
+        kai_arena_destroy(&(program->tree_arena));
+}
+
+KAI_API(void) kai_create_type_table(Kai_Type_Table* table, Kai_Allocator* allocator)
+{
+    kai_arena_create(&(table->arena), allocator);
+    kai__memory_zero(&(table->types), sizeof(table->types));
+}
+
+KAI_API(void) kai_destroy_type_table(Kai_Type_Table* table)
+{
+    Kai_Allocator* allocator = &((table->arena).base);
+    if ((table->types).capacity!=0)
+    {
+        kai__free((table->types).occupied, kai_raw_table_size((table->types).capacity, sizeof(Kai_Type), sizeof(Kai_u32)).total);
+    }
+    kai_arena_free_all(&(table->arena));
 }
 
 KAI_API(void*) kai_find_variable(Kai_Program* program, Kai_string name, Kai_Type* out_type)
@@ -8153,6 +13061,110 @@ KAI_API(Kai_u64) kai_allocator_usage(Kai_Allocator* allocator)
     return metadata->total_allocated;
 }
 
+#endif
+#ifndef KAI_DONT_USE_SOURCE_API
+
+#if defined(KAI_PLATFORM_LINUX) || defined(KAI_PLATFORM_APPLE)
+#include <fcntl.h>    // -> open
+#include <sys/stat.h> // -> fstat
+#include <sys/mman.h> // -> mmap
+#include <unistd.h>   // -> close
+KAI_INTERNAL void* kai__platform_map_file(char const* path, Kai_u32* out_size)
+{
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return NULL;
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size > 0xFFFFFFFF) {
+        close(fd);
+        return NULL;
+    }
+    *out_size = (Kai_u32)info.st_size;
+    if (info.st_size == 0) {
+        close(fd);
+        return (void*)""; // nothing to map
+    }
+    void* data = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd); // the mapping keeps the file
+    if (data == MAP_FAILED)
+        return NULL;
+    // Read once from beginning to end, so ask for all of it now
+    madvise(data, (size_t)info.st_size, MADV_SEQUENTIAL);
+    madvise(data, (size_t)info.st_size, MADV_WILLNEED);
+    return data;
+}
+KAI_INTERNAL void kai__platform_unmap_file(void* data, Kai_u32 size)
+{
+    if (size != 0)
+        kai_assert(munmap(data, size) == 0);
+}
+#elif defined(KAI_PLATFORM_WINDOWS)
+__declspec(dllimport) void* __stdcall CreateFileA(char const* lpFileName, unsigned long dwDesiredAccess, unsigned long dwShareMode, void* lpSecurityAttributes, unsigned long dwCreationDisposition, unsigned long dwFlagsAndAttributes, void* hTemplateFile);
+__declspec(dllimport) int __stdcall GetFileSizeEx(void* hFile, long long* lpFileSize);
+__declspec(dllimport) void* __stdcall CreateFileMappingA(void* hFile, void* lpFileMappingAttributes, unsigned long flProtect, unsigned long dwMaximumSizeHigh, unsigned long dwMaximumSizeLow, char const* lpName);
+__declspec(dllimport) void* __stdcall MapViewOfFile(void* hFileMappingObject, unsigned long dwDesiredAccess, unsigned long dwFileOffsetHigh, unsigned long dwFileOffsetLow, uintptr_t dwNumberOfBytesToMap);
+__declspec(dllimport) int __stdcall UnmapViewOfFile(void const* lpBaseAddress);
+__declspec(dllimport) int __stdcall CloseHandle(void* hObject);
+__declspec(dllimport) void* __stdcall GetCurrentProcess(void);
+typedef struct { void* VirtualAddress; uintptr_t NumberOfBytes; } Kai__Memory_Range_Entry; // WIN32_MEMORY_RANGE_ENTRY
+__declspec(dllimport) int __stdcall PrefetchVirtualMemory(void* hProcess, uintptr_t NumberOfEntries, Kai__Memory_Range_Entry* VirtualAddresses, unsigned long Flags);
+KAI_INTERNAL void* kai__platform_map_file(char const* path, Kai_u32* out_size)
+{
+    // GENERIC_READ, FILE_SHARE_READ, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL
+    void* file = CreateFileA(path, 0x80000000, 0x1, NULL, 3, 0x80, NULL);
+    if (file == (void*)(intptr_t)-1)
+        return NULL;
+    long long size = 0;
+    if (!GetFileSizeEx(file, &size) || size > 0xFFFFFFFF) {
+        CloseHandle(file);
+        return NULL;
+    }
+    *out_size = (Kai_u32)size;
+    if (size == 0) {
+        CloseHandle(file);
+        return (void*)""; // nothing to map
+    }
+    void* mapping = CreateFileMappingA(file, NULL, 0x02, 0, 0, NULL); // PAGE_READONLY
+    CloseHandle(file);
+    if (mapping == NULL)
+        return NULL;
+    void* data = MapViewOfFile(mapping, 0x04, 0, 0, 0); // FILE_MAP_READ
+    CloseHandle(mapping); // the view keeps the mapping
+    if (data == NULL)
+        return NULL;
+    // Read once from beginning to end, so ask for all of it now (a hint, failure is fine)
+    Kai__Memory_Range_Entry range = { data, (uintptr_t)size };
+    PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+    return data;
+}
+KAI_INTERNAL void kai__platform_unmap_file(void* data, Kai_u32 size)
+{
+    if (size != 0)
+        kai_assert(UnmapViewOfFile(data) != 0);
+}
+#else
+#	error "[KAI] No file mapping implemented for the current platform :( (define KAI_DONT_USE_SOURCE_API)"
+#endif
+KAI_API(Kai_Result) kai_source_map_file(Kai_cstring path, Kai_Source* out_source)
+{
+    kai_assert(out_source!=NULL);
+    *out_source = ((Kai_Source){0});
+    out_source->name = kai_string_from_c(path);
+    Kai_u32 size = 0;
+    Kai_u8* data = ((Kai_u8*)kai__platform_map_file(path, &size));
+    if (data==NULL)
+        return KAI_ERROR_INTERNAL;
+    out_source->contents = ((Kai_string){.count = size, .data = data});
+    return KAI_SUCCESS;
+}
+
+KAI_API(void) kai_source_unmap(Kai_Source* source)
+{
+    if ((source->contents).data!=NULL)
+        kai__platform_unmap_file((source->contents).data, (source->contents).count);
+    source->contents = ((Kai_string){0});
+}
+
 #endif
 #endif // KAI_IMPLEMENTATION
 
@@ -28,18 +28,12 @@ Kai_Allocator allocator = {0};
 
 static inline Kai_Source load_source_file(const char* path)
 {
-	String_Builder builder = {0};
-	
-	if (!read_entire_file(path, &builder))
+	Kai_Source source = {0};
+	if (kai_source_map_file(path, &source) != KAI_SUCCESS) {
+		nob_log(ERROR, "Could not read file %s", path);
 		exit(1);
-	
-	return (Kai_Source) {
-		.name = kai_string_from_c(path),
-		.contents = {
-			.data = (Kai_u8*)(builder.items),
-			.count = (Kai_u32)(builder.count)
-		}
-	};
+	}
+	return source;
 }
 
 #define TOKEN_COUNT (1<<0)
@@ -59,6 +53,7 @@ void help_parse(void)
 {
     printf(
         "Usage: kai parse [FLAGS] <files...>\n"
+        "       kai parse [FLAGS] -   (read the source from stdin, one declaration at a time)\n"
         "\n"
         "FLAGS:\n"
         "   -p, --no-print   Do not print AST\n"
@@ -73,6 +68,8 @@ void help_compile(void)
 {
     printf(
         "Usage: kai compile [FLAGS] [OPTIONS] <files...>\n"
+        "       (stdin is not supported, every declaration is needed before any is compiled;\n"
+        "        use `kai parse -` to stream a source)\n"
         "\n"
         "FLAGS:\n"
         "   -d, --debug          Enable debug printing\n"
@@ -159,13 +156,11 @@ int token(int argc, char** argv)
     }
     if (source_start < 0) return error_no_source_provided();
     Kai_Source source = load_source_file(argv[source_start]);
+    Kai_Arena_Allocator string_arena = {0};
+    kai_arena_create(&string_arena, &allocator);
     Kai_Tokenizer tokenizer = {
         .source = source.contents,
-        .line_number = 1,
-        .string_arena = {
-            .data = allocator.heap_allocate(allocator.user, NULL, source.contents.count, 0),
-            .size = source.contents.count,
-        },
+        .string_arena = &string_arena,
     };
     Kai_u64 count = 0;
     Kai_Token* token = kai_tokenizer_next(&tokenizer);
@@ -180,14 +175,49 @@ int token(int argc, char** argv)
     }
     if (parse_options & TOKEN_COUNT)
         printf("%"PRIu64"\n", count);
+    kai_arena_destroy(&string_arena);
+    kai_source_unmap(&source);
     return 0;
 }
 
+static Kai_u32 read_stdin(void* user, Kai_u8* buffer, Kai_u32 capacity)
+{
+    return (Kai_u32)fread(buffer, 1, capacity, (FILE*)user);
+}
+
+// Sources from a pipe can be larger than memory, so they are parsed as they arrive
+int parse_stdin(Kai_u32 parse_options)
+{
+    Kai_Error error = {0};
+    Kai_Source_Stream stream = {0};
+    Kai_Source_Stream_Create_Info info = {
+        .name = KAI_CONST_STRING("stdin"),
+        .read = read_stdin,
+        .user = stdin,
+        .allocator = allocator,
+        .error = &error,
+    };
+    if (kai_create_source_stream(&info, &stream) != KAI_SUCCESS)
+        return 1;
+    Kai_u64 count = 0;
+    for (Kai_Stmt* stmt; (stmt = kai_source_stream_next(&stream)) != NULL; count += 1) {
+        if (!(parse_options & PARSE_NO_PRINT))
+            kai_write_expression(writer, stmt, 0);
+    }
+    if (error.result != KAI_SUCCESS)
+        kai_write_error(writer, &error);
+    else if (parse_options & PARSE_NO_PRINT)
+        printf("%"PRIu64" declarations\n", count);
+    kai_destroy_source_stream(&stream);
+    return error.result != KAI_SUCCESS;
+}
+
 int parse(int argc, char** argv)
 {
     Kai_u32 parse_options = 0;
     Kai_s32 source_start = -1;
     for (int i = 0; i < argc; ++i) {
+        if (strcmp(argv[i], "-") == 0) return parse_stdin(parse_options);
         if (argv[i][0] == '-') {
             // -> Possible Flag
             if (strcmp(argv[i]+1, "p") == 0) parse_options |= PARSE_NO_PRINT;
@@ -211,6 +241,8 @@ int parse(int argc, char** argv)
 	if (error.result != KAI_SUCCESS) {
 		kai_write_error(writer, &error);
 	}
+	kai_destroy_syntax_tree(&tree);
+	kai_source_unmap(&info.source);
 	return error.result != KAI_SUCCESS;
 }
 
@@ -219,6 +251,10 @@ int compile(int argc, char** argv)
     Kai_u32 parse_options = 0;
     Kai_s32 source_start = -1;
     for (int i = 0; i < argc; ++i) {
+        if (strcmp(argv[i], "-") == 0) {
+            nob_log(ERROR, "compile does not read stdin, only `kai parse -` streams a source");
+            return 1;
+        }
         if (argv[i][0] == '-') {
             // -> Possible Flag
             if (strcmp(argv[i]+1, "p") == 0) parse_options |= COMPILE_NO_PRINT;
@@ -270,6 +306,8 @@ int compile(int argc, char** argv)
 	if (error.result != KAI_SUCCESS) {
 		kai_write_error(writer, &error);
 	}
+	kai_destroy_program(&program);
+	kai_source_unmap(&source);
 	return error.result != KAI_SUCCESS;
 }
 
@@ -307,11 +345,15 @@ int run(int argc, char** argv)
         Main main_proc = (Main)kai_find_procedure(&program, KAI_STRING("main"), KAI_STRING("()->s64"));
         if (main_proc == NULL) {
             nob_log(ERROR, "Could not find main procedure");
-            return 1;
+            error.result = KAI_ERROR_SEMANTIC;
+        }
+        else {
+            Kai_s64 return_value = main_proc();
+            printf("main exited with code %"PRIi64"\n", return_value);
         }
-        Kai_s64 return_value = main_proc();
-        printf("main exited with code %"PRIi64"\n", return_value);
     }
+	kai_destroy_program(&program);
+	kai_source_unmap(&source);
 	return error.result != KAI_SUCCESS;
 }
 
@@ -24,6 +24,7 @@ const char* join(const char* left, const char* right)
 #define kai__todo(...) __env_panic("TODO", join(__func__, #__VA_ARGS__), __FILE__, __LINE__)
 #define KAI_DONT_USE_WRITER_API
 #define KAI_DONT_USE_ALLOCATOR_API
+#define KAI_DONT_USE_SOURCE_API
 #define KAI_IMPLEMENTATION
 #include "../kai.h"
 
@@ -46,6 +46,76 @@ static inline Kai_u32 kai_intrinsics_ctz64(Kai_u64 value)
 #endif
 }
 
+static inline Kai_u32 kai_intrinsics_popcount32(Kai_u32 value)
+{
+#if defined(KAI_COMPILER_CLANG) || defined(KAI_COMPILER_GNU)
+    return (Kai_u32)__builtin_popcount(value);
+#elif defined(KAI_COMPILER_MSVC)
+    return (Kai_u32)__popcnt(value);
+#endif
+}
+
+static inline Kai_u32 kai_intrinsics_popcount64(Kai_u64 value)
+{
+#if defined(KAI_COMPILER_CLANG) || defined(KAI_COMPILER_GNU)
+    return (Kai_u32)__builtin_popcountll(value);
+#elif defined(KAI_COMPILER_MSVC)
+    return (Kai_u32)__popcnt64(value);
+#endif
+}
+
+static inline Kai_u32 kai_intrinsics_bswap32(Kai_u32 value)
+{
+#if defined(KAI_COMPILER_CLANG) || defined(KAI_COMPILER_GNU)
+    return __builtin_bswap32(value);
+#elif defined(KAI_COMPILER_MSVC)
+    return _byteswap_ulong(value);
+#endif
+}
+
+static inline Kai_u64 kai_intrinsics_bswap64(Kai_u64 value)
+{
+#if defined(KAI_COMPILER_CLANG) || defined(KAI_COMPILER_GNU)
+    return __builtin_bswap64(value);
+#elif defined(KAI_COMPILER_MSVC)
+    return _byteswap_uint64(value);
+#endif
+}
+
+// NOTE: compilers recognize this pattern and emit a single rotate instruction
+static inline Kai_u32 kai_intrinsics_rotl32(Kai_u32 value, Kai_u32 shift)
+{
+#if defined(KAI_COMPILER_MSVC)
+    return _rotl(value, (int)shift);
+#else
+    shift &= 31;
+    return (value << shift) | (value >> ((32 - shift) & 31));
+#endif
+}
+
+static inline Kai_u64 kai_intrinsics_rotl64(Kai_u64 value, Kai_u32 shift)
+{
+#if defined(KAI_COMPILER_MSVC)
+    return _rotl64(value, (int)shift);
+#else
+    shift &= 63;
+    return (value << shift) | (value >> ((64 - shift) & 63));
+#endif
+}
+
+// Memory (WASM builds must provide memcpy, memmove and memset)
+
+#if defined(KAI_COMPILER_CLANG) || defined(KAI_COMPILER_GNU)
+#   define kai_intrinsics_memory_copy(DST,SRC,SIZE) __builtin_memcpy(DST,SRC,SIZE)
+#   define kai_intrinsics_memory_move(DST,SRC,SIZE) __builtin_memmove(DST,SRC,SIZE)
+#   define kai_intrinsics_memory_set(DST,BYTE,SIZE) __builtin_memset(DST,BYTE,SIZE)
+#else
+#   include <string.h>
+#   define kai_intrinsics_memory_copy(DST,SRC,SIZE) memcpy(DST,SRC,SIZE)
+#   define kai_intrinsics_memory_move(DST,SRC,SIZE) memmove(DST,SRC,SIZE)
+#   define kai_intrinsics_memory_set(DST,BYTE,SIZE) memset(DST,BYTE,SIZE)
+#endif
+
 // 128 bit integers (unsigned)
 
 // Always use fallback when compiling for WASM
@@ -95,6 +165,135 @@ static inline Kai_u32 kai_intrinsics_ctz64(Kai_u64 value)
     }
 #endif
 
+// Byte scanning (used by the tokenizer)
+// Each scan returns the index of the first byte in [start, end) that stops it, or end.
+// 32 bytes at a time with AVX2, 16 with SSE2 or NEON, one at a time for WASM or KAI_NO_SIMD.
+
+#if defined(KAI_NO_SIMD) || defined(__wasm__)
+#elif defined(__AVX2__)
+#   include <immintrin.h>
+#   define KAI__VECTOR_SIZE 32
+#   define KAI__VECTOR_MASK_SHIFT 0 // one mask bit per byte
+#   define KAI__VECTOR_ALL 0xFFFFFFFFull
+    typedef __m256i Kai__Vector;
+    static inline Kai__Vector kai__vector_load(Kai_u8 const* p) { return _mm256_loadu_si256((__m256i const*)p); }
+    static inline Kai__Vector kai__vector_splat(Kai_u8 b) { return _mm256_set1_epi8((char)b); }
+    static inline Kai__Vector kai__vector_equals(Kai__Vector a, Kai__Vector b) { return _mm256_cmpeq_epi8(a, b); }
+    static inline Kai__Vector kai__vector_or(Kai__Vector a, Kai__Vector b) { return _mm256_or_si256(a, b); }
+    static inline Kai__Vector kai__vector_and_not(Kai__Vector a, Kai__Vector b) { return _mm256_andnot_si256(b, a); }
+    static inline Kai__Vector kai__vector_sub(Kai__Vector a, Kai_u8 b) { return _mm256_sub_epi8(a, _mm256_set1_epi8((char)b)); }
+    static inline Kai__Vector kai__vector_at_most(Kai__Vector a, Kai_u8 b) {
+        return _mm256_cmpeq_epi8(_mm256_subs_epu8(a, _mm256_set1_epi8((char)b)), _mm256_setzero_si256());
+    }
+    static inline Kai_u64 kai__vector_mask(Kai__Vector a) { return (Kai_u32)_mm256_movemask_epi8(a); }
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#   include <emmintrin.h>
+#   define KAI__VECTOR_SIZE 16
+#   define KAI__VECTOR_MASK_SHIFT 0
+#   define KAI__VECTOR_ALL 0xFFFFull
+    typedef __m128i Kai__Vector;
+    static inline Kai__Vector kai__vector_load(Kai_u8 const* p) { return _mm_loadu_si128((__m128i const*)p); }
+    static inline Kai__Vector kai__vector_splat(Kai_u8 b) { return _mm_set1_epi8((char)b); }
+    static inline Kai__Vector kai__vector_equals(Kai__Vector a, Kai__Vector b) { return _mm_cmpeq_epi8(a, b); }
+    static inline Kai__Vector kai__vector_or(Kai__Vector a, Kai__Vector b) { return _mm_or_si128(a, b); }
+    static inline Kai__Vector kai__vector_and_not(Kai__Vector a, Kai__Vector b) { return _mm_andnot_si128(b, a); }
+    static inline Kai__Vector kai__vector_sub(Kai__Vector a, Kai_u8 b) { return _mm_sub_epi8(a, _mm_set1_epi8((char)b)); }
+    static inline Kai__Vector kai__vector_at_most(Kai__Vector a, Kai_u8 b) {
+        return _mm_cmpeq_epi8(_mm_subs_epu8(a, _mm_set1_epi8((char)b)), _mm_setzero_si128());
+    }
+    static inline Kai_u64 kai__vector_mask(Kai__Vector a) { return (Kai_u32)_mm_movemask_epi8(a); }
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#   include <arm_neon.h>
+#   define KAI__VECTOR_SIZE 16
+#   define KAI__VECTOR_MASK_SHIFT 2 // four mask bits per byte
+#   define KAI__VECTOR_ALL 0xFFFFFFFFFFFFFFFFull
+    typedef uint8x16_t Kai__Vector;
+    static inline Kai__Vector kai__vector_load(Kai_u8 const* p) { return vld1q_u8(p); }
+    static inline Kai__Vector kai__vector_splat(Kai_u8 b) { return vdupq_n_u8(b); }
+    static inline Kai__Vector kai__vector_equals(Kai__Vector a, Kai__Vector b) { return vceqq_u8(a, b); }
+    static inline Kai__Vector kai__vector_or(Kai__Vector a, Kai__Vector b) { return vorrq_u8(a, b); }
+    static inline Kai__Vector kai__vector_and_not(Kai__Vector a, Kai__Vector b) { return vbicq_u8(a, b); }
+    static inline Kai__Vector kai__vector_sub(Kai__Vector a, Kai_u8 b) { return vsubq_u8(a, vdupq_n_u8(b)); }
+    static inline Kai__Vector kai__vector_at_most(Kai__Vector a, Kai_u8 b) { return vcleq_u8(a, vdupq_n_u8(b)); }
+    static inline Kai_u64 kai__vector_mask(Kai__Vector a) {
+        return vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(a), 4)), 0);
+    }
+#endif
+
+#if defined(KAI__VECTOR_SIZE)
+    static inline Kai__Vector kai__vector_in_range(Kai__Vector a, Kai_u8 low, Kai_u8 high) {
+        return kai__vector_at_most(kai__vector_sub(a, low), (Kai_u8)(high - low));
+    }
+#endif
+
+// Spaces, tabs and other control characters, but not line breaks
+static inline Kai_u32 kai_intrinsics_skip_whitespace(Kai_u8 const* data, Kai_u32 start, Kai_u32 end)
+{
+#if defined(KAI__VECTOR_SIZE)
+    Kai__Vector lf = kai__vector_splat('\n');
+    Kai__Vector cr = kai__vector_splat('\r');
+    while (start + KAI__VECTOR_SIZE <= end) {
+        Kai__Vector v = kai__vector_load(data + start);
+        Kai__Vector breaks = kai__vector_or(kai__vector_equals(v, lf), kai__vector_equals(v, cr));
+        Kai_u64 stop = kai__vector_mask(kai__vector_and_not(kai__vector_at_most(v, ' '), breaks)) ^ KAI__VECTOR_ALL;
+        if (stop) return start + (kai_intrinsics_ctz64(stop) >> KAI__VECTOR_MASK_SHIFT);
+        start += KAI__VECTOR_SIZE;
+    }
+#endif
+    while (start < end && data[start] <= ' ' && data[start] != '\n' && data[start] != '\r')
+        start += 1;
+    return start;
+}
+
+// [0-9A-Za-z_] and any byte of a multi-byte unicode symbol
+static inline Kai_u32 kai_intrinsics_skip_identifier(Kai_u8 const* data, Kai_u32 start, Kai_u32 end)
+{
+#if defined(KAI__VECTOR_SIZE)
+    Kai__Vector underscore = kai__vector_splat('_');
+    Kai__Vector lower = kai__vector_splat(0x20);
+    while (start + KAI__VECTOR_SIZE <= end) {
+        Kai__Vector v = kai__vector_load(data + start);
+        Kai__Vector ident = kai__vector_or(
+            kai__vector_or(kai__vector_in_range(v, '0', '9'), kai__vector_in_range(kai__vector_or(v, lower), 'a', 'z')),
+            kai__vector_or(kai__vector_equals(v, underscore), kai__vector_in_range(v, 0x80, 0xFF)));
+        Kai_u64 stop = kai__vector_mask(ident) ^ KAI__VECTOR_ALL;
+        if (stop) return start + (kai_intrinsics_ctz64(stop) >> KAI__VECTOR_MASK_SHIFT);
+        start += KAI__VECTOR_SIZE;
+    }
+#endif
+    while (start < end) {
+        Kai_u8 c = data[start];
+        if (!((c >= '0' && c <= '9') || ((c | 0x20) >= 'a' && (c | 0x20) <= 'z') || c == '_' || c >= 0x80))
+            break;
+        start += 1;
+    }
+    return start;
+}
+
+// Stops at any of the bytes a, b, c or d (repeat a byte to look for fewer)
+static inline Kai_u32 kai_intrinsics_find_any4(Kai_u8 const* data, Kai_u32 start, Kai_u32 end, Kai_u8 a, Kai_u8 b, Kai_u8 c, Kai_u8 d)
+{
+#if defined(KAI__VECTOR_SIZE)
+    Kai__Vector va = kai__vector_splat(a), vb = kai__vector_splat(b);
+    Kai__Vector vc = kai__vector_splat(c), vd = kai__vector_splat(d);
+    while (start + KAI__VECTOR_SIZE <= end) {
+        Kai__Vector v = kai__vector_load(data + start);
+        Kai_u64 stop = kai__vector_mask(kai__vector_or(
+            kai__vector_or(kai__vector_equals(v, va), kai__vector_equals(v, vb)),
+            kai__vector_or(kai__vector_equals(v, vc), kai__vector_equals(v, vd))));
+        if (stop) return start + (kai_intrinsics_ctz64(stop) >> KAI__VECTOR_MASK_SHIFT);
+        start += KAI__VECTOR_SIZE;
+    }
+#endif
+    while (start < end) {
+        Kai_u8 x = data[start];
+        if (x == a || x == b || x == c || x == d)
+            break;
+        start += 1;
+    }
+    return start;
+}
+
 // TODO: only dev builds
 #if defined(KAI_PLATFORM_APPLE) || defined(KAI_PLATFORM_LINUX)
 #include "execinfo.h"
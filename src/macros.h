@@ -97,6 +97,7 @@ do {
     while (kai_raw_table_next_match((Kai_Raw_Hash_Table*)(T), __hash__, &__index__))                       \
         if (kai_ ## K ## _equals(KEY, (T)->keys[__index__]))                                               \
             break;                                                                                         \
+        else __index__ += 1; /* hash collision, keep probing */                                            \
     (T)->keys[__index__] = KEY;                                                                            \
     (T)->values[__index__] = __VA_ARGS__;                                                                  \
 } while(0)
@@ -24,4 +24,5 @@ int main()
     assert_true(type_info->bits == 32);
 
     assert_true(*value == 369);
+    kai_source_unmap(&sources[0]);
 }
\ No newline at end of file
@@ -29,4 +29,5 @@ int main()
     Kai_s32* value = (Kai_s32*)ptr;
     assert_true(value != NULL);
     assert_true(*value == 3);
+    kai_source_unmap(&sources[0]);
 }
\ No newline at end of file
@@ -28,4 +28,5 @@ int main()
     Kai_f32* value = (Kai_f32*)ptr;
     assert_true(value != NULL);
     assert_true(*value == 4.0f);
+    kai_source_unmap(&sources[0]);
 }
\ No newline at end of file
@@ -21,4 +21,5 @@ int main()
 
     check_procedure(&program, KAI_STRING("ceil_div"));
     check_procedure(&program, KAI_STRING("ceil_div_fast"));
+    kai_source_unmap(&sources[0]);
 }
\ No newline at end of file
@@ -22,4 +22,5 @@ int main()
 //    assert_true(type != NULL);
 //    assert_true(ptr != NULL);
 //    assert_true(type->id == KAI_TYPE_ID_PROCEDURE);
+    kai_source_unmap(&sources[0]);
 }
\ No newline at end of file
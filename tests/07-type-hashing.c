@@ -86,7 +86,7 @@ int main()
 
             printf("Type ");
             write_type(type);
-            printf(" at (types.kai:%u)\n", stmt->line_number);
+            printf(" at (types.kai:%u)\n", kai_source_line(&tree->source, stmt->offset));
 
             printf("Type ");
             write_type(hashes.data[index].type);
@@ -94,8 +94,9 @@ int main()
 
             FAIL("Found a duplicate hash: %016llX", hash);
         }
-        slice_insert(&hashes, index, (Hash){hash, stmt->line_number, type});
+        slice_insert(&hashes, index, (Hash){hash, kai_source_line(&tree->source, stmt->offset), type});
 
         stmt = stmt->next;
     }
+    kai_source_unmap(&sources[0]);
 }
\ No newline at end of file
@@ -0,0 +1,129 @@
+#include "test.h"
+
+void* find_integer(Kai_Program* program, Kai_string name, Kai_u8 bits)
+{
+    Kai_Type type = NULL;
+    void* ptr = kai_find_variable(program, name, &type);
+    assert_true(ptr != NULL);
+    assert_true(type != NULL);
+    assert_true(type->id == KAI_TYPE_ID_INTEGER);
+    assert_true(((Kai_Type_Info_Integer*)type)->bits == bits);
+    return ptr;
+}
+
+// Words emitted since the last check, compared against their encodings
+static void assert_words(Kai_Assembler* assembler, Kai_u32* words, Kai_u32 count)
+{
+    assert_true(assembler->code.count == count);
+    assert_true(memcmp(assembler->code.data, words, count * sizeof(Kai_u32)) == 0);
+    assembler->code.count = 0;
+}
+
+#define ASSERT_WORDS(...) do { Kai_u32 w[] = { __VA_ARGS__ }; assert_words(&assembler, w, sizeof(w) / 4); } while (0)
+
+int main()
+{
+    Kai_Program program = {0};
+    Kai_Source sources[] = { load_source_file("scripts/intrinsics.kai") };
+    Kai_Program_Create_Info info = {
+        .allocator = default_allocator(),
+        .error = default_error(),
+        .sources = MAKE_SLICE(sources),
+		.options = { .flags = KAI_COMPILE_NO_CODE_GEN },
+    };
+    kai_create_program(&info, &program);
+    assert_no_error();
+
+    assert_true(*(Kai_u32*)find_integer(&program, KAI_STRING("leading_zeros"), 32) == 24);
+    assert_true(*(Kai_u32*)find_integer(&program, KAI_STRING("trailing_zeros"), 32) == 4);
+    assert_true(*(Kai_u32*)find_integer(&program, KAI_STRING("empty_zeros"), 32) == 16);
+    assert_true(*(Kai_u32*)find_integer(&program, KAI_STRING("bit_count"), 32) == 32);
+    assert_true(*(Kai_u64*)find_integer(&program, KAI_STRING("swapped"), 64) == 0xEFCDAB8967452301);
+    assert_true(*(Kai_u64*)find_integer(&program, KAI_STRING("rotated"), 64) == 0x3456789ABCDEF012);
+    assert_true(*(Kai_u16*)find_integer(&program, KAI_STRING("swapped_short"), 16) == 0x3412);
+    assert_true(*(Kai_u32*)find_integer(&program, KAI_STRING("rotated_word"), 32) == 0x0000000F);
+    assert_true(*(Kai_u64*)find_integer(&program, KAI_STRING("high"), 64) == 0x14B66DC33F6AC);
+
+    assert_true(kai_find_variable(&program, KAI_STRING("count_bits"), NULL) != NULL);
+    assert_true(kai_find_variable(&program, KAI_STRING("copy"), NULL) != NULL);
+    kai_source_unmap(&sources[0]);
+
+    // Every intrinsic assembled on its own, no arm64 host needed to check the words
+    Kai_Allocator base = default_allocator();
+    Kai_Allocator* allocator = &base;
+    Kai_Assembler assembler = { .backend = KAI_BACKEND_ARM64, .allocator = allocator };
+
+    kai_asm_insert_count_leading_zeros(&assembler, 3, 8);
+    ASSERT_WORDS(0x53001C63, 0x5AC01063, 0x51006063); // uxtb w3, w3, clz w3, w3, sub w3, w3, #24
+    kai_asm_insert_count_leading_zeros(&assembler, 3, 16);
+    ASSERT_WORDS(0x53003C63, 0x5AC01063, 0x51004063); // uxth w3, w3, clz w3, w3, sub w3, w3, #16
+    kai_asm_insert_count_leading_zeros(&assembler, 3, 32);
+    ASSERT_WORDS(0x5AC01063); // clz w3, w3
+    kai_asm_insert_count_leading_zeros(&assembler, 3, 64);
+    ASSERT_WORDS(0xDAC01063); // clz x3, x3
+
+    kai_asm_insert_count_trailing_zeros(&assembler, 3, 8);
+    ASSERT_WORDS(0x32180063, 0x5AC00063, 0x5AC01063); // orr w3, w3, #0x100, rbit w3, w3, clz w3, w3
+    kai_asm_insert_count_trailing_zeros(&assembler, 3, 16);
+    ASSERT_WORDS(0x32100063, 0x5AC00063, 0x5AC01063); // orr w3, w3, #0x10000, rbit w3, w3, clz w3, w3
+    kai_asm_insert_count_trailing_zeros(&assembler, 3, 32);
+    ASSERT_WORDS(0x5AC00063, 0x5AC01063); // rbit w3, w3, clz w3, w3
+    kai_asm_insert_count_trailing_zeros(&assembler, 3, 64);
+    ASSERT_WORDS(0xDAC00063, 0xDAC01063); // rbit x3, x3, clz x3, x3
+
+    // fmov to the vector unit, cnt v0.8b, addv b0, v0.8b, fmov w3, s0
+    kai_asm_insert_popcount(&assembler, 3, 8);
+    ASSERT_WORDS(0x53001C63, 0x1E270060, 0x0E205800, 0x0E31B800, 0x1E260003);
+    kai_asm_insert_popcount(&assembler, 3, 16);
+    ASSERT_WORDS(0x53003C63, 0x1E270060, 0x0E205800, 0x0E31B800, 0x1E260003);
+    kai_asm_insert_popcount(&assembler, 3, 32);
+    ASSERT_WORDS(0x1E270060, 0x0E205800, 0x0E31B800, 0x1E260003); // fmov s0, w3
+    kai_asm_insert_popcount(&assembler, 3, 64);
+    ASSERT_WORDS(0x9E670060, 0x0E205800, 0x0E31B800, 0x1E260003); // fmov d0, x3
+
+    kai_asm_insert_byte_swap(&assembler, 3, 8);
+    assert_true(assembler.code.count == 0); // a single byte is its own swap
+    kai_asm_insert_byte_swap(&assembler, 3, 16);
+    ASSERT_WORDS(0x53003C63, 0x5AC00463); // uxth w3, w3, rev16 w3, w3
+    kai_asm_insert_byte_swap(&assembler, 3, 32);
+    ASSERT_WORDS(0x5AC00863); // rev w3, w3
+    kai_asm_insert_byte_swap(&assembler, 3, 64);
+    ASSERT_WORDS(0xDAC00C63); // rev x3, x3
+
+    // Rotate right by the negated shift
+    kai_asm_insert_rotate_left(&assembler, 0, 1, 2, 32);
+    ASSERT_WORDS(0x4B0203E2, 0x1AC22C20); // neg w2, w2, ror w0, w1, w2
+    kai_asm_insert_rotate_left(&assembler, 0, 1, 2, 64);
+    ASSERT_WORDS(0xCB0203E2, 0x9AC22C20); // neg x2, x2, ror x0, x1, x2
+
+    kai_asm_insert_multiply_high(&assembler, 0, 1, 2);
+    ASSERT_WORDS(0x9BC27C20); // umulh x0, x1, x2
+
+    kai_asm_insert_memory_copy(&assembler, 0, 1, 2);
+    ASSERT_WORDS(
+        0xB40000A2, // cbz x2, end (+5)
+        0x38401423, // loop: ldrb w3, [x1], #1
+        0x38001403, // strb w3, [x0], #1
+        0xF1000442, // subs x2, x2, #1
+        0x54FFFFA1  // b.ne loop (-3)
+    );
+    kai_asm_insert_memory_set(&assembler, 0, 1, 2);
+    ASSERT_WORDS(
+        0xB4000082, // cbz x2, end (+4)
+        0x38001401, // loop: strb w1, [x0], #1
+        0xF1000442, // subs x2, x2, #1
+        0x54FFFFC1  // b.ne loop (-2)
+    );
+    kai_array_destroy(&assembler.code);
+
+    // The same words come out of a compiled procedure
+    Kai_Program_Create_Info code_info = { .allocator = readable_code_allocator() };
+    Kai_Program swap = {0};
+    assert_true(compile_script("#export f :: (x: u64) -> u64 { ret bswap(x); }", &code_info, &swap).result == KAI_SUCCESS);
+    Kai_u32 swap_words[] = { 0xF84003E0, 0xDAC00C00, 0xD65F03C0 }; // ldur x0, [sp], rev x0, x0, ret
+    Kai_u32 word_count;
+    Kai_u32* words = procedure_words(&swap, "f", &word_count);
+    assert_true(word_count == sizeof(swap_words) / 4);
+    assert_true(memcmp(words, swap_words, sizeof(swap_words)) == 0);
+    kai_destroy_program(&swap);
+}
@@ -0,0 +1,199 @@
+#include "test.h"
+
+int main()
+{
+    Kai_Program program = {0};
+    Kai_Compile_Statistics statistics = {0};
+    Kai_Source sources[] = { load_source_file("scripts/if-case.kai") };
+    Kai_Program_Create_Info info = {
+        .allocator = default_allocator(),
+        .error = default_error(),
+        .sources = MAKE_SLICE(sources),
+        .statistics = &statistics,
+    };
+    kai_create_program(&info, &program);
+    assert_no_error();
+
+    assert_true(kai_find_procedure(&program, KAI_STRING("opcode_size"), (Kai_string){0}) != NULL);
+    assert_true(kai_find_procedure(&program, KAI_STRING("port_kind"), (Kai_string){0}) != NULL);
+    assert_true(statistics.jump_table_count == 1 && statistics.compare_tree_count == 1);
+
+    // Dense values are a jump table, sparse values or fewer than 4 are a tree of compares
+    const char* lowerings[] = {
+        "f :: (x: s32) -> s32 { if x == { case 10; ret 1; case 11; ret 2; case 12; ret 3; case 13; ret 4; } ret 0; }",
+        "f :: (x: u8) -> u32 { if x == { case 100; ret 1; case 101; ret 2; case 103; ret 3; case 107; ret 4; case; ret 5; } ret 0; }",
+        "f :: (x: u32) -> u32 { if x == { case 0; ret 1; case 1; ret 2; case 2; ret 3; } ret 0; }",
+        "f :: (x: u32) -> u32 { if x == { case 0; ret 1; case 2; ret 2; case 4; ret 3; case 8; ret 4; } ret 0; }",
+        "f :: (x: s64) -> u32 { if x == { case 1000; ret 1; case 5; ret 2; case 1000000; ret 3; case 7; ret 4; } ret 0; }",
+    };
+    Kai_u32 expected_tables[] = { 1, 1, 0, 0, 0 };
+    Kai_Source lowering_sources[] = {{ .name = KAI_CONST_STRING("lowering") }};
+    info.sources = (Kai_Source_Slice)MAKE_SLICE(lowering_sources);
+    for (int k = 0; k < 5; ++k) {
+        lowering_sources[0].contents = kai_string_from_c(lowerings[k]);
+        Kai_Program lowered = {0};
+        kai_create_program(&info, &lowered);
+        assert_no_error();
+        assert_true(statistics.jump_table_count == expected_tables[k]);
+        assert_true(statistics.compare_tree_count == 1 - expected_tables[k]);
+        kai_destroy_program(&lowered);
+    }
+    info.statistics = NULL;
+
+    // Words of a jump table: extend, bounds check to the end, then each entry is the byte
+    // offset of a case body from the table, and bodies that do not fall through jump to the end
+    Kai_Program_Create_Info code_info = { .allocator = readable_code_allocator() };
+    Kai_Program dense = {0};
+    assert_true(compile_script("#export f :: (x: u32) -> u32 { if x == { case 10; ret 1; case 11; ret 2; case 12; ret 3; case 13; ret 4; } ret 0; }",
+        &code_info, &dense).result == KAI_SUCCESS);
+    Kai_u32 dense_words[] = {
+        0xF84003E0, // ldur x0, [sp]
+        0xD3407C00, // uxtw x0, w0
+        0x52800141, // mov w1, #10
+        0xCB010000, // sub x0, x0, x1
+        0x52800081, // mov w1, #4
+        0xEB01001F, // cmp x0, x1
+        0x54000282, // b.cs end (+20)
+        0x10000081, // adr x1, table (+16 bytes)
+        0xB8A07822, // ldrsw x2, [x1, x0, lsl #2]
+        0x8B020021, // add x1, x1, x2
+        0xD61F0020, // br x1
+        0x10, 0x1C, 0x28, 0x34, // table
+        0x52800020, 0xD65F03C0, 0x5400012E, // case 10: ret 1, b end (+9)
+        0x52800040, 0xD65F03C0, 0x540000CE, // case 11: ret 2, b end (+6)
+        0x52800060, 0xD65F03C0, 0x5400006E, // case 12: ret 3, b end (+3)
+        0x52800080, 0xD65F03C0,             // case 13: ret 4
+        0x52800000, 0xD65F03C0,             // end: ret 0
+    };
+    Kai_u32 word_count;
+    Kai_u32* words = procedure_words(&dense, "f", &word_count);
+    assert_true(word_count == sizeof(dense_words) / 4);
+    assert_true(memcmp(words, dense_words, sizeof(dense_words)) == 0);
+    kai_destroy_program(&dense);
+
+    // Words of a compare tree on a signed value: split on the middle value with an unsigned
+    // or signed less than, leaves compare each value and jump to the default (the end)
+    Kai_Program sparse = {0};
+    assert_true(compile_script("#export f :: (x: s16) -> u32 { if x == { case 1; ret 1; case 100; ret 2; case 1000; ret 3; case 10000; ret 4; } ret 0; }",
+        &code_info, &sparse).result == KAI_SUCCESS);
+    Kai_u32 sparse_words[] = {
+        0xF84003E0, // ldur x0, [sp]
+        0x93403C00, // sxth x0, w0
+        0x52807D01, 0xEB01001F, 0x54000260, // mov w1, #1000, cmp x0, x1, b.eq case 1000 (+19)
+        0x540000AB,                         // b.lt left (+5)
+        0x5284E201, 0xEB01001F, 0x54000240, // mov w1, #10000, cmp x0, x1, b.eq case 10000 (+18)
+        0x5400026E,                         // b end (+19)
+        0x52800021, 0xEB01001F, 0x540000A0, // left: mov w1, #1, cmp x0, x1, b.eq case 1 (+5)
+        0x52800C81, 0xEB01001F, 0x540000A0, // mov w1, #100, cmp x0, x1, b.eq case 100 (+5)
+        0x5400018E,                         // b end (+12)
+        0x52800020, 0xD65F03C0, 0x5400012E, // case 1: ret 1, b end (+9)
+        0x52800040, 0xD65F03C0, 0x540000CE, // case 100: ret 2, b end (+6)
+        0x52800060, 0xD65F03C0, 0x5400006E, // case 1000: ret 3, b end (+3)
+        0x52800080, 0xD65F03C0,             // case 10000: ret 4
+        0x52800000, 0xD65F03C0,             // end: ret 0
+    };
+    words = procedure_words(&sparse, "f", &word_count);
+    assert_true(word_count == sizeof(sparse_words) / 4);
+    assert_true(memcmp(words, sparse_words, sizeof(sparse_words)) == 0);
+    kai_destroy_program(&sparse);
+
+    // Duplicate case values are an error
+    Kai_Error error = {0};
+    Kai_Program duplicate = {0};
+    Kai_Source duplicate_sources[] = {{
+        .name = KAI_CONST_STRING("duplicate"),
+        .contents = KAI_CONST_STRING("f :: (x: u32) -> u32 { if x == { case 1; ret 1; case 1; ret 2; } ret 0; }"),
+    }};
+    info.error = &error;
+    info.sources = (Kai_Source_Slice)MAKE_SLICE(duplicate_sources);
+    kai_create_program(&info, &duplicate);
+    assert_true(error.result != KAI_SUCCESS);
+
+    // Cases on a string are type-checked without code too
+    Kai_Source string_sources[] = {{
+        .name = KAI_CONST_STRING("string"),
+        .contents = KAI_CONST_STRING(
+            "f :: (s: string) -> u32 {\n"
+            "    if s == { case \"add\"; ret 1; case \"sub\"; #through; case \"neg\"; ret 2; case; ret 0; }\n"
+            "    ret 0;\n"
+            "}"
+        ),
+    }};
+    info.sources = (Kai_Source_Slice)MAKE_SLICE(string_sources);
+    info.options.flags = KAI_COMPILE_NO_CODE_GEN;
+    error = (Kai_Error){0};
+    Kai_Program strings = {0};
+    kai_create_program(&info, &strings);
+    assert_true(error.result == KAI_SUCCESS);
+
+    info.options.flags = 0;
+    kai_create_program(&info, &strings);
+    assert_true(error.result == KAI_SUCCESS);
+    kai_destroy_program(&strings);
+
+    // Words of a string if-case: the hash (2*c(1)) % 3 of "add", "sub", "neg" is 2, 0, 1 and selects
+    // an entry of the table, each entry compares the length and the bytes against a copy of its value
+    code_info.statistics = &statistics;
+    assert_true(compile_script("#export f :: (s: string) -> u32 { if s == { case \"add\"; ret 1; case \"sub\"; #through; case \"neg\"; ret 2; case; ret 0; } ret 3; }",
+        &code_info, &strings).result == KAI_SUCCESS);
+    assert_true(statistics.jump_table_count == 1 && statistics.compare_tree_count == 0);
+    Kai_u32 string_words[] = {
+        0xF84003E0, // ldur x0, [sp]
+        0xAA0103E7, // mov x7, x1
+        0x52800002, 0xF100041F, 0x54000049, 0x394004E2, // mov w2, #0, cmp x0, #1, b.ls (+2), ldrb w2, [x7, #1]
+        0x52800003, 0xF100041F, 0x54000049, 0x394004E3, // mov w3, #0, cmp x0, #1, b.ls (+2), ldrb w3, [x7, #1]
+        0x52800005, 0x9B050C04, // mov w5, #0, madd x4, x0, x5, x3
+        0x52800025, 0x9B051044, // mov w5, #1, madd x4, x2, x5, x4
+        0x52800065, 0x9AC50886, 0x9B0590C4, // mov w5, #3, udiv x6, x4, x5, msub x4, x6, x5, x4
+        0x10000081, 0xB8A47822, 0x8B020021, 0xD61F0020, // adr x1, table, ldrsw x2, [x1, x4, lsl #2], add x1, x1, x2, br x1
+        0x48, 0x84, 0x0C, // table: "sub", "neg", "add"
+        0x52800062, 0xEB02001F, 0x54000181, // "add": mov w2, #3, cmp x0, x2, b.ne next (+12)
+        0x10000143, 0xAA0703E4, 0x52800065, // adr x3, "add" (+10), mov x4, x7, mov w5, #3
+        0x38401462, 0x38401486, 0xEB06005F, 0x540000A1, // loop: ldrb w2, [x3], #1, ldrb w6, [x4], #1, cmp x2, x6, b.ne next (+5)
+        0xF10004A5, 0x54FFFF61, // subs x5, x5, #1, b.ne loop (-5)
+        0x5400042E, 0x00646461, // b case "add" (+33), "add"
+        0x540004AE,             // next: b default (+37)
+        0x52800062, 0xEB02001F, 0x54000181, 0x10000143, 0xAA0703E4, 0x52800065, // "sub"
+        0x38401462, 0x38401486, 0xEB06005F, 0x540000A1, 0xF10004A5, 0x54FFFF61,
+        0x540002AE, 0x00627573, 0x540002CE,
+        0x52800062, 0xEB02001F, 0x54000181, 0x10000143, 0xAA0703E4, 0x52800065, // "neg"
+        0x38401462, 0x38401486, 0xEB06005F, 0x540000A1, 0xF10004A5, 0x54FFFF61,
+        0x540000CE, 0x0067656E, 0x540000EE,
+        0x52800020, 0xD65F03C0, 0x540000CE, // case "add": ret 1, b end (+6)
+        0x52800040, 0xD65F03C0, 0x5400006E, // case "sub", "neg": ret 2, b end (+3)
+        0x52800000, 0xD65F03C0,             // default: ret 0
+        0x52800060, 0xD65F03C0,             // end: ret 3
+    };
+    words = procedure_words(&strings, "f", &word_count);
+    assert_true(word_count == sizeof(string_words) / 4);
+    assert_true(memcmp(words, string_words, sizeof(string_words)) == 0);
+    kai_destroy_program(&strings);
+
+    // Values no hash separates (same length, same first 8 bytes) are compared one after another,
+    // an empty value only compares the length
+    assert_true(compile_script("#export f :: (s: string) -> u32 { if s == { case \"longer_prefix_a\"; ret 1; case \"longer_prefix_b\"; ret 2; case \"\"; ret 3; } ret 0; }",
+        &code_info, &strings).result == KAI_SUCCESS);
+    assert_true(statistics.jump_table_count == 0 && statistics.compare_tree_count == 1);
+    words = procedure_words(&strings, "f", &word_count);
+    assert_true(word_count == 51);
+    assert_true(words[14] == 0x5400036E && words[31] == 0x540001AE); // b case (+27), b case (+13)
+    assert_true(words[15] == 0x676E6F6C && words[18] == 0x00615F78); // "long", "x_a"
+    Kai_u32 empty_words[] = { 0x52800002, 0xEB02001F, 0x54000041, 0x5400010E, 0x5400012E }; // mov w2, #0, cmp x0, x2, b.ne (+2), b case (+8), b end (+9)
+    assert_true(memcmp(words + 36, empty_words, sizeof(empty_words)) == 0);
+    kai_destroy_program(&strings);
+    code_info.statistics = NULL;
+
+    const char* bad_string_cases[] = {
+        "f :: (s: string) -> u32 { if s == { case \"a\"; ret 1; case \"a\"; ret 2; } ret 0; }",
+        "f :: (s: string) -> u32 { if s == { case \"a\"; ret 1; case 2; ret 2; } ret 0; }",
+        "f :: (s: string) -> u32 { if s == { case \"a\"; ret \"b\"; } ret 0; }",
+    };
+    info.options.flags = KAI_COMPILE_NO_CODE_GEN;
+    for (int k = 0; k < 3; ++k) {
+        string_sources[0].contents = kai_string_from_c(bad_string_cases[k]);
+        error = (Kai_Error){0};
+        kai_create_program(&info, &strings);
+        assert_true(error.result != KAI_SUCCESS);
+    }
+    kai_source_unmap(&sources[0]);
+}
@@ -0,0 +1,51 @@
+#include "test.h"
+
+int main()
+{
+    Kai_Program program = {0};
+    Kai_Source sources[] = { load_source_file("scripts/polymorphic.kai") };
+    Kai_Compile_Statistics statistics = {0};
+    Kai_Program_Create_Info info = {
+        .allocator = default_allocator(),
+        .error = default_error(),
+        .sources = MAKE_SLICE(sources),
+        .statistics = &statistics,
+    };
+    kai_create_program(&info, &program);
+    assert_no_error();
+
+    // maximum for u32 (called three times), maximum for s64 and load for u16
+    assert_true(statistics.instance_count == 3);
+
+    assert_true(kai_find_procedure(&program, KAI_STRING("max_u32"), (Kai_string){0}) != NULL);
+    assert_true(kai_find_procedure(&program, KAI_STRING("max_s64"), (Kai_string){0}) != NULL);
+    assert_true(kai_find_procedure(&program, KAI_STRING("max3_u32"), (Kai_string){0}) != NULL);
+    assert_true(kai_find_procedure(&program, KAI_STRING("load_u16"), (Kai_string){0}) != NULL);
+
+    // The same from a compact tree, where declarations are expanded when they are compiled
+    Kai_Program compact = {0};
+    info.options.flags = KAI_COMPILE_COMPACT_TREES;
+    kai_create_program(&info, &compact);
+    assert_no_error();
+    assert_true(kai_find_procedure(&compact, KAI_STRING("max_u32"), (Kai_string){0}) != NULL);
+    assert_true(kai_find_procedure(&compact, KAI_STRING("max3_u32"), (Kai_string){0}) != NULL);
+    assert_true(statistics.instance_count == 3);
+    kai_destroy_program(&compact);
+    info.options.flags = 0;
+
+    // Both arguments must bind to the same type
+    Kai_Error error = {0};
+    Kai_Program mismatch = {0};
+    Kai_Source mismatch_sources[] = {{
+        .name = KAI_CONST_STRING("mismatch"),
+        .contents = KAI_CONST_STRING(
+            "same :: (a: $T, b: T) -> T { ret a; }\n"
+            "f :: (a: u32, b: s64) -> u32 { ret same(a, b); }"
+        ),
+    }};
+    info.error = &error;
+    info.sources = (Kai_Source_Slice)MAKE_SLICE(mismatch_sources);
+    kai_create_program(&info, &mismatch);
+    assert_true(error.result != KAI_SUCCESS);
+    kai_source_unmap(&sources[0]);
+}
@@ -0,0 +1,55 @@
+#include "test.h"
+
+// Declarations in reverse dependency order are the worst case for dependency resolution:
+// every declaration refers to the one after it.
+#define DECLARATION_COUNT 100000
+
+static Kai_Allocator counted_base;
+static Kai_s64 live_bytes;
+static Kai_s64 most_bytes;
+
+static void* counted_heap_allocate(void* user, void* ptr, Kai_u32 new_size, Kai_u32 old_size)
+{
+    live_bytes += (Kai_s64)new_size - (Kai_s64)old_size;
+    if (live_bytes > most_bytes) most_bytes = live_bytes;
+    return counted_base.heap_allocate(user, ptr, new_size, old_size);
+}
+
+int main()
+{
+    String_Builder builder = {0};
+    sb_append_cstr(&builder, "#export d0 : u32 : d1 + 1;\n");
+    for (int i = 1; i < DECLARATION_COUNT - 1; ++i)
+        sb_appendf(&builder, "d%i : u32 : d%i + 1;\n", i, i + 1);
+    sb_appendf(&builder, "d%i : u32 : 1;\n", DECLARATION_COUNT - 1);
+
+    Kai_Program program = {0};
+    Kai_Source sources[] = {{
+        .name = KAI_CONST_STRING("many-declarations"),
+        .contents = { .data = (Kai_u8*)builder.items, .count = (Kai_u32)builder.count },
+    }};
+    counted_base = default_allocator();
+    Kai_Allocator allocator = counted_base;
+    allocator.heap_allocate = counted_heap_allocate;
+    Kai_Program_Create_Info info = {
+        .allocator = allocator,
+        .error = default_error(),
+        .sources = MAKE_SLICE(sources),
+        .options = { .flags = KAI_COMPILE_NO_CODE_GEN },
+    };
+    uint64_t start = nanos_since_unspecified_epoch();
+    kai_create_program(&info, &program);
+    uint64_t end = nanos_since_unspecified_epoch();
+    assert_no_error();
+
+    Kai_Type type = NULL;
+    Kai_u32* d0 = kai_find_variable(&program, KAI_STRING("d0"), &type);
+    assert_true(d0 != NULL);
+    assert_true(*d0 == DECLARATION_COUNT);
+
+    printf("    %i declarations in %.1f ms, %.1f MB at most\n", DECLARATION_COUNT, (double)(end - start) * 1e-6,
+        (double)most_bytes / (1 << 20));
+
+    // Blocked attempts are rolled back, so memory grows with the declarations and not with the retries
+    assert_true(most_bytes < 1536 * DECLARATION_COUNT); // about 1 KB now
+}
@@ -0,0 +1,60 @@
+#include "test.h"
+
+static int count_cycles(Kai_Error* error)
+{
+    int count = 0;
+    for (; error != NULL; error = error->next)
+        if (error->result == KAI_ERROR_SEMANTIC) count += 1;
+    return count;
+}
+
+int main()
+{
+    // Every cycle is reported, nodes that only depend on a cycle are not
+    Kai_Error error = compile_script(
+        "a : u32 : b + 1;\n"
+        "b : u32 : c;\n"
+        "c : u32 : a;\n"
+        "d : u32 : 4;\n"
+        "x : u32 : x;\n"
+        "p : u32 : q;\n"
+        "q : u32 : p;\n"
+        "r : u32 : p;\n",
+        NULL, NULL);
+    assert_true(error.result == KAI_ERROR_SEMANTIC);
+    assert_true(count_cycles(&error) == 3);
+
+    // Names longer than everything else in the messages, with another cycle after them
+    String_Builder long_name = {0};
+    for (int i = 0; i < 5000; ++i) da_append(&long_name, 'n');
+    String_Builder script = {0};
+    sb_appendf(&script, "%.*s : u32 : y;\ny : u32 : %.*s;\nz : u32 : z;\n",
+        (int)long_name.count, long_name.items, (int)long_name.count, long_name.items);
+    error = compile_script(script.items, NULL, NULL);
+    assert_true(count_cycles(&error) == 2);
+    int infos = 0;
+    for (Kai_Error* e = &error; e != NULL; e = e->next) {
+        Kai_string prefix = KAI_STRING("detected circular dependency on \"");
+        if (e->result == KAI_ERROR_SEMANTIC) {
+            assert_true(e->message.count > prefix.count && memcmp(e->message.data, prefix.data, prefix.count) == 0);
+        }
+        else {
+            assert_true(e->result == KAI_ERROR_INFO);
+            infos += 1;
+        }
+        assert_true(e->location.line >= 1 && e->location.line <= 3);
+        assert_true(e->location.string.count == (e->location.line == 1 ? 5000u : 1u));
+    }
+    assert_true(infos == 3);
+    sb_free(script);
+    sb_free(long_name);
+
+    // One large cycle
+    String_Builder builder = {0};
+    int count = 100000;
+    for (int i = 0; i < count; ++i)
+        sb_appendf(&builder, "d%i : u32 : d%i + 1;\n", i, (i + 1) % count);
+    error = compile_script(builder.items, NULL, NULL);
+    assert_true(error.result == KAI_ERROR_SEMANTIC);
+    assert_true(count_cycles(&error) == 1);
+}
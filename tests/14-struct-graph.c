@@ -0,0 +1,54 @@
+#include "test.h"
+
+// Structs are declared in reverse order, each pointing to the next one,
+// so every struct blocks on its first field before it can be completed.
+#define STRUCT_COUNT  500
+#define STRUCT_FIELDS 16
+
+static Kai_Allocator base;
+static Kai_u64 current_bytes, peak_bytes;
+
+static void* peak_heap_allocate(void* user, void* ptr, Kai_u32 new_size, Kai_u32 old_size)
+{
+    current_bytes += new_size;
+    current_bytes -= old_size;
+    if (current_bytes > peak_bytes) peak_bytes = current_bytes;
+    return base.heap_allocate(user, ptr, new_size, old_size);
+}
+
+int main()
+{
+    String_Builder builder = {0};
+    for (int i = 0; i < STRUCT_COUNT; ++i)
+    {
+        sb_appendf(&builder, "S%i :: struct {\n", i);
+        if (i + 1 < STRUCT_COUNT)
+            sb_appendf(&builder, "    next: *S%i;\n", i + 1);
+        for (int k = 0; k < STRUCT_FIELDS; ++k)
+            sb_appendf(&builder, "    f%i: u%i;\n", k, 8 << (k % 4));
+        sb_append_cstr(&builder, "}\n");
+    }
+
+    base = default_allocator();
+    Kai_Allocator allocator = base;
+    allocator.heap_allocate = peak_heap_allocate;
+
+    Kai_Program program = {0};
+    Kai_Source sources[] = {{
+        .name = KAI_CONST_STRING("struct-graph"),
+        .contents = { .data = (Kai_u8*)builder.items, .count = (Kai_u32)builder.count },
+    }};
+    Kai_Program_Create_Info info = {
+        .allocator = allocator,
+        .error = default_error(),
+        .sources = MAKE_SLICE(sources),
+        .options = { .flags = KAI_COMPILE_NO_CODE_GEN },
+    };
+    uint64_t start = nanos_since_unspecified_epoch();
+    kai_create_program(&info, &program);
+    uint64_t end = nanos_since_unspecified_epoch();
+    assert_no_error();
+
+    printf("    %i structs in %.1f ms, peak memory %llu KiB\n", STRUCT_COUNT,
+        (double)(end - start) * 1e-6, (unsigned long long)(peak_bytes / 1024));
+}
@@ -0,0 +1,93 @@
+#include "test.h"
+
+// Procedure bodies compiled on host threads must give the same program as a serial compile
+#define PROCEDURE_COUNT 4000
+#define WORKER_COUNT    8
+
+static double compile(const char* script, Kai_Job_System* jobs, Kai_Error* error, Kai_Program* program)
+{
+    Kai_Program_Create_Info info = {
+        .allocator = locked_allocator(),
+        .options = { .worker_count = WORKER_COUNT },
+        .jobs = jobs,
+    };
+    uint64_t start = nanos_since_unspecified_epoch();
+    *error = compile_script(script, &info, program);
+    return (double)(nanos_since_unspecified_epoch() - start) * 1e-6;
+}
+
+// Machine code is mapped execute-only
+static void make_readable(Kai_u8_Slice code)
+{
+    Kai_u64 page = (Kai_u64)code.data & ~(Kai_u64)4095;
+    mprotect((void*)page, (Kai_u64)code.data + code.count - page, PROT_READ);
+}
+
+int main()
+{
+    Kai_Job_System jobs = { .dispatch = thread_dispatch };
+
+    String_Builder builder = {0};
+    sb_append_cstr(&builder,
+        "maximum :: (a: $T, b: T) -> T\n"
+        "{\n"
+        "    if a > b ret a;\n"
+        "    ret b;\n"
+        "}\n");
+    for (int i = 0; i < PROCEDURE_COUNT; ++i)
+    {
+        if (i % 2 == 0)
+            sb_appendf(&builder,
+                "#export\n"
+                "p%i :: (a: u32, b: u32) -> u32\n"
+                "{\n"
+                "    c: u32 = a * %i + b;\n"
+                "    if c > %i ret maximum(c, a);\n"
+                "    ret c - b;\n"
+                "}\n", i, i % 7 + 1, i);
+        else
+            sb_appendf(&builder,
+                "#export\n"
+                "p%i :: (a: s64, b: s64) -> s64\n"
+                "{\n"
+                "    c: s64 = a - b * %i;\n"
+                "    ret maximum(c, b);\n"
+                "}\n", i, i % 5 + 1);
+    }
+    Kai_Error serial_error = {0}, parallel_error = {0};
+    Kai_Program serial = {0}, parallel = {0};
+    double serial_ms = compile(builder.items, NULL, &serial_error, &serial);
+    double parallel_ms = compile(builder.items, &jobs, &parallel_error, &parallel);
+    assert_true(serial_error.result == KAI_SUCCESS);
+    assert_true(parallel_error.result == KAI_SUCCESS);
+
+    // Same code in the same order, and exports point at the same procedures
+    make_readable(serial.code);
+    make_readable(parallel.code);
+    assert_true(serial.code.count == parallel.code.count);
+    assert_true(memcmp(serial.code.data, parallel.code.data, serial.code.count) == 0);
+    for (int i = 0; i < PROCEDURE_COUNT; i += 97)
+    {
+        Kai_string name = kai_string_from_c(temp_sprintf("p%i", i));
+        Kai_u8* a = kai_find_procedure(&serial, name, (Kai_string){0});
+        Kai_u8* b = kai_find_procedure(&parallel, name, (Kai_string){0});
+        assert_true(a != NULL && b != NULL);
+        assert_true(a - serial.code.data == b - parallel.code.data);
+    }
+
+    // The first error in declaration order is reported, whichever worker finds it
+    const char* errors =
+        "a :: (x: u32) -> u32 { ret x; }\n"
+        "b :: (x: u32) -> u32 { ret y; }\n"
+        "c :: (x: u32) -> u32 { ret x; }\n"
+        "d :: (x: u32) -> u32 { ret z; }\n";
+    compile(errors, NULL, &serial_error, &serial);
+    compile(errors, &jobs, &parallel_error, &parallel);
+    assert_true(serial_error.result != KAI_SUCCESS);
+    assert_true(parallel_error.result == serial_error.result);
+    assert_true(parallel_error.location.line == 2);
+    assert_true(kai_string_equals(parallel_error.message, serial_error.message));
+
+    printf("    %i procedures: serial %.1f ms, %i workers %.1f ms\n",
+        PROCEDURE_COUNT, serial_ms, WORKER_COUNT, parallel_ms);
+}
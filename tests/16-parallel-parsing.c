@@ -0,0 +1,82 @@
+#include "test.h"
+
+// Every source is parsed by a host thread, errors are reported in source order
+#define SOURCE_COUNT       200
+#define DECLARATIONS       200
+#define WORKER_COUNT       8
+
+static Kai_Job_System jobs = { .dispatch = thread_dispatch };
+
+static Kai_Result parse(Kai_Source* sources, Kai_u32 count, Kai_Job_System* job_system, Kai_Error* error, Kai_Program* program, double* ms)
+{
+    Kai_Program_Create_Info info = {
+        .allocator = locked_allocator(),
+        .error = error,
+        .sources = { .data = sources, .count = count },
+        .options = { .flags = KAI_COMPILE_NO_CODE_GEN, .worker_count = WORKER_COUNT },
+        .jobs = job_system,
+    };
+    uint64_t start = nanos_since_unspecified_epoch();
+    Kai_Result result = kai_create_program(&info, program);
+    if (ms) *ms = (double)(nanos_since_unspecified_epoch() - start) * 1e-6;
+    return result;
+}
+
+static Kai_u32 statement_count(Kai_Syntax_Tree* tree)
+{
+    Kai_u32 count = 0;
+    for (Kai_Stmt* it = tree->root.head; it != NULL; it = it->next) count += 1;
+    return count;
+}
+
+int main()
+{
+    Kai_Source sources[SOURCE_COUNT];
+    for (int s = 0; s < SOURCE_COUNT; ++s)
+    {
+        String_Builder builder = {0};
+        for (int i = 0; i < DECLARATIONS; ++i)
+            sb_appendf(&builder, "s%i_d%i :: %i * (%i + 1);\n", s, i, s, i);
+        sources[s] = (Kai_Source){
+            .name = kai_string_from_c(temp_sprintf("source-%i", s)),
+            .contents = { .data = (Kai_u8*)builder.items, .count = (Kai_u32)builder.count },
+        };
+    }
+
+    Kai_Error serial_error = {0}, parallel_error = {0};
+    Kai_Program serial = {0}, parallel = {0};
+    double serial_ms = 0, parallel_ms = 0;
+    parse(sources, SOURCE_COUNT, NULL, &serial_error, &serial, &serial_ms);
+    parse(sources, SOURCE_COUNT, &jobs, &parallel_error, &parallel, &parallel_ms);
+    assert_true(serial_error.result == KAI_SUCCESS);
+    assert_true(parallel_error.result == KAI_SUCCESS);
+
+    // One tree per source, in source order
+    assert_true(parallel.trees.count == SOURCE_COUNT);
+    for (int s = 0; s < SOURCE_COUNT; ++s)
+    {
+        assert_true(kai_string_equals(parallel.trees.data[s].source.name, sources[s].name));
+        assert_true(kai_string_equals(serial.trees.data[s].source.name, sources[s].name));
+        assert_true(statement_count(&parallel.trees.data[s]) == DECLARATIONS);
+    }
+
+    // Syntax errors in two sources, the first one wins in both modes
+    Kai_Source broken[] = {
+        { .name = KAI_CONST_STRING("ok-0"),  .contents = KAI_CONST_STRING("a :: 1;\n") },
+        { .name = KAI_CONST_STRING("bad-1"), .contents = KAI_CONST_STRING("b :: 2;\nc :: ;\n") },
+        { .name = KAI_CONST_STRING("ok-2"),  .contents = KAI_CONST_STRING("d :: 3;\n") },
+        { .name = KAI_CONST_STRING("bad-3"), .contents = KAI_CONST_STRING("e :: (;\n") },
+    };
+    serial_error = (Kai_Error){0};
+    parallel_error = (Kai_Error){0};
+    parse(broken, 4, NULL, &serial_error, &serial, NULL);
+    parse(broken, 4, &jobs, &parallel_error, &parallel, NULL);
+    assert_true(serial_error.result == KAI_ERROR_SYNTAX);
+    assert_true(parallel_error.result == KAI_ERROR_SYNTAX);
+    assert_true(kai_string_equals(parallel_error.location.source.name, KAI_STRING("bad-1")));
+    assert_true(parallel_error.location.line == serial_error.location.line);
+    assert_true(kai_string_equals(parallel_error.message, serial_error.message));
+
+    printf("    %i sources: serial %.1f ms, %i workers %.1f ms\n",
+        SOURCE_COUNT, serial_ms, WORKER_COUNT, parallel_ms);
+}
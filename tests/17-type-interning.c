@@ -0,0 +1,100 @@
+#include "test.h"
+
+// Every structural type is interned once, so types compare by pointer,
+// also between programs that are created with the same type table.
+static const char* script =
+    "#export A   :: struct { x: s32; }\n"
+    "#export B   :: struct { x: s32; }\n"
+    "#export pa  :: *A;\n"
+    "#export pb  :: *B;\n"
+    "#export p0  :: *s64;\n"
+    "#export p1  :: *s64;\n"
+    "#export pp  :: **s64;\n"
+    "#export q0  :: #proc (*s64, u8) -> f32;\n"
+    "#export q1  :: #proc (*s64, u8) -> f32;\n"
+    "#export q2  :: #proc (*s64, u16) -> f32;\n"
+    "#export a4  :: [4] u32;\n"
+    "#export a4b :: [4] u32;\n"
+    "#export a8  :: [8] u32;\n"
+    "#export s   :: string;\n"
+    "#export i   :: s32;\n";
+
+static Kai_Type get_type(Kai_Program* program, const char* name)
+{
+    Kai_Type type = NULL;
+    Kai_Type* value = (Kai_Type*)kai_find_variable(program,
+        (Kai_string){ .data = (Kai_u8*)name, .count = (Kai_u32)strlen(name) }, &type);
+    if (value == NULL) FAIL("\"%s\" not found", name);
+    assert_true(type != NULL && type->id == KAI_TYPE_ID_TYPE);
+    assert_true(*value != NULL);
+    return *value;
+}
+
+static void create_program(Kai_Program* program, Kai_Type_Table* types)
+{
+    Kai_Source sources[] = {{
+        .name = KAI_CONST_STRING("interning"),
+        .contents = { .data = (Kai_u8*)script, .count = (Kai_u32)strlen(script) },
+    }};
+    Kai_Program_Create_Info info = {
+        .allocator = default_allocator(),
+        .error = default_error(),
+        .sources = MAKE_SLICE(sources),
+        .options = { .flags = KAI_COMPILE_NO_CODE_GEN },
+        .types = types,
+    };
+    kai_create_program(&info, program);
+    assert_no_error();
+}
+
+int main()
+{
+    Kai_Allocator allocator = default_allocator();
+    Kai_Type_Table types = {0};
+    kai_create_type_table(&types, &allocator);
+
+    Kai_Program first = {0};
+    create_program(&first, &types);
+
+    // Same structure => same pointer
+    assert_true(get_type(&first, "p0") == get_type(&first, "p1"));
+    assert_true(get_type(&first, "q0") == get_type(&first, "q1"));
+    assert_true(get_type(&first, "a4") == get_type(&first, "a4b"));
+    assert_true(((Kai_Type_Info_Pointer*)get_type(&first, "pp"))->sub_type == get_type(&first, "p0"));
+
+    // Different structure => different pointer
+    assert_true(get_type(&first, "q0") != get_type(&first, "q2"));
+    assert_true(get_type(&first, "a4") != get_type(&first, "a8"));
+    assert_true(kai_hash_type(get_type(&first, "a4")) != kai_hash_type(get_type(&first, "a8")));
+
+    // Structs are nominal, even with the same fields
+    assert_true(get_type(&first, "A") != get_type(&first, "B"));
+    assert_true(get_type(&first, "pa") != get_type(&first, "pb"));
+    assert_true(((Kai_Type_Info_Pointer*)get_type(&first, "pb"))->sub_type == get_type(&first, "B"));
+
+    // Stored hash is the structural hash
+    Kai_Type p0 = get_type(&first, "p0");
+    assert_true(kai_hash_type(p0) == kai__compute_type_hash(p0));
+
+    // A second program with the same table gets the same types
+    Kai_Program second = {0};
+    Kai_u32 type_count = types.types.count;
+    create_program(&second, &types);
+    assert_true(types.types.count == type_count + 2); // only new: *A, *B
+    assert_true(get_type(&first, "p0") == get_type(&second, "p0"));
+    assert_true(get_type(&first, "q0") == get_type(&second, "q1"));
+    assert_true(get_type(&first, "a8") == get_type(&second, "a8"));
+    assert_true(get_type(&first, "s")  == get_type(&second, "s"));
+    assert_true(get_type(&first, "A")  != get_type(&second, "A"));
+
+    // Builtins are static, so they are the same even without a shared table
+    Kai_Program third = {0};
+    create_program(&third, NULL);
+    assert_true(get_type(&first, "i") == get_type(&third, "i"));
+    assert_true(get_type(&first, "p0") != get_type(&third, "p0"));
+
+    kai_destroy_program(&third);
+    kai_destroy_program(&second);
+    kai_destroy_program(&first);
+    kai_destroy_type_table(&types);
+}
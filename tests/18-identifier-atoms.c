@@ -0,0 +1,77 @@
+#include "test.h"
+
+// Identifiers are interned by the tokenizer, so equal names have equal atoms
+static const char* script =
+    "a :: 1;\n"
+    "b :: a + a;\n"
+    "main :: (x: s32) -> s32 {\n"
+    "    for i: 0..<x { a; }\n"
+    "    ret x + b;\n"
+    "}\n";
+
+static Kai_u32 atom_of(Kai_Atom_Table* atoms, const char* name)
+{
+    Kai_string s = { .data = (Kai_u8*)name, .count = (Kai_u32)strlen(name) };
+    Kai_int index = kai_table_find(string, &atoms->atoms, s);
+    assert_true(index != -1);
+    return atoms->atoms.values[index];
+}
+
+int main()
+{
+    Kai_Allocator allocator = default_allocator();
+    Kai_Atom_Table atoms = {0};
+    kai_create_atom_table(&atoms, &allocator);
+
+    Kai_Syntax_Tree tree = {0};
+    Kai_Syntax_Tree_Create_Info info = {
+        .source = {
+            .name = KAI_CONST_STRING("atoms"),
+            .contents = { .data = (Kai_u8*)script, .count = (Kai_u32)strlen(script) },
+        },
+        .allocator = allocator,
+        .error = default_error(),
+        .atoms = &atoms,
+    };
+    kai_create_syntax_tree(&info, &tree);
+    assert_no_error();
+
+    // a, b, main, x, s32, i
+    assert_true(atoms.names.count == 7);
+    assert_true(kai_string_equals(atoms.names.data[0], KAI_STRING("")));
+    assert_true(kai_intern_atom(&atoms, KAI_STRING("")) == 0);
+
+    Kai_Stmt_Declaration* a = (Kai_Stmt_Declaration*)tree.root.head;
+    Kai_Stmt_Declaration* b = (Kai_Stmt_Declaration*)a->next;
+    Kai_Stmt_Declaration* m = (Kai_Stmt_Declaration*)b->next;
+    assert_true(a->name_atom == atom_of(&atoms, "a"));
+    assert_true(b->name_atom == atom_of(&atoms, "b"));
+    assert_true(m->name_atom == atom_of(&atoms, "main"));
+
+    Kai_Expr_Binary* sum = (Kai_Expr_Binary*)b->value;
+    assert_true(sum->left->id == KAI_EXPR_IDENTIFIER && sum->left->atom == a->name_atom);
+    assert_true(sum->right->atom == a->name_atom);
+
+    Kai_Expr_Procedure* proc = (Kai_Expr_Procedure*)m->value;
+    assert_true(proc->in_out_expr->name_atom == atom_of(&atoms, "x"));
+    assert_true(proc->in_out_expr->atom == atom_of(&atoms, "s32"));
+
+    Kai_Stmt_For* loop = (Kai_Stmt_For*)((Kai_Stmt_Compound*)proc->body)->head;
+    assert_true(loop->id == KAI_STMT_FOR);
+    assert_true(loop->iterator_atom == atom_of(&atoms, "i"));
+
+    // Interning a name that was already seen gives back the same atom
+    assert_true(kai_intern_atom(&atoms, KAI_STRING("main")) == m->name_atom);
+    assert_true(kai_intern_atom(&atoms, KAI_STRING("other")) == 7);
+
+    // Without a table identifiers are not interned
+    Kai_Syntax_Tree plain = {0};
+    info.atoms = NULL;
+    kai_create_syntax_tree(&info, &plain);
+    assert_no_error();
+    assert_true(((Kai_Stmt*)plain.root.head)->name_atom == 0);
+
+    kai_destroy_syntax_tree(&plain);
+    kai_destroy_syntax_tree(&tree);
+    kai_destroy_atom_table(&atoms);
+}
@@ -0,0 +1,36 @@
+#include "test.h"
+
+// Every scope binds into one symbol table, leaving a scope must bring back
+// whatever its names shadowed.
+#define DEPTH 200
+
+int main()
+{
+    // Each level shadows `x` with another type, only the outermost `x` is a number
+    String_Builder builder = {0};
+    sb_append_cstr(&builder, "#export\ndeep :: (a: s32) -> s32 {\n    x: s32 = a;\n");
+    for (int i = 0; i < DEPTH; ++i)
+        sb_appendf(&builder, "{ x: bool = a > %i; y%i: s32 = a; \n", i, i);
+    sb_append_cstr(&builder, "if x ret a + y0;\n");
+    for (int i = 0; i < DEPTH; ++i)
+        sb_append_cstr(&builder, "}\n");
+    sb_append_cstr(&builder,
+        "    for i: 0..<3 { x: bool = i > 1; }\n"
+        "    ret x + 1;\n"
+        "}\n");
+    sb_append_null(&builder);
+
+    Kai_Program program = {0};
+    assert_true(compile_script(builder.items, NULL, &program).result == KAI_SUCCESS);
+    assert_true(kai_find_procedure(&program, KAI_STRING("deep"), (Kai_string){0}) != NULL);
+
+    // Names do not outlive their block
+    Kai_Program leaked = {0};
+    assert_true(compile_script("f :: (a: s32) -> s32 { { b: s32 = a; } ret b; }", NULL, &leaked).result != KAI_SUCCESS);
+
+    // Redefinition is only an error within the same scope
+    Kai_Program twice = {0};
+    assert_true(compile_script("a :: 1; a :: 2;", NULL, &twice).result != KAI_SUCCESS);
+    Kai_Program inner = {0};
+    assert_true(compile_script("a :: 1; f :: (a: s32) -> s32 { ret a; }", NULL, &inner).result == KAI_SUCCESS);
+}
@@ -0,0 +1,80 @@
+#include "test.h"
+
+// With KAI_COMPILE_REACHABLE_ONLY only exports (and names the host asks for)
+// and what they depend on are compiled, everything else is only parsed.
+static const char* script =
+    "#export\n"
+    "area :: (w: s32, h: s32) -> s32 { ret scale(w) * h; }\n"
+    "scale :: (x: s32) -> s32 { ret x * factor; }\n"
+    "factor :: 2;\n"
+    "unused_a :: (x: s32) -> s32 { ret x + unused_b; }\n"
+    "unused_b :: 3;\n"
+    "broken :: (x: s32) -> s32 { ret missing(x); }\n"
+    "wanted : s32 : 7;\n";
+
+static Kai_Result compile(Kai_Compile_Flags flags, Kai_Job_System* jobs, Kai_string_Slice exports,
+    Kai_Compile_Statistics* statistics, Kai_Program* program)
+{
+    Kai_Program_Create_Info info = {
+        .allocator = locked_allocator(),
+        .exports = exports,
+        .options = { .flags = flags, .worker_count = 2 },
+        .jobs = jobs,
+        .statistics = statistics,
+    };
+    return compile_script(script, &info, program).result;
+}
+
+int main()
+{
+    Kai_Job_System jobs = { .dispatch = thread_dispatch };
+    Kai_Compile_Statistics statistics = {0};
+
+    // Everything is compiled by default, so the broken procedure is an error
+    Kai_Program full = {0};
+    assert_true(compile(0, NULL, (Kai_string_Slice){0}, &statistics, &full) != KAI_SUCCESS);
+
+    // Serial, parallel and type-check only compiles skip the same declarations
+    Kai_Compile_Flags modes[] = { 0, 0, KAI_COMPILE_NO_CODE_GEN };
+    Kai_Job_System* mode_jobs[] = { NULL, &jobs, NULL };
+    for (int i = 0; i < 3; ++i)
+    {
+        Kai_Program program = {0};
+        assert_true(compile(KAI_COMPILE_REACHABLE_ONLY | modes[i], mode_jobs[i],
+            (Kai_string_Slice){0}, &statistics, &program) == KAI_SUCCESS);
+        assert_true(statistics.declaration_count == 7);
+        assert_true(statistics.skipped_count == 4); // unused_a, unused_b, broken, wanted
+        assert_true(kai_find_procedure(&program, KAI_STRING("area"), (Kai_string){0}) != NULL);
+        assert_true(kai_find_variable(&program, KAI_STRING("wanted"), NULL) == NULL);
+    }
+
+    // Names the host looks up are compiled and exported
+    Kai_string names[] = { KAI_CONST_STRING("wanted"), KAI_CONST_STRING("unused_a") };
+    Kai_Program program = {0};
+    assert_true(compile(KAI_COMPILE_REACHABLE_ONLY, &jobs, (Kai_string_Slice)MAKE_SLICE(names),
+        &statistics, &program) == KAI_SUCCESS);
+    assert_true(statistics.skipped_count == 1); // broken
+    Kai_Type type = NULL;
+    Kai_s32* wanted = kai_find_variable(&program, KAI_STRING("wanted"), &type);
+    assert_true(wanted != NULL && type->id == KAI_TYPE_ID_INTEGER);
+    assert_true(*wanted == 7);
+    assert_true(kai_find_procedure(&program, KAI_STRING("unused_a"), (Kai_string){0}) != NULL);
+    kai_destroy_program(&program);
+
+    // Compact trees only expand the declarations that are compiled
+    for (int i = 0; i < 2; ++i)
+    {
+        Kai_Program compact = {0};
+        assert_true(compile(KAI_COMPILE_REACHABLE_ONLY | KAI_COMPILE_COMPACT_TREES, mode_jobs[i],
+            (Kai_string_Slice)MAKE_SLICE(names), &statistics, &compact) == KAI_SUCCESS);
+        assert_true(statistics.declaration_count == 7);
+        assert_true(statistics.skipped_count == 1 && statistics.expanded_count == 6);
+        wanted = kai_find_variable(&compact, KAI_STRING("wanted"), &type);
+        assert_true(wanted != NULL && *wanted == 7);
+        assert_true(kai_find_procedure(&compact, KAI_STRING("area"), (Kai_string){0}) != NULL);
+        kai_destroy_program(&compact);
+    }
+    Kai_Program compact = {0};
+    assert_true(compile(KAI_COMPILE_COMPACT_TREES, &jobs, (Kai_string_Slice){0}, &statistics, &compact) != KAI_SUCCESS);
+    kai_destroy_program(&compact);
+}
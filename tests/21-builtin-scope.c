@@ -0,0 +1,49 @@
+#include "test.h"
+
+// Builtin types and the global scope they are declared in are static,
+// so every program starts from the same snapshot without building it.
+#define PROGRAM_COUNT 2000
+
+static Kai_Type get_type(Kai_Program* program, const char* name)
+{
+    Kai_Type* value = (Kai_Type*)kai_find_variable(program, kai_string_from_c(name), NULL);
+    assert_true(value != NULL);
+    return *value;
+}
+
+int main()
+{
+    static const char* script =
+        "#export s  :: string;\n"
+        "#export p  :: *u8;\n"
+        "#export pp :: **u8;\n"
+        "#export f  :: (s32: u8) -> u8 { ret s32; }\n";
+
+    Kai_Program first = {0};
+    assert_true(compile_script(script, NULL, &first).result == KAI_SUCCESS);
+
+    // *u8 is the type of string.data in every program
+    Kai_Type_Info_Struct* s = (Kai_Type_Info_Struct*)get_type(&first, "s");
+    assert_true(s->id == KAI_TYPE_ID_STRING && s->fields.count == 2);
+    assert_true(s->fields.data[1].type == get_type(&first, "p"));
+    assert_true(kai_hash_type(get_type(&first, "p")) == kai__compute_type_hash(get_type(&first, "p")));
+    assert_true(((Kai_Type_Info_Pointer*)get_type(&first, "pp"))->sub_type == get_type(&first, "p"));
+
+    uint64_t start = nanos_since_unspecified_epoch();
+    for (int i = 0; i < PROGRAM_COUNT; ++i)
+    {
+        Kai_Program program = {0};
+        assert_true(compile_script(script, NULL, &program).result == KAI_SUCCESS);
+        assert_true(get_type(&program, "s") == (Kai_Type)s);
+        assert_true(get_type(&program, "p") == get_type(&first, "p"));
+        kai_destroy_program(&program);
+    }
+    double ms = (double)(nanos_since_unspecified_epoch() - start) * 1e-6;
+
+    // Builtins belong to the global scope
+    Kai_Program twice = {0};
+    assert_true(compile_script("s32 :: u8;", NULL, &twice).result != KAI_SUCCESS);
+
+    printf("    %i programs: %.3f ms each\n", PROGRAM_COUNT, ms / PROGRAM_COUNT);
+    kai_destroy_program(&first);
+}
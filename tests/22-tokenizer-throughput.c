@@ -0,0 +1,103 @@
+#include "test.h"
+
+// The tokenizer skips whitespace, identifiers, comments and string contents
+// a vector at a time, the scans must agree with a plain byte loop.
+#define GENERATED_SIZE (32 << 20)
+
+static Kai_u32 reference_skip_whitespace(Kai_u8 const* data, Kai_u32 i, Kai_u32 end)
+{
+    while (i < end && data[i] <= ' ' && data[i] != '\n' && data[i] != '\r') ++i;
+    return i;
+}
+
+static Kai_u32 reference_skip_identifier(Kai_u8 const* data, Kai_u32 i, Kai_u32 end)
+{
+    while (i < end && (isalnum(data[i]) || data[i] == '_' || data[i] >= 0x80)) ++i;
+    return i;
+}
+
+static Kai_u32 reference_find_any4(Kai_u8 const* data, Kai_u32 i, Kai_u32 end, Kai_u8 a, Kai_u8 b, Kai_u8 c, Kai_u8 d)
+{
+    while (i < end && data[i] != a && data[i] != b && data[i] != c && data[i] != d) ++i;
+    return i;
+}
+
+static Kai_Arena_Allocator string_arena;
+
+static Kai_Tokenizer tokenizer_for(String_Builder* source)
+{
+    if (string_arena.current_bucket == NULL) {
+        Kai_Allocator allocator = default_allocator();
+        kai_arena_create(&string_arena, &allocator);
+    }
+    return (Kai_Tokenizer){
+        .source = { .data = (Kai_u8*)source->items, .count = (Kai_u32)source->count },
+        .string_arena = &string_arena,
+    };
+}
+
+int main()
+{
+    // Runs of every length at every position, over a mix of bytes that stop each scan
+    static const Kai_u8 alphabet[] = " \t\n\r\x01\x7f\x80\xff_azAZ09@[`{/*\"\\";
+    Kai_u8 data[256];
+    srand(1234);
+    for (int trial = 0; trial < 20000; ++trial)
+    {
+        Kai_u32 stop = (Kai_u32)(rand() % 160);
+        for (int i = 0; i < 256; ++i)
+            data[i] = (i < (int)stop) ? "  \tab_Z9\x80"[rand() % 9] : alphabet[rand() % (sizeof(alphabet) - 1)];
+        Kai_u32 start = (Kai_u32)(rand() % 32);
+        Kai_u32 end = start + (Kai_u32)(rand() % (256 - start));
+        assert_true(kai_intrinsics_skip_whitespace(data, start, end) == reference_skip_whitespace(data, start, end));
+        assert_true(kai_intrinsics_skip_identifier(data, start, end) == reference_skip_identifier(data, start, end));
+        assert_true(kai_intrinsics_find_any4(data, start, end, '/', '*', '\r', '\n')
+            == reference_find_any4(data, start, end, '/', '*', '\r', '\n'));
+    }
+
+    // Tokens and line numbers around long runs
+    String_Builder source = {0};
+    sb_append_cstr(&source,
+        "                                        name_that_is_longer_than_thirty_two_bytes\n"
+        "/* a comment that spans\n   more than one line /* and nests */ */ after\n"
+        "\"a string that is long enough to cover two vectors \\\"quoted\\\" \\n end\"\n"
+        "// line comment that is also quite a bit longer than thirty two bytes\r\n"
+        "\t\t\tlast");
+    Kai_Tokenizer tokenizer = tokenizer_for(&source);
+    Kai_Source lines = { .contents = tokenizer.source };
+    Kai_Token* token = kai_tokenizer_next(&tokenizer);
+    assert_true(token->id == KAI_TOKEN_IDENTIFIER && kai_source_line(&lines, token->offset) == 1);
+    assert_true(kai_string_equals(token->string, KAI_STRING("name_that_is_longer_than_thirty_two_bytes")));
+    token = kai_tokenizer_next(&tokenizer);
+    assert_true(token->id == KAI_TOKEN_IDENTIFIER && kai_source_line(&lines, token->offset) == 3);
+    assert_true(kai_string_equals(token->string, KAI_STRING("after")));
+    token = kai_tokenizer_next(&tokenizer);
+    assert_true(token->id == KAI_TOKEN_STRING && kai_source_line(&lines, token->offset) == 4);
+    assert_true(kai_string_equals(token->value.string,
+        KAI_STRING("a string that is long enough to cover two vectors \"quoted\" \n end")));
+    token = kai_tokenizer_next(&tokenizer);
+    assert_true(token->id == KAI_TOKEN_IDENTIFIER && kai_source_line(&lines, token->offset) == 6);
+    assert_true(kai_string_equals(token->string, KAI_STRING("last")));
+    assert_true(kai_tokenizer_next(&tokenizer)->id == KAI_TOKEN_END);
+
+    // Throughput on a large generated data script
+    source.count = 0;
+    for (int i = 0; source.count < GENERATED_SIZE; ++i)
+        sb_appendf(&source,
+            "// generated record %i, do not edit\n"
+            "record_%i :: Record.{\n"
+            "    identifier_name = \"record number %i with some text\",\n"
+            "    value           = %i,\n"
+            "    /* weight */ scaled_weight = value * 3 + offset_%i;\n"
+            "};\n", i, i, i, i * 7, i % 13);
+    tokenizer = tokenizer_for(&source);
+    Kai_u32 token_count = 0;
+    uint64_t begin = nanos_since_unspecified_epoch();
+    while (kai_tokenizer_next(&tokenizer)->id != KAI_TOKEN_END)
+        token_count += 1;
+    double seconds = (double)(nanos_since_unspecified_epoch() - begin) * 1e-9;
+    assert_true(tokenizer.cursor >= source.count);
+
+    printf("    %.1f MB, %u tokens: %.0f MB/s\n",
+        (double)source.count / (1 << 20), token_count, (double)source.count / (1 << 20) / seconds);
+}
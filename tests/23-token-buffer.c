@@ -0,0 +1,171 @@
+#include "test.h"
+
+// A source tokenized once into a token buffer parses the same as reading
+// tokens straight from the source, and any token can be looked at again.
+static const char* script =
+    "Vec :: struct { x: f32; y: f32; }\n"
+    "name :: \"a \\\"quoted\\\" string\";\n"
+    "#export main :: (a: s32, b: s32) -> s32 {\n"
+    "    v: Vec;\n"
+    "    for i: 0..<a { b += i * 0x10; }\n"
+    "    ret a + b; // sum\n"
+    "}\n";
+
+static void assert_same_tokens(Kai_Token a, Kai_Token b)
+{
+    assert_true(a.id == b.id);
+    assert_true(a.offset == b.offset);
+    assert_true(a.atom == b.atom);
+    assert_true(kai_string_equals(a.string, b.string));
+    if (a.id == KAI_TOKEN_STRING || a.id == KAI_TOKEN_DIRECTIVE || a.id == KAI_TOKEN_TAG)
+        assert_true(kai_string_equals(a.value.string, b.value.string));
+    if (a.id == KAI_TOKEN_NUMBER)
+        assert_true(memcmp(&a.value.number, &b.value.number, sizeof(Kai_Number)) == 0);
+}
+
+static void assert_same_expr(Kai_Expr* a, Kai_Expr* b);
+
+static void assert_same_stmt(Kai_Stmt* a, Kai_Stmt* b)
+{
+    for (; a != NULL && b != NULL; a = a->next, b = b->next)
+        assert_same_expr(a, b);
+    assert_true(a == NULL && b == NULL);
+}
+
+static void assert_same_expr(Kai_Expr* a, Kai_Expr* b)
+{
+    assert_true((a == NULL) == (b == NULL));
+    if (a == NULL) return;
+    assert_true(a->id == b->id);
+    assert_true(a->offset == b->offset);
+    assert_true(a->atom == b->atom && a->name_atom == b->name_atom);
+    assert_true(kai_string_equals(a->source_code, b->source_code));
+    switch (a->id)
+    {
+    case KAI_EXPR_STRING:
+        assert_true(kai_string_equals(((Kai_Expr_String*)a)->value, ((Kai_Expr_String*)b)->value));
+        break;
+    case KAI_EXPR_BINARY:
+        assert_same_expr(((Kai_Expr_Binary*)a)->left, ((Kai_Expr_Binary*)b)->left);
+        assert_same_expr(((Kai_Expr_Binary*)a)->right, ((Kai_Expr_Binary*)b)->right);
+        break;
+    case KAI_EXPR_PROCEDURE:
+        assert_same_stmt(((Kai_Expr_Procedure*)a)->in_out_expr, ((Kai_Expr_Procedure*)b)->in_out_expr);
+        assert_same_stmt(((Kai_Expr_Procedure*)a)->body, ((Kai_Expr_Procedure*)b)->body);
+        break;
+    case KAI_STMT_DECLARATION:
+        assert_same_expr(((Kai_Stmt_Declaration*)a)->type, ((Kai_Stmt_Declaration*)b)->type);
+        assert_same_expr(((Kai_Stmt_Declaration*)a)->value, ((Kai_Stmt_Declaration*)b)->value);
+        break;
+    case KAI_STMT_COMPOUND:
+        assert_same_stmt(((Kai_Stmt_Compound*)a)->head, ((Kai_Stmt_Compound*)b)->head);
+        break;
+    case KAI_STMT_FOR:
+        assert_same_expr(((Kai_Stmt_For*)a)->from, ((Kai_Stmt_For*)b)->from);
+        assert_same_expr(((Kai_Stmt_For*)a)->to, ((Kai_Stmt_For*)b)->to);
+        assert_same_stmt(((Kai_Stmt_For*)a)->body, ((Kai_Stmt_For*)b)->body);
+        break;
+    }
+}
+
+int main()
+{
+    Kai_Allocator allocator = default_allocator();
+    Kai_Atom_Table atoms = {0};
+    kai_create_atom_table(&atoms, &allocator);
+
+    Kai_string source = { .data = (Kai_u8*)script, .count = (Kai_u32)strlen(script) };
+    Kai_Token_Buffer buffer = {0};
+    kai_create_token_buffer(&buffer, &allocator);
+    kai_tokenize_source(&buffer, source, &atoms);
+
+    // Same tokens as the tokenizer makes by itself
+    Kai_Arena_Allocator string_arena = {0};
+    kai_arena_create(&string_arena, &allocator);
+    Kai_Tokenizer direct = {
+        .source = source,
+        .atoms = &atoms,
+        .string_arena = &string_arena,
+    };
+    Kai_u32 count = 0;
+    for (;;) {
+        Kai_Token token = kai_tokenizer_generate(&direct);
+        assert_same_tokens(token, kai_token_buffer_get(&buffer, count++));
+        if (token.id == KAI_TOKEN_END) break;
+    }
+    assert_true(buffer.ids.count == count);
+    assert_true(kai_token_buffer_get(&buffer, count + 100).id == KAI_TOKEN_END);
+
+    // Any distance ahead, also while peeking
+    Kai_Tokenizer reader = { .tokens = &buffer };
+    kai_tokenizer_next(&reader); // Vec
+    assert_true(kai_tokenizer_look_ahead(&reader, 1).id == ':');
+    assert_true(kai_tokenizer_look_ahead(&reader, 4).id == '{');
+    kai_tokenizer_peek(&reader);
+    assert_true(kai_tokenizer_look_ahead(&reader, 4).id == '{');
+    assert_true(kai_tokenizer_next(&reader)->id == ':');
+    assert_true(kai_tokenizer_look_ahead(&reader, 3).id == '{');
+    assert_true(kai_tokenizer_look_ahead(&reader, count).id == KAI_TOKEN_END);
+
+    // Parsing from the buffer gives the same tree
+    Kai_Syntax_Tree_Create_Info info = {
+        .source = { .name = KAI_CONST_STRING("token buffer"), .contents = source },
+        .allocator = allocator,
+        .error = default_error(),
+        .atoms = &atoms,
+    };
+    Kai_Syntax_Tree plain = {0};
+    kai_create_syntax_tree(&info, &plain);
+    assert_no_error();
+
+    info.tokens = &buffer;
+    Kai_Syntax_Tree buffered = {0};
+    kai_create_syntax_tree(&info, &buffered);
+    assert_no_error();
+    assert_same_expr((Kai_Expr*)&plain.root, (Kai_Expr*)&buffered.root);
+
+    // The buffer can be filled again without growing
+    Kai_u32 capacity = buffer.ids.capacity;
+    Kai_string smaller = { .data = source.data, .count = 40 };
+    kai_tokenize_source(&buffer, smaller, &atoms);
+    assert_true(buffer.ids.capacity == capacity);
+    assert_true(buffer.ids.count < count);
+    assert_true(buffer.source.count == 40);
+
+    // Escaped strings of the tree do not change when the buffer is filled again
+    kai_tokenize_source(&buffer, KAI_STRING("other :: \"\\t\\t\\t\\t\\t\\t\\t\\t\\t\\t\";"), &atoms);
+    assert_same_expr((Kai_Expr*)&plain.root, (Kai_Expr*)&buffered.root);
+
+    // Parse time of a large source, from the source and from the buffer
+    String_Builder large = {0};
+    for (int i = 0; large.count < (4 << 20); ++i)
+        sb_appendf(&large,
+            "add_%i :: (a: s32, b: s32) -> s32 { c := (a + %i) * b; ret c - (b >> 1); }\n"
+            "record_%i :: Record.{ name = \"record %i\", value = add_%i(%i, 3) };\n", i, i, i, i, i, i);
+    info.source.contents = (Kai_string){ .data = (Kai_u8*)large.items, .count = (Kai_u32)large.count };
+    info.tokens = NULL;
+    kai_reset_syntax_tree(&plain);
+    kai_create_syntax_tree(&info, &plain); // atoms and memory of the tree are made once
+    kai_reset_syntax_tree(&plain);
+    uint64_t begin = nanos_since_unspecified_epoch();
+    kai_create_syntax_tree(&info, &plain);
+    double plain_seconds = (double)(nanos_since_unspecified_epoch() - begin) * 1e-9;
+    assert_no_error();
+    kai_tokenize_source(&buffer, info.source.contents, &atoms);
+    info.tokens = &buffer;
+    kai_reset_syntax_tree(&buffered);
+    begin = nanos_since_unspecified_epoch();
+    kai_create_syntax_tree(&info, &buffered);
+    double buffered_seconds = (double)(nanos_since_unspecified_epoch() - begin) * 1e-9;
+    assert_no_error();
+    assert_same_expr((Kai_Expr*)&plain.root, (Kai_Expr*)&buffered.root);
+    printf("    %.1f MB, %u tokens: parsed from source in %.1f ms, from the buffer in %.1f ms\n",
+        (double)large.count / (1 << 20), buffer.ids.count, plain_seconds * 1e3, buffered_seconds * 1e3);
+    sb_free(large);
+
+    kai_arena_destroy(&string_arena);
+    kai_destroy_syntax_tree(&buffered);
+    kai_destroy_syntax_tree(&plain);
+    kai_destroy_token_buffer(&buffer);
+    kai_destroy_atom_table(&atoms);
+}
@@ -0,0 +1,108 @@
+#include "test.h"
+
+// Tokens and nodes only store byte offsets, lines and columns come from
+// the line table of the source.
+static void reference_position(Kai_string s, Kai_u32 offset, Kai_u32* line, Kai_u32* column)
+{
+    *line = 1;
+    *column = 1;
+    for (Kai_u32 i = 0; i < offset; ++i) {
+        if (s.data[i] == '\r' && i + 1 < offset && s.data[i + 1] == '\n') continue;
+        if (s.data[i] == '\n' || s.data[i] == '\r') {
+            *line += 1;
+            *column = 1;
+        }
+        else *column += 1;
+    }
+}
+
+static const char* script =
+    "a :: 1;\r\n"
+    "b :: 2;\r"
+    "/* comment\n\n */ c :: 3;\n"
+    "main :: () -> s32 {\n"
+    "    ret a + undeclared;\n"
+    "}\n";
+
+int main()
+{
+    // Every offset of random text with all kinds of line endings
+    Kai_u8 data[300];
+    Kai_u32 starts[301];
+    srand(4321);
+    for (int trial = 0; trial < 500; ++trial)
+    {
+        for (int i = 0; i < (int)sizeof(data); ++i)
+            data[i] = "ab \n\r\r\n"[rand() % 7];
+        Kai_Source source = { .contents = { .data = data, .count = (Kai_u32)(rand() % sizeof(data)) } };
+        Kai_Source plain = source;
+        Kai_u32 count = kai_find_line_starts(source.contents, NULL);
+        assert_true(kai_find_line_starts(source.contents, starts) == count);
+        source.line_starts.data = starts;
+        source.line_starts.count = count;
+
+        for (Kai_u32 offset = 0; offset <= source.contents.count; ++offset) {
+            if (offset > 0 && data[offset - 1] == '\r' && offset < source.contents.count && data[offset] == '\n')
+                continue; // inside a line ending
+            Kai_u32 line, column;
+            reference_position(source.contents, offset, &line, &column);
+            assert_true(kai_source_line(&source, offset) == line);
+            assert_true(kai_source_column(&source, offset) == column);
+            assert_true(kai_source_line(&plain, offset) == line);
+            assert_true(kai_source_column(&plain, offset) == column);
+        }
+    }
+
+    // Syntax trees keep the table, and nodes point into the source
+    Kai_Allocator allocator = default_allocator();
+    Kai_Syntax_Tree tree = {0};
+    Kai_Syntax_Tree_Create_Info tree_info = {
+        .source = {
+            .name = KAI_CONST_STRING("lines"),
+            .contents = { .data = (Kai_u8*)script, .count = (Kai_u32)strlen(script) },
+        },
+        .allocator = allocator,
+        .error = default_error(),
+    };
+    kai_create_syntax_tree(&tree_info, &tree);
+    assert_no_error();
+    assert_true(tree.source.line_starts.count == 9);
+    Kai_Stmt* a = tree.root.head;
+    Kai_Stmt* b = a->next;
+    Kai_Stmt* c = b->next;
+    assert_true(kai_source_line(&tree.source, a->offset) == 1);
+    assert_true(kai_source_line(&tree.source, b->offset) == 2);
+    assert_true(kai_source_line(&tree.source, c->offset) == 5);
+    assert_true(kai_source_column(&tree.source, c->offset) == 5);
+    kai_destroy_syntax_tree(&tree);
+
+    // Errors get their line from the table
+    Kai_Source sources[] = { tree_info.source };
+    Kai_Program program = {0};
+    Kai_Program_Create_Info info = {
+        .allocator = allocator,
+        .error = default_error(),
+        .sources = MAKE_SLICE(sources),
+        .options = { .flags = KAI_COMPILE_NO_CODE_GEN },
+    };
+    assert_true(kai_create_program(&info, &program) != KAI_SUCCESS);
+    assert_true(info.error->location.line == 7);
+    assert_true(kai_string_equals(info.error->location.string, KAI_STRING("undeclared")));
+    assert_true(info.error->location.source.line_starts.count == 9);
+    kai_write_error(default_writer(), info.error);
+    info.error->result = KAI_SUCCESS;
+
+    // Declarations find their line only for an error, on both sides of a redefinition
+    Kai_Error error = compile_script("a :: 1;\r\n\r\nb :: 2;\n\ta :: 3;", NULL, NULL);
+    assert_true(error.result == KAI_ERROR_SEMANTIC && error.location.line == 4);
+    assert_true(error.next != NULL && error.next->location.line == 1);
+    assert_true(kai_string_equals(error.next->location.string, KAI_STRING("a")));
+
+    // Broken syntax on the last line
+    tree_info.source.contents = KAI_STRING("x :: 1;\r\ny :: 2;\n\nz :: ;");
+    kai_create_syntax_tree(&tree_info, &tree);
+    assert_true(tree_info.error->result == KAI_ERROR_SYNTAX);
+    assert_true(tree_info.error->location.line == 4);
+    kai_write_error(default_writer(), tree_info.error);
+    tree_info.error->result = KAI_SUCCESS;
+}
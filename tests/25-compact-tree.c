@@ -0,0 +1,131 @@
+#include "test.h"
+
+// The compact tree keeps everything the syntax tree has, so it is written the same
+static const char* script_files[] = {
+    "scripts/simple.kai",
+    "scripts/simple-procedures.kai",
+    "scripts/simple-pointers.kai",
+    "scripts/if-case.kai",
+    "scripts/intrinsics.kai",
+    "scripts/polymorphic.kai",
+    "scripts/types.kai",
+};
+
+static const char* script =
+    "Point :: struct { x: f32; y: f32; } @tag(1, \"two\") @other\n"
+    "Color :: enum u8 { RED; GREEN = 2; }\n"
+    "#export main :: (n: s32) -> s32 {\n"
+    "    p: Point = .{x = 1.5, y = 2};\n"
+    "    a: [4] s32;\n"
+    "    for i: 0..<n { a[i % 4] += i; }\n"
+    "    while n > 0 { n -= 1; }\n"
+    "    if n == 0 ret -n; else ret cast(s32) p.x;\n"
+    "}\n";
+
+static Kai_string capture(Kai_Allocator* allocator, void (*write)(Kai_Writer*, void*), void* data)
+{
+    static Kai_Growing_Arena arena;
+    arena = (Kai_Growing_Arena){ .allocator = *allocator };
+    Kai_Writer writer = kai_writer_from_arena(&arena);
+    write(&writer, data);
+    return (Kai_string){ .data = arena.buffer.data, .count = arena.buffer.count };
+}
+
+static void write_pointer_tree(Kai_Writer* writer, void* tree) { kai_write_expression(writer, (Kai_Expr*)&((Kai_Syntax_Tree*)tree)->root, 0); }
+static void write_compact_tree(Kai_Writer* writer, void* tree) { kai_write_compact_tree(writer, tree); }
+static void write_syntax_tree(Kai_Writer* writer, void* tree) { kai_write_syntax_tree(writer, tree); }
+static void write_expression_0(Kai_Writer* writer, void* expr) { kai_write_expression(writer, expr, 0); }
+
+static void check_node(Kai_Compact_Tree* compact, Kai_u32 index, Kai_Expr* expr)
+{
+    Kai_Compact_Node* node = kai_compact_node(compact, index);
+    assert_true(node->id == expr->id && node->flags == expr->flags);
+    assert_true(kai_string_equals(kai_compact_source(compact, index), expr->source_code));
+    assert_true(kai_string_equals(kai_compact_name(compact, index), expr->name));
+    assert_true(node->name_atom == expr->name_atom);
+}
+
+// Expanded nodes are the same as the nodes the parser made
+static void check_expanded(Kai_Expr* a, Kai_Expr* b)
+{
+    assert_true(a->id == b->id && a->flags == b->flags && a->offset == b->offset);
+    assert_true(a->atom == b->atom && a->name_atom == b->name_atom);
+    assert_true(kai_string_equals(a->source_code, b->source_code));
+    assert_true(kai_string_equals(a->name, b->name));
+}
+
+static void check(Kai_Source source)
+{
+    Kai_Allocator allocator = default_allocator();
+    Kai_Atom_Table atoms = {0};
+    kai_create_atom_table(&atoms, &allocator);
+    Kai_Syntax_Tree tree = {0};
+    Kai_Syntax_Tree_Create_Info info = {
+        .source = source,
+        .allocator = allocator,
+        .error = default_error(),
+        .atoms = &atoms,
+    };
+    kai_create_syntax_tree(&info, &tree);
+    assert_no_error();
+
+    Kai_Compact_Tree compact = {0};
+    kai_create_compact_tree(&tree, &atoms, &allocator, &compact);
+    assert_true(kai_compact_node(&compact, 1)->id == KAI_STMT_COMPOUND);
+
+    // Statements are the children of the root, with the same atoms as the parser gave
+    Kai_u32 i = 0;
+    for (Kai_Stmt* stmt = tree.root.head; stmt != NULL; stmt = stmt->next)
+        check_node(&compact, kai_compact_child(&compact, 1, i++), stmt);
+    assert_true(kai_compact_node(&compact, 1)->child_count == i);
+
+    Kai_string expected = capture(&allocator, write_pointer_tree, &tree);
+    Kai_string got = capture(&allocator, write_compact_tree, &compact);
+    if (!kai_string_equals(expected, got)) {
+        printf("%.*s\n----\n%.*s\n", (int)expected.count, expected.data, (int)got.count, got.data);
+        FAIL("compact tree of \"%.*s\" is written differently", (int)source.name.count, source.name.data);
+    }
+    assert_true(kai_string_equals(expected, capture(&allocator, write_syntax_tree, &tree)));
+
+    // Parsing straight into a compact tree gives the same nodes, without a whole syntax tree
+    Kai_Compact_Tree parsed = {0};
+    assert_true(kai_parse_compact_tree(&info, &parsed) == KAI_SUCCESS);
+    assert_true(parsed.nodes.count == compact.nodes.count);
+    assert_true(memcmp(parsed.nodes.data, compact.nodes.data, compact.nodes.count * sizeof(Kai_Compact_Node)) == 0);
+    assert_true(parsed.string_data.count == compact.string_data.count);
+    assert_true(kai_string_equals(expected, capture(&allocator, write_compact_tree, &parsed)));
+    assert_true(parsed.source.line_starts.count == kai_source_line(&source, source.contents.count));
+
+    // Expanding gives back the syntax tree
+    Kai_Arena_Allocator arena = {0};
+    kai_arena_create(&arena, &allocator);
+    Kai_Expr* root = kai_compact_expand(&parsed, 1, &arena);
+    assert_true(kai_string_equals(expected, capture(&allocator, write_expression_0, root)));
+    Kai_u32 count = 0;
+    for (Kai_Stmt* stmt = tree.root.head; stmt != NULL; stmt = stmt->next, ++count) {
+        Kai_Expr* expanded = kai_compact_expand(&parsed, kai_compact_child(&parsed, 1, count), &arena);
+        check_expanded(stmt, expanded);
+    }
+    kai_arena_destroy(&arena);
+    kai_destroy_compact_tree(&parsed);
+
+    kai_destroy_compact_tree(&compact);
+    kai_destroy_syntax_tree(&tree);
+    kai_destroy_atom_table(&atoms);
+}
+
+int main()
+{
+    // Smaller than the header of a syntax tree node
+    assert_true(sizeof(Kai_Compact_Node) == 32 && sizeof(Kai_Compact_Node) < sizeof(Kai_Expr));
+
+    check((Kai_Source){
+        .name = KAI_CONST_STRING("compact"),
+        .contents = { .data = (Kai_u8*)script, .count = (Kai_u32)strlen(script) },
+    });
+    for (int i = 0; i < (int)(sizeof(script_files) / sizeof(script_files[0])); ++i) {
+        Kai_Source source = load_source_file(script_files[i]);
+        check(source);
+        kai_source_unmap(&source);
+    }
+}
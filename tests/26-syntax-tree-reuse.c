@@ -0,0 +1,107 @@
+#include "test.h"
+
+// A tree that is reset keeps its memory, so parsing the same
+// source again does not allocate anything.
+static Kai_Allocator counted_base;
+static Kai_u32 allocation_count;
+
+static void* counted_heap_allocate(void* user, void* ptr, Kai_u32 new_size, Kai_u32 old_size)
+{
+    if (new_size != 0) allocation_count += 1;
+    return counted_base.heap_allocate(user, ptr, new_size, old_size);
+}
+
+static Kai_Allocator counted_allocator()
+{
+    counted_base = default_allocator();
+    Kai_Allocator allocator = counted_base;
+    allocator.heap_allocate = counted_heap_allocate;
+    return allocator;
+}
+
+static void generate_script(String_Builder* builder, int count)
+{
+    for (int i = 0; i < count; ++i)
+        sb_appendf(builder,
+            "Value_%i :: struct { name: string; value: s32; }\n"
+            "make_%i :: (x: s32) -> Value_%i {\n"
+            "    v: Value_%i;\n"
+            "    v.name = \"value \\\"%i\\\"\";\n"
+            "    for i: 0..<x { v.value += i * %i; }\n"
+            "    ret v;\n"
+            "}\n", i, i, i, i, i, i);
+}
+
+int main()
+{
+    Kai_Allocator allocator = counted_allocator();
+    Kai_Atom_Table atoms = {0};
+    kai_create_atom_table(&atoms, &allocator);
+
+    // Large enough to need more than one arena bucket
+    String_Builder script = {0};
+    generate_script(&script, 2000);
+    Kai_Syntax_Tree_Create_Info info = {
+        .source = {
+            .name = KAI_CONST_STRING("reuse"),
+            .contents = { .data = (Kai_u8*)script.items, .count = (Kai_u32)script.count },
+        },
+        .allocator = allocator,
+        .error = default_error(),
+        .atoms = &atoms,
+    };
+
+    Kai_Syntax_Tree tree = {0};
+    kai_create_syntax_tree(&info, &tree);
+    assert_no_error();
+    Kai_Stmt* first = tree.root.head;
+    assert_true(first != NULL && kai_string_equals(first->name, KAI_STRING("Value_0")));
+    assert_true(kai_source_line(&tree.source, first->next->offset) == 2);
+
+    for (int i = 0; i < 5; ++i) {
+        kai_reset_syntax_tree(&tree);
+        allocation_count = 0;
+        kai_create_syntax_tree(&info, &tree);
+        assert_no_error();
+        assert_true(allocation_count == 0);
+        assert_true(kai_string_equals(tree.root.head->name, KAI_STRING("Value_0")));
+    }
+
+    // A smaller source fits in the same memory
+    String_Builder small = {0};
+    generate_script(&small, 3);
+    kai_reset_syntax_tree(&tree);
+    allocation_count = 0;
+    info.source.contents = (Kai_string){ .data = (Kai_u8*)small.items, .count = (Kai_u32)small.count };
+    kai_create_syntax_tree(&info, &tree);
+    assert_no_error();
+    assert_true(allocation_count == 0);
+    assert_true(tree.source.line_starts.count == 3 * 7 + 1);
+    kai_destroy_syntax_tree(&tree);
+
+    // Nodes in a caller arena, reset gives the arena back
+    Kai_Arena_Allocator arena = {0};
+    kai_arena_create(&arena, &allocator);
+    Kai_Arena_Checkpoint start = kai_arena_save(&arena);
+    info.arena = &arena;
+    info.source.contents = (Kai_string){ .data = (Kai_u8*)script.items, .count = (Kai_u32)script.count };
+    Kai_Syntax_Tree in_arena = {0};
+    kai_create_syntax_tree(&info, &in_arena);
+    assert_no_error();
+    assert_true(in_arena.allocator.current_bucket == NULL);
+    assert_true(arena.current_bucket != start.bucket || arena.current_allocated > start.allocated);
+
+    for (int i = 0; i < 3; ++i) {
+        kai_reset_syntax_tree(&in_arena);
+        assert_true(arena.current_bucket == start.bucket && arena.current_allocated == start.allocated);
+        allocation_count = 0;
+        kai_create_syntax_tree(&info, &in_arena);
+        assert_no_error();
+        assert_true(allocation_count == 0);
+        assert_true(kai_string_equals(in_arena.root.head->name, KAI_STRING("Value_0")));
+    }
+
+    kai_destroy_syntax_tree(&in_arena);
+    kai_arena_destroy(&arena);
+    kai_destroy_atom_table(&atoms);
+}
@@ -0,0 +1,192 @@
+#include "test.h"
+
+// A tree updated with an edit is the same as parsing the new source from the
+// beginning, and statements the edit did not touch keep their nodes.
+static const char* script =
+    "Point :: struct { x: f32; y: f32; } @tag(1, \"two\")\n"
+    "Color :: enum u8 { RED; GREEN = 2; }\n"
+    "name :: \"a \\\"quoted\\\" string\";\n"
+    "#export main :: (n: s32) -> s32 {\n"
+    "    p: Point = .{x = 1.5, y = 2};\n"
+    "    for i: 0..<n { p.x += i; }\n"
+    "    ret n;\n"
+    "}\n"
+    "/* comment */ count :: 10;\n"
+    "add :: (a: s32, b: s32) -> s32 { ret a + b; }\n"
+    "Pair :: struct { a: s32; b: s32; }\n"
+    "last :: add(1, 2);\n";
+
+static const char* snippets[] = {
+    "", " ", "\n", ";", "x", "9", "}", "{", "\"", "// note\n", "/*", "*/",
+    "z :: 3;\n", "Empty :: struct {}\n", "f :: () { ret; }\n",
+    "s :: \"new\\tstring\";", "#export", "@mark", "ret", ": s32 =", "\r", "\r\n",
+};
+
+typedef struct {
+    char* data;
+    Kai_u32 count;
+    Kai_u32 capacity;
+} Text;
+
+static Kai_string text_string(Text* text)
+{
+    return (Kai_string){ .data = (Kai_u8*)text->data, .count = text->count };
+}
+
+// Edits the text in place or in a new buffer, the old buffer is given back to be freed after the update
+static char* text_edit(Text* text, Kai_Source_Edit edit, const char* inserted, int in_place)
+{
+    Kai_u32 count = text->count - edit.removed + edit.inserted;
+    char* old = NULL;
+    if (!in_place || count > text->capacity) {
+        old = text->data;
+        text->capacity = count * 2 + 16;
+        text->data = malloc(text->capacity);
+        memcpy(text->data, old, text->count);
+    }
+    memmove(text->data + edit.offset + edit.inserted, text->data + edit.offset + edit.removed,
+        text->count - edit.offset - edit.removed);
+    memcpy(text->data + edit.offset, inserted, edit.inserted);
+    text->count = count;
+    return old;
+}
+
+static Kai_Compact_Tree compact(Kai_Syntax_Tree* tree, Kai_Atom_Table* atoms, Kai_Allocator* allocator)
+{
+    Kai_Compact_Tree out = {0};
+    kai_create_compact_tree(tree, atoms, allocator, &out);
+    return out;
+}
+
+static void assert_same_spans(Kai_Syntax_Tree* updated, Kai_Syntax_Tree* parsed)
+{
+    assert_true(updated->spans.count == parsed->spans.count);
+    for (Kai_u32 i = 0; i < parsed->spans.count; ++i)
+        assert_true(updated->spans.data[i].start == parsed->spans.data[i].start);
+    assert_true(updated->source.line_starts.count == parsed->source.line_starts.count);
+    assert_true(memcmp(updated->source.line_starts.data, parsed->source.line_starts.data,
+        parsed->source.line_starts.count * sizeof(Kai_u32)) == 0);
+}
+
+static void assert_same_tree(Kai_Syntax_Tree* updated, Kai_Syntax_Tree* parsed, Kai_Atom_Table* atoms, Kai_Allocator* allocator)
+{
+    // Offsets, names and source code of every node are in the compact tree
+    Kai_Compact_Tree a = compact(updated, atoms, allocator);
+    Kai_Compact_Tree b = compact(parsed, atoms, allocator);
+    assert_true(a.nodes.count == b.nodes.count);
+    assert_true(memcmp(a.nodes.data, b.nodes.data, a.nodes.count * sizeof(Kai_Compact_Node)) == 0);
+    assert_true(a.string_data.count == b.string_data.count);
+    assert_true(a.string_data.count == 0 || memcmp(a.string_data.data, b.string_data.data, a.string_data.count) == 0);
+    kai_destroy_compact_tree(&a);
+    kai_destroy_compact_tree(&b);
+    assert_same_spans(updated, parsed);
+}
+
+int main()
+{
+    Kai_Allocator allocator = default_allocator();
+    Kai_Atom_Table atoms = {0};
+    kai_create_atom_table(&atoms, &allocator);
+
+    Text text = { .count = (Kai_u32)strlen(script) };
+    text.capacity = text.count;
+    text.data = malloc(text.capacity);
+    memcpy(text.data, script, text.count);
+
+    Kai_Error update_error = {0};
+    Kai_Error parse_error = {0};
+    Kai_Syntax_Tree_Create_Info info = {
+        .source = { .name = KAI_CONST_STRING("edited"), .contents = text_string(&text) },
+        .allocator = allocator,
+        .error = &update_error,
+        .atoms = &atoms,
+    };
+    Kai_Syntax_Tree tree = {0};
+    assert_true(kai_create_syntax_tree(&info, &tree) == KAI_SUCCESS);
+    assert_true(tree.spans.count == 8);
+
+    // Changing the body of `main` only parses `main` again
+    Kai_Stmt* point = tree.root.head;
+    Kai_Stmt* pair = tree.spans.data[6].stmt;
+    const char* body = strstr(text.data, "ret n;");
+    Kai_Source_Edit edit = { .offset = (Kai_u32)(body - text.data) + 4, .removed = 1, .inserted = 5 };
+    free(text_edit(&text, edit, "n * 2", 0));
+    info.source.contents = text_string(&text);
+    assert_true(kai_update_syntax_tree(&info, &tree, edit) == KAI_SUCCESS);
+    assert_true(tree.update_bytes < text.count / 2);
+    assert_true(tree.root.head == point && tree.spans.data[6].stmt == pair);
+
+    // Nodes after the edit are moved once they are settled, not by each update
+    Kai_u32 pair_offset = (Kai_u32)(strstr(text.data, "Pair ::") - text.data);
+    assert_true(tree.spans.data[6].start == pair_offset && pair->offset == pair_offset - 4);
+    kai_settle_syntax_tree(&tree);
+    assert_true(kai_string_equals(pair->name, KAI_STRING("Pair")));
+    assert_true(pair->offset == pair_offset);
+    assert_true(pair->name.data == (Kai_u8*)text.data + pair_offset);
+    assert_true(kai_source_line(&tree.source, pair->offset) == 11);
+
+    Kai_Syntax_Tree parsed = {0};
+    Kai_Syntax_Tree_Create_Info parse_info = info;
+    parse_info.error = &parse_error;
+    assert_true(kai_create_syntax_tree(&parse_info, &parsed) == KAI_SUCCESS);
+    assert_same_tree(&tree, &parsed, &atoms, &allocator);
+    kai_destroy_syntax_tree(&parsed);
+
+    // Random edits, with syntax errors on the way. Nodes are compared (and so settled)
+    // after every third update, so they are also moved by several updates at once.
+    srand(2718);
+    for (int trial = 0; trial < 6000; ++trial)
+    {
+        const char* inserted = snippets[rand() % (sizeof(snippets) / sizeof(snippets[0]))];
+        edit.offset = text.count == 0 ? 0 : (Kai_u32)(rand() % (text.count + 1));
+        edit.removed = rand() % 3 == 0 ? (Kai_u32)(rand() % 12) : 0;
+        if (edit.offset + edit.removed > text.count) edit.removed = text.count - edit.offset;
+        edit.inserted = (Kai_u32)strlen(inserted);
+
+        // Keep the text from growing without end
+        if (text.count > 2000) {
+            edit.offset = 0;
+            edit.removed = text.count / 2;
+        }
+
+        char* old = text_edit(&text, edit, inserted, trial % 2);
+        info.source.contents = text_string(&text);
+        Kai_Result result = kai_update_syntax_tree(&info, &tree, edit);
+        free(old);
+
+        parse_info.source.contents = info.source.contents;
+        Kai_Result expected = kai_create_syntax_tree(&parse_info, &parsed);
+        assert_true(result == expected);
+        if (result == KAI_SUCCESS && trial % 3 == 0)
+            assert_same_tree(&tree, &parsed, &atoms, &allocator);
+        else if (result == KAI_SUCCESS)
+            assert_same_spans(&tree, &parsed);
+        else
+            assert_true(update_error.location.line == parse_error.location.line);
+        update_error.result = KAI_SUCCESS;
+        parse_error.result = KAI_SUCCESS;
+        kai_reset_syntax_tree(&parsed);
+    }
+
+    // A tree with an error is parsed again from the beginning
+    free(text.data);
+    text.data = strdup("a :: 1;\nb :: ;\nc :: 3;\n");
+    text.count = text.capacity = (Kai_u32)strlen(text.data);
+    kai_reset_syntax_tree(&tree);
+    info.source.contents = text_string(&text);
+    assert_true(kai_create_syntax_tree(&info, &tree) == KAI_ERROR_SYNTAX);
+    assert_true(tree.incomplete);
+    update_error.result = KAI_SUCCESS;
+    edit = (Kai_Source_Edit){ .offset = 13, .inserted = 1 };
+    free(text_edit(&text, edit, "2", 0));
+    info.source.contents = text_string(&text);
+    assert_true(kai_update_syntax_tree(&info, &tree, edit) == KAI_SUCCESS);
+    kai_settle_syntax_tree(&tree);
+    assert_true(!tree.incomplete && tree.spans.count == 3);
+    assert_true(kai_string_equals(tree.spans.data[2].stmt->name, KAI_STRING("c")));
+
+    free(text.data);
+    kai_destroy_syntax_tree(&parsed);
+    kai_destroy_syntax_tree(&tree);
+    kai_destroy_atom_table(&atoms);
+}
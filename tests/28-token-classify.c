@@ -0,0 +1,184 @@
+#include "test.h"
+
+// Classified runs are the tokens of the tokenizer plus comments, and classifying
+// line by line from saved states gives the same runs cut at line starts.
+#define GENERATED_SIZE (32 << 20)
+
+static const char* script_files[] = {
+    "scripts/simple.kai",
+    "scripts/simple-procedures.kai",
+    "scripts/if-case.kai",
+    "scripts/intrinsics.kai",
+    "scripts/polymorphic.kai",
+    "scripts/types.kai",
+};
+
+static const char* script =
+    "#export main :: (n: s32) -> s32 { // entry\n"
+    "    a := 0x1F + 0b101 + 1_000 + .25 + 1.5e+3;\n"
+    "    for i: 0..<n { a <<= 1; a -= 1; } @tag\n"
+    "    /* nested /* comment\n"
+    "       over */ lines */ s := \"a \\\"string\\\"\n"
+    "over lines\";\n"
+    "    if a >= 10 && a != 3 ret a; else ret -a;\n"
+    "} x :: cast(u8) 3 --- \n";
+
+static Kai_u8 class_of(Kai_Token token)
+{
+    if (token.id & 0x80) return KAI_TOKEN_CLASS_KEYWORD;
+    switch (token.id) {
+    case KAI_TOKEN_IDENTIFIER: return KAI_TOKEN_CLASS_IDENTIFIER;
+    case KAI_TOKEN_NUMBER:     return KAI_TOKEN_CLASS_NUMBER;
+    case KAI_TOKEN_STRING:     return KAI_TOKEN_CLASS_STRING;
+    case KAI_TOKEN_DIRECTIVE:  return KAI_TOKEN_CLASS_DIRECTIVE;
+    case KAI_TOKEN_TAG:        return KAI_TOKEN_CLASS_TAG;
+    default:                   return KAI_TOKEN_CLASS_SYMBOL;
+    }
+}
+
+static int same_runs(Kai_Token_Run* a, Kai_Token_Run* b, Kai_u32 count)
+{
+    for (Kai_u32 i = 0; i < count; ++i)
+        if (a[i].offset != b[i].offset || a[i].length != b[i].length || a[i].kind != b[i].kind)
+            return 0;
+    return 1;
+}
+
+static Kai_Token_Run* classify_all(Kai_string source, Kai_u32 capacity, Kai_u32* count)
+{
+    Kai_Token_Run* runs = malloc((source.count + 1) * sizeof(Kai_Token_Run));
+    Kai_Classify_State state = {0};
+    *count = 0;
+    for (;;) {
+        Kai_u32 n = kai_tokenize_classify(source, source.count, &state, runs + *count, capacity);
+        *count += n;
+        if (n < capacity) break;
+    }
+    assert_true(state.offset >= source.count);
+    return runs;
+}
+
+static void check(Kai_string source)
+{
+    Kai_u32 count;
+    Kai_Token_Run* runs = classify_all(source, 0xFFFFFFFF, &count);
+
+    // Same runs when there is little room for them
+    Kai_u32 small_count;
+    Kai_Token_Run* small = classify_all(source, 3, &small_count);
+    assert_true(small_count == count && same_runs(small, runs, count));
+    free(small);
+
+    // Every token is a run, the runs between them are comments
+    Kai_Allocator allocator = default_allocator();
+    Kai_Arena_Allocator string_arena = {0};
+    kai_arena_create(&string_arena, &allocator);
+    Kai_Tokenizer tokenizer = { .source = source, .string_arena = &string_arena };
+    Kai_u32 i = 0;
+    for (;;) {
+        Kai_Token token = kai_tokenizer_generate(&tokenizer);
+        if (token.id == KAI_TOKEN_END) break;
+        while (i < count && runs[i].kind == KAI_TOKEN_CLASS_COMMENT && runs[i].offset < token.offset) ++i;
+        assert_true(i < count);
+        assert_true(runs[i].offset == token.offset && runs[i].length == token.string.count);
+        assert_true(runs[i].kind == class_of(token));
+        ++i;
+    }
+    while (i < count) assert_true(runs[i++].kind == KAI_TOKEN_CLASS_COMMENT);
+    kai_arena_destroy(&string_arena);
+
+    // Line by line, each line begins with the state the line before ended with
+    Kai_u32 line_count = kai_find_line_starts(source, NULL);
+    Kai_u32* line_starts = malloc(line_count * sizeof(Kai_u32));
+    kai_find_line_starts(source, line_starts);
+    Kai_Classify_State* states = malloc(line_count * sizeof(Kai_Classify_State));
+    Kai_Classify_State state = {0};
+    Kai_Token_Run* line_runs = malloc((source.count + line_count) * sizeof(Kai_Token_Run));
+    Kai_u32 line_run_count = 0;
+    for (Kai_u32 line = 0; line < line_count; ++line) {
+        Kai_u32 end = line + 1 < line_count ? line_starts[line + 1] : source.count;
+        assert_true(state.offset <= end);
+        if (state.offset < line_starts[line]) state.offset = line_starts[line];
+        states[line] = state;
+        line_run_count += kai_tokenize_classify(source, end, &state, line_runs + line_run_count, 0xFFFFFFFF);
+    }
+
+    // Pieces of a run follow each other and have its kind
+    Kai_u32 k = 0;
+    for (i = 0; i < count; ++i) {
+        Kai_u32 offset = runs[i].offset;
+        while (offset < runs[i].offset + runs[i].length) {
+            assert_true(k < line_run_count);
+            assert_true(line_runs[k].offset == offset && line_runs[k].kind == runs[i].kind);
+            offset += line_runs[k++].length;
+        }
+        assert_true(offset == runs[i].offset + runs[i].length);
+    }
+    assert_true(k == line_run_count);
+
+    // Any line again by itself, from its saved state
+    for (Kai_u32 line = 0; line < line_count; line += 3) {
+        Kai_u32 end = line + 1 < line_count ? line_starts[line + 1] : source.count;
+        Kai_Classify_State again = states[line];
+        Kai_Token_Run viewport[256];
+        Kai_u32 n = kai_tokenize_classify(source, end, &again, viewport, 256);
+        for (k = 0; k < line_run_count && line_runs[k].offset < states[line].offset; ++k) {}
+        assert_true(n == 256 || k + n <= line_run_count);
+        assert_true(same_runs(viewport, line_runs + k, n));
+    }
+
+    free(line_runs);
+    free(states);
+    free(line_starts);
+    free(runs);
+}
+
+int main()
+{
+    check(kai_string_from_c(script));
+    for (int i = 0; i < (int)(sizeof(script_files) / sizeof(script_files[0])); ++i) {
+        Kai_Source source = load_source_file(script_files[i]);
+        check(source.contents);
+        kai_source_unmap(&source);
+    }
+
+    // The inline script has the kinds it should
+    Kai_u32 count;
+    Kai_Token_Run* runs = classify_all(kai_string_from_c(script), 0xFFFFFFFF, &count);
+    assert_true(runs[0].kind == KAI_TOKEN_CLASS_DIRECTIVE && runs[0].length == 7);
+    assert_true(runs[1].kind == KAI_TOKEN_CLASS_IDENTIFIER && runs[1].length == 4);
+    Kai_u32 comments = 0, strings = 0, keywords = 0, tags = 0;
+    for (Kai_u32 i = 0; i < count; ++i) {
+        comments += runs[i].kind == KAI_TOKEN_CLASS_COMMENT;
+        strings += runs[i].kind == KAI_TOKEN_CLASS_STRING;
+        keywords += runs[i].kind == KAI_TOKEN_CLASS_KEYWORD;
+        tags += runs[i].kind == KAI_TOKEN_CLASS_TAG;
+    }
+    assert_true(comments == 2 && strings == 1 && keywords == 6 && tags == 1);
+    free(runs);
+
+    // Throughput on a large generated data script
+    String_Builder source = {0};
+    for (int i = 0; source.count < GENERATED_SIZE; ++i)
+        sb_appendf(&source,
+            "// generated record %i, do not edit\n"
+            "record_%i :: Record.{\n"
+            "    identifier_name = \"record number %i with some text\",\n"
+            "    value           = %i,\n"
+            "    /* weight */ scaled_weight = value * 3 + offset_%i;\n"
+            "};\n", i, i, i, i * 7, i % 13);
+    Kai_string generated = { .data = (Kai_u8*)source.items, .count = (Kai_u32)source.count };
+    Kai_Token_Run viewport[4096];
+    Kai_Classify_State state = {0};
+    Kai_u32 run_count = 0, n;
+    uint64_t begin = nanos_since_unspecified_epoch();
+    do {
+        n = kai_tokenize_classify(generated, generated.count, &state, viewport, 4096);
+        run_count += n;
+    } while (n == 4096);
+    double seconds = (double)(nanos_since_unspecified_epoch() - begin) * 1e-9;
+    assert_true(state.offset >= generated.count);
+
+    printf("    %.1f MB, %u runs: %.0f MB/s\n",
+        (double)generated.count / (1 << 20), run_count, (double)generated.count / (1 << 20) / seconds);
+}
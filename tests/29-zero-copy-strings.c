@@ -0,0 +1,180 @@
+#include "test.h"
+
+// Strings without escapes are the source itself, only strings with escapes take memory,
+// so the memory of a tree does not grow with the length of its strings.
+static Kai_Allocator counted_base;
+static Kai_u64 allocated_bytes; // in use
+static Kai_u32 allocation_count;
+
+static void* counted_heap_allocate(void* user, void* ptr, Kai_u32 new_size, Kai_u32 old_size)
+{
+    if (new_size != 0) allocation_count += 1;
+    allocated_bytes += (Kai_u64)new_size - old_size;
+    return counted_base.heap_allocate(user, ptr, new_size, old_size);
+}
+
+static Kai_Allocator counted_allocator()
+{
+    counted_base = default_allocator();
+    Kai_Allocator allocator = counted_base;
+    allocator.heap_allocate = counted_heap_allocate;
+    return allocator;
+}
+
+static int in_source(Kai_string s, Kai_string source)
+{
+    return s.data >= source.data && s.data + s.count <= source.data + source.count;
+}
+
+// Memory a tree and its atoms take for a script of `count` strings of `length` bytes
+static Kai_u64 parse_bytes(Kai_Allocator* allocator, int count, int length)
+{
+    String_Builder data = {0};
+    for (int i = 0; i < count; ++i) {
+        sb_appendf(&data, "record_%i :: \"", i);
+        for (int k = 0; k < length; ++k) da_append(&data, 'a' + (i + k) % 26);
+        sb_append_cstr(&data, "\";\n");
+    }
+    Kai_u64 start = allocated_bytes;
+    Kai_Atom_Table atoms = {0};
+    kai_create_atom_table(&atoms, allocator);
+    Kai_Syntax_Tree_Create_Info info = {
+        .source = {
+            .name = KAI_CONST_STRING("data"),
+            .contents = { .data = (Kai_u8*)data.items, .count = (Kai_u32)data.count },
+        },
+        .allocator = *allocator,
+        .error = default_error(),
+        .atoms = &atoms,
+    };
+    Kai_Syntax_Tree tree = {0};
+    kai_create_syntax_tree(&info, &tree);
+    assert_no_error();
+    Kai_u64 bytes = allocated_bytes - start;
+
+    Kai_Stmt_Declaration* first = (Kai_Stmt_Declaration*)tree.root.head;
+    assert_true(first->value->id == KAI_EXPR_STRING);
+    Kai_string value = ((Kai_Expr_String*)first->value)->value;
+    assert_true(value.count == (Kai_u32)length && in_source(value, info.source.contents));
+
+    kai_destroy_syntax_tree(&tree);
+    kai_destroy_atom_table(&atoms);
+    sb_free(data);
+    return bytes;
+}
+
+static const char* script =
+    "plain :: \"no escapes here\";\n"
+    "empty :: \"\";\n"
+    "escaped :: \"tab\\there \\\"quoted\\\" \\\\ end\\n\";\n"
+    "unknown :: \"\\q\";\n"
+    "main :: () { s := \"inner\"; }\n";
+
+int main()
+{
+    Kai_Allocator allocator = counted_allocator();
+    Kai_Arena_Allocator string_arena = {0};
+    kai_arena_create(&string_arena, &allocator);
+
+    // Values point into the source unless there was an escape
+    Kai_string source = kai_string_from_c(script);
+    Kai_Tokenizer tokenizer = { .source = source, .string_arena = &string_arena };
+    Kai_string expected[] = {
+        KAI_STRING("no escapes here"), KAI_STRING(""), KAI_STRING("tab\there \"quoted\" \\ end\n"),
+        KAI_STRING("q"), KAI_STRING("inner"),
+    };
+    Kai_u32 found = 0;
+    for (;;) {
+        Kai_Token token = kai_tokenizer_generate(&tokenizer);
+        if (token.id == KAI_TOKEN_END) break;
+        if (token.id != KAI_TOKEN_STRING) continue;
+        assert_true(kai_string_equals(token.value.string, expected[found]));
+        assert_true(in_source(token.string, source) && token.string.data[token.string.count - 1] == '"');
+        assert_true(in_source(token.value.string, source) == (found != 2 && found != 3));
+        found += 1;
+    }
+    assert_true(found == 5);
+
+    // Unterminated strings end with the source, with or without an escape
+    Kai_string unterminated = KAI_STRING("\"abc");
+    tokenizer = (Kai_Tokenizer){ .source = unterminated, .string_arena = &string_arena };
+    Kai_Token token = kai_tokenizer_generate(&tokenizer);
+    assert_true(token.string.count == unterminated.count + 1 && kai_string_equals(token.value.string, KAI_STRING("abc")));
+    unterminated = KAI_STRING("\"a\\tb\\");
+    tokenizer = (Kai_Tokenizer){ .source = unterminated, .string_arena = &string_arena };
+    token = kai_tokenizer_generate(&tokenizer);
+    assert_true(token.string.count == unterminated.count + 1 && kai_string_equals(token.value.string, KAI_STRING("a\tb")));
+
+    // An escaped string larger than an arena bucket
+    String_Builder large = {0};
+    sb_append_cstr(&large, "\"");
+    for (int i = 0; i < 50000; ++i) sb_append_cstr(&large, "ab\\n");
+    sb_append_cstr(&large, "\" next");
+    tokenizer = (Kai_Tokenizer){
+        .source = { .data = (Kai_u8*)large.items, .count = (Kai_u32)large.count },
+        .string_arena = &string_arena,
+    };
+    token = kai_tokenizer_generate(&tokenizer);
+    assert_true(token.id == KAI_TOKEN_STRING && token.value.string.count == 150000);
+    assert_true(token.value.string.data[149999] == '\n' && token.value.string.data[149998] == 'b');
+    assert_true(kai_tokenizer_generate(&tokenizer).id == KAI_TOKEN_IDENTIFIER);
+    Kai_Arena_Checkpoint before = kai_arena_save(&string_arena);
+    tokenizer.cursor = 0;
+    kai_tokenizer_generate(&tokenizer);
+    assert_true(string_arena.large != before.large);
+    kai_arena_restore(&string_arena, before);
+    assert_true(string_arena.large == before.large);
+    kai_arena_destroy(&string_arena);
+    assert_true(string_arena.large == NULL);
+
+    // Longer strings do not take more memory
+    Kai_u64 short_bytes = parse_bytes(&allocator, 20000, 20);
+    Kai_u64 long_bytes = parse_bytes(&allocator, 20000, 400);
+    printf("    %.1f MB with short strings, %.1f MB with strings 20 times longer\n",
+        (double)short_bytes / (1 << 20), (double)long_bytes / (1 << 20));
+    assert_true(long_bytes == short_bytes);
+
+    Kai_Atom_Table atoms = {0};
+    kai_create_atom_table(&atoms, &allocator);
+    Kai_Syntax_Tree_Create_Info info = {
+        .source = { .name = KAI_CONST_STRING("escaped") },
+        .allocator = allocator,
+        .error = default_error(),
+        .atoms = &atoms,
+    };
+    Kai_Syntax_Tree tree = {0};
+
+    // Escaped strings are in the memory of the tree, which is used again after a reset
+    Kai_Syntax_Tree_Create_Info escaped_info = info;
+    escaped_info.source.contents = source;
+    kai_create_syntax_tree(&escaped_info, &tree);
+    assert_no_error();
+    for (int i = 0; i < 3; ++i) {
+        kai_reset_syntax_tree(&tree);
+        allocation_count = 0;
+        kai_create_syntax_tree(&escaped_info, &tree);
+        assert_no_error();
+        assert_true(allocation_count == 0);
+    }
+
+    // Strings of statements an update keeps move with the source
+    char* edited = strdup(script);
+    edited[0] = 'P';
+    escaped_info.source.contents = kai_string_from_c(edited);
+    Kai_Source_Edit edit = { .offset = 0, .removed = 1, .inserted = 1 };
+    assert_true(kai_update_syntax_tree(&escaped_info, &tree, edit) == KAI_SUCCESS);
+    kai_settle_syntax_tree(&tree);
+    Kai_u32 i = 0;
+    for (Kai_Stmt* stmt = tree.root.head; stmt != NULL; stmt = stmt->next, ++i) {
+        Kai_Expr* expr = ((Kai_Stmt_Declaration*)stmt)->value;
+        if (expr->id != KAI_EXPR_STRING) continue;
+        Kai_string value = ((Kai_Expr_String*)expr)->value;
+        assert_true(kai_string_equals(value, expected[i]));
+        assert_true(in_source(value, escaped_info.source.contents) == (i != 2 && i != 3));
+    }
+    assert_true(i == 5);
+
+    free(edited);
+    kai_destroy_syntax_tree(&tree);
+    kai_destroy_atom_table(&atoms);
+}
@@ -0,0 +1,82 @@
+#include "test.h"
+
+// A mapped source has the bytes of the file, and compiles and reports errors
+// the same as a source that was read into memory.
+#define TEMP_PATH "30-mapped-source.tmp"
+
+static void write_file(const char* contents)
+{
+    FILE* f = fopen(TEMP_PATH, "wb");
+    assert_true(f != NULL);
+    fwrite(contents, 1, strlen(contents), f);
+    fclose(f);
+}
+
+int main()
+{
+    Kai_Source source = {0};
+    assert_true(kai_source_map_file("scripts/simple.kai", &source) == KAI_SUCCESS);
+    assert_true(kai_string_equals(source.name, KAI_STRING("scripts/simple.kai")));
+    String_Builder read = {0};
+    assert_true(read_entire_file("scripts/simple.kai", &read));
+    assert_true(source.contents.count == read.count && read.count != 0);
+    assert_true(memcmp(source.contents.data, read.items, read.count) == 0);
+
+    Kai_Program program = {0};
+    Kai_Program_Create_Info info = {
+        .allocator = default_allocator(),
+        .error = default_error(),
+        .sources = { .count = 1, .data = &source },
+    };
+    kai_create_program(&info, &program);
+    assert_no_error();
+    kai_destroy_program(&program);
+    kai_source_unmap(&source);
+    assert_true(source.contents.data == NULL && source.contents.count == 0);
+
+    // Errors point into the mapping
+    write_file("a :: 1;\nb :: ;\n");
+    assert_true(kai_source_map_file(TEMP_PATH, &source) == KAI_SUCCESS);
+    Kai_Syntax_Tree tree = {0};
+    Kai_Error error = {0};
+    Kai_Syntax_Tree_Create_Info tree_info = {
+        .source = source,
+        .allocator = default_allocator(),
+        .error = &error,
+    };
+    assert_true(kai_create_syntax_tree(&tree_info, &tree) == KAI_ERROR_SYNTAX);
+    assert_true(error.location.line == 2);
+    assert_true(error.location.string.data >= source.contents.data
+        && error.location.string.data < source.contents.data + source.contents.count);
+    kai_write_error(default_writer(), &error);
+    kai_destroy_syntax_tree(&tree);
+    kai_source_unmap(&source);
+
+    // An error on the last line of a file that fills its pages, with no newline or null after it
+    String_Builder full = {0};
+    sb_append_cstr(&full, "a :: 1;\n");
+    while (full.count < 4096 - 8) da_append(&full, '/');
+    sb_append_cstr(&full, "\nb :: ;");
+    while (full.count < 4096) da_append(&full, ' ');
+    sb_append_null(&full);
+    write_file(full.items);
+    assert_true(kai_source_map_file(TEMP_PATH, &source) == KAI_SUCCESS);
+    assert_true(source.contents.count == 4096);
+    tree_info.source = source;
+    error = (Kai_Error){0};
+    assert_true(kai_create_syntax_tree(&tree_info, &tree) == KAI_ERROR_SYNTAX);
+    assert_true(error.location.line == 3);
+    kai_write_error(default_writer(), &error);
+    kai_destroy_syntax_tree(&tree);
+    kai_source_unmap(&source);
+    sb_free(full);
+
+    // Empty files have no contents, missing files are an error
+    write_file("");
+    assert_true(kai_source_map_file(TEMP_PATH, &source) == KAI_SUCCESS);
+    assert_true(source.contents.count == 0);
+    kai_source_unmap(&source);
+    remove(TEMP_PATH);
+    assert_true(kai_source_map_file(TEMP_PATH, &source) == KAI_ERROR_INTERNAL);
+    assert_true(source.contents.data == NULL);
+}
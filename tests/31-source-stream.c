@@ -0,0 +1,212 @@
+#include "test.h"
+
+// Declarations of a stream are the same as the declarations of the whole source,
+// however the source is cut into pieces by the reads and the window.
+static const char* script =
+    "Point :: struct { x: f32; y: f32; } @tag(1, \"two\")\n"
+    "Color :: enum u8 { RED; GREEN = 2; }\r\n"
+    "name :: \"a \\\"quoted\\\" string\";\n"
+    "#export main :: (n: s32) -> s32 {\n"
+    "    p: Point = .{x = 1.5, y = 2};\n"
+    "    for i: 0..<n { p.x += i; }\n"
+    "    ret n;\n"
+    "}\n"
+    "/* comment /* nested */\n over lines */ count :: 10;\r\n"
+    "add :: (a: s32, b: s32) -> s32 { ret a + b; } // after\n"
+    "Pair :: struct { a: s32; b: s32; }\n"
+    "long_name_that_is_cut_more_often_than_the_others :: 1.5e+3;\n"
+    "last :: add(1, 2);\n";
+
+typedef struct {
+    const char* data;
+    Kai_u64 count;
+    Kai_u64 position;
+    Kai_u32 most; // bytes in one read
+} Reader;
+
+static Kai_u32 read_piece(void* user, Kai_u8* buffer, Kai_u32 capacity)
+{
+    Reader* reader = (Reader*)user;
+    Kai_u64 n = 1 + (Kai_u64)rand() % reader->most;
+    if (n > capacity) n = capacity;
+    if (n > reader->count - reader->position) n = reader->count - reader->position;
+    memcpy(buffer, reader->data + reader->position, n);
+    reader->position += n;
+    return (Kai_u32)n;
+}
+
+static Kai_string capture(Kai_Allocator* allocator, Kai_Expr* expr)
+{
+    static Kai_Growing_Arena arena;
+    arena = (Kai_Growing_Arena){ .allocator = *allocator };
+    Kai_Writer writer = kai_writer_from_arena(&arena);
+    kai_write_expression(&writer, expr, 0);
+    return (Kai_string){ .data = arena.buffer.data, .count = arena.buffer.count };
+}
+
+// Streams `source` and checks each declaration against the tree of all of it
+static void check(Kai_string source, Kai_u32 window_size, Kai_u32 most)
+{
+    Kai_Allocator allocator = default_allocator();
+    Kai_Atom_Table atoms = {0};
+    kai_create_atom_table(&atoms, &allocator);
+    Kai_Error tree_error = {0};
+    Kai_Syntax_Tree_Create_Info tree_info = {
+        .source = { .name = KAI_CONST_STRING("stream"), .contents = source },
+        .allocator = allocator,
+        .error = &tree_error,
+        .atoms = &atoms,
+    };
+    Kai_Syntax_Tree tree = {0};
+    kai_create_syntax_tree(&tree_info, &tree);
+
+    Reader reader = { .data = (const char*)source.data, .count = source.count, .most = most };
+    Kai_Error error = {0};
+    Kai_Source_Stream_Create_Info info = {
+        .name = KAI_CONST_STRING("stream"),
+        .read = read_piece,
+        .user = &reader,
+        .window_size = window_size,
+        .allocator = allocator,
+        .error = &error,
+        .atoms = &atoms,
+    };
+    Kai_Source_Stream stream = {0};
+    assert_true(kai_create_source_stream(&info, &stream) == KAI_SUCCESS);
+
+    Kai_Stmt* expected = tree.root.head;
+    for (Kai_Stmt* stmt; (stmt = kai_source_stream_next(&stream)) != NULL; expected = expected->next) {
+        assert_true(expected != NULL);
+        assert_true(stream.offset + stmt->offset == expected->offset);
+        assert_true(stream.line + kai_source_line(&stream.source, stmt->offset) - 1
+            == kai_source_line(&tree.source, expected->offset));
+        assert_true(stmt->name_atom == expected->name_atom);
+        Kai_string a = capture(&allocator, stmt);
+        Kai_string b = capture(&allocator, expected);
+        assert_true(kai_string_equals(a, b));
+    }
+    assert_true(error.result == tree_error.result);
+    if (error.result == KAI_SUCCESS) {
+        assert_true(expected == NULL && reader.position == reader.count);
+    }
+    else {
+        assert_true(error.location.line == tree_error.location.line);
+        assert_true(kai_string_equals(error.message, tree_error.message));
+    }
+    kai_destroy_source_stream(&stream);
+    kai_destroy_syntax_tree(&tree);
+    kai_destroy_atom_table(&atoms);
+}
+
+// Source made as it is read, so that all of it is never in memory
+typedef struct {
+    Kai_u64 size;
+    Kai_u64 position;
+    Kai_u64 records;
+    char pending[256];
+    Kai_u32 pending_count;
+    Kai_u32 pending_start;
+} Generator;
+
+static Kai_u32 read_generated(void* user, Kai_u8* buffer, Kai_u32 capacity)
+{
+    Generator* g = (Generator*)user;
+    Kai_u32 n = 0;
+    while (n < capacity && g->position < g->size) {
+        if (g->pending_start == g->pending_count) {
+            g->pending_count = (Kai_u32)snprintf(g->pending, sizeof(g->pending),
+                "record_%i :: Record.{ name = \"record \\\"%llu\\\"\", value = %llu }; // generated\n",
+                (int)(g->records % 100), (unsigned long long)g->records, (unsigned long long)g->records * 7);
+            g->pending_start = 0;
+            g->records += 1;
+        }
+        buffer[n++] = (Kai_u8)g->pending[g->pending_start++];
+        g->position += 1;
+    }
+    return n;
+}
+
+static Kai_Allocator counted_base;
+static Kai_s64 live_bytes;
+static Kai_s64 most_bytes;
+
+static void* counted_heap_allocate(void* user, void* ptr, Kai_u32 new_size, Kai_u32 old_size)
+{
+    live_bytes += (Kai_s64)new_size - (Kai_s64)old_size;
+    if (live_bytes > most_bytes) most_bytes = live_bytes;
+    return counted_base.heap_allocate(user, ptr, new_size, old_size);
+}
+
+int main()
+{
+    srand(31);
+    Kai_string source = kai_string_from_c(script);
+    check(source, 0, 4096);
+    for (Kai_u32 window = 160; window <= 512; window += 31)
+        for (Kai_u32 most = 1; most < 64; most *= 3)
+            check(source, window, most);
+
+    // A syntax error is on the same line as in the whole source
+    String_Builder broken = {0};
+    sb_append_cstr(&broken, script);
+    sb_append_cstr(&broken, "b :: ;\n");
+    sb_append_cstr(&broken, script);
+    check((Kai_string){ .data = (Kai_u8*)broken.items, .count = (Kai_u32)broken.count }, 200, 7);
+
+    // A declaration larger than the window
+    Kai_Allocator allocator = default_allocator();
+    const char* large = "a :: 1;\nb :: struct { x: s32; y: s32; z: s32; w: s32; }\n";
+    Reader reader = { .data = large, .count = strlen(large), .most = 100 };
+    Kai_Error error = {0};
+    Kai_Source_Stream_Create_Info info = {
+        .name = KAI_CONST_STRING("large"),
+        .read = read_piece,
+        .user = &reader,
+        .window_size = 24,
+        .allocator = allocator,
+        .error = &error,
+    };
+    Kai_Source_Stream stream = {0};
+    kai_create_source_stream(&info, &stream);
+    assert_true(kai_source_stream_next(&stream) != NULL);
+    assert_true(kai_source_stream_next(&stream) == NULL);
+    assert_true(error.result == KAI_ERROR_INTERNAL && error.location.line == 2);
+    assert_true(kai_string_equals(error.message, KAI_STRING("declaration does not fit in the window of the source stream")));
+    assert_true(error.location.string.data == stream.source.contents.data);
+    kai_destroy_source_stream(&stream);
+
+    // Memory stays the same however long the source is
+    counted_base = allocator;
+    allocator.heap_allocate = counted_heap_allocate;
+    Kai_Atom_Table atoms = {0};
+    kai_create_atom_table(&atoms, &allocator);
+    Generator generator = { .size = 32 << 20 };
+    info = (Kai_Source_Stream_Create_Info){
+        .name = KAI_CONST_STRING("generated"),
+        .read = read_generated,
+        .user = &generator,
+        .window_size = 1 << 16,
+        .allocator = allocator,
+        .error = &error,
+        .atoms = &atoms,
+    };
+    error = (Kai_Error){0};
+    kai_create_source_stream(&info, &stream);
+    Kai_u64 count = 0;
+    Kai_Stmt* stmt;
+    uint64_t begin = nanos_since_unspecified_epoch();
+    while ((stmt = kai_source_stream_next(&stream)) != NULL) {
+        assert_true(stmt->id == KAI_STMT_DECLARATION);
+        count += 1;
+    }
+    double seconds = (double)(nanos_since_unspecified_epoch() - begin) * 1e-9;
+    assert_true(error.result == KAI_SUCCESS || error.result == KAI_ERROR_SYNTAX); // the last record is cut
+    assert_true(count + 1 >= generator.records && count <= generator.records);
+    assert_true(stream.offset + stream.source.contents.count == generator.size);
+    printf("    %.1f MB, %llu declarations in %.1f KB of memory: %.0f MB/s\n",
+        (double)generator.size / (1 << 20), (unsigned long long)count, (double)most_bytes / 1024,
+        (double)generator.size / (1 << 20) / seconds);
+    assert_true(most_bytes < (1 << 20));
+    kai_destroy_source_stream(&stream);
+    kai_destroy_atom_table(&atoms);
+}
@@ -0,0 +1,53 @@
+#include "test.h"
+
+// Messages written with _writef, where the format string is lowered to writer calls
+// when kai.h is generated, have the text and arguments in the right places.
+static int starts_with(Kai_string s, const char* prefix)
+{
+    Kai_u32 count = (Kai_u32)strlen(prefix);
+    return s.count >= count && memcmp(s.data, prefix, count) == 0;
+}
+
+static int ends_with(Kai_string s, const char* suffix)
+{
+    Kai_u32 count = (Kai_u32)strlen(suffix);
+    return s.count >= count && memcmp(s.data + s.count - count, suffix, count) == 0;
+}
+
+static int contains(Kai_string s, const char* part)
+{
+    Kai_u32 count = (Kai_u32)strlen(part);
+    for (Kai_u32 i = 0; i + count <= s.count; ++i)
+        if (memcmp(s.data + i, part, count) == 0) return 1;
+    return 0;
+}
+
+int main()
+{
+    // One string argument between two pieces of text
+    Kai_Error error = compile_script("f :: () -> u32 { ret missing; }", NULL, NULL);
+    assert_true(error.result == KAI_ERROR_SEMANTIC);
+    assert_true(kai_string_equals(error.message, KAI_STRING("identifier \"missing\" not declared")));
+
+    // Text after a type written by another procedure
+    error = compile_script("P :: struct { x: s32; }\nf :: (p: P) -> s32 { ret p.z; }", NULL, NULL);
+    assert_true(error.result == KAI_ERROR_SEMANTIC);
+    assert_true(starts_with(error.message, "type "));
+    assert_true(ends_with(error.message, " has no member named \"z\""));
+
+    // Chains of messages
+    error = compile_script("a :: b;\nb :: a;", NULL, NULL);
+    assert_true(error.result == KAI_ERROR_SEMANTIC);
+    assert_true(starts_with(error.message, "detected circular dependency on \""));
+    assert_true(error.next != NULL);
+    assert_true(contains(error.next->message, "\" depends on "));
+    assert_true(starts_with(error.next->message, "type of \"") || starts_with(error.next->message, "value of \""));
+
+    // A number argument, the line of the error
+    error = compile_script("a :: 1;\n\nb :: missing;", NULL, NULL);
+    Kai_Growing_Arena arena = { .allocator = default_allocator() };
+    Kai_Writer writer = kai_writer_from_arena(&arena);
+    kai_write_error(&writer, &error);
+    Kai_string written = { .data = arena.buffer.data, .count = arena.buffer.count };
+    assert_true(contains(written, " 3 | b :: missing;"));
+}
@@ -36,21 +36,134 @@ static inline Kai_Writer* default_writer()
 
 static inline Kai_Source load_source_file(const char* path)
 {
-	String_Builder builder = {0};
-	
-	if (!read_entire_file(path, &builder))
+	Kai_Source source = {0};
+	if (kai_source_map_file(path, &source) != KAI_SUCCESS)
 		FAIL("Failed to read \"%s\"", path);
-	
-	return (Kai_Source) {
-		.name = kai_string_from_c(path),
-		.contents = {
-			.data = (Kai_u8*)(builder.items),
-			.count = (Kai_u32)(builder.count)
-		}
-	};
+	return source;
 }
 
 static inline void write_expression(Kai_Expr* expr)
 {
     kai_write_expression(default_writer(), expr, 1);
 }
+
+// Compiles `script` as the only source of a program, `info` has the other options
+// (NULL to only type-check with the default allocator). The program is destroyed when `program` is NULL.
+static inline Kai_Error compile_script(const char* script, const Kai_Program_Create_Info* info, Kai_Program* program)
+{
+    Kai_Error error = {0};
+    Kai_Source source = { .name = KAI_CONST_STRING("script"), .contents = kai_string_from_c(script) };
+    Kai_Program_Create_Info create = {
+        .allocator = default_allocator(),
+        .options = { .flags = KAI_COMPILE_NO_CODE_GEN },
+    };
+    if (info != NULL) create = *info;
+    create.error = &error;
+    create.sources = (Kai_Source_Slice){ .data = &source, .count = 1 };
+    Kai_Program temporary = {0};
+    kai_create_program(&create, program != NULL ? program : &temporary);
+    kai_destroy_program(&temporary);
+    return error;
+}
+
+// Job system for Kai_Program_Create_Info.jobs, one thread per index
+typedef struct {
+    Kai_P_Job_Run* run;
+    void* data;
+    Kai_u32 index;
+} Thread_Job;
+
+#if defined(_WIN32)
+typedef HANDLE Thread;
+typedef SRWLOCK Thread_Mutex;
+#define THREAD_MUTEX_INITIALIZER SRWLOCK_INIT
+
+static inline DWORD WINAPI thread_job_main(LPVOID user)
+{
+    Thread_Job* job = user;
+    job->run(job->data, job->index);
+    return 0;
+}
+static inline void thread_start(Thread* thread, Thread_Job* job) { *thread = CreateThread(NULL, 0, thread_job_main, job, 0, NULL); }
+static inline void thread_join(Thread thread) { WaitForSingleObject(thread, INFINITE); CloseHandle(thread); }
+static inline void thread_mutex_lock(Thread_Mutex* mutex) { AcquireSRWLockExclusive(mutex); }
+static inline void thread_mutex_unlock(Thread_Mutex* mutex) { ReleaseSRWLockExclusive(mutex); }
+#else
+#include <pthread.h>
+typedef pthread_t Thread;
+typedef pthread_mutex_t Thread_Mutex;
+#define THREAD_MUTEX_INITIALIZER PTHREAD_MUTEX_INITIALIZER
+
+static inline void* thread_job_main(void* user)
+{
+    Thread_Job* job = user;
+    job->run(job->data, job->index);
+    return NULL;
+}
+static inline void thread_start(Thread* thread, Thread_Job* job) { pthread_create(thread, NULL, thread_job_main, job); }
+static inline void thread_join(Thread thread) { pthread_join(thread, NULL); }
+static inline void thread_mutex_lock(Thread_Mutex* mutex) { pthread_mutex_lock(mutex); }
+static inline void thread_mutex_unlock(Thread_Mutex* mutex) { pthread_mutex_unlock(mutex); }
+#endif
+
+static inline void thread_dispatch(void* user, Kai_P_Job_Run* run, void* data, Kai_u32 count)
+{
+    (void)user;
+    Thread threads[64];
+    Thread_Job jobs[64];
+    assert_true(count <= 64);
+    for (Kai_u32 i = 0; i < count; ++i) {
+        jobs[i] = (Thread_Job){ .run = run, .data = data, .index = i };
+        thread_start(&threads[i], &jobs[i]);
+    }
+    for (Kai_u32 i = 0; i < count; ++i)
+        thread_join(threads[i]);
+}
+
+// The default allocator keeps a usage counter, so calls are serialized
+static Kai_Allocator locked_base;
+static Thread_Mutex locked_heap_mutex = THREAD_MUTEX_INITIALIZER;
+
+static inline void* locked_heap_allocate(void* user, void* ptr, Kai_u32 new_size, Kai_u32 old_size)
+{
+    thread_mutex_lock(&locked_heap_mutex);
+    void* result = locked_base.heap_allocate(user, ptr, new_size, old_size);
+    thread_mutex_unlock(&locked_heap_mutex);
+    return result;
+}
+
+static inline Kai_Allocator locked_allocator()
+{
+    if (locked_base.heap_allocate == NULL)
+        locked_base = default_allocator();
+    Kai_Allocator allocator = locked_base;
+    allocator.heap_allocate = locked_heap_allocate;
+    return allocator;
+}
+
+// Machine code stays writable instead of executable, so tests can read the words it was assembled to
+static Kai_Allocator readable_code_base;
+
+static inline void* readable_code_platform_allocate(void* user, void* ptr, Kai_u32 size, Kai_u32 op)
+{
+    if (op == KAI_MEMORY_COMMAND_SET_EXECUTABLE) return NULL;
+    return readable_code_base.platform_allocate(user, ptr, size, op);
+}
+
+static inline Kai_Allocator readable_code_allocator()
+{
+    if (readable_code_base.platform_allocate == NULL)
+        readable_code_base = default_allocator();
+    Kai_Allocator allocator = readable_code_base;
+    allocator.platform_allocate = readable_code_platform_allocate;
+    return allocator;
+}
+
+// Words of an exported procedure, `count` is the rest of the code after it
+static inline Kai_u32* procedure_words(Kai_Program* program, const char* name, Kai_u32* count)
+{
+    Kai_u8* code = kai_find_procedure(program, kai_string_from_c(name), (Kai_string){0});
+    assert_true(code != NULL);
+    *count = (Kai_u32)(program->code.data + program->code.count - code) / 4;
+    return (Kai_u32*)code;
+}